@@ -12,7 +12,40 @@ elseif(${CMAKE_SYSTEM_PROCESSOR} MATCHES "^(aarch64|arm64|arm64e)$")
   set(AARCH64 1)
 endif()
 
+# Builds the s390x code with a portable emulation of the vector intrinsics
+# (for testing on other hosts).
+if(S390X_EMU AND NOT S390X)
+  set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DS390X -DS390X_EMU")
+endif()
+
 if(X86_64)
+    # Test AVX2 (the build defines __AVX2__ with -march=native)
+    try_run(RUN_RESULT COMPILE_RESULT
+            "${CMAKE_BINARY_DIR}" "${PROJECT_SOURCE_DIR}/cmake/test_x86_64_avx2.c"
+            COMPILE_DEFINITIONS "-march=native -Werror -Wall -Wpedantic"
+            OUTPUT_VARIABLE OUTPUT
+    )
+
+    if(${COMPILE_RESULT} AND (RUN_RESULT EQUAL 0))
+        set(AVX2 1)
+    else()
+        message(STATUS "The AVX2 implementation is not supported")
+    endif()
+
+    # Test AVX512-F/DQ (64-bit multiplications)
+    try_run(RUN_RESULT COMPILE_RESULT
+            "${CMAKE_BINARY_DIR}" "${PROJECT_SOURCE_DIR}/cmake/test_x86_64_avx512.c"
+            COMPILE_DEFINITIONS "-march=native -Werror -Wall -Wpedantic"
+            OUTPUT_VARIABLE OUTPUT
+    )
+
+    if(${COMPILE_RESULT} AND (RUN_RESULT EQUAL 0))
+        set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAVX512_SUPPORT")
+        set(AVX512 1)
+    else()
+        message(STATUS "The AVX512 implementation is not supported")
+    endif()
+
     # Test AVX512-IFMA
     try_run(RUN_RESULT COMPILE_RESULT
             "${CMAKE_BINARY_DIR}" "${PROJECT_SOURCE_DIR}/cmake/test_x86_64_avx512_ifma.c"
@@ -60,6 +60,18 @@ if(DEBUG)
     set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DDEBUG")
 endif()
 
+if(GVEC_LANES)
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DGVEC_LANES=${GVEC_LANES}")
+endif()
+
+if(OPENMP)
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -fopenmp")
+endif()
+
+if(CHECK_BOUNDS)
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DNTT_CHECK_BOUNDS")
+endif()
+
 if(INTEL_SDE)
     set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DINTEL_SDE")
 endif()
@@ -2,28 +2,60 @@
 # SPDX-License-Identifier: Apache-2.0
 
 set(NTT_SOURCES 
+    ${SRC_DIR}/final_reduce.c
+    ${SRC_DIR}/ntt_automorphism.c
+    ${SRC_DIR}/ntt_autotune.c
+    ${SRC_DIR}/ntt_bigint.c
+    ${SRC_DIR}/ntt_goldilocks.c
+    ${SRC_DIR}/ntt_mixed_radix.c
+    ${SRC_DIR}/ntt_natural.c
+    ${SRC_DIR}/ntt_nd.c
+    ${SRC_DIR}/ntt_partial.c
     ${SRC_DIR}/ntt_radix4.c
+    ${SRC_DIR}/ntt_radix4_gvec.c
     ${SRC_DIR}/ntt_radix4x4.c
+    ${SRC_DIR}/ntt_radix8.c
     ${SRC_DIR}/ntt_reference.c
 )
 
-if(S390X)
+if(S390X OR S390X_EMU)
     set(NTT_SOURCES ${NTT_SOURCES}
         ${SRC_DIR}/ntt_radix4_s390x_vef.c
     )
 endif()
 
+if(X86_64 AND AVX2)
+    set(NTT_SOURCES ${NTT_SOURCES}
+        ${SRC_DIR}/ntt_goldilocks_avx2.c
+    )
+endif()
+
+if(X86_64 AND AVX512)
+    set(NTT_SOURCES ${NTT_SOURCES}
+        ${SRC_DIR}/ntt_automorphism_avx512.c
+        ${SRC_DIR}/ntt_goldilocks_avx512.c
+        ${SRC_DIR}/ntt_radix4_avx512.c
+    )
+endif()
+
 if(X86_64 AND AVX512_IFMA)
     set(NTT_SOURCES ${NTT_SOURCES}
         ${SRC_DIR}/ntt_radix4_avx512_ifma.c
         ${SRC_DIR}/ntt_r4r2_avx512_ifma.c
         ${SRC_DIR}/ntt_r2_16_avx512_ifma.c
         ${SRC_DIR}/ntt_radix4_avx512_ifma_unordered.c
+        ${SRC_DIR}/ntt_radix8_avx512_ifma.c
     )
 endif()
 
 set(MAIN_SOURCE 
     ${TESTS_DIR}/main.c
     ${TESTS_DIR}/bench.c
+    ${TESTS_DIR}/bench_automorphism.c
+    ${TESTS_DIR}/bench_bigint.c
+    ${TESTS_DIR}/bench_goldilocks.c
+    ${TESTS_DIR}/bench_nd.c
+    ${TESTS_DIR}/bench_trunc.c
+    ${TESTS_DIR}/sweep.c
     ${TESTS_DIR}/test_correctness.c
 )
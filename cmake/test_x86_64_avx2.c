@@ -0,0 +1,17 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdint.h>
+#include <immintrin.h>
+
+int main(void)
+{
+  __m256i reg = {0};
+  uint64_t mem[4] = {0};
+  reg = _mm256_loadu_si256((const __m256i*)mem);
+  reg = _mm256_mul_epu32(reg, reg);
+  reg = _mm256_add_epi64(reg, reg);
+  _mm256_storeu_si256((__m256i*)mem, reg);
+  
+  return 0;
+}
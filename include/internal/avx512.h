@@ -9,6 +9,8 @@ EXTERNC_BEGIN
 
 #include <immintrin.h>
 
+#include "final_reduce.h"
+
 #define ADD(a, b) _mm512_add_epi64(a, b)
 #define SUB(a, b) _mm512_sub_epi64(a, b)
 #define MIN(a, b) _mm512_min_epu64(a, b)
@@ -18,9 +20,6 @@ EXTERNC_BEGIN
 #define UNPACKLO(a, b)   _mm512_unpacklo_epi64((a), (b))
 #define UNPACKHI(a, b)   _mm512_unpackhi_epi64((a), (b))
 
-#define MADDLO(accum, op1, op2) _mm512_madd52lo_epu64((accum), (op1), (op2))
-#define MADDHI(accum, op1, op2) _mm512_madd52hi_epu64((accum), (op1), (op2))
-
 #define SET1(val) _mm512_set1_epi64(val)
 #define SETR(a, b, c, d, e, f, g, h) \
   _mm512_setr_epi64((a), (b), (c), (d), (e), (f), (g), (h))
@@ -28,9 +27,19 @@ EXTERNC_BEGIN
 #define LOADA(mem)      _mm512_load_epi64((mem))
 #define STORE(mem, reg) _mm512_storeu_epi64((mem), (reg))
 
+// Non-temporal store, mem must be 64-byte aligned. A store fence (SFENCE)
+// orders the streamed data before later stores.
+#define STREAM(mem, reg)   _mm512_stream_si512((__m512i *)(mem), (reg))
+#define SFENCE()           _mm_sfence()
+#define IS_ALIGNED_64(mem) (0 == ((uintptr_t)(mem)&63))
+
 #define GATHER(idx, mem, scale) _mm512_i64gather_epi64((idx), (mem), (scale))
 #define SCATTER(mem, idx, reg, scale) \
   _mm512_i64scatter_epi64((mem), (idx), (reg), scale)
+// Eight 64-bit values at 32-bit indices (a __m256i).
+#define GATHER_I32(idx, mem, scale) \
+  _mm512_i32gather_epi64((idx), (mem), (scale))
+#define LOAD_256(mem) _mm256_loadu_si256((const __m256i *)(mem))
 
 #define SET1_256(val)            _mm256_set1_epi64x(val)
 #define BROADCAST2HALVES(v1, v2) _mm512_inserti64x4(SET1((v1)), SET1_256((v2)), 1)
@@ -45,6 +54,47 @@ static inline __m512i reduce_if_greater(const __m512i val, const __m512i mod)
   return MIN(val, SUB(val, mod));
 }
 
+// In-place transpose of an 8x8 matrix of qw, where X[i] is the i'th row.
+static inline void transpose_8x8_m512(__m512i X[8])
+{
+  const __m512i idx_lo = SETR(0, 1, 8, 9, 4, 5, 12, 13);
+  const __m512i idx_hi = SETR(2, 3, 10, 11, 6, 7, 14, 15);
+
+  const __m512i T0 = UNPACKLO(X[0], X[1]);
+  const __m512i T1 = UNPACKHI(X[0], X[1]);
+  const __m512i T2 = UNPACKLO(X[2], X[3]);
+  const __m512i T3 = UNPACKHI(X[2], X[3]);
+  const __m512i T4 = UNPACKLO(X[4], X[5]);
+  const __m512i T5 = UNPACKHI(X[4], X[5]);
+  const __m512i T6 = UNPACKLO(X[6], X[7]);
+  const __m512i T7 = UNPACKHI(X[6], X[7]);
+
+  // Columns (0,4), (1,5), (2,6), (3,7) of rows 0-3 and of rows 4-7.
+  const __m512i U0 = PERM(T0, idx_lo, T2);
+  const __m512i U1 = PERM(T1, idx_lo, T3);
+  const __m512i U2 = PERM(T0, idx_hi, T2);
+  const __m512i U3 = PERM(T1, idx_hi, T3);
+  const __m512i U4 = PERM(T4, idx_lo, T6);
+  const __m512i U5 = PERM(T5, idx_lo, T7);
+  const __m512i U6 = PERM(T4, idx_hi, T6);
+  const __m512i U7 = PERM(T5, idx_hi, T7);
+
+  X[0] = SHUF(U0, U4, 0x44);
+  X[1] = SHUF(U1, U5, 0x44);
+  X[2] = SHUF(U2, U6, 0x44);
+  X[3] = SHUF(U3, U7, 0x44);
+  X[4] = SHUF(U0, U4, 0xee);
+  X[5] = SHUF(U1, U5, 0xee);
+  X[6] = SHUF(U2, U6, 0xee);
+  X[7] = SHUF(U3, U7, 0xee);
+}
+
+// The following functions use the 52-bit multiplications of AVX512-IFMA.
+#ifdef AVX512_IFMA_SUPPORT
+
+#  define MADDLO(accum, op1, op2) _mm512_madd52lo_epu64((accum), (op1), (op2))
+#  define MADDHI(accum, op1, op2) _mm512_madd52hi_epu64((accum), (op1), (op2))
+
 static inline __m512i
 fast_mul_mod_q2_m512(const mul_op_m512_t w, const __m512i t, const __m512i neg_q)
 {
@@ -54,6 +104,9 @@ fast_mul_mod_q2_m512(const mul_op_m512_t w, const __m512i t, const __m512i neg_q
   return MADDLO(tmp, w.op, t) & AVX512_IFMA_WORD_SIZE_MASK;
 }
 
+// Returns w1*t1 + w2*t2 mod q. Each of the two MADDHI quotients may be short
+// by up to 2 (t1, t2 < 2^52), so for q < 2^49 and t1, t2 < 8q the result is
+// in the range [0, 4q) (not [0, 2q)).
 static inline __m512i fast_dbl_mul_mod_q2_m512(const mul_op_m512_t w1,
                                                const mul_op_m512_t w2,
                                                const __m512i       t1,
@@ -84,8 +137,12 @@ static inline void fwd_radix4_butterfly_m512(__m512i *           X,
   const __m512i T1 = reduce_if_greater(*X, q4);
   const __m512i T2 = fast_mul_mod_q2_m512(w[0], *Z, neg_q);
 
-  const __m512i Y1 = fast_dbl_mul_mod_q2_m512(w[1], w[2], *Y, *T, neg_q);
-  const __m512i Y2 = fast_dbl_mul_mod_q2_m512(w[3], w[4], *Y, *T, neg_q);
+  // Bring the [0, 4q) double products back to [0, 2q), otherwise X exceeds 8q
+  // and SUB(q2, Y1) underflows.
+  const __m512i Y1 =
+    reduce_if_greater(fast_dbl_mul_mod_q2_m512(w[1], w[2], *Y, *T, neg_q), q2);
+  const __m512i Y2 =
+    reduce_if_greater(fast_dbl_mul_mod_q2_m512(w[3], w[4], *Y, *T, neg_q), q2);
 
   const __m512i T3 = ADD(T1, T2);
   const __m512i T4 = SUB(T1, T2);
@@ -111,4 +168,79 @@ static inline void fwd_radix2_butterfly_m512(__m512i *            X,
   *X = ADD(*X, T);
 }
 
+// See radix8_fwd_butterfly.
+static inline void fwd_radix8_butterfly_m512(__m512i             X[8],
+                                             const mul_op_m512_t w[11],
+                                             const uint64_t      q_64)
+{
+  const __m512i q4 = SET1(q_64 << 2);
+
+  for(size_t s = 0; s < 4; s++) {
+    X[s] = reduce_if_greater(X[s], q4);
+    fwd_radix2_butterfly_m512(&X[s], &X[s + 4], &w[0], q_64);
+  }
+
+  fwd_radix4_butterfly_m512(&X[0], &X[1], &X[2], &X[3], &w[1], q_64);
+  fwd_radix4_butterfly_m512(&X[4], &X[5], &X[6], &X[7], &w[6], q_64);
+}
+
+// The inputs are in the range [0, 2q) and so are the outputs.
+static inline void inv_radix2_butterfly_m512(__m512i *            X,
+                                             __m512i *            Y,
+                                             const mul_op_m512_t *w,
+                                             const uint64_t       q_64)
+{
+  const __m512i neg_q = SET1(-1 * q_64);
+  const __m512i q2    = SET1(q_64 << 1);
+
+  const __m512i T = ADD(SUB(q2, *Y), *X);
+
+  *X = reduce_if_greater(ADD(*X, *Y), q2);
+  *Y = fast_mul_mod_q2_m512(*w, T, neg_q);
+}
+
+// The inputs are in the range [0, 2q) and so are the outputs.
+static inline void inv_radix4_butterfly_m512(__m512i *           X,
+                                             __m512i *           Y,
+                                             __m512i *           Z,
+                                             __m512i *           T,
+                                             const mul_op_m512_t w[5],
+                                             const uint64_t      q_64)
+{
+  const __m512i neg_q = SET1(-1 * q_64);
+  const __m512i q     = SET1(q_64);
+  const __m512i q2    = SET1(q_64 << 1);
+  const __m512i q4    = SET1(q_64 << 2);
+
+  const __m512i T0 = ADD(*Z, *T);
+  const __m512i T1 = ADD(*X, *Y);
+  const __m512i T2 = SUB(ADD(q4, *X), *Y);
+  const __m512i T3 = SUB(ADD(q4, *Z), *T);
+
+  // The double multiplication of [0, 6q) inputs returns values in [0, 4q).
+  const __m512i Y1 = fast_dbl_mul_mod_q2_m512(w[1], w[3], T2, T3, neg_q);
+  const __m512i Y2 = fast_dbl_mul_mod_q2_m512(w[2], w[4], T2, T3, neg_q);
+
+  *X = reduce_if_greater(reduce_if_greater(ADD(T1, T0), q4), q2);
+  *Z = fast_mul_mod_q2_m512(w[0], SUB(ADD(q4, T1), T0), neg_q);
+  *Z = reduce_if_greater(*Z, q);
+  *Y = reduce_if_greater(Y1, q2);
+  *T = reduce_if_greater(Y2, q2);
+}
+
+// See radix8_inv_butterfly.
+static inline void inv_radix8_butterfly_m512(__m512i             X[8],
+                                             const mul_op_m512_t w[11],
+                                             const uint64_t      q_64)
+{
+  inv_radix4_butterfly_m512(&X[0], &X[1], &X[2], &X[3], &w[1], q_64);
+  inv_radix4_butterfly_m512(&X[4], &X[5], &X[6], &X[7], &w[6], q_64);
+
+  for(size_t s = 0; s < 4; s++) {
+    inv_radix2_butterfly_m512(&X[s], &X[s + 4], &w[0], q_64);
+  }
+}
+
+#endif
+
 EXTERNC_END
@@ -0,0 +1,141 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "avx512.h"
+
+EXTERNC_BEGIN
+
+// 64-bit modular multiplications for AVX512-F/DQ platforms without IFMA.
+// The w-powers constants (con) are computed with WORD_SIZE (64 bits).
+
+#define MUL32(a, b)  _mm512_mul_epu32((a), (b))
+#define MULLO(a, b)  _mm512_mullo_epi64((a), (b))
+#define SRLI(a, imm) _mm512_srli_epi64((a), (imm))
+#define SWAP32(a)    _mm512_shuffle_epi32((a), (_MM_PERM_ENUM)0xB1)
+
+// The high 64 bits of the 128-bit product x*y, from four 32x32-bit products
+// (see _mm512_hexl_mulhi_epi_64).
+static inline __m512i mulhi_epu64_m512(const __m512i x, const __m512i y)
+{
+  const __m512i lo_mask = SET1(0xffffffff);
+  const __m512i x_hi    = SWAP32(x);
+  const __m512i y_hi    = SWAP32(y);
+
+  const __m512i lo_lo = MUL32(x, y);
+  const __m512i lo_hi = MUL32(x, y_hi);
+  const __m512i hi_lo = MUL32(x_hi, y);
+  const __m512i hi_hi = MUL32(x_hi, y_hi);
+
+  // Sum the middle 32-bit columns and propagate their carries.
+  const __m512i mid1 = ADD(lo_hi, SRLI(lo_lo, 32));
+  const __m512i mid2 = ADD(hi_lo, mid1 & lo_mask);
+
+  return ADD(ADD(hi_hi, SRLI(mid1, 32)), SRLI(mid2, 32));
+}
+
+// Shoup's multiplication, returns w*t mod q in the range [0, 2q).
+static inline __m512i
+fast_mul_mod_q2_m512_64(const mul_op_m512_t w, const __m512i t, const __m512i q)
+{
+  const __m512i Q = mulhi_epu64_m512(w.con, t);
+  return SUB(MULLO(w.op, t), MULLO(Q, q));
+}
+
+// Returns w1*t1 + w2*t2 mod q in the range [0, 2q).
+static inline __m512i fast_dbl_mul_mod_q2_m512_64(const mul_op_m512_t w1,
+                                                  const mul_op_m512_t w2,
+                                                  const __m512i       t1,
+                                                  const __m512i       t2,
+                                                  const __m512i       q)
+{
+  const __m512i q2 = ADD(q, q);
+  const __m512i T1 = fast_mul_mod_q2_m512_64(w1, t1, q);
+  const __m512i T2 = fast_mul_mod_q2_m512_64(w2, t2, q);
+
+  return reduce_if_greater(ADD(T1, T2), q2);
+}
+
+// The inputs are in the range [0, 4q) and so are the outputs. Unlike
+// fwd_radix4_butterfly_m512 (which keeps [0, 8q)), 4q fits in 64 bits for the
+// 62-bit moduli, at the cost of reducing the sums of the first layer.
+static inline void fwd_radix4_butterfly_m512_64(__m512i *           X,
+                                                __m512i *           Y,
+                                                __m512i *           Z,
+                                                __m512i *           T,
+                                                const mul_op_m512_t w[5],
+                                                const uint64_t      q_64)
+{
+  const __m512i q  = SET1(q_64);
+  const __m512i q2 = SET1(q_64 << 1);
+
+  const __m512i T1 = reduce_if_greater(*X, q2);
+  const __m512i T2 = fast_mul_mod_q2_m512_64(w[0], *Z, q);
+
+  const __m512i Y1 = fast_dbl_mul_mod_q2_m512_64(w[1], w[2], *Y, *T, q);
+  const __m512i Y2 = fast_dbl_mul_mod_q2_m512_64(w[3], w[4], *Y, *T, q);
+
+  const __m512i T3 = reduce_if_greater(ADD(T1, T2), q2);
+  const __m512i T4 = reduce_if_greater(ADD(SUB(q2, T2), T1), q2);
+
+  *X = ADD(T3, Y1);
+  *Y = ADD(SUB(q2, Y1), T3);
+  *Z = ADD(T4, Y2);
+  *T = ADD(SUB(q2, Y2), T4);
+}
+
+static inline void fwd_radix2_butterfly_m512_64(__m512i *            X,
+                                                __m512i *            Y,
+                                                const mul_op_m512_t *w,
+                                                const uint64_t       q_64)
+{
+  const __m512i q  = SET1(q_64);
+  const __m512i q2 = SET1(q_64 << 1);
+
+  *X              = reduce_if_greater(*X, q2);
+  const __m512i T = fast_mul_mod_q2_m512_64(*w, *Y, q);
+
+  *Y = ADD(SUB(q2, T), *X);
+  *X = ADD(*X, T);
+}
+
+// The inputs are in the range [0, 2q) and so are the outputs.
+static inline void inv_radix2_butterfly_m512_64(__m512i *            X,
+                                                __m512i *            Y,
+                                                const mul_op_m512_t *w,
+                                                const uint64_t       q_64)
+{
+  const __m512i q  = SET1(q_64);
+  const __m512i q2 = SET1(q_64 << 1);
+
+  const __m512i T = ADD(SUB(q2, *Y), *X);
+
+  *X = reduce_if_greater(ADD(*X, *Y), q2);
+  *Y = fast_mul_mod_q2_m512_64(*w, T, q);
+}
+
+// The inputs are in the range [0, 2q) and so are the outputs.
+// The intermediate values stay below 4q (see fwd_radix4_butterfly_m512_64).
+static inline void inv_radix4_butterfly_m512_64(__m512i *           X,
+                                                __m512i *           Y,
+                                                __m512i *           Z,
+                                                __m512i *           T,
+                                                const mul_op_m512_t w[5],
+                                                const uint64_t      q_64)
+{
+  const __m512i q  = SET1(q_64);
+  const __m512i q2 = SET1(q_64 << 1);
+
+  const __m512i T0 = reduce_if_greater(ADD(*Z, *T), q2);
+  const __m512i T1 = reduce_if_greater(ADD(*X, *Y), q2);
+  const __m512i T2 = SUB(ADD(q2, *X), *Y);
+  const __m512i T3 = SUB(ADD(q2, *Z), *T);
+
+  *X = reduce_if_greater(ADD(T1, T0), q2);
+  *Z = fast_mul_mod_q2_m512_64(w[0], SUB(ADD(q2, T1), T0), q);
+  *Y = fast_dbl_mul_mod_q2_m512_64(w[1], w[3], T2, T3, q);
+  *T = fast_dbl_mul_mod_q2_m512_64(w[2], w[4], T2, T3, q);
+}
+
+EXTERNC_END
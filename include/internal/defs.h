@@ -59,9 +59,93 @@
 #define LOW_VMSL_WORD(x)    ((x)&VMSL_WORD_SIZE_MASK)
 
 #define AVX512_IFMA_WORD_SIZE_MASK   ((1UL << AVX512_IFMA_WORD_SIZE) - 1)
+// The IFMA kernels keep values in [0, 8q), which must fit in the 52-bit
+// multiplier inputs.
 #define AVX512_IFMA_MAX_MODULUS      49UL
 #define AVX512_IFMA_MAX_MODULUS_MASK (~((1UL << AVX512_IFMA_MAX_MODULUS) - 1))
 
+// The 64-bit AVX512 kernels keep values in [0, 4q).
+#define AVX512_MAX_MODULUS      62UL
+#define AVX512_MAX_MODULUS_MASK (~((1UL << AVX512_MAX_MODULUS) - 1))
+
+// The Goldilocks prime p = 2^64 - 2^32 + 1 and 2^64 mod p = 2^32 - 1.
+#define GOLDILOCKS_Q   0xffffffff00000001UL
+#define GOLDILOCKS_EPS 0xffffffffUL
+// A generator of the multiplicative group mod p (the usual coset shift).
+#define GOLDILOCKS_GENERATOR 7UL
+
+// Sub-transforms of at most RADIX4_RECURSION_BASE_N qw are computed
+// breadth-first by the recursive (depth-first) radix-4 drivers.
+// The default (16KiB) keeps a sub-block and its roots L1-resident.
+#ifndef RADIX4_RECURSION_BASE_N
+#  define RADIX4_RECURSION_BASE_N 2048
+#endif
+
+// Minimal N for which fwd_ntt_radix4_avx512_ifma_leaf uses the
+// register-resident leaf for the last 4 layers (it requires N >= 128).
+#ifndef RADIX4_AVX512_IFMA_LEAF_MIN_N
+#  define RADIX4_AVX512_IFMA_LEAF_MIN_N 128
+#endif
+#if RADIX4_AVX512_IFMA_LEAF_MIN_N < 128
+#  error "RADIX4_AVX512_IFMA_LEAF_MIN_N must be at least 128"
+#endif
+
+// The number of 64-bit lanes of the generic vector (gvec) kernels (2, 4 or 8).
+// The default (256-bit vectors) maps to one AVX2 register or two NEON ones.
+#ifndef GVEC_LANES
+#  define GVEC_LANES 4
+#endif
+
+// The strided NTTs (see ntt_nd.h) transform NTT_ND_COLUMN_BLOCK adjacent
+// columns together. The default keeps a block of 2^10 rows (128KiB) in L2.
+#ifndef NTT_ND_COLUMN_BLOCK
+#  define NTT_ND_COLUMN_BLOCK 16
+#endif
+
+// The cost model of the partial NTTs (see ntt_partial.h), in Horner steps
+// (one Shoup multiplication and one addition): a slot evaluated directly costs
+// N steps, and a pruned radix-4 group of t butterflies t * NTT_PARTIAL_R4_COST
+// (a radix-4 butterfly took ~4.4 steps on an AVX512 Xeon, so a single slot is
+// evaluated directly and two in different quarters of a with the tree).
+// At most NTT_PARTIAL_MAX_HORNER_SLOTS slots are evaluated directly.
+#ifndef NTT_PARTIAL_R4_COST
+#  define NTT_PARTIAL_R4_COST 4
+#endif
+
+#ifndef NTT_PARTIAL_MAX_HORNER_SLOTS
+#  define NTT_PARTIAL_MAX_HORNER_SLOTS 16
+#endif
+
+// The NTT-domain automorphisms (see ntt_automorphism.h) permute all the limbs
+// in blocks of NTT_AUTOMORPHISM_BLOCK slots (a power of two >= 8). The default
+// keeps a map block (4KiB) and the input block it reads (8KiB) in L1.
+#ifndef NTT_AUTOMORPHISM_BLOCK
+#  define NTT_AUTOMORPHISM_BLOCK 1024
+#endif
+
+// The lazy ranges of the kernels are given as mod factors (as in HEXL): a value
+// with mod factor f is in the range [0, f*q), where f is 1, 2, 4 or 8.
+#define IS_MOD_FACTOR(f) (((f) != 0) && ((f) <= 8) && (0 == ((f) & ((f)-1))))
+
+// When NTT_CHECK_BOUNDS is defined (cmake -DCHECK_BOUNDS=1), the scalar kernels
+// check them after every layer and abort on a violation. This is not an
+// assert(), which the -DNDEBUG of the Release builds would remove. The bound
+// is checked with a division, as f*q may not fit in 64 bits.
+#ifdef NTT_CHECK_BOUNDS
+#  include <stdlib.h>
+#  define CHECK_BOUNDS(a, N, q, mod_factor)                                \
+    for(size_t i_ = 0; i_ < (N); i_++) {                                   \
+      if(((a)[i_] / (q)) >= (mod_factor)) {                                \
+        fprintf(stderr, "%s:%d: a[%zu]=0x%lx is not below %lu*q\n",        \
+                __FILE__, __LINE__, i_, (uint64_t)(a)[i_],                \
+                (uint64_t)(mod_factor));                                   \
+        abort();                                                           \
+      }                                                                    \
+    }
+#else
+#  define CHECK_BOUNDS(a, N, q, mod_factor)
+#endif
+
 // Check whether N=2^m where m is odd by masking it.
 #define ODD_POWER_MASK  0xaaaaaaaaaaaaaaaa
 #define REM1_POWER_MASK 0x2222222222222222
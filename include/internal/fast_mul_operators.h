@@ -42,6 +42,35 @@ static inline uint64_t reduce_8q_to_q(const uint64_t val, const uint64_t q)
   return reduce_2q_to_q(reduce_8q_to_2q(val, q), q);
 }
 
+// Reduces a[0..N-1] from the mod factor in_mod_factor to out_mod_factor
+// (both 1, 2, 4 or 8), performing only the needed conditional subtractions.
+// Returns ERROR (and leaves a unchanged) when a factor is not supported.
+static inline int reduce_mod_factor(uint64_t       a[],
+                                    const uint64_t N,
+                                    const uint64_t q,
+                                    const uint64_t in_mod_factor,
+                                    const uint64_t out_mod_factor)
+{
+  if(!IS_MOD_FACTOR(in_mod_factor) || !IS_MOD_FACTOR(out_mod_factor)) {
+    return ERROR;
+  }
+
+  CHECK_BOUNDS(a, N, q, in_mod_factor);
+
+  if(in_mod_factor <= out_mod_factor) {
+    return SUCCESS;
+  }
+
+  for(size_t i = 0; i < N; i++) {
+    uint64_t val = a[i];
+    for(uint64_t f = in_mod_factor >> 1; f >= out_mod_factor; f >>= 1) {
+      val = (val < f * q) ? val : val - f * q;
+    }
+    a[i] = val;
+  }
+  return SUCCESS;
+}
+
 #ifndef L_HIGH_WORD
 #  define L_HIGH_WORD HIGH_WORD
 #endif
@@ -127,6 +156,31 @@ static inline void radix4_fwd_butterfly(uint64_t *     X,
   *T = (T1 - T2 - Y2) + q4;
 }
 
+// radix4_fwd_butterfly with *Z = *T = 0 (they are not read), as in the first
+// layers of a truncated NTT. The radix-2 roots w[0], w[2] and w[4] are unused.
+static inline void radix4_fwd_butterfly_half(uint64_t *     X,
+                                             uint64_t *     Y,
+                                             uint64_t *     Z,
+                                             uint64_t *     T,
+                                             const mul_op_t w[5],
+                                             const uint64_t q)
+{
+  const uint64_t q2 = q << 1;
+  const uint64_t q4 = q << 2;
+
+  const uint64_t Y1 = fast_mul_mod_q2(w[1], *Y, q);
+  const uint64_t Y2 = fast_mul_mod_q2(w[3], *Y, q);
+  const uint64_t T1 = reduce_8q_to_4q(*X, q);
+
+  *X = (T1 + Y1);
+  *Y = (T1 - Y1) + q2;
+  *Z = (T1 + Y2) + q2;
+  *T = (T1 - Y2) + q4;
+}
+
+// The inputs are in the range [0, 2q), and so are the outputs. T2 and T3 are
+// in [0, 4q), so T2 + T3 < 8q fits in 64 bits and fast_dbl_mul_mod_q2 returns
+// values below 2q (Assumption q < 2^61).
 static inline void radix4_inv_butterfly(uint64_t *     X,
                                         uint64_t *     Y,
                                         uint64_t *     Z,
@@ -134,13 +188,14 @@ static inline void radix4_inv_butterfly(uint64_t *     X,
                                         const mul_op_t w[5],
                                         const uint64_t q)
 {
+  const uint64_t q2 = q << 1;
   const uint64_t q4 = q << 2;
 
   const uint64_t T0 = *Z + *T;
   const uint64_t T1 = *X + *Y;
 
-  const uint64_t T2 = q4 + *X - *Y;
-  const uint64_t T3 = q4 + *Z - *T;
+  const uint64_t T2 = q2 + *X - *Y;
+  const uint64_t T3 = q2 + *Z - *T;
 
   *X = reduce_8q_to_2q(T1 + T0, q);
   *Z = fast_mul_mod_q(w[0], q4 + T1 - T0, q);
@@ -148,4 +203,167 @@ static inline void radix4_inv_butterfly(uint64_t *     X,
   *T = fast_dbl_mul_mod_q2(w[2], w[4], T2, T3, q);
 }
 
+// The first iteration of an inverse NTT, where the inputs are in the range
+// [0, 8q) (e.g. the output of a lazy forward NTT) instead of [0, 2q).
+// The inputs and the two sums are reduced only to [0, 4q), and so are T2, T3
+// before the multiplications (Assumption q < 2^61). This replaces a separate
+// reduction pass. The outputs are in the same ranges as in
+// radix4_inv_butterfly.
+static inline void radix4_inv_butterfly_first(uint64_t *     X,
+                                              uint64_t *     Y,
+                                              uint64_t *     Z,
+                                              uint64_t *     T,
+                                              const mul_op_t w[5],
+                                              const uint64_t q)
+{
+  const uint64_t q4 = q << 2;
+
+  const uint64_t X1 = reduce_8q_to_4q(*X, q);
+  const uint64_t Y1 = reduce_8q_to_4q(*Y, q);
+  const uint64_t Z1 = reduce_8q_to_4q(*Z, q);
+  const uint64_t W1 = reduce_8q_to_4q(*T, q);
+
+  const uint64_t T0 = reduce_8q_to_4q(Z1 + W1, q);
+  const uint64_t T1 = reduce_8q_to_4q(X1 + Y1, q);
+
+  const uint64_t T2 = reduce_8q_to_4q(q4 + X1 - Y1, q);
+  const uint64_t T3 = reduce_8q_to_4q(q4 + Z1 - W1, q);
+
+  *X = reduce_8q_to_2q(T1 + T0, q);
+  *Z = fast_mul_mod_q(w[0], q4 + T1 - T0, q);
+  *Y = fast_dbl_mul_mod_q2(w[1], w[3], T2, T3, q);
+  *T = fast_dbl_mul_mod_q2(w[2], w[4], T2, T3, q);
+}
+
+// The last iteration of an inverse NTT, where the roots w are already
+// multiplied by n^-1 (see calc_w_n_inv). The outputs are in the range [0, q).
+static inline void radix4_inv_butterfly_final(uint64_t *     X,
+                                              uint64_t *     Y,
+                                              uint64_t *     Z,
+                                              uint64_t *     T,
+                                              const mul_op_t w[5],
+                                              const mul_op_t n_inv,
+                                              const uint64_t q)
+{
+  const uint64_t q2 = q << 1;
+  const uint64_t q4 = q << 2;
+
+  const uint64_t T0 = *Z + *T;
+  const uint64_t T1 = *X + *Y;
+
+  const uint64_t T2 = q2 + *X - *Y;
+  const uint64_t T3 = q2 + *Z - *T;
+
+  *X = fast_mul_mod_q(n_inv, T1 + T0, q);
+  *Z = fast_mul_mod_q(w[0], q4 + T1 - T0, q);
+  *Y = reduce_2q_to_q(fast_dbl_mul_mod_q2(w[1], w[3], T2, T3, q), q);
+  *T = reduce_2q_to_q(fast_dbl_mul_mod_q2(w[2], w[4], T2, T3, q), q);
+}
+
+// The 3-point DFT of the radix-3 butterflies: with the cube root of unity w,
+// (x0, x1, x2) -> (x0 + x1 + x2, x0 + w * x1 + w^2 * x2, x0 + w^2 * x1 + w * x2),
+// where w^2 = -1 - w. The inputs are in [0, 2q), the outputs in [0, 6q).
+static inline void dft3(uint64_t *     x0,
+                        uint64_t *     x1,
+                        uint64_t *     x2,
+                        const mul_op_t w,
+                        const uint64_t q)
+{
+  const uint64_t T = fast_mul_mod_q2(w, *x1 - *x2 + 2 * q, q);
+  const uint64_t Y = *x0 - *x2 + 2 * q + T;
+  const uint64_t Z = *x0 - *x1 + 4 * q - T;
+
+  *x0 = *x0 + *x1 + *x2;
+  *x1 = Y;
+  *x2 = Z;
+}
+
+// The radix-3 butterfly of the mixed-radix NTT (see calc_w_mixed_radix3):
+// Y and Z are multiplied by w[0] = psi^M and w[1] = psi^2M, and after the
+// 3-point DFT (with the cube root w[1]) X and Z are multiplied by the twists
+// w[2] = psi^-2i and w[3] = psi^2i. The inputs are in [0, 4q), the outputs X
+// and Z in [0, 2q) and Y in [0, 6q).
+static inline void radix3_fwd_butterfly(uint64_t *     X,
+                                        uint64_t *     Y,
+                                        uint64_t *     Z,
+                                        const mul_op_t w[4],
+                                        const uint64_t q)
+{
+  uint64_t x0 = reduce_4q_to_2q(*X, q);
+  uint64_t x1 = fast_mul_mod_q2(w[0], *Y, q);
+  uint64_t x2 = fast_mul_mod_q2(w[1], *Z, q);
+
+  dft3(&x0, &x1, &x2, w[1], q);
+
+  *X = fast_mul_mod_q2(w[2], x0, q);
+  *Y = x1;
+  *Z = fast_mul_mod_q2(w[3], x2, q);
+}
+
+// The inverse butterfly runs the steps of radix3_fwd_butterfly backwards with
+// the roots of psi^-1 (the n^-1 scaling is left to the radix-4 NTTs). The
+// inputs are in [0, q) and the outputs in [0, q).
+static inline void radix3_inv_butterfly(uint64_t *     X,
+                                        uint64_t *     Y,
+                                        uint64_t *     Z,
+                                        const mul_op_t w[4],
+                                        const uint64_t q)
+{
+  uint64_t y0 = fast_mul_mod_q2(w[2], *X, q);
+  uint64_t y1 = *Y;
+  uint64_t y2 = fast_mul_mod_q2(w[3], *Z, q);
+
+  dft3(&y0, &y1, &y2, w[1], q);
+
+  *X = reduce_8q_to_q(y0, q);
+  *Y = fast_mul_mod_q(w[0], y1, q);
+  *Z = fast_mul_mod_q(w[1], y2, q);
+}
+
+// A radix-8 butterfly on X[0], X[t], ..., X[7t] is a radix-2 layer followed
+// by two radix-4 butterflies. w[0] is the radix-2 root, w[1..5] and w[6..10]
+// are the roots of the two radix-4 butterflies (see radix4_fwd_butterfly).
+static inline void radix8_fwd_butterfly(uint64_t *     X,
+                                        const size_t   t,
+                                        const mul_op_t w[11],
+                                        const uint64_t q)
+{
+  uint64_t T[8];
+
+  for(size_t s = 0; s < 4; s++) {
+    T[s]     = reduce_8q_to_4q(X[s * t], q);
+    T[s + 4] = X[(s + 4) * t];
+    harvey_fwd_butterfly(&T[s], &T[s + 4], w[0], q);
+  }
+
+  radix4_fwd_butterfly(&T[0], &T[1], &T[2], &T[3], &w[1], q);
+  radix4_fwd_butterfly(&T[4], &T[5], &T[6], &T[7], &w[6], q);
+
+  for(size_t s = 0; s < 8; s++) {
+    X[s * t] = T[s];
+  }
+}
+
+// The inverse of radix8_fwd_butterfly. The inputs are in the range [0, 2q).
+static inline void radix8_inv_butterfly(uint64_t *     X,
+                                        const size_t   t,
+                                        const mul_op_t w[11],
+                                        const uint64_t q)
+{
+  uint64_t T[8];
+
+  for(size_t s = 0; s < 8; s++) {
+    T[s] = X[s * t];
+  }
+
+  radix4_inv_butterfly(&T[0], &T[1], &T[2], &T[3], &w[1], q);
+  radix4_inv_butterfly(&T[4], &T[5], &T[6], &T[7], &w[6], q);
+
+  for(size_t s = 0; s < 4; s++) {
+    harvey_bkw_butterfly(&T[s], &T[s + 4], w[0], q);
+    X[s * t]       = T[s];
+    X[(s + 4) * t] = T[s + 4];
+  }
+}
+
 EXTERNC_END
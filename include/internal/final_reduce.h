@@ -0,0 +1,122 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+// Final reductions of the lazy outputs of the kernels: a[i] in [0, f*q) is
+// reduced to [0, q), where the mod factor f is 2, 4 or 8. The main loop uses
+// the widest vectors available (AVX512-F, AVX2 or GCC/Clang generic vectors)
+// and the remaining N % lanes values are reduced with scalar code, so N is
+// arbitrary.
+
+#pragma once
+
+#include "fast_mul_operators.h"
+
+#if defined(AVX512_SUPPORT) || defined(__AVX2__)
+#  include <immintrin.h>
+#endif
+
+EXTERNC_BEGIN
+
+static inline void final_reduce_scalar(uint64_t       a[],
+                                       const size_t   N,
+                                       const uint64_t q,
+                                       const uint64_t mod_factor)
+{
+  reduce_mod_factor(a, N, q, mod_factor, 1);
+}
+
+// Returns the number of reduced values (N rounded down to GVEC_LANES).
+// Implemented in src/final_reduce.c, so that the generic vector types (and
+// the -Wpsabi suppression of gvec.h) stay out of the public headers.
+size_t final_reduce_gvec(uint64_t       a[],
+                         const size_t   N,
+                         const uint64_t q,
+                         const uint64_t mod_factor);
+
+#ifdef __AVX2__
+// AVX2 has no unsigned 64-bit comparison, the sign bits are flipped first.
+static inline __m256i reduce_if_greater_avx2(const __m256i val, const __m256i mod)
+{
+  const __m256i sign = _mm256_set1_epi64x((long long)(1ULL << 63));
+  const __m256i lt   = _mm256_cmpgt_epi64(_mm256_xor_si256(mod, sign),
+                                        _mm256_xor_si256(val, sign));
+
+  return _mm256_sub_epi64(val, _mm256_andnot_si256(lt, mod));
+}
+
+// Returns the number of reduced values (N rounded down to 4).
+static inline size_t final_reduce_avx2(uint64_t       a[],
+                                       const size_t   N,
+                                       const uint64_t q,
+                                       const uint64_t mod_factor)
+{
+  size_t i = 0;
+
+  LOOP_UNROLL_4
+  for(; (i + 4) <= N; i += 4) {
+    __m256i T = _mm256_loadu_si256((const __m256i *)&a[i]);
+    for(uint64_t f = mod_factor >> 1; f >= 1; f >>= 1) {
+      T = reduce_if_greater_avx2(T, _mm256_set1_epi64x((long long)(f * q)));
+    }
+    _mm256_storeu_si256((__m256i *)&a[i], T);
+  }
+
+  return i;
+}
+#endif
+
+#ifdef AVX512_SUPPORT
+// Returns the number of reduced values (N rounded down to 8).
+static inline size_t final_reduce_avx512(uint64_t       a[],
+                                         const size_t   N,
+                                         const uint64_t q,
+                                         const uint64_t mod_factor)
+{
+  size_t i = 0;
+
+  LOOP_UNROLL_4
+  for(; (i + 8) <= N; i += 8) {
+    __m512i T = _mm512_loadu_si512(&a[i]);
+    for(uint64_t f = mod_factor >> 1; f >= 1; f >>= 1) {
+      const __m512i fq = _mm512_set1_epi64((long long)(f * q));
+      T                = _mm512_min_epu64(T, _mm512_sub_epi64(T, fq));
+    }
+    _mm512_storeu_si512(&a[i], T);
+  }
+
+  return i;
+}
+#endif
+
+static inline void final_reduce(uint64_t       a[],
+                                const size_t   N,
+                                const uint64_t q,
+                                const uint64_t mod_factor)
+{
+#if defined(AVX512_SUPPORT)
+  const size_t done = final_reduce_avx512(a, N, q, mod_factor);
+#elif defined(__AVX2__)
+  const size_t done = final_reduce_avx2(a, N, q, mod_factor);
+#else
+  const size_t done = final_reduce_gvec(a, N, q, mod_factor);
+#endif
+
+  final_reduce_scalar(&a[done], N - done, q, mod_factor);
+}
+
+static inline void final_reduce_q8(uint64_t a[], const size_t N, const uint64_t q)
+{
+  final_reduce(a, N, q, 8);
+}
+
+static inline void final_reduce_q4(uint64_t a[], const size_t N, const uint64_t q)
+{
+  final_reduce(a, N, q, 4);
+}
+
+static inline void final_reduce_q2(uint64_t a[], const size_t N, const uint64_t q)
+{
+  final_reduce(a, N, q, 2);
+}
+
+EXTERNC_END
@@ -0,0 +1,379 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+// Arithmetic modulo the Goldilocks prime p = 2^64 - 2^32 + 1. Since
+// 2^64 = 2^32 - 1 (mod p) and 2^96 = -1 (mod p), a 128-bit product is reduced
+// with shifts, additions and subtractions only, and the roots need no Shoup
+// constants (w_con).
+//
+// The functions accept any 64-bit representative and return one, i.e. values
+// in [0, 2^64), which is within [0, 2p) (mod factor 2). A single conditional
+// subtraction of p makes them canonical.
+
+#pragma once
+
+#include "defs.h"
+
+#if defined(AVX512_SUPPORT) || defined(__AVX2__)
+#  include <immintrin.h>
+#endif
+
+EXTERNC_BEGIN
+
+static inline uint64_t goldilocks_add(const uint64_t a, const uint64_t b)
+{
+  // A carry out of 2^64 is worth EPS. Adding it may carry again, but then the
+  // sum is below EPS and the second correction cannot carry.
+  const uint64_t s  = a + b;
+  const uint64_t c  = (s < a) ? GOLDILOCKS_EPS : 0;
+  const uint64_t s1 = s + c;
+  const uint64_t c1 = (s1 < c) ? GOLDILOCKS_EPS : 0;
+
+  return s1 + c1;
+}
+
+static inline uint64_t goldilocks_sub(const uint64_t a, const uint64_t b)
+{
+  const uint64_t d  = a - b;
+  const uint64_t c  = (a < b) ? GOLDILOCKS_EPS : 0;
+  const uint64_t c1 = (d < c) ? GOLDILOCKS_EPS : 0;
+
+  return d - c - c1;
+}
+
+// x = lo + 2^64 * hi_lo + 2^96 * hi_hi = lo - hi_hi + EPS * hi_lo (mod p).
+static inline uint64_t goldilocks_reduce128(const __uint128_t x)
+{
+  const uint64_t lo    = (uint64_t)x;
+  const uint64_t hi    = (uint64_t)(x >> 64);
+  const uint64_t hi_hi = hi >> 32;
+  const uint64_t hi_lo = hi & GOLDILOCKS_EPS;
+
+  // When it borrows, t0 >= 2^64 - 2^32 and cannot borrow again.
+  uint64_t t0 = lo - hi_hi;
+  t0 -= (lo < hi_hi) ? GOLDILOCKS_EPS : 0;
+
+  // t1 <= (2^32 - 1)^2, so after a carry t2 < t1 and t2 + EPS cannot carry.
+  const uint64_t t1 = (hi_lo << 32) - hi_lo;
+  const uint64_t t2 = t0 + t1;
+
+  return t2 + ((t2 < t1) ? GOLDILOCKS_EPS : 0);
+}
+
+static inline uint64_t goldilocks_mul(const uint64_t a, const uint64_t b)
+{
+  return goldilocks_reduce128((__uint128_t)a * b);
+}
+
+static inline uint64_t goldilocks_pow(uint64_t base, uint64_t exp)
+{
+  uint64_t ret = 1;
+  while(exp > 0) {
+    if(exp & 1) {
+      ret = goldilocks_mul(ret, base);
+    }
+    base = goldilocks_mul(base, base);
+    exp >>= 1;
+  }
+  return ret;
+}
+
+static inline uint64_t goldilocks_canonical(const uint64_t a)
+{
+  return (a >= GOLDILOCKS_Q) ? (a - GOLDILOCKS_Q) : a;
+}
+
+static inline void goldilocks_canonicalize(uint64_t a[], const size_t N)
+{
+  for(size_t i = 0; i < N; i++) {
+    a[i] = goldilocks_canonical(a[i]);
+  }
+}
+
+static inline void
+goldilocks_fwd_butterfly(uint64_t *X, uint64_t *Y, const uint64_t w)
+{
+  const uint64_t T = goldilocks_mul(w, *Y);
+
+  *Y = goldilocks_sub(*X, T);
+  *X = goldilocks_add(*X, T);
+}
+
+static inline void
+goldilocks_inv_butterfly(uint64_t *X, uint64_t *Y, const uint64_t w)
+{
+  const uint64_t T = goldilocks_sub(*X, *Y);
+
+  *X = goldilocks_add(*X, *Y);
+  *Y = goldilocks_mul(w, T);
+}
+
+// Two radix-2 levels: (X, Z) and (Y, T) with w[0], then (X, Y) with w[1] and
+// (Z, T) with w[2]. For the group g of level m, w = {w[g], w[2g], w[2g+1]}.
+static inline void goldilocks_radix4_fwd_butterfly(uint64_t *     X,
+                                                   uint64_t *     Y,
+                                                   uint64_t *     Z,
+                                                   uint64_t *     T,
+                                                   const uint64_t w[3])
+{
+  goldilocks_fwd_butterfly(X, Z, w[0]);
+  goldilocks_fwd_butterfly(Y, T, w[0]);
+  goldilocks_fwd_butterfly(X, Y, w[1]);
+  goldilocks_fwd_butterfly(Z, T, w[2]);
+}
+
+// The inverse of goldilocks_radix4_fwd_butterfly (up to a factor of 4), with
+// the inverse powers.
+static inline void goldilocks_radix4_inv_butterfly(uint64_t *     X,
+                                                   uint64_t *     Y,
+                                                   uint64_t *     Z,
+                                                   uint64_t *     T,
+                                                   const uint64_t w[3])
+{
+  goldilocks_inv_butterfly(X, Y, w[1]);
+  goldilocks_inv_butterfly(Z, T, w[2]);
+  goldilocks_inv_butterfly(X, Z, w[0]);
+  goldilocks_inv_butterfly(Y, T, w[0]);
+}
+
+#ifdef __AVX2__
+// AVX2 has no unsigned 64-bit comparison, the sign bits are flipped first.
+static inline __m256i goldilocks_lt_avx2(const __m256i a, const __m256i b)
+{
+  const __m256i sign = _mm256_set1_epi64x((long long)(1ULL << 63));
+  return _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+}
+
+static inline __m256i goldilocks_add_avx2(const __m256i a, const __m256i b)
+{
+  const __m256i eps = _mm256_set1_epi64x((long long)GOLDILOCKS_EPS);
+  const __m256i s   = _mm256_add_epi64(a, b);
+  const __m256i c   = _mm256_and_si256(goldilocks_lt_avx2(s, a), eps);
+  const __m256i s1  = _mm256_add_epi64(s, c);
+  const __m256i c1  = _mm256_and_si256(goldilocks_lt_avx2(s1, c), eps);
+
+  return _mm256_add_epi64(s1, c1);
+}
+
+static inline __m256i goldilocks_sub_avx2(const __m256i a, const __m256i b)
+{
+  const __m256i eps = _mm256_set1_epi64x((long long)GOLDILOCKS_EPS);
+  const __m256i d   = _mm256_sub_epi64(a, b);
+  const __m256i c   = _mm256_and_si256(goldilocks_lt_avx2(a, b), eps);
+  const __m256i c1  = _mm256_and_si256(goldilocks_lt_avx2(d, c), eps);
+
+  return _mm256_sub_epi64(_mm256_sub_epi64(d, c), c1);
+}
+
+// The 128-bit products, computed from 32x32-bit products (as in gvec_mulhi).
+static inline void goldilocks_mul_wide_avx2(__m256i *     hi,
+                                            __m256i *     lo,
+                                            const __m256i a,
+                                            const __m256i b)
+{
+  const __m256i mask = _mm256_set1_epi64x((long long)GOLDILOCKS_EPS);
+  const __m256i a_hi = _mm256_srli_epi64(a, 32);
+  const __m256i b_hi = _mm256_srli_epi64(b, 32);
+
+  const __m256i lo_lo = _mm256_mul_epu32(a, b);
+  const __m256i lo_hi = _mm256_mul_epu32(a, b_hi);
+  const __m256i hi_lo = _mm256_mul_epu32(a_hi, b);
+  const __m256i hi_hi = _mm256_mul_epu32(a_hi, b_hi);
+
+  // Cannot overflow: (2^32 - 1)^2 + (2^32 - 1) < 2^64.
+  const __m256i mid  = _mm256_add_epi64(lo_hi, _mm256_srli_epi64(lo_lo, 32));
+  const __m256i mid1 = _mm256_add_epi64(hi_lo, _mm256_and_si256(mid, mask));
+
+  *lo = _mm256_blend_epi32(lo_lo, _mm256_slli_epi64(mid1, 32), 0xaa);
+  *hi = _mm256_add_epi64(_mm256_add_epi64(hi_hi, _mm256_srli_epi64(mid, 32)),
+                         _mm256_srli_epi64(mid1, 32));
+}
+
+// See goldilocks_reduce128.
+static inline __m256i goldilocks_reduce128_avx2(const __m256i hi,
+                                                const __m256i lo)
+{
+  const __m256i eps   = _mm256_set1_epi64x((long long)GOLDILOCKS_EPS);
+  const __m256i hi_hi = _mm256_srli_epi64(hi, 32);
+
+  const __m256i borrow = _mm256_and_si256(goldilocks_lt_avx2(lo, hi_hi), eps);
+  const __m256i t0     = _mm256_sub_epi64(_mm256_sub_epi64(lo, hi_hi), borrow);
+
+  const __m256i t1 =
+    _mm256_sub_epi64(_mm256_slli_epi64(hi, 32), _mm256_and_si256(hi, eps));
+  const __m256i t2 = _mm256_add_epi64(t0, t1);
+
+  return _mm256_add_epi64(t2, _mm256_and_si256(goldilocks_lt_avx2(t2, t1), eps));
+}
+
+static inline __m256i goldilocks_mul_avx2(const __m256i a, const __m256i b)
+{
+  __m256i hi;
+  __m256i lo;
+
+  goldilocks_mul_wide_avx2(&hi, &lo, a, b);
+  return goldilocks_reduce128_avx2(hi, lo);
+}
+
+static inline __m256i goldilocks_canonical_avx2(const __m256i a)
+{
+  const __m256i q = _mm256_set1_epi64x((long long)GOLDILOCKS_Q);
+  return _mm256_sub_epi64(a, _mm256_andnot_si256(goldilocks_lt_avx2(a, q), q));
+}
+
+// The same as goldilocks_radix4_fwd_butterfly, lane-wise.
+static inline void goldilocks_radix4_fwd_butterfly_avx2(__m256i *     X,
+                                                        __m256i *     Y,
+                                                        __m256i *     Z,
+                                                        __m256i *     T,
+                                                        const __m256i w[3])
+{
+  const __m256i T0 = goldilocks_mul_avx2(w[0], *Z);
+  const __m256i T1 = goldilocks_mul_avx2(w[0], *T);
+  const __m256i X1 = goldilocks_add_avx2(*X, T0);
+  const __m256i Z1 = goldilocks_sub_avx2(*X, T0);
+  const __m256i Y1 = goldilocks_mul_avx2(w[1], goldilocks_add_avx2(*Y, T1));
+  const __m256i T2 = goldilocks_mul_avx2(w[2], goldilocks_sub_avx2(*Y, T1));
+
+  *X = goldilocks_add_avx2(X1, Y1);
+  *Y = goldilocks_sub_avx2(X1, Y1);
+  *Z = goldilocks_add_avx2(Z1, T2);
+  *T = goldilocks_sub_avx2(Z1, T2);
+}
+
+// The same as goldilocks_radix4_inv_butterfly, lane-wise.
+static inline void goldilocks_radix4_inv_butterfly_avx2(__m256i *     X,
+                                                        __m256i *     Y,
+                                                        __m256i *     Z,
+                                                        __m256i *     T,
+                                                        const __m256i w[3])
+{
+  const __m256i X1 = goldilocks_add_avx2(*X, *Y);
+  const __m256i Y1 = goldilocks_mul_avx2(w[1], goldilocks_sub_avx2(*X, *Y));
+  const __m256i Z1 = goldilocks_add_avx2(*Z, *T);
+  const __m256i T1 = goldilocks_mul_avx2(w[2], goldilocks_sub_avx2(*Z, *T));
+
+  *X = goldilocks_add_avx2(X1, Z1);
+  *Z = goldilocks_mul_avx2(w[0], goldilocks_sub_avx2(X1, Z1));
+  *Y = goldilocks_add_avx2(Y1, T1);
+  *T = goldilocks_mul_avx2(w[0], goldilocks_sub_avx2(Y1, T1));
+}
+#endif
+
+#ifdef AVX512_SUPPORT
+static inline __m512i goldilocks_add_avx512(const __m512i a, const __m512i b)
+{
+  const __m512i  eps = _mm512_set1_epi64((long long)GOLDILOCKS_EPS);
+  const __m512i  s   = _mm512_add_epi64(a, b);
+  const __mmask8 c   = _mm512_cmplt_epu64_mask(s, a);
+  const __m512i  s1  = _mm512_mask_add_epi64(s, c, s, eps);
+  const __mmask8 c1  = _mm512_mask_cmplt_epu64_mask(c, s1, eps);
+
+  return _mm512_mask_add_epi64(s1, c1, s1, eps);
+}
+
+static inline __m512i goldilocks_sub_avx512(const __m512i a, const __m512i b)
+{
+  const __m512i  eps = _mm512_set1_epi64((long long)GOLDILOCKS_EPS);
+  const __m512i  d   = _mm512_sub_epi64(a, b);
+  const __mmask8 c   = _mm512_cmplt_epu64_mask(a, b);
+  const __mmask8 c1  = _mm512_mask_cmplt_epu64_mask(c, d, eps);
+  const __m512i  d1  = _mm512_mask_sub_epi64(d, c, d, eps);
+
+  return _mm512_mask_sub_epi64(d1, c1, d1, eps);
+}
+
+// See goldilocks_mul_wide_avx2.
+static inline void goldilocks_mul_wide_avx512(__m512i *     hi,
+                                              __m512i *     lo,
+                                              const __m512i a,
+                                              const __m512i b)
+{
+  const __m512i mask = _mm512_set1_epi64((long long)GOLDILOCKS_EPS);
+  const __m512i a_hi = _mm512_srli_epi64(a, 32);
+  const __m512i b_hi = _mm512_srli_epi64(b, 32);
+
+  const __m512i lo_lo = _mm512_mul_epu32(a, b);
+  const __m512i lo_hi = _mm512_mul_epu32(a, b_hi);
+  const __m512i hi_lo = _mm512_mul_epu32(a_hi, b);
+  const __m512i hi_hi = _mm512_mul_epu32(a_hi, b_hi);
+
+  const __m512i mid  = _mm512_add_epi64(lo_hi, _mm512_srli_epi64(lo_lo, 32));
+  const __m512i mid1 = _mm512_add_epi64(hi_lo, _mm512_and_si512(mid, mask));
+
+  *lo = _mm512_mask_blend_epi32(0xaaaa, lo_lo, _mm512_slli_epi64(mid1, 32));
+  *hi = _mm512_add_epi64(_mm512_add_epi64(hi_hi, _mm512_srli_epi64(mid, 32)),
+                         _mm512_srli_epi64(mid1, 32));
+}
+
+// See goldilocks_reduce128.
+static inline __m512i goldilocks_reduce128_avx512(const __m512i hi,
+                                                  const __m512i lo)
+{
+  const __m512i  eps    = _mm512_set1_epi64((long long)GOLDILOCKS_EPS);
+  const __m512i  hi_hi  = _mm512_srli_epi64(hi, 32);
+  const __mmask8 borrow = _mm512_cmplt_epu64_mask(lo, hi_hi);
+  const __m512i  t0     = _mm512_sub_epi64(lo, hi_hi);
+  const __m512i  t1     = _mm512_sub_epi64(_mm512_slli_epi64(hi, 32),
+                                      _mm512_and_si512(hi, eps));
+  const __m512i  t2 =
+    _mm512_add_epi64(_mm512_mask_sub_epi64(t0, borrow, t0, eps), t1);
+
+  return _mm512_mask_add_epi64(t2, _mm512_cmplt_epu64_mask(t2, t1), t2, eps);
+}
+
+static inline __m512i goldilocks_mul_avx512(const __m512i a, const __m512i b)
+{
+  __m512i hi;
+  __m512i lo;
+
+  goldilocks_mul_wide_avx512(&hi, &lo, a, b);
+  return goldilocks_reduce128_avx512(hi, lo);
+}
+
+static inline __m512i goldilocks_canonical_avx512(const __m512i a)
+{
+  const __m512i q = _mm512_set1_epi64((long long)GOLDILOCKS_Q);
+  return _mm512_min_epu64(a, _mm512_sub_epi64(a, q));
+}
+
+// The same as goldilocks_radix4_fwd_butterfly, lane-wise.
+static inline void goldilocks_radix4_fwd_butterfly_avx512(__m512i *     X,
+                                                          __m512i *     Y,
+                                                          __m512i *     Z,
+                                                          __m512i *     T,
+                                                          const __m512i w[3])
+{
+  const __m512i T0 = goldilocks_mul_avx512(w[0], *Z);
+  const __m512i T1 = goldilocks_mul_avx512(w[0], *T);
+  const __m512i X1 = goldilocks_add_avx512(*X, T0);
+  const __m512i Z1 = goldilocks_sub_avx512(*X, T0);
+  const __m512i Y1 = goldilocks_mul_avx512(w[1], goldilocks_add_avx512(*Y, T1));
+  const __m512i T2 = goldilocks_mul_avx512(w[2], goldilocks_sub_avx512(*Y, T1));
+
+  *X = goldilocks_add_avx512(X1, Y1);
+  *Y = goldilocks_sub_avx512(X1, Y1);
+  *Z = goldilocks_add_avx512(Z1, T2);
+  *T = goldilocks_sub_avx512(Z1, T2);
+}
+
+// The same as goldilocks_radix4_inv_butterfly, lane-wise.
+static inline void goldilocks_radix4_inv_butterfly_avx512(__m512i *     X,
+                                                          __m512i *     Y,
+                                                          __m512i *     Z,
+                                                          __m512i *     T,
+                                                          const __m512i w[3])
+{
+  const __m512i X1 = goldilocks_add_avx512(*X, *Y);
+  const __m512i Y1 = goldilocks_mul_avx512(w[1], goldilocks_sub_avx512(*X, *Y));
+  const __m512i Z1 = goldilocks_add_avx512(*Z, *T);
+  const __m512i T1 = goldilocks_mul_avx512(w[2], goldilocks_sub_avx512(*Z, *T));
+
+  *X = goldilocks_add_avx512(X1, Z1);
+  *Z = goldilocks_mul_avx512(w[0], goldilocks_sub_avx512(X1, Z1));
+  *Y = goldilocks_add_avx512(Y1, T1);
+  *T = goldilocks_mul_avx512(w[0], goldilocks_sub_avx512(Y1, T1));
+}
+#endif
+
+EXTERNC_END
@@ -0,0 +1,209 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+// Portable SIMD helpers based on the GCC/Clang generic vector extension
+// (__attribute__((vector_size))). The compiler lowers them to the native
+// vector instructions of the target (NEON, SVE, AVX2, VSX, ...) or to scalar
+// code when there is no vector unit.
+
+#pragma once
+
+#include <string.h>
+
+#include "fast_mul_operators.h"
+
+EXTERNC_BEGIN
+
+#if(GVEC_LANES != 2) && (GVEC_LANES != 4) && (GVEC_LANES != 8)
+#  error "GVEC_LANES must be 2, 4, or 8"
+#endif
+
+// The helpers are static inline, so vectors wider than the native registers
+// (e.g. 256-bit ones without AVX) never cross an ABI boundary. GCC reports
+// -Wpsabi at the end of the translation unit, so the suppression cannot be
+// popped; include this header only from .c files, never from public headers.
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+typedef uint64_t gvec_t
+  __attribute__((vector_size(GVEC_LANES * sizeof(uint64_t))));
+
+typedef struct mul_op_gvec_s {
+  gvec_t op;
+  gvec_t con;
+} mul_op_gvec_t;
+
+#define GVEC_LOW32_MASK 0xffffffffUL
+
+static inline gvec_t gvec_set1(const uint64_t x)
+{
+  return x + (gvec_t){0};
+}
+
+// a may be unaligned.
+static inline gvec_t gvec_load(const uint64_t *a)
+{
+  gvec_t v;
+  memcpy(&v, a, sizeof(v));
+  return v;
+}
+
+static inline void gvec_store(uint64_t *a, const gvec_t v)
+{
+  memcpy(a, &v, sizeof(v));
+}
+
+// The comparison returns -1 (all ones) in lanes where it holds.
+static inline gvec_t gvec_reduce_if_greater(const gvec_t a, const gvec_t b)
+{
+  return a - (b & (gvec_t)(a >= b));
+}
+
+// The high 64 bits of the 128-bit products, computed from 32x32-bit
+// products since there is no portable vector mulhi.
+static inline gvec_t gvec_mulhi(const gvec_t a, const gvec_t b)
+{
+  const gvec_t mask = gvec_set1(GVEC_LOW32_MASK);
+  const gvec_t a_lo = a & mask;
+  const gvec_t a_hi = a >> 32;
+  const gvec_t b_lo = b & mask;
+  const gvec_t b_hi = b >> 32;
+
+  const gvec_t lo_lo = a_lo * b_lo;
+  const gvec_t hi_lo = a_hi * b_lo;
+  const gvec_t lo_hi = a_lo * b_hi;
+  const gvec_t hi_hi = a_hi * b_hi;
+
+  // Cannot overflow: (2^32 - 1)^2 + 2 * (2^32 - 1) < 2^64.
+  const gvec_t mid = (lo_lo >> 32) + (hi_lo & mask) + lo_hi;
+
+  return hi_hi + (hi_lo >> 32) + (mid >> 32);
+}
+
+static inline gvec_t
+fast_mul_mod_q2_gvec(const mul_op_gvec_t w, const gvec_t t, const gvec_t q)
+{
+  const gvec_t Q = gvec_mulhi(w.con, t);
+  return (w.op * t) - (Q * q);
+}
+
+static inline gvec_t
+fast_mul_mod_q_gvec(const mul_op_gvec_t w, const gvec_t t, const gvec_t q)
+{
+  return gvec_reduce_if_greater(fast_mul_mod_q2_gvec(w, t, q), q);
+}
+
+// See fast_dbl_mul_mod_q2, the 128-bit sum of the two products is computed
+// with an explicit carry.
+static inline gvec_t fast_dbl_mul_mod_q2_gvec(const mul_op_gvec_t w1,
+                                              const mul_op_gvec_t w2,
+                                              const gvec_t        t1,
+                                              const gvec_t        t2,
+                                              const gvec_t        q)
+{
+  const gvec_t lo1 = w1.con * t1;
+  const gvec_t lo  = lo1 + (w2.con * t2);
+  const gvec_t Q   = gvec_mulhi(w1.con, t1) + gvec_mulhi(w2.con, t2) -
+                   (gvec_t)(lo < lo1);
+
+  return (t1 * w1.op) + (t2 * w2.op) - (Q * q);
+}
+
+static inline void harvey_fwd_butterfly_gvec(gvec_t *            X,
+                                             gvec_t *            Y,
+                                             const mul_op_gvec_t w,
+                                             const gvec_t        q)
+{
+  const gvec_t q2 = q << 1;
+  const gvec_t X1 = gvec_reduce_if_greater(*X, q2);
+  const gvec_t T  = fast_mul_mod_q2_gvec(w, *Y, q);
+
+  *X = X1 + T;
+  *Y = X1 - T + q2;
+}
+
+static inline void harvey_bkw_butterfly_gvec(gvec_t *            X,
+                                             gvec_t *            Y,
+                                             const mul_op_gvec_t w,
+                                             const gvec_t        q)
+{
+  const gvec_t q2 = q << 1;
+  const gvec_t X1 = gvec_reduce_if_greater(*X + *Y, q2);
+  const gvec_t T  = *X - *Y + q2;
+
+  *X = X1;
+  *Y = fast_mul_mod_q2_gvec(w, T, q);
+}
+
+// The same as radix4_fwd_butterfly, lane-wise.
+static inline void radix4_fwd_butterfly_gvec(gvec_t *            X,
+                                             gvec_t *            Y,
+                                             gvec_t *            Z,
+                                             gvec_t *            T,
+                                             const mul_op_gvec_t w[5],
+                                             const gvec_t        q)
+{
+  const gvec_t q2 = q << 1;
+  const gvec_t q4 = q << 2;
+
+  const gvec_t Y1 = fast_dbl_mul_mod_q2_gvec(w[1], w[2], *Y, *T, q);
+  const gvec_t Y2 = fast_dbl_mul_mod_q2_gvec(w[3], w[4], *Y, *T, q);
+
+  const gvec_t T1 = gvec_reduce_if_greater(*X, q4);
+  const gvec_t T2 = fast_mul_mod_q2_gvec(w[0], *Z, q);
+
+  *X = (T1 + T2 + Y1);
+  *Y = (T1 + T2 - Y1) + q2;
+  *Z = (T1 - T2 + Y2) + q2;
+  *T = (T1 - T2 - Y2) + q4;
+}
+
+// The same as radix4_inv_butterfly, lane-wise.
+static inline void radix4_inv_butterfly_gvec(gvec_t *            X,
+                                             gvec_t *            Y,
+                                             gvec_t *            Z,
+                                             gvec_t *            T,
+                                             const mul_op_gvec_t w[5],
+                                             const gvec_t        q)
+{
+  const gvec_t q2 = q << 1;
+  const gvec_t q4 = q << 2;
+
+  const gvec_t T0 = *Z + *T;
+  const gvec_t T1 = *X + *Y;
+
+  const gvec_t T2 = q2 + *X - *Y;
+  const gvec_t T3 = q2 + *Z - *T;
+
+  *X = gvec_reduce_if_greater(gvec_reduce_if_greater(T1 + T0, q4), q2);
+  *Z = fast_mul_mod_q_gvec(w[0], q4 + T1 - T0, q);
+  *Y = fast_dbl_mul_mod_q2_gvec(w[1], w[3], T2, T3, q);
+  *T = fast_dbl_mul_mod_q2_gvec(w[2], w[4], T2, T3, q);
+}
+
+// The same as radix4_inv_butterfly_final, lane-wise.
+static inline void radix4_inv_butterfly_final_gvec(gvec_t *            X,
+                                                   gvec_t *            Y,
+                                                   gvec_t *            Z,
+                                                   gvec_t *            T,
+                                                   const mul_op_gvec_t w[5],
+                                                   const mul_op_gvec_t n_inv,
+                                                   const gvec_t        q)
+{
+  const gvec_t q2 = q << 1;
+  const gvec_t q4 = q << 2;
+
+  const gvec_t T0 = *Z + *T;
+  const gvec_t T1 = *X + *Y;
+
+  const gvec_t T2 = q2 + *X - *Y;
+  const gvec_t T3 = q2 + *Z - *T;
+
+  *X = fast_mul_mod_q_gvec(n_inv, T1 + T0, q);
+  *Z = fast_mul_mod_q_gvec(w[0], q4 + T1 - T0, q);
+  *Y = gvec_reduce_if_greater(fast_dbl_mul_mod_q2_gvec(w[1], w[3], T2, T3, q), q);
+  *T = gvec_reduce_if_greater(fast_dbl_mul_mod_q2_gvec(w[2], w[4], T2, T3, q), q);
+}
+
+EXTERNC_END
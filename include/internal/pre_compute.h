@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "defs.h"
@@ -13,6 +14,15 @@ EXTERNC_BEGIN
 // in this file, as all of their output serves as
 // precomputaitons that we can cache for the NTT computations.
 
+// Returns a 64 bytes aligned pointer into the allocation *base of qw_num qw.
+static inline uint64_t *aligned_alloc_qw(void **base, const size_t qw_num)
+{
+  if(NULL == (*base = malloc((qw_num * sizeof(uint64_t)) + 64))) {
+    return NULL;
+  }
+  return (uint64_t *)(((uint64_t)*base & (~0x3fULL)) + 64);
+}
+
 static inline uint64_t bit_rev_idx(uint64_t idx, uint64_t width)
 {
   uint64_t ret = 0;
@@ -35,19 +45,36 @@ static inline void bit_rev(uint64_t       w_powers[],
   }
 }
 
+// The Galois automorphism a(X) -> a(X^g) (g odd) maps the NTT output (slot)
+// k = a(psi^(2 * brv(k) + 1)) to a(psi^(g * (2 * brv(k) + 1))), which is the
+// slot brv(e) for 2e + 1 = g * (2 * brv(k) + 1) mod 2N. So in the NTT domain
+// the automorphism is the permutation out[k] = in[map[k]] (see
+// ntt_automorphism.h), without any sign flips.
+// Assumption N = 2^width < 2^31 and g < 2N.
+static inline void calc_automorphism_map(uint32_t       map[],
+                                         const uint64_t g,
+                                         const uint64_t N,
+                                         const uint64_t width)
+{
+  for(size_t k = 0; k < N; k++) {
+    const uint64_t r = (g * ((2 * bit_rev_idx(k, width)) + 1)) % (2 * N);
+    map[k]           = (uint32_t)bit_rev_idx((r - 1) / 2, width);
+  }
+}
+
 static inline void calc_w(uint64_t       w_powers_rev[],
                           const uint64_t w,
                           const uint64_t N,
                           const uint64_t q,
                           const uint64_t width)
 {
-  uint64_t w_powers[N];
-  w_powers[0] = 1;
-  for(size_t i = 1; i < N; i++) {
-    w_powers[i] = (uint64_t)(((__uint128_t)w_powers[i - 1] * w) % q);
+  // Write the powers directly to their bit-reversed position to avoid a
+  // temporary array of N elements on the stack (N can be large).
+  uint64_t w_power = 1;
+  for(size_t i = 0; i < N; i++) {
+    w_powers_rev[bit_rev_idx(i, width)] = w_power;
+    w_power = (uint64_t)(((__uint128_t)w_power * w) % q);
   }
-
-  bit_rev(w_powers_rev, w_powers, N, width);
 }
 
 static inline void calc_w_inv(uint64_t       w_inv_rev[],
@@ -56,13 +83,43 @@ static inline void calc_w_inv(uint64_t       w_inv_rev[],
                               const uint64_t q,
                               const uint64_t width)
 {
-  uint64_t w_inv_powers[N];
-  w_inv_powers[0] = 1;
-  for(size_t i = 1; i < N; i++) {
-    w_inv_powers[i] = (uint64_t)(((__uint128_t)w_inv_powers[i - 1] * w_inv) % q);
+  calc_w(w_inv_rev, w_inv, N, q, width);
+}
+
+// Tables for the cyclic NTT (mod X^N - 1) with the negacyclic kernels.
+// w is a primitive N-th root of unity mod q, and the group j of level m uses
+// w_rev[m + j] = w^(brv(j)), where brv reverses width - 1 bits (the first
+// iteration has the root 1). The output at index k is then a(w^(brv(k))),
+// with brv over width bits. The table feeds calc_w_con and the expand_w
+// functions as the one of calc_w does.
+static inline void calc_w_cyclic(uint64_t       w_rev[],
+                                 const uint64_t w,
+                                 const uint64_t N,
+                                 const uint64_t q,
+                                 const uint64_t width)
+{
+  w_rev[0] = 1;
+  for(size_t m = 1, l = 0; m < N; m <<= 1, l++) {
+    uint64_t w_m = w;
+    // w_m is a primitive 2m-th root of unity.
+    for(size_t i = l + 1; i < width; i++) {
+      w_m = (uint64_t)(((__uint128_t)w_m * w_m) % q);
+    }
+    uint64_t w_power = 1;
+    for(size_t j = 0; j < m; j++) {
+      w_rev[m + bit_rev_idx(j, l)] = w_power;
+      w_power = (uint64_t)(((__uint128_t)w_power * w_m) % q);
+    }
   }
+}
 
-  bit_rev(w_inv_rev, w_inv_powers, N, width);
+static inline void calc_w_inv_cyclic(uint64_t       w_inv_rev[],
+                                     const uint64_t w_inv,
+                                     const uint64_t N,
+                                     const uint64_t q,
+                                     const uint64_t width)
+{
+  calc_w_cyclic(w_inv_rev, w_inv, N, q, width);
 }
 
 static inline void calc_w_con(uint64_t       w_con[],
@@ -76,12 +133,197 @@ static inline void calc_w_con(uint64_t       w_con[],
   }
 }
 
-static uint64_t
+static inline uint64_t
 calc_ninv_con(const uint64_t Ninv, const uint64_t q, const uint64_t word_size)
 {
   return ((__uint128_t)Ninv << word_size) / q;
 }
 
+static inline uint64_t mul_mod(const uint64_t a, const uint64_t b, const uint64_t q)
+{
+  return (uint64_t)(((__uint128_t)a * b) % q);
+}
+
+// Multiplies the len roots of w by n_inv and computes their w_con.
+// Used to fold the n^-1 scaling of an inverse NTT into its last iteration.
+static inline void calc_w_n_inv(uint64_t       w_out[],
+                                uint64_t       w_con_out[],
+                                const uint64_t w[],
+                                const uint64_t len,
+                                const uint64_t n_inv,
+                                const uint64_t q,
+                                const uint64_t word_size)
+{
+  for(size_t i = 0; i < len; i++) {
+    w_out[i] = mul_mod(w[i], n_inv, q);
+  }
+  calc_w_con(w_con_out, w_out, len, q, word_size);
+}
+
+static inline uint64_t pow_mod(uint64_t base, uint64_t exp, const uint64_t q)
+{
+  uint64_t ret = 1;
+  base %= q;
+  while(exp > 0) {
+    if(exp & 1) {
+      ret = mul_mod(ret, base, q);
+    }
+    base = mul_mod(base, base, q);
+    exp >>= 1;
+  }
+  return ret;
+}
+
+// The Galois element 5^steps mod 2N of a rotation by steps of the batched
+// (BGV/CKKS) slots, which sit at the roots psi^(5^j) and psi^(-5^j). 5 has the
+// order N/2 mod 2N, so negative steps rotate the other way. The conjugation
+// has the Galois element 2N - 1.
+static inline uint64_t galois_elt_rotation(const int64_t steps, const uint64_t N)
+{
+  const int64_t order = (int64_t)(N >> 1);
+  const int64_t r     = steps % order;
+
+  return pow_mod(5, (uint64_t)((r < 0) ? r + order : r), 2 * N);
+}
+
+// Assumption: q is prime.
+static inline uint64_t inv_mod(const uint64_t a, const uint64_t q)
+{
+  return pow_mod(a, q - 2, q);
+}
+
+// Deterministic Miller-Rabin test for 64-bit values.
+static inline int is_prime(const uint64_t n)
+{
+  static const uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+  const size_t          num_of_bases = sizeof(bases) / sizeof(bases[0]);
+
+  if(n < 2) {
+    return 0;
+  }
+  for(size_t i = 0; i < num_of_bases; i++) {
+    if(n % bases[i] == 0) {
+      return n == bases[i];
+    }
+  }
+
+  uint64_t d = n - 1;
+  uint64_t s = 0;
+  while(!(d & 1)) {
+    d >>= 1;
+    s++;
+  }
+
+  for(size_t i = 0; i < num_of_bases; i++) {
+    uint64_t x = pow_mod(bases[i], d, n);
+    if((x == 1) || (x == n - 1)) {
+      continue;
+    }
+    size_t r = 1;
+    for(; r < s; r++) {
+      x = mul_mod(x, x, n);
+      if(x == n - 1) {
+        break;
+      }
+    }
+    if(r == s) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Writes the num smallest primes q of exactly bits bits such that
+// q = 1 mod order to primes (in increasing order), and returns how many were
+// found. For the negacyclic NTT use order = 2N.
+static inline size_t find_ntt_primes(uint64_t       primes[],
+                                     const size_t   num,
+                                     const uint64_t order,
+                                     const uint64_t bits)
+{
+  size_t found = 0;
+
+  if((bits < 2) || (bits > 63)) {
+    return 0;
+  }
+
+  const uint64_t lower = 1UL << (bits - 1);
+  const uint64_t upper = (bits == 63) ? (uint64_t)-1 : (1UL << bits);
+
+  for(uint64_t q = (lower / order + 1) * order + 1; (q < upper) && (found < num);
+      q += order) {
+    if(is_prime(q)) {
+      primes[found++] = q;
+    }
+    if(q > upper - order) {
+      break;
+    }
+  }
+  return found;
+}
+
+// Returns the smallest prime q of exactly bits bits such that q = 1 mod order,
+// or 0 if there is no such prime.
+static inline uint64_t find_ntt_prime(const uint64_t order, const uint64_t bits)
+{
+  uint64_t q = 0;
+  find_ntt_primes(&q, 1, order, bits);
+  return q;
+}
+
+// Returns an element of multiplicative order exactly "order" mod the prime q.
+// Assumption: order divides q - 1.
+static inline uint64_t find_primitive_root(const uint64_t order, const uint64_t q)
+{
+  // Collect the distinct prime factors of order.
+  uint64_t factors[64];
+  size_t   num_of_factors = 0;
+  uint64_t rem            = order;
+  for(uint64_t p = 2; p * p <= rem; p++) {
+    if(rem % p == 0) {
+      factors[num_of_factors++] = p;
+      while(rem % p == 0) {
+        rem /= p;
+      }
+    }
+  }
+  if(rem > 1) {
+    factors[num_of_factors++] = rem;
+  }
+
+  for(uint64_t g = 2; g < q; g++) {
+    const uint64_t w  = pow_mod(g, (q - 1) / order, q);
+    int            ok = 1;
+    for(size_t i = 0; ok && (i < num_of_factors); i++) {
+      ok = (pow_mod(w, order / factors[i], q) != 1);
+    }
+    if(ok) {
+      return w;
+    }
+  }
+  return 0;
+}
+
+// The shifts of the k cosets of a low-degree extension (see lde_goldilocks):
+// shifts[j] = shift * z^j, where z is a primitive kN-th root of unity mod q.
+// The cosets z^j * <z^k> (j < k) partition the kN-th roots of unity, so the
+// negacyclic coset NTTs evaluate on shift * psi times all of them.
+// Assumption: kN divides q - 1.
+static inline void calc_lde_shifts(uint64_t       shifts[],
+                                   const uint64_t k,
+                                   const uint64_t N,
+                                   const uint64_t shift,
+                                   const uint64_t q)
+{
+  const uint64_t z   = find_primitive_root(k * N, q);
+  uint64_t       z_j = shift % q;
+
+  for(size_t j = 0; j < k; j++) {
+    shifts[j] = z_j;
+    z_j       = mul_mod(z_j, z, q);
+  }
+}
+
 static inline void expand_w(uint64_t       w_expanded[],
                             const uint64_t w[],
                             const uint64_t N,
@@ -104,7 +346,47 @@ static inline void expand_w(uint64_t       w_expanded[],
   }
 }
 
-#ifdef AVX512_IFMA_SUPPORT
+// The tables of the mixed-radix NTT of size N = 3M, M = 2^width (see
+// ntt_mixed_radix.h). psi is a primitive 2N-th root of unity mod q, and the
+// inverse NTT uses the same layout with psi^-1:
+// w[0..2M)         the radix-4 w-powers of psi^3 (calc_w and expand_w),
+// w[2M], w[2M + 1] the radix-3 roots psi^M and psi^2M (a cube root of unity),
+// w[2M + 8 + 2i]   the twists psi^-2i and psi^2i of radix-3 butterfly i.
+#define MIXED_RADIX3_W_SIZE(N) ((4 * (N) / 3) + 8)
+
+static inline void calc_w_mixed_radix3(uint64_t       w[],
+                                       const uint64_t psi,
+                                       const uint64_t N,
+                                       const uint64_t q,
+                                       const uint64_t width)
+{
+  const uint64_t M       = N / 3;
+  const uint64_t psi_inv = inv_mod(psi, q);
+  uint64_t      *tw      = &w[(2 * M) + 8];
+
+  // expand_w is not in place, the twist area holds its input.
+  calc_w(tw, pow_mod(psi, 3, q), M, q, width);
+  expand_w(w, tw, M, q);
+
+  w[2 * M]       = pow_mod(psi, M, q);
+  w[(2 * M) + 1] = pow_mod(psi, 2 * M, q);
+  for(size_t i = 2; i < 8; i++) {
+    w[(2 * M) + i] = 0;
+  }
+
+  uint64_t psi_2i     = 1;
+  uint64_t psi_inv_2i = 1;
+  for(size_t i = 0; i < M; i++) {
+    tw[2 * i]       = psi_inv_2i;
+    tw[(2 * i) + 1] = psi_2i;
+    psi_2i          = mul_mod(mul_mod(psi_2i, psi, q), psi, q);
+    psi_inv_2i      = mul_mod(mul_mod(psi_inv_2i, psi_inv, q), psi_inv, q);
+  }
+}
+
+// The following layouts are used by the AVX512-IFMA kernels, and the leaf
+// layout also by the 64-bit AVX512 kernels.
+#if defined(AVX512_IFMA_SUPPORT) || defined(AVX512_SUPPORT)
 
 static inline void
 expand_w_hexl(uint64_t w_expanded[], const uint64_t w[], const uint64_t N)
@@ -136,6 +418,20 @@ expand_w_hexl(uint64_t w_expanded[], const uint64_t w[], const uint64_t N)
   memset(&w_expanded[idx], 0, (2 * N - idx) * sizeof(uint64_t));
 }
 
+// The layout of HEXL's inverse roots: w[0] followed by the roots of every
+// level in the order they are used, from m = N/2 down to m = 1.
+static inline void
+expand_w_inv_hexl(uint64_t w_expanded[], const uint64_t w[], const uint64_t N)
+{
+  size_t idx = 0;
+
+  w_expanded[idx++] = w[0];
+  for(size_t m = (N >> 1); m > 0; m >>= 1) {
+    memcpy(&w_expanded[idx], &w[m], m * sizeof(uint64_t));
+    idx += m;
+  }
+}
+
 static inline void permute_w(uint64_t in_out[8])
 {
   uint64_t t[8];
@@ -151,11 +447,12 @@ static inline void permute_w(uint64_t in_out[8])
   in_out[7] = t[7];
 }
 
-static inline void expand_w_r4_avx512_ifma(uint64_t       w_expanded[],
-                                           const uint64_t w[],
-                                           const uint64_t N,
-                                           const uint64_t q,
-                                           const uint64_t unordered)
+// The roots of the radix-4 iterations with t >= 8 (FWD8).
+// Returns the next free index in w_expanded.
+static inline size_t expand_w_r4_fwd8_avx512_ifma(uint64_t       w_expanded[],
+                                                  const uint64_t w[],
+                                                  const uint64_t N,
+                                                  const uint64_t q)
 {
   size_t w_idx     = 1;
   size_t new_w_idx = 1;
@@ -196,6 +493,18 @@ static inline void expand_w_r4_avx512_ifma(uint64_t       w_expanded[],
     }
   }
 
+  return new_w_idx;
+}
+
+static inline void expand_w_r4_avx512_ifma(uint64_t       w_expanded[],
+                                           const uint64_t w[],
+                                           const uint64_t N,
+                                           const uint64_t q,
+                                           const uint64_t unordered)
+{
+  size_t w_idx;
+  size_t new_w_idx = expand_w_r4_fwd8_avx512_ifma(w_expanded, w, N, q);
+
   // FWD4
   for(w_idx = (N >> 4); w_idx < (N >> 3); w_idx += 2) {
     const uint64_t k        = 2 * w_idx;
@@ -203,12 +512,12 @@ static inline void expand_w_r4_avx512_ifma(uint64_t       w_expanded[],
     w_expanded[new_w_idx++] = w[w_idx + 1];
     w_expanded[new_w_idx++] = w[k];
     w_expanded[new_w_idx++] = w[k + 2];
-    w_expanded[new_w_idx++] = (w[w_idx] * w[k]) % q;
-    w_expanded[new_w_idx++] = (w[w_idx + 1] * w[k + 2]) % q;
+    w_expanded[new_w_idx++] = mul_mod(w[w_idx], w[k], q);
+    w_expanded[new_w_idx++] = mul_mod(w[w_idx + 1], w[k + 2], q);
     w_expanded[new_w_idx++] = w[k + 1];
     w_expanded[new_w_idx++] = w[k + 2 + 1];
-    w_expanded[new_w_idx++] = q - ((w[w_idx] * w[k + 1]) % q);
-    w_expanded[new_w_idx++] = q - ((w[w_idx + 1] * w[k + 3]) % q);
+    w_expanded[new_w_idx++] = q - mul_mod(w[w_idx], w[k + 1], q);
+    w_expanded[new_w_idx++] = q - mul_mod(w[w_idx + 1], w[k + 3], q);
   }
 
   // Align on an 8-qw boundary
@@ -226,7 +535,7 @@ static inline void expand_w_r4_avx512_ifma(uint64_t       w_expanded[],
     }
     // W3
     for(size_t i = 0; i < 8; i++) {
-      w_expanded[new_w_idx++] = (w[w_idx + i] * w[2 * (w_idx + i)]) % q;
+      w_expanded[new_w_idx++] = mul_mod(w[w_idx + i], w[2 * (w_idx + i)], q);
     }
     // W4
     for(size_t i = 0; i < 8; i++) {
@@ -234,7 +543,8 @@ static inline void expand_w_r4_avx512_ifma(uint64_t       w_expanded[],
     }
     // W5
     for(size_t i = 0; i < 8; i++) {
-      w_expanded[new_w_idx++] = q - ((w[w_idx + i] * w[2 * (w_idx + i) + 1]) % q);
+      w_expanded[new_w_idx++] =
+        q - mul_mod(w[w_idx + i], w[2 * (w_idx + i) + 1], q);
     }
 
     // Need to permute values
@@ -250,6 +560,61 @@ static inline void expand_w_r4_avx512_ifma(uint64_t       w_expanded[],
   memset(&w_expanded[new_w_idx], 0, ((5 * N) - new_w_idx) * sizeof(uint64_t));
 }
 
+// The radix-4 roots (w1, w2, w1*w2, w3, -w1*w3) of the group g.
+static inline void collect_r4_roots(uint64_t       roots[5],
+                                    const uint64_t w[],
+                                    const uint64_t g,
+                                    const uint64_t q)
+{
+  roots[0] = w[g];
+  roots[1] = w[2 * g];
+  roots[2] = mul_mod(w[g], w[2 * g], q);
+  roots[3] = w[2 * g + 1];
+  roots[4] = q - mul_mod(w[g], w[2 * g + 1], q);
+}
+
+// Same as expand_w_r4_avx512_ifma (FWD8 part) followed by the roots of the
+// 128-qw leaf. For every leaf, 5 vectors for the t=4 iteration and 4x5 vectors
+// for the t=1 iteration, where lane i holds the roots of the i'th 16-qw block.
+static inline void expand_w_r4_leaf_avx512_ifma(uint64_t       w_expanded[],
+                                                const uint64_t w[],
+                                                const uint64_t N,
+                                                const uint64_t q)
+{
+  if(N < RADIX4_AVX512_IFMA_LEAF_MIN_N) {
+    expand_w_r4_avx512_ifma(w_expanded, w, N, q, 0);
+    return;
+  }
+
+  size_t new_w_idx = expand_w_r4_fwd8_avx512_ifma(w_expanded, w, N, q);
+  uint64_t roots[5];
+
+  // Align on an 8-qw boundary
+  new_w_idx = ((new_w_idx >> 3) << 3) + 8;
+
+  for(size_t b = 0; b < (N >> 7); b++) {
+    for(size_t r = 0; r < 8; r++) {
+      collect_r4_roots(roots, w, (N >> 4) + 8 * b + r, q);
+      for(size_t k = 0; k < 5; k++) {
+        w_expanded[new_w_idx + 8 * k + r] = roots[k];
+      }
+    }
+    new_w_idx += 5 * 8;
+
+    for(size_t u = 0; u < 4; u++) {
+      for(size_t r = 0; r < 8; r++) {
+        collect_r4_roots(roots, w, (N >> 2) + 4 * (8 * b + r) + u, q);
+        for(size_t k = 0; k < 5; k++) {
+          w_expanded[new_w_idx + 8 * k + r] = roots[k];
+        }
+      }
+      new_w_idx += 5 * 8;
+    }
+  }
+
+  memset(&w_expanded[new_w_idx], 0, ((5 * N) - new_w_idx) * sizeof(uint64_t));
+}
+
 static inline void expand_w_r4r2_avx512_ifma(uint64_t       w_expanded[],
                                              const uint64_t w[],
                                              const uint64_t N,
@@ -323,6 +688,74 @@ static inline void expand_w_r4r2_avx512_ifma(uint64_t       w_expanded[],
   memset(&w_expanded[new_w_idx], 0, ((5 * N) - new_w_idx) * sizeof(uint64_t));
 }
 
+// The 11 roots of the radix-8 butterfly of group g (see radix8_fwd_butterfly).
+static inline void
+collect_r8_roots(uint64_t roots[11], const uint64_t w[], const uint64_t g, const uint64_t q)
+{
+  roots[0] = w[g];
+  for(size_t h = 0; h < 2; h++) {
+    const uint64_t g1 = 2 * g + h;
+    roots[1 + 5 * h]  = w[g1];
+    roots[2 + 5 * h]  = w[2 * g1];
+    roots[3 + 5 * h]  = mul_mod(w[g1], w[2 * g1], q);
+    roots[4 + 5 * h]  = w[2 * g1 + 1];
+    roots[5 + 5 * h]  = q - mul_mod(w[g1], w[2 * g1 + 1], q);
+  }
+}
+
+// Layout (N >= 64):
+// 1. The roots of the extra radix-2 or radix-4 iteration (padded to 8 qw).
+// 2. For every radix-8 iteration with m < N/8 groups, 11 roots per group
+//    (padded to 8 qw).
+// 3. For the last radix-8 iteration, 11 vectors of 8 qw per 8 groups, where
+//    lane i holds the root of the i'th group.
+static inline void expand_w_r8_avx512_ifma(uint64_t       w_expanded[],
+                                           const uint64_t w[],
+                                           const uint64_t N,
+                                           const uint64_t q)
+{
+  uint64_t log_n = 0;
+  uint64_t m     = 1;
+  size_t   idx   = 8;
+
+  for(uint64_t n = N; n > 1; n >>= 1) {
+    log_n++;
+  }
+
+  memset(w_expanded, 0, 2 * N * sizeof(uint64_t));
+
+  if(log_n % 3 == 1) {
+    w_expanded[0] = w[1];
+    m             = 2;
+  } else if(log_n % 3 == 2) {
+    w_expanded[0] = w[1];
+    w_expanded[1] = w[2];
+    w_expanded[2] = mul_mod(w[1], w[2], q);
+    w_expanded[3] = w[3];
+    w_expanded[4] = q - mul_mod(w[1], w[3], q);
+    m             = 4;
+  }
+
+  for(; m < (N >> 3); m <<= 3) {
+    for(size_t j = 0; j < m; j++) {
+      collect_r8_roots(&w_expanded[idx], w, m + j, q);
+      idx += 11;
+    }
+    idx = ((idx + 7) >> 3) << 3;
+  }
+
+  for(size_t j = 0; j < m; j += 8) {
+    uint64_t roots[11];
+    for(size_t l = 0; l < 8; l++) {
+      collect_r8_roots(roots, w, m + j + l, q);
+      for(size_t k = 0; k < 11; k++) {
+        w_expanded[idx + 8 * k + l] = roots[k];
+      }
+    }
+    idx += 8 * 11;
+  }
+}
+
 static inline void expand_w_r2_16_avx512_ifma(uint64_t       w_expanded[],
                                               const uint64_t w[],
                                               const uint64_t N)
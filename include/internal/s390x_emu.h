@@ -0,0 +1,80 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+// A portable emulation of the z/Architecture vector intrinsics (vecintrin.h)
+// that are used by ntt_radix4_s390x_vef.c. It keeps the big-endian element
+// order of the hardware (element 0 holds the most significant doubleword of a
+// 128-bit value), so that the s390x code can be built and unit-tested on
+// other hosts (cmake -DS390X_EMU=1). It is slow and meant for testing only.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "defs.h"
+
+// The zvector "vector" keyword, under a prefixed name so that it does not
+// leak into the includers. As on s390x, vector loads and stores only require
+// an 8 bytes alignment.
+#define S390X_EMU_VECTOR __attribute__((vector_size(16), aligned(8)))
+
+typedef S390X_EMU_VECTOR unsigned long long s390x_emu_ul_vec;
+typedef S390X_EMU_VECTOR unsigned char      s390x_emu_uc_vec;
+
+static inline __uint128_t s390x_emu_to_u128(const s390x_emu_ul_vec v)
+{
+  return ((__uint128_t)v[0] << 64) | v[1];
+}
+
+static inline s390x_emu_ul_vec s390x_emu_from_u128(const __uint128_t x)
+{
+  const s390x_emu_ul_vec v = {(unsigned long long)(x >> 64),
+                              (unsigned long long)x};
+  return v;
+}
+
+// VMSL: the sum of the products of the even and of the odd doublewords plus
+// the 128-bit value c (modulo 2^128).
+static inline s390x_emu_uc_vec vec_msum_u128(const s390x_emu_ul_vec a,
+                                             const s390x_emu_ul_vec b,
+                                             const s390x_emu_uc_vec c,
+                                             UNUSED const int       d)
+{
+  const __uint128_t r = ((__uint128_t)a[0] * b[0]) +
+                        ((__uint128_t)a[1] * b[1]) +
+                        s390x_emu_to_u128((s390x_emu_ul_vec)c);
+
+  return (s390x_emu_uc_vec)s390x_emu_from_u128(r);
+}
+
+// Bytes n..n+15 of the concatenation of a and b.
+static inline s390x_emu_ul_vec
+vec_sld(const s390x_emu_ul_vec a, const s390x_emu_ul_vec b, const int n)
+{
+  if(n == 0) {
+    return a;
+  }
+
+  return s390x_emu_from_u128((s390x_emu_to_u128(a) << (8 * n)) |
+                             (s390x_emu_to_u128(b) >> (128 - (8 * n))));
+}
+
+static inline s390x_emu_ul_vec vec_cmpge(const s390x_emu_ul_vec a,
+                                         const s390x_emu_ul_vec b)
+{
+  return (s390x_emu_ul_vec)(a >= b);
+}
+
+static inline s390x_emu_ul_vec vec_sel(const s390x_emu_ul_vec a,
+                                       const s390x_emu_ul_vec b,
+                                       const s390x_emu_ul_vec c)
+{
+  return (a & ~c) | (b & c);
+}
+
+static inline s390x_emu_ul_vec vec_mergel(const s390x_emu_ul_vec a,
+                                          const s390x_emu_ul_vec b)
+{
+  const s390x_emu_ul_vec v = {a[1], b[1]};
+  return v;
+}
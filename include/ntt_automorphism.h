@@ -0,0 +1,34 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "defs.h"
+
+EXTERNC_BEGIN
+
+// Galois automorphisms a(X) -> a(X^g) in the NTT domain of fwd_ntt_radix4
+// (and every kernel with its bit-reversed output order): out[k] = in[map[k]],
+// with the map of calc_automorphism_map for (N, g). The map does not depend on
+// q, so num_limbs RNS limbs (limb l at in[l * N] and out[l * N]) are permuted
+// with one map. The map sends every aligned block of 2^r slots to a single
+// aligned block of 2^r slots, so the limbs are permuted block by block
+// (NTT_AUTOMORPHISM_BLOCK slots): the map block stays in L1 across the limbs,
+// and the gathers of a block read a single block of in.
+// Assumption out does not overlap in.
+void ntt_automorphism(uint64_t       out[],
+                      const uint64_t in[],
+                      const uint32_t map[],
+                      uint64_t       N,
+                      uint64_t       num_limbs);
+
+#ifdef AVX512_SUPPORT
+// The same with AVX512-F gathers (eight slots at a time), N >= 8.
+void ntt_automorphism_avx512(uint64_t       out[],
+                             const uint64_t in[],
+                             const uint32_t map[],
+                             uint64_t       N,
+                             uint64_t       num_limbs);
+#endif
+
+EXTERNC_END
@@ -0,0 +1,123 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "defs.h"
+
+EXTERNC_BEGIN
+
+#include <stdint.h>
+
+#include "fast_mul_operators.h"
+
+// The forward NTT kernels a plan can select from. All of them compute the
+// output of fwd_ntt_radix4 and differ only in speed and in their w-powers
+// layout. fwd_ntt_radix4_avx512_ifma_unordered permutes its output, so it is
+// not a candidate.
+typedef enum ntt_kernel_e
+{
+  NTT_KERNEL_RADIX4 = 0,
+  NTT_KERNEL_RADIX4X4,
+  NTT_KERNEL_RADIX8,
+  NTT_KERNEL_RADIX4_REC,
+  NTT_KERNEL_RADIX4_GVEC,
+#ifdef AVX512_SUPPORT
+  NTT_KERNEL_RADIX4_AVX512,
+#endif
+#ifdef AVX512_IFMA_SUPPORT
+  NTT_KERNEL_RADIX2_HEXL,
+  NTT_KERNEL_RADIX4_AVX512_IFMA,
+  NTT_KERNEL_RADIX4_AVX512_IFMA_LEAF,
+  NTT_KERNEL_RADIX4_AVX512_IFMA_REC,
+  NTT_KERNEL_R4R2_AVX512_IFMA,
+  NTT_KERNEL_R2_16_AVX512_IFMA,
+  NTT_KERNEL_RADIX8_AVX512_IFMA,
+#endif
+  NTT_KERNEL_NUM
+} ntt_kernel_t;
+
+// NTT_PLAN_ESTIMATE picks the kernel heuristically (no timing).
+// NTT_PLAN_MEASURE times every applicable kernel and picks the fastest one,
+// the recursive kernels with every power of two cut-off from 2^9 to 2^14 qw
+// (below N).
+// In both cases a matching wisdom entry takes precedence.
+typedef enum ntt_plan_flags_e
+{
+  NTT_PLAN_ESTIMATE = 0,
+  NTT_PLAN_MEASURE  = 1
+} ntt_plan_flags_t;
+
+typedef struct ntt_plan_s {
+  uint64_t     m;
+  uint64_t     n;
+  uint64_t     q;
+  uint64_t     w; // A primitive 2n-th root of unity mod q
+  ntt_kernel_t kernel;
+  // The recursion cut-off (in qw) of the recursive kernels, see
+  // RADIX4_RECURSION_BASE_N. Ignored by the other kernels.
+  uint64_t     rec_base_n;
+
+  // The w-powers (and their Shoup constants) in the layout of kernel.
+  void *    base;
+  uint64_t *w_powers;
+  uint64_t *w_powers_con;
+
+  // The inverse w-powers (expanded with expand_w) and n^-1, for
+  // inv_ntt_radix4.
+  uint64_t *w_inv_powers;
+  uint64_t *w_inv_powers_con;
+  mul_op_t  n_inv;
+} ntt_plan_t;
+
+// Creates a plan for N=2^m. The wisdom file is a text file with one
+// "<cpu-model> <m> <q-bits> <kernel-name> [<rec-base-n>]" entry per line, it
+// may be NULL. Without rec-base-n the default RADIX4_RECURSION_BASE_N is used.
+// When a plan is measured and wisdom_path is not NULL, the winner is appended
+// to the wisdom file.
+// Returns SUCCESS or ERROR.
+int ntt_plan_init(ntt_plan_t *     plan,
+                  uint64_t         m,
+                  uint64_t         q,
+                  uint64_t         w,
+                  ntt_plan_flags_t flags,
+                  const char *     wisdom_path);
+
+void ntt_plan_destroy(ntt_plan_t *plan);
+
+// Computes the forward NTT of a (in-place), the output is in [0, q).
+void ntt_plan_fwd(const ntt_plan_t *plan, uint64_t a[]);
+
+// Same as ntt_plan_fwd with explicit lazy ranges (as in HEXL): the input is in
+// [0, input_mod_factor*q) and the output in [0, output_mod_factor*q), where
+// both factors are 1, 2, 4 or 8. Only the reductions the kernel needs to meet
+// the contract are performed, e.g. when the output feeds
+// ntt_plan_inv_mod_factor (which accepts [0, 8q)) output_mod_factor may be 8.
+// Returns ERROR (and leaves a unchanged) for other factors, SUCCESS otherwise.
+int ntt_plan_fwd_mod_factor(const ntt_plan_t *plan,
+                            uint64_t          a[],
+                            uint64_t          input_mod_factor,
+                            uint64_t          output_mod_factor);
+
+// The output mod factor of the lazy kernel of plan. Passing it as
+// output_mod_factor skips the final reduction.
+uint64_t ntt_plan_out_mod_factor(const ntt_plan_t *plan);
+
+// Computes the inverse NTT of a (in-place) with inv_ntt_radix4, the input and
+// the output are in [0, q).
+void ntt_plan_inv(const ntt_plan_t *plan, uint64_t a[]);
+
+// Same as ntt_plan_inv with explicit lazy ranges: the input is in
+// [0, input_mod_factor*q) (e.g. the lazy output of ntt_plan_fwd_mod_factor)
+// and the output in [0, output_mod_factor*q), where both factors are 1, 2, 4
+// or 8. The inverse kernel accepts [0, 8q) and reduces its output to [0, q), so
+// no extra pass is performed.
+// Returns ERROR (and leaves a unchanged) for other factors, SUCCESS otherwise.
+int ntt_plan_inv_mod_factor(const ntt_plan_t *plan,
+                            uint64_t          a[],
+                            uint64_t          input_mod_factor,
+                            uint64_t          output_mod_factor);
+
+const char *ntt_kernel_name(ntt_kernel_t kernel);
+
+EXTERNC_END
@@ -0,0 +1,79 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "defs.h"
+
+EXTERNC_BEGIN
+
+#ifdef AVX512_SUPPORT
+
+#  include "avx512.h"
+#  include "fast_mul_operators.h"
+
+// Radix-4 NTT with 64-bit AVX512-F/DQ multiplications, for platforms without
+// AVX512-IFMA and for moduli up to AVX512_MAX_MODULUS bits.
+// The output of the lazy forward NTT is in the range [0, 4q).
+// The w-powers are expanded with expand_w_r4_leaf_avx512_ifma and their
+// constants are computed with WORD_SIZE.
+// Assumption N >= RADIX4_AVX512_IFMA_LEAF_MIN_N.
+void fwd_ntt_radix4_avx512_lazy(uint64_t       a[],
+                                uint64_t       N,
+                                uint64_t       q,
+                                const uint64_t w[],
+                                const uint64_t w_con[]);
+
+// The input is in the range [0, 8q) (or [0, 4q) when 8q >= 2^64) and the
+// output in [0, q).
+// n_inv.con is computed with WORD_SIZE.
+void inv_ntt_radix4_avx512(uint64_t       a[],
+                           uint64_t       N,
+                           uint64_t       q,
+                           mul_op_t       n_inv,
+                           const uint64_t w[],
+                           const uint64_t w_con[]);
+
+// Out-of-place variants: the first iteration reads src and writes dst, src is
+// not modified and dst may be src. The non-lazy forward NTT reduces its
+// outputs in the last iteration instead of an extra pass. When nt_store is
+// non-zero, the last pass writes dst with non-temporal stores, which bypass
+// the caches. This pays off for large N when the result is not read again
+// soon; it is ignored when dst is not 64-byte aligned.
+void fwd_ntt_radix4_avx512_oop_lazy(uint64_t       dst[],
+                                    const uint64_t src[],
+                                    uint64_t       N,
+                                    uint64_t       q,
+                                    const uint64_t w[],
+                                    const uint64_t w_con[],
+                                    int            nt_store);
+
+void fwd_ntt_radix4_avx512_oop(uint64_t       dst[],
+                               const uint64_t src[],
+                               uint64_t       N,
+                               uint64_t       q,
+                               const uint64_t w[],
+                               const uint64_t w_con[],
+                               int            nt_store);
+
+void inv_ntt_radix4_avx512_oop(uint64_t       dst[],
+                               const uint64_t src[],
+                               uint64_t       N,
+                               uint64_t       q,
+                               mul_op_t       n_inv,
+                               const uint64_t w[],
+                               const uint64_t w_con[],
+                               int            nt_store);
+
+static inline void fwd_ntt_radix4_avx512(uint64_t       a[],
+                                         const uint64_t N,
+                                         const uint64_t q,
+                                         const uint64_t w[],
+                                         const uint64_t w_con[])
+{
+  fwd_ntt_radix4_avx512_oop(a, a, N, q, w, w_con, 0);
+}
+
+#endif
+
+EXTERNC_END
@@ -10,6 +10,7 @@ EXTERNC_BEGIN
 #ifdef AVX512_IFMA_SUPPORT
 
 #  include "avx512.h"
+#  include "fast_mul_operators.h"
 
 void fwd_ntt_radix4_avx512_ifma_lazy(uint64_t       a[],
                                      uint64_t       N,
@@ -17,52 +18,109 @@ void fwd_ntt_radix4_avx512_ifma_lazy(uint64_t       a[],
                                      const uint64_t w[],
                                      const uint64_t w_con[]);
 
-// Assumption N % 2^6 = 0
-static inline void
-final_reduce_q8(uint64_t a[], const uint64_t N, const uint64_t q_64)
+static inline void fwd_ntt_radix4_avx512_ifma(uint64_t       a[],
+                                              const uint64_t N,
+                                              const uint64_t q,
+                                              const uint64_t w[],
+                                              const uint64_t w_con[])
 {
-  const __m512i q  = SET1(q_64);
-  const __m512i q2 = SET1(q_64 << 1);
-  const __m512i q4 = SET1(q_64 << 2);
-
-  // Final reduction
-  for(size_t i = 0; i < N; i += 8 * 8) {
-    LOOP_UNROLL_8
-    for(size_t j = 0; j < 8; j++) {
-      __m512i T = reduce_if_greater(LOAD(&a[i + 8 * j]), q4);
-      T         = reduce_if_greater(T, q2);
-      T         = reduce_if_greater(T, q);
-      STORE(&a[i + 8 * j], T);
-    }
-  }
+  fwd_ntt_radix4_avx512_ifma_lazy(a, N, q, w, w_con);
+  final_reduce_q8(a, N, q);
 }
 
-// Assumption N % 2^6 = 0
-static inline void
-final_reduce_q4(uint64_t a[], const uint64_t N, const uint64_t q_64)
+// Out-of-place variants: the first iteration reads src and writes dst, src is
+// not modified and dst may be src. These have no nt_store option: their last
+// iterations work on 4-qw groups, and the non-lazy variant reads dst back in
+// final_reduce_q8 (see fwd_ntt_radix4_avx512_ifma_leaf_oop_lazy).
+void fwd_ntt_radix4_avx512_ifma_oop_lazy(uint64_t       dst[],
+                                         const uint64_t src[],
+                                         uint64_t       N,
+                                         uint64_t       q,
+                                         const uint64_t w[],
+                                         const uint64_t w_con[]);
+
+static inline void fwd_ntt_radix4_avx512_ifma_oop(uint64_t       dst[],
+                                                  const uint64_t src[],
+                                                  const uint64_t N,
+                                                  const uint64_t q,
+                                                  const uint64_t w[],
+                                                  const uint64_t w_con[])
 {
-  const __m512i q  = SET1(q_64);
-  const __m512i q2 = SET1(q_64 << 1);
-  // Final reduction
-  for(size_t i = 0; i < N; i += 8 * 8) {
-    LOOP_UNROLL_8
-    for(size_t j = 0; j < 8; j++) {
-      __m512i T = reduce_if_greater(LOAD(&a[i + 8 * j]), q2);
-      STORE(&a[i + 8 * j], reduce_if_greater(T, q));
-    }
-  }
+  fwd_ntt_radix4_avx512_ifma_oop_lazy(dst, src, N, q, w, w_con);
+  final_reduce_q8(dst, N, q);
 }
 
-static inline void fwd_ntt_radix4_avx512_ifma(uint64_t       a[],
-                                              const uint64_t N,
-                                              const uint64_t q,
+// Same as fwd_ntt_radix4_avx512_ifma but for N >= RADIX4_AVX512_IFMA_LEAF_MIN_N
+// the last four layers are performed in registers on 128-qw blocks (without
+// gather/scatter). The w-powers are expanded with expand_w_r4_leaf_avx512_ifma.
+void fwd_ntt_radix4_avx512_ifma_leaf_lazy(uint64_t       a[],
+                                          uint64_t       N,
+                                          uint64_t       q,
+                                          const uint64_t w[],
+                                          const uint64_t w_con[]);
+
+static inline void fwd_ntt_radix4_avx512_ifma_leaf(uint64_t       a[],
+                                                   const uint64_t N,
+                                                   const uint64_t q,
+                                                   const uint64_t w[],
+                                                   const uint64_t w_con[])
+{
+  fwd_ntt_radix4_avx512_ifma_leaf_lazy(a, N, q, w, w_con);
+  final_reduce_q8(a, N, q);
+}
+
+// When nt_store is non-zero and N >= RADIX4_AVX512_IFMA_LEAF_MIN_N, the leaf
+// pass writes dst with non-temporal stores, as in fwd_ntt_radix4_avx512_oop.
+// It is ignored when dst is not 64-byte aligned. The non-lazy variant does not
+// use it, as final_reduce_q8 reads dst right back.
+void fwd_ntt_radix4_avx512_ifma_leaf_oop_lazy(uint64_t       dst[],
+                                              const uint64_t src[],
+                                              uint64_t       N,
+                                              uint64_t       q,
                                               const uint64_t w[],
-                                              const uint64_t w_con[])
+                                              const uint64_t w_con[],
+                                              int            nt_store);
+
+static inline void fwd_ntt_radix4_avx512_ifma_leaf_oop(uint64_t       dst[],
+                                                       const uint64_t src[],
+                                                       const uint64_t N,
+                                                       const uint64_t q,
+                                                       const uint64_t w[],
+                                                       const uint64_t w_con[])
 {
-  fwd_ntt_radix4_avx512_ifma_lazy(a, N, q, w, w_con);
+  fwd_ntt_radix4_avx512_ifma_leaf_oop_lazy(dst, src, N, q, w, w_con, 0);
+  final_reduce_q8(dst, N, q);
+}
+
+// Depth-first variant of fwd_ntt_radix4_avx512_ifma_leaf (same w-powers).
+// A block is recursively split into its four quarters until it is at most
+// RADIX4_RECURSION_BASE_N qw, its remaining layers are then computed while it
+// is cache-resident.
+void fwd_ntt_radix4_avx512_ifma_rec_lazy(uint64_t       a[],
+                                         uint64_t       N,
+                                         uint64_t       q,
+                                         const uint64_t w[],
+                                         const uint64_t w_con[]);
+
+static inline void fwd_ntt_radix4_avx512_ifma_rec(uint64_t       a[],
+                                                  const uint64_t N,
+                                                  const uint64_t q,
+                                                  const uint64_t w[],
+                                                  const uint64_t w_con[])
+{
+  fwd_ntt_radix4_avx512_ifma_rec_lazy(a, N, q, w, w_con);
   final_reduce_q8(a, N, q);
 }
 
+// Same as fwd_ntt_radix4_avx512_ifma_rec_lazy with the cut-off base_n instead
+// of RADIX4_RECURSION_BASE_N, for the autotuner.
+void fwd_ntt_radix4_avx512_ifma_rec_base_lazy(uint64_t       a[],
+                                              uint64_t       N,
+                                              uint64_t       q,
+                                              const uint64_t w[],
+                                              const uint64_t w_con[],
+                                              uint64_t       base_n);
+
 void fwd_ntt_r4r2_avx512_ifma_lazy(uint64_t       a[],
                                    uint64_t       N,
                                    uint64_t       q,
@@ -95,6 +153,35 @@ static inline void fwd_ntt_radix4_avx512_ifma_unordered(uint64_t       a[],
   final_reduce_q8(a, N, q);
 }
 
+// The inverse of fwd_ntt_radix4_avx512_ifma_lazy_unordered. It takes the
+// input in the permuted order of the forward transform, in the range [0, 8q),
+// and returns the output in the natural order, in the range [0, q).
+// The w-powers are the inverse ones, expanded with expand_w_r4_avx512_ifma
+// (unordered=1). n_inv.con is computed with AVX512_IFMA_WORD_SIZE.
+// Assumption N >= 128 (as in the forward transform).
+void inv_ntt_radix4_avx512_ifma_unordered(uint64_t       a[],
+                                          uint64_t       N,
+                                          uint64_t       q,
+                                          mul_op_t       n_inv,
+                                          const uint64_t w[],
+                                          const uint64_t w_con[]);
+
+// a[i] = a[i] * b[i] mod q, for a[i] < 2^52 (e.g. the [0, 8q) output of a lazy
+// forward NTT). b is in the range [0, q) and b_con is computed with calc_w_con
+// and AVX512_IFMA_WORD_SIZE. The output is in the range [0, 2q).
+// In both pointwise operations N is a multiple of 8.
+void pointwise_mul_avx512_ifma(uint64_t       a[],
+                               const uint64_t b[],
+                               const uint64_t b_con[],
+                               uint64_t       N,
+                               uint64_t       q);
+
+// a[i] = a[i] + b[i], the inputs and the output are in the range [0, 8q).
+void pointwise_add_avx512_ifma(uint64_t       a[],
+                               const uint64_t b[],
+                               uint64_t       N,
+                               uint64_t       q);
+
 void fwd_ntt_r2_16_avx512_ifma_lazy(uint64_t       a[],
                                     uint64_t       N,
                                     uint64_t       q,
@@ -111,6 +198,32 @@ static inline void fwd_ntt_r2_16_avx512_ifma(uint64_t       a[],
   final_reduce_q4(a, N, q);
 }
 
+// Mixed radix-8/4/2 NTT (see ntt_radix8.h).
+// The w-powers are expanded with expand_w_r8_avx512_ifma. Assumption N >= 64.
+void fwd_ntt_radix8_avx512_ifma_lazy(uint64_t       a[],
+                                     uint64_t       N,
+                                     uint64_t       q,
+                                     const uint64_t w[],
+                                     const uint64_t w_con[]);
+
+static inline void fwd_ntt_radix8_avx512_ifma(uint64_t       a[],
+                                              const uint64_t N,
+                                              const uint64_t q,
+                                              const uint64_t w[],
+                                              const uint64_t w_con[])
+{
+  fwd_ntt_radix8_avx512_ifma_lazy(a, N, q, w, w_con);
+  final_reduce_q8(a, N, q);
+}
+
+// n_inv.con is computed with AVX512_IFMA_WORD_SIZE.
+void inv_ntt_radix8_avx512_ifma(uint64_t       a[],
+                                uint64_t       N,
+                                uint64_t       q,
+                                mul_op_t       n_inv,
+                                const uint64_t w[],
+                                const uint64_t w_con[]);
+
 #endif
 
 EXTERNC_END
@@ -0,0 +1,102 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "fast_mul_operators.h"
+
+EXTERNC_BEGIN
+
+// Multiplication of unsigned integers of 64-bit limbs (least significant limb
+// first). Every limb is a coefficient of a polynomial, so that a product of
+// a_len and b_len limbs is a linear convolution of L = a_len + b_len - 1
+// coefficients. Each coefficient is below L * 2^128, it is computed modulo
+// BIGINT_NUM_OF_PRIMES primes of BIGINT_PRIME_BITS bits with negacyclic NTTs
+// of size N >= L (the zero padding avoids any wrap-around), and is recovered
+// with the CRT before the carries are propagated.
+// The product of the primes exceeds 2^177, hence L < 2^49.
+
+// The Garner recombination is written for three primes.
+#define BIGINT_NUM_OF_PRIMES 3
+
+// The inverse NTT accepts [0, 8q) inputs only for q < 2^60.
+#define BIGINT_PRIME_BITS 60UL
+
+#define BIGINT_MIN_M 6UL
+
+// The cut-overs of bigint_mul in limbs: schoolbook multiplication when the
+// shorter operand is below BIGINT_KARATSUBA_THRESHOLD limbs, Karatsuba up to
+// a product of BIGINT_NTT_THRESHOLD limbs and the NTT above it.
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#  define BIGINT_KARATSUBA_THRESHOLD 32
+#endif
+
+#ifndef BIGINT_NTT_THRESHOLD
+#  define BIGINT_NTT_THRESHOLD 768
+#endif
+
+typedef struct bigint_mul_plan_s {
+  uint64_t m;
+  uint64_t n;
+  uint64_t q[BIGINT_NUM_OF_PRIMES];
+
+  // q^-1 mod 2^64, for the Montgomery products of the pointwise step.
+  uint64_t q_inv[BIGINT_NUM_OF_PRIMES];
+
+  // n^-1 * 2^64 mod q, which also removes the Montgomery factor.
+  mul_op_t n_inv[BIGINT_NUM_OF_PRIMES];
+
+  // The Garner constants q0^-1 mod q1, q0^-1 mod q2 and q1^-1 mod q2.
+  mul_op_t crt[3];
+
+  // The w-powers of every prime, expanded with expand_w (2n qw each), and
+  // their w_con with WORD_SIZE.
+  void *    base;
+  uint64_t *w[BIGINT_NUM_OF_PRIMES];
+  uint64_t *w_con[BIGINT_NUM_OF_PRIMES];
+  uint64_t *w_inv[BIGINT_NUM_OF_PRIMES];
+  uint64_t *w_inv_con[BIGINT_NUM_OF_PRIMES];
+} bigint_mul_plan_t;
+
+// Creates a plan for products of up to N + 1 = 2^m + 1 limbs.
+// Returns SUCCESS, or ERROR when m < BIGINT_MIN_M or on allocation failure.
+int bigint_mul_plan_init(bigint_mul_plan_t *plan, uint64_t m);
+
+void bigint_mul_plan_destroy(bigint_mul_plan_t *plan);
+
+// c[0..a_len + b_len) = a * b with the NTT. The forward NTTs are computed with
+// fwd_ntt_radix4x4 and the inverse NTTs with inv_ntt_radix4.
+// Assumption a_len + b_len - 1 <= plan->n, and c does not overlap a or b.
+// Returns SUCCESS or ERROR (allocation failure).
+int bigint_mul_ntt(const bigint_mul_plan_t *plan,
+                   uint64_t                 c[],
+                   const uint64_t           a[],
+                   uint64_t                 a_len,
+                   const uint64_t           b[],
+                   uint64_t                 b_len);
+
+// c[0..a_len + b_len) = a * b, c does not overlap a or b.
+void bigint_mul_schoolbook(uint64_t       c[],
+                           const uint64_t a[],
+                           uint64_t       a_len,
+                           const uint64_t b[],
+                           uint64_t       b_len);
+
+// c[0..2 * len) = a * b, c does not overlap a or b.
+// Returns SUCCESS or ERROR (allocation failure).
+int bigint_mul_karatsuba(uint64_t       c[],
+                         const uint64_t a[],
+                         const uint64_t b[],
+                         uint64_t       len);
+
+// c[0..a_len + b_len) = a * b with the algorithm of the cut-overs above. The
+// NTT plan is created for every call, callers that multiply many operands of
+// the same size should keep a plan and call bigint_mul_ntt.
+// Returns SUCCESS or ERROR.
+int bigint_mul(uint64_t       c[],
+               const uint64_t a[],
+               uint64_t       a_len,
+               const uint64_t b[],
+               uint64_t       b_len);
+
+EXTERNC_END
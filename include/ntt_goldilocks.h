@@ -0,0 +1,136 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "goldilocks.h"
+
+EXTERNC_BEGIN
+
+// Radix-4 NTT modulo the Goldilocks prime p = GOLDILOCKS_Q, with the
+// special-form reduction of goldilocks.h instead of Shoup multiplications.
+// w (w_inv) are the bit-reversed powers of a primitive 2N-th root of unity
+// mod p (its inverse), computed with calc_w (calc_w_inv), and there is no
+// w_con. When N = 2^m with m odd, the forward NTT starts with a radix-2 layer
+// and the inverse NTT ends with one.
+// The input and the lazy output are any 64-bit values (mod factor 2, see
+// goldilocks.h), the output of the non-lazy functions is in [0, p).
+// Assumption 8 <= N <= 2^31 (the 2-adicity of p - 1 is 32).
+void fwd_ntt_goldilocks_lazy(uint64_t a[], uint64_t N, const uint64_t w[]);
+
+static inline void
+fwd_ntt_goldilocks(uint64_t a[], const uint64_t N, const uint64_t w[])
+{
+  fwd_ntt_goldilocks_lazy(a, N, w);
+  goldilocks_canonicalize(a, N);
+}
+
+// n_inv = N^-1 mod p, it is folded into the last layer.
+void inv_ntt_goldilocks(uint64_t       a[],
+                        uint64_t       N,
+                        uint64_t       n_inv,
+                        const uint64_t w_inv[]);
+
+// Coset NTT: the NTT of in[i] * shift^i, i.e. the polynomial in evaluated on
+// shift times the points of fwd_ntt_goldilocks. The powers of shift are
+// applied by the first iteration, which reads in and writes out (out may be
+// in), and the tables are the same.
+void fwd_ntt_goldilocks_coset_lazy(uint64_t       out[],
+                                   const uint64_t in[],
+                                   uint64_t       N,
+                                   uint64_t       shift,
+                                   const uint64_t w[]);
+
+static inline void fwd_ntt_goldilocks_coset(uint64_t       out[],
+                                            const uint64_t in[],
+                                            const uint64_t N,
+                                            const uint64_t shift,
+                                            const uint64_t w[])
+{
+  fwd_ntt_goldilocks_coset_lazy(out, in, N, shift, w);
+  goldilocks_canonicalize(out, N);
+}
+
+// Low-degree extension: out[jN..(j+1)N) is the coset NTT of a with shifts[j]
+// for j < k, in [0, p). All the cosets share the w-powers, and with the shifts
+// of calc_lde_shifts they evaluate a on k*N points. When built with OpenMP
+// (cmake -DOPENMP=1) the cosets are computed in parallel. It uses the widest
+// available coset NTT.
+void lde_goldilocks(uint64_t       out[],
+                    const uint64_t a[],
+                    uint64_t       N,
+                    uint64_t       k,
+                    const uint64_t shifts[],
+                    const uint64_t w[]);
+
+#ifdef __AVX2__
+// The same with AVX2 and the same tables. For N < 64 they fall back to the
+// scalar functions.
+void fwd_ntt_goldilocks_avx2_lazy(uint64_t a[], uint64_t N, const uint64_t w[]);
+
+static inline void
+fwd_ntt_goldilocks_avx2(uint64_t a[], const uint64_t N, const uint64_t w[])
+{
+  fwd_ntt_goldilocks_avx2_lazy(a, N, w);
+  goldilocks_canonicalize(a, N);
+}
+
+void inv_ntt_goldilocks_avx2(uint64_t       a[],
+                             uint64_t       N,
+                             uint64_t       n_inv,
+                             const uint64_t w_inv[]);
+
+void fwd_ntt_goldilocks_avx2_coset_lazy(uint64_t       out[],
+                                        const uint64_t in[],
+                                        uint64_t       N,
+                                        uint64_t       shift,
+                                        const uint64_t w[]);
+
+static inline void fwd_ntt_goldilocks_avx2_coset(uint64_t       out[],
+                                                 const uint64_t in[],
+                                                 const uint64_t N,
+                                                 const uint64_t shift,
+                                                 const uint64_t w[])
+{
+  fwd_ntt_goldilocks_avx2_coset_lazy(out, in, N, shift, w);
+  goldilocks_canonicalize(out, N);
+}
+#endif
+
+#ifdef AVX512_SUPPORT
+// The same with AVX512-F and the same tables. For N < 64 they fall back to the
+// scalar functions.
+void fwd_ntt_goldilocks_avx512_lazy(uint64_t       a[],
+                                    uint64_t       N,
+                                    const uint64_t w[]);
+
+static inline void
+fwd_ntt_goldilocks_avx512(uint64_t a[], const uint64_t N, const uint64_t w[])
+{
+  fwd_ntt_goldilocks_avx512_lazy(a, N, w);
+  goldilocks_canonicalize(a, N);
+}
+
+void inv_ntt_goldilocks_avx512(uint64_t       a[],
+                               uint64_t       N,
+                               uint64_t       n_inv,
+                               const uint64_t w_inv[]);
+
+void fwd_ntt_goldilocks_avx512_coset_lazy(uint64_t       out[],
+                                          const uint64_t in[],
+                                          uint64_t       N,
+                                          uint64_t       shift,
+                                          const uint64_t w[]);
+
+static inline void fwd_ntt_goldilocks_avx512_coset(uint64_t       out[],
+                                                   const uint64_t in[],
+                                                   const uint64_t N,
+                                                   const uint64_t shift,
+                                                   const uint64_t w[])
+{
+  fwd_ntt_goldilocks_avx512_coset_lazy(out, in, N, shift, w);
+  goldilocks_canonicalize(out, N);
+}
+#endif
+
+EXTERNC_END
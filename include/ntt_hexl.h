@@ -39,6 +39,30 @@ static inline void fwd_ntt_radix2_hexl(uint64_t       a[],
   ForwardTransformToBitReverseAVX512(a, N, q, w, w_con, 2, 1, 0, 0);
 }
 
+// Internal function of Intel HEXL under the license of Intel HEXL
+void InverseTransformFromBitReverseAVX512(
+  uint64_t *      operand,
+  uint64_t        degree,
+  uint64_t        mod,
+  const uint64_t *inv_root_of_unity_powers,
+  const uint64_t *precon_inv_root_of_unity_powers,
+  uint64_t        input_mod_factor,
+  uint64_t        output_mod_factor,
+  uint64_t        recursion_depth,
+  uint64_t        recursion_half);
+
+// The inputs are in the range [0, 2q) and the outputs in [0, q).
+// The w-powers are the inverse ones, expanded with expand_w_inv_hexl.
+// n^-1 is computed internally (as in HEXL). Assumption N >= 16.
+static inline void inv_ntt_radix2_hexl(uint64_t       a[],
+                                       const uint64_t N,
+                                       const uint64_t q,
+                                       const uint64_t w[],
+                                       const uint64_t w_con[])
+{
+  InverseTransformFromBitReverseAVX512(a, N, q, w, w_con, 2, 1, 0, 0);
+}
+
 #endif
 
 EXTERNC_END
@@ -0,0 +1,47 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "final_reduce.h"
+
+EXTERNC_BEGIN
+
+// Negacyclic NTTs (mod X^N + 1) of size N = 3M, M = 2^k. A radix-3 layer
+// splits X^N + 1 into the three factors X^M - psi^(M(2j + 1)), j < 3, and
+// twists each of them to X^M + 1, whose NTT is the radix-4 NTT of size M
+// with the root psi^3. Output j * M + l is then a(psi^(2(3 * brv(l) + j) + 1)),
+// where brv reverses k bits and psi is a primitive 2N-th root of unity.
+// The w-powers are those of calc_w_mixed_radix3 (with psi for the forward NTT
+// and psi^-1 for the inverse NTT, w_con with WORD_SIZE).
+// Assumption k >= 2, q < 2^60 and 2N divides q - 1.
+
+// The input is in [0, 4q) and the output in [0, 8q).
+void fwd_ntt_mixed_radix3_lazy(uint64_t       a[],
+                               uint64_t       N,
+                               uint64_t       q,
+                               const uint64_t w[],
+                               const uint64_t w_con[]);
+
+static inline void fwd_ntt_mixed_radix3(uint64_t       a[],
+                                        const uint64_t N,
+                                        const uint64_t q,
+                                        const uint64_t w[],
+                                        const uint64_t w_con[])
+{
+  fwd_ntt_mixed_radix3_lazy(a, N, q, w, w_con);
+
+  // Final reduction
+  final_reduce_q8(a, N, q);
+}
+
+// n_inv is N^-1 mod q (it includes the 1/3 of the radix-3 layer). The input is
+// in [0, 8q) and the output in [0, q).
+void inv_ntt_mixed_radix3(uint64_t       a[],
+                          uint64_t       N,
+                          uint64_t       q,
+                          mul_op_t       n_inv,
+                          const uint64_t w[],
+                          const uint64_t w_con[]);
+
+EXTERNC_END
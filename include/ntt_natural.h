@@ -0,0 +1,32 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "fast_mul_operators.h"
+
+EXTERNC_BEGIN
+
+// In-place bit-reversal permutation of a[0..N-1] (N=2^m).
+// The permutation is cache blocked: it moves 8x8 tiles of whole cache lines,
+// and every tile is transposed in a small local buffer.
+void bit_rev_in_place(uint64_t a[], uint64_t N);
+
+// Natural-order variants of the radix-4 kernels.
+// The bit-reversal permutation is merged with the final reduction pass of the
+// forward NTT (resp. the initial reduction pass of the inverse NTT),
+// so the natural order does not cost an extra pass over the data.
+void fwd_ntt_radix4_natural(uint64_t       a[],
+                            uint64_t       N,
+                            uint64_t       q,
+                            const uint64_t w[],
+                            const uint64_t w_con[]);
+
+void inv_ntt_radix4_natural(uint64_t       a[],
+                            uint64_t       N,
+                            uint64_t       q,
+                            mul_op_t       n_inv,
+                            const uint64_t w[],
+                            const uint64_t w_con[]);
+
+EXTERNC_END
@@ -0,0 +1,78 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "fast_mul_operators.h"
+
+EXTERNC_BEGIN
+
+// Strided (batched) radix-4 NTTs: count transforms of size N, where element i
+// of transform b is a[b * batch_stride + i * stride]. The w-powers are those
+// of fwd_ntt_radix4/inv_ntt_radix4 (expanded with expand_w, w_con with
+// WORD_SIZE), the inputs are in [0, 8q) and the outputs in [0, q).
+// With stride 1 every transform is computed with the contiguous generic-vector
+// kernels. Otherwise the transforms are processed in blocks of
+// NTT_ND_COLUMN_BLOCK, and every butterfly is applied to the whole block,
+// so that with batch_stride 1 (adjacent columns of a row-major matrix) the
+// vector lanes span the columns and no transpose is needed.
+// Assumption N >= 4 and q < 2^60.
+void fwd_ntt_radix4_strided(uint64_t       a[],
+                            uint64_t       N,
+                            uint64_t       stride,
+                            uint64_t       count,
+                            uint64_t       batch_stride,
+                            uint64_t       q,
+                            const uint64_t w[],
+                            const uint64_t w_con[]);
+
+void inv_ntt_radix4_strided(uint64_t       a[],
+                            uint64_t       N,
+                            uint64_t       stride,
+                            uint64_t       count,
+                            uint64_t       batch_stride,
+                            uint64_t       q,
+                            mul_op_t       n_inv,
+                            const uint64_t w[],
+                            const uint64_t w_con[]);
+
+#define NTT_ND_MAX_DIMS 8
+
+// The negacyclic NTT of a d-dimensional row-major array of shape
+// 2^m[0] x ... x 2^m[d-1] (the last axis is contiguous) is the NTT of size
+// 2^m[k] along every axis k. The plan holds the w-powers of every axis for a
+// single q.
+typedef struct ntt_nd_plan_s {
+  uint64_t d;
+  uint64_t q;
+  uint64_t n[NTT_ND_MAX_DIMS];
+
+  // n^-1 mod q of every axis, con is computed with WORD_SIZE.
+  mul_op_t n_inv[NTT_ND_MAX_DIMS];
+
+  // The w-powers of every axis (2n qw each) as in fwd_ntt_radix4_strided.
+  void *    base;
+  uint64_t *w[NTT_ND_MAX_DIMS];
+  uint64_t *w_con[NTT_ND_MAX_DIMS];
+  uint64_t *w_inv[NTT_ND_MAX_DIMS];
+  uint64_t *w_inv_con[NTT_ND_MAX_DIMS];
+} ntt_nd_plan_t;
+
+// Assumption q is a prime below 2^60.
+// Returns ERROR when d is not in [1, NTT_ND_MAX_DIMS], when some m[k] is not
+// in [2, 61], when 2^(m[k] + 1) does not divide q - 1, or on allocation
+// failure, and SUCCESS otherwise.
+int ntt_nd_plan_init(ntt_nd_plan_t *plan,
+                     const uint64_t m[],
+                     uint64_t       d,
+                     uint64_t       q);
+
+void ntt_nd_plan_destroy(ntt_nd_plan_t *plan);
+
+// The inputs are in [0, 8q) and the outputs in [0, q). The last axis is
+// transformed row by row, every other axis with the strided NTTs above.
+void fwd_ntt_nd(const ntt_nd_plan_t *plan, uint64_t a[]);
+
+void inv_ntt_nd(const ntt_nd_plan_t *plan, uint64_t a[]);
+
+EXTERNC_END
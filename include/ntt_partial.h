@@ -0,0 +1,47 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "fast_mul_operators.h"
+
+EXTERNC_BEGIN
+
+// Partial forward NTTs compute only some outputs (slots) of fwd_ntt_radix4:
+// slot k is a(psi^(2 * brv(k) + 1)), where psi is the primitive 2N-th root of
+// unity of the w-powers (expanded with expand_w, w_con with WORD_SIZE).
+// The computation is in place: the input is in [0, 8q), and on return a[k] is
+// slot k in [0, q) for every selected k, the other entries are unspecified.
+// Two methods are available: the radix-4 butterflies restricted to the
+// sub-blocks that hold a selected slot (the pruned tree), and the direct
+// (Horner) evaluation at the roots of at most NTT_PARTIAL_MAX_HORNER_SLOTS
+// slots. NTT_PARTIAL_AUTO picks the cheaper one with the cost model of defs.h,
+// NTT_PARTIAL_HORNER falls back to the tree when there are too many slots.
+// Assumptions N >= 4 and q < 2^61 (8q fits in 64 bits).
+typedef enum ntt_partial_method_e
+{
+  NTT_PARTIAL_AUTO = 0,
+  NTT_PARTIAL_TREE,
+  NTT_PARTIAL_HORNER
+} ntt_partial_method_t;
+
+// The slots [first, first + count), first + count <= N.
+void fwd_ntt_radix4_partial_range(uint64_t             a[],
+                                  uint64_t             N,
+                                  uint64_t             first,
+                                  uint64_t             count,
+                                  uint64_t             q,
+                                  const uint64_t       w[],
+                                  const uint64_t       w_con[],
+                                  ntt_partial_method_t method);
+
+// The slots k whose bit k % 64 of mask[k / 64] is set (ceil(N / 64) words).
+void fwd_ntt_radix4_partial_mask(uint64_t             a[],
+                                 uint64_t             N,
+                                 const uint64_t       mask[],
+                                 uint64_t             q,
+                                 const uint64_t       w[],
+                                 const uint64_t       w_con[],
+                                 ntt_partial_method_t method);
+
+EXTERNC_END
@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include "fast_mul_operators.h"
+#include "final_reduce.h"
 
 EXTERNC_BEGIN
 
@@ -22,11 +22,39 @@ static inline void fwd_ntt_radix4(uint64_t       a[],
   fwd_ntt_radix4_lazy(a, N, q, w, w_con);
 
   // Final reduction
-  for(size_t i = 0; i < N; i++) {
-    a[i] = reduce_8q_to_q(a[i], q);
-  }
+  final_reduce_q8(a, N, q);
 }
 
+// Truncated NTTs of inputs whose coefficients a[len..N) are zero (e.g. zero
+// padded). As long as the nonzero prefix of a block fits in its first quarter
+// the radix-4 butterflies become copies, and when it fits in the first half
+// the butterflies skip Z and T; the remaining layers are those of
+// fwd_ntt_radix4_lazy. The zero coefficients must be in a, but the first
+// layers do not read them. The outputs are those of fwd_ntt_radix4_lazy (up
+// to multiples of q). Assumption len <= N.
+void fwd_ntt_radix4_trunc_lazy(uint64_t       a[],
+                               uint64_t       N,
+                               uint64_t       len,
+                               uint64_t       q,
+                               const uint64_t w[],
+                               const uint64_t w_con[]);
+
+static inline void fwd_ntt_radix4_trunc(uint64_t       a[],
+                                        const uint64_t N,
+                                        const uint64_t len,
+                                        const uint64_t q,
+                                        const uint64_t w[],
+                                        const uint64_t w_con[])
+{
+  fwd_ntt_radix4_trunc_lazy(a, N, len, q, w, w_con);
+
+  // Final reduction
+  final_reduce_q8(a, N, q);
+}
+
+// The input may be in the range [0, 8q) (e.g. the output of
+// fwd_ntt_radix4_lazy), the first iteration reduces it. The n^-1 scaling is
+// folded into the last radix-4 iteration, so N >= 4. Assumption q < 2^61.
 void inv_ntt_radix4(uint64_t       a[],
                     uint64_t       N,
                     uint64_t       q,
@@ -34,4 +62,85 @@ void inv_ntt_radix4(uint64_t       a[],
                     const uint64_t w[],
                     const uint64_t w_con[]);
 
+// Same as inv_ntt_radix4, but when N=2^m where m is even, the input must be
+// in the range [0, 2q).
+void inv_ntt_radix4_reduced_input(uint64_t       a[],
+                                  uint64_t       N,
+                                  uint64_t       q,
+                                  mul_op_t       n_inv,
+                                  const uint64_t w[],
+                                  const uint64_t w_con[]);
+
+// Out-of-place variants: the first iteration reads src and writes dst, so
+// that callers that keep their input save the copy before an in-place call.
+// src is not modified, and dst may be src (the in-place functions above call
+// them this way). The inputs, outputs and w-powers are the same as in the
+// in-place functions. Assumption N >= 4.
+void fwd_ntt_radix4_oop_lazy(uint64_t       dst[],
+                             const uint64_t src[],
+                             uint64_t       N,
+                             uint64_t       q,
+                             const uint64_t w[],
+                             const uint64_t w_con[]);
+
+static inline void fwd_ntt_radix4_oop(uint64_t       dst[],
+                                      const uint64_t src[],
+                                      const uint64_t N,
+                                      const uint64_t q,
+                                      const uint64_t w[],
+                                      const uint64_t w_con[])
+{
+  fwd_ntt_radix4_oop_lazy(dst, src, N, q, w, w_con);
+
+  // Final reduction
+  final_reduce_q8(dst, N, q);
+}
+
+void inv_ntt_radix4_oop(uint64_t       dst[],
+                        const uint64_t src[],
+                        uint64_t       N,
+                        uint64_t       q,
+                        mul_op_t       n_inv,
+                        const uint64_t w[],
+                        const uint64_t w_con[]);
+
+// Depth-first variants of fwd_ntt_radix4_lazy and inv_ntt_radix4.
+// A block is recursively split into its four quarters until it is at most
+// RADIX4_RECURSION_BASE_N qw, so that the remaining layers of a sub-block are
+// computed while it is cache-resident. The inputs, outputs and w-powers are
+// the same as in the iterative variants.
+void fwd_ntt_radix4_rec_lazy(uint64_t       a[],
+                             uint64_t       N,
+                             uint64_t       q,
+                             const uint64_t w[],
+                             const uint64_t w_con[]);
+
+static inline void fwd_ntt_radix4_rec(uint64_t       a[],
+                                      const uint64_t N,
+                                      const uint64_t q,
+                                      const uint64_t w[],
+                                      const uint64_t w_con[])
+{
+  fwd_ntt_radix4_rec_lazy(a, N, q, w, w_con);
+
+  // Final reduction
+  final_reduce_q8(a, N, q);
+}
+
+// Same as fwd_ntt_radix4_rec_lazy with the cut-off base_n (>= 4) instead of
+// RADIX4_RECURSION_BASE_N, for the autotuner.
+void fwd_ntt_radix4_rec_base_lazy(uint64_t       a[],
+                                  uint64_t       N,
+                                  uint64_t       q,
+                                  const uint64_t w[],
+                                  const uint64_t w_con[],
+                                  uint64_t       base_n);
+
+void inv_ntt_radix4_rec(uint64_t       a[],
+                        uint64_t       N,
+                        uint64_t       q,
+                        mul_op_t       n_inv,
+                        const uint64_t w[],
+                        const uint64_t w_con[]);
+
 EXTERNC_END
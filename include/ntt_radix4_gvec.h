@@ -0,0 +1,38 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "final_reduce.h"
+
+EXTERNC_BEGIN
+
+// Radix-4 NTT written with GCC/Clang generic vectors of GVEC_LANES 64-bit
+// lanes. It compiles on every target these compilers support and uses the
+// same w-powers (and w_con with WORD_SIZE) as fwd_ntt_radix4/inv_ntt_radix4.
+void fwd_ntt_radix4_gvec_lazy(uint64_t       a[],
+                              uint64_t       N,
+                              uint64_t       q,
+                              const uint64_t w[],
+                              const uint64_t w_con[]);
+
+static inline void fwd_ntt_radix4_gvec(uint64_t       a[],
+                                       const uint64_t N,
+                                       const uint64_t q,
+                                       const uint64_t w[],
+                                       const uint64_t w_con[])
+{
+  fwd_ntt_radix4_gvec_lazy(a, N, q, w, w_con);
+
+  // Final reduction
+  final_reduce_q8(a, N, q);
+}
+
+void inv_ntt_radix4_gvec(uint64_t       a[],
+                         uint64_t       N,
+                         uint64_t       q,
+                         mul_op_t       n_inv,
+                         const uint64_t w[],
+                         const uint64_t w_con[]);
+
+EXTERNC_END
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "defs.h"
+#include "final_reduce.h"
 
 EXTERNC_BEGIN
 
@@ -25,11 +26,10 @@ static inline void fwd_ntt_radix4_intrinsic(uint64_t       a[],
   fwd_ntt_radix4_intrinsic_lazy(a, N, q, w, w_con);
 
   // Final reduction
-  for(size_t i = 0; i < N; i++) {
-    a[i] = reduce_8q_to_q(a[i], q);
-  }
+  final_reduce_q8(a, N, q);
 }
 
+// The multiplication by n^-1 is folded into the last iteration.
 void inv_ntt_radix4_intrinsic(uint64_t       a[],
                               uint64_t       N,
                               uint64_t       q,
@@ -57,10 +57,16 @@ static inline void fwd_ntt_radix4_intrinsic_dbl(uint64_t       a1[],
   fwd_ntt_radix4_intrinsic_lazy_dbl(a1, a2, N, q, w, w_con);
 
   // Final reduction
-  for(size_t i = 0; i < N; i++) {
-    a1[i] = reduce_8q_to_q(a1[i], q);
-    a2[i] = reduce_8q_to_q(a2[i], q);
-  }
+  final_reduce_q8(a1, N, q);
+  final_reduce_q8(a2, N, q);
 }
 
+void inv_ntt_radix4_intrinsic_dbl(uint64_t       a1[],
+                                  uint64_t       a2[],
+                                  uint64_t       N,
+                                  uint64_t       q,
+                                  mul_op_t       n_inv,
+                                  const uint64_t w[],
+                                  const uint64_t w_con[]);
+
 EXTERNC_END
@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include "fast_mul_operators.h"
+#include "final_reduce.h"
 
 EXTERNC_BEGIN
 
@@ -22,9 +22,7 @@ static inline void fwd_ntt_radix4x4(uint64_t       a[],
   fwd_ntt_radix4x4_lazy(a, N, q, w, w_con);
 
   // Final reduction
-  for(size_t i = 0; i < N; i++) {
-    a[i] = reduce_8q_to_q(a[i], q);
-  }
+  final_reduce_q8(a, N, q);
 }
 
 EXTERNC_END
@@ -0,0 +1,39 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "final_reduce.h"
+
+EXTERNC_BEGIN
+
+// Mixed radix-8/4/2 NTT. For N=2^m the kernels perform m/3 radix-8 passes and
+// at most one extra radix-4 (m%3=2) or radix-2 (m%3=1) pass.
+// They use the radix-4 expanded w-powers tables (see expand_w).
+// Assumption N >= 8.
+void fwd_ntt_radix8_lazy(uint64_t       a[],
+                         uint64_t       N,
+                         uint64_t       q,
+                         const uint64_t w[],
+                         const uint64_t w_con[]);
+
+static inline void fwd_ntt_radix8(uint64_t       a[],
+                                  const uint64_t N,
+                                  const uint64_t q,
+                                  const uint64_t w[],
+                                  const uint64_t w_con[])
+{
+  fwd_ntt_radix8_lazy(a, N, q, w, w_con);
+
+  // Final reduction
+  final_reduce_q8(a, N, q);
+}
+
+void inv_ntt_radix8(uint64_t       a[],
+                    uint64_t       N,
+                    uint64_t       q,
+                    mul_op_t       n_inv,
+                    const uint64_t w[],
+                    const uint64_t w_con[]);
+
+EXTERNC_END
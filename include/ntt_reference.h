@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include "fast_mul_operators.h"
+#include "final_reduce.h"
 
 EXTERNC_BEGIN
 
@@ -25,9 +25,7 @@ static inline void fwd_ntt_ref_harvey(uint64_t       a[],
   fwd_ntt_ref_harvey_lazy(a, N, q, w, w_con);
 
   // Final reduction
-  for(size_t i = 0; i < N; i++) {
-    a[i] = reduce_4q_to_q(a[i], q);
-  }
+  final_reduce_q4(a, N, q);
 }
 
 void inv_ntt_ref_harvey(uint64_t       a[],
@@ -58,10 +56,8 @@ static inline void fwd_ntt_ref_harvey_dbl(uint64_t       a1[],
   fwd_ntt_ref_harvey_lazy_dbl(a1, a2, N, q, w, w_con);
 
   // Final reduction
-  for(size_t i = 0; i < N; i++) {
-    a1[i] = reduce_4q_to_q(a1[i], q);
-    a2[i] = reduce_4q_to_q(a2[i], q);
-  }
+  final_reduce_q4(a1, N, q);
+  final_reduce_q4(a2, N, q);
 }
 
 EXTERNC_END
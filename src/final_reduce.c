@@ -0,0 +1,24 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "final_reduce.h"
+#include "gvec.h"
+
+size_t final_reduce_gvec(uint64_t       a[],
+                         const size_t   N,
+                         const uint64_t q,
+                         const uint64_t mod_factor)
+{
+  size_t i = 0;
+
+  LOOP_UNROLL_4
+  for(; (i + GVEC_LANES) <= N; i += GVEC_LANES) {
+    gvec_t T = gvec_load(&a[i]);
+    for(uint64_t f = mod_factor >> 1; f >= 1; f >>= 1) {
+      T = gvec_reduce_if_greater(T, gvec_set1(f * q));
+    }
+    gvec_store(&a[i], T);
+  }
+
+  return i;
+}
@@ -0,0 +1,24 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt_automorphism.h"
+
+void ntt_automorphism(uint64_t       out[],
+                      const uint64_t in[],
+                      const uint32_t map[],
+                      const uint64_t N,
+                      const uint64_t num_limbs)
+{
+  const size_t block = (N < NTT_AUTOMORPHISM_BLOCK) ? N : NTT_AUTOMORPHISM_BLOCK;
+
+  for(size_t k0 = 0; k0 < N; k0 += block) {
+    for(size_t l = 0; l < num_limbs; l++) {
+      const uint64_t *src = &in[l * N];
+      uint64_t       *dst = &out[l * N];
+
+      for(size_t k = k0; k < k0 + block; k++) {
+        dst[k] = src[map[k]];
+      }
+    }
+  }
+}
@@ -0,0 +1,565 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ntt_autotune.h"
+#include "ntt_radix4.h"
+#include "ntt_radix4_gvec.h"
+#include "ntt_radix4x4.h"
+#include "ntt_radix8.h"
+#include "pre_compute.h"
+
+#ifdef AVX512_SUPPORT
+#  include "ntt_avx512.h"
+#endif
+
+#ifdef AVX512_IFMA_SUPPORT
+#  include "ntt_avx512_ifma.h"
+#  include "ntt_hexl.h"
+#endif
+
+// Every candidate is timed AUTOTUNE_REPEAT times over about
+// AUTOTUNE_WORK_QW coefficients and the best repetition is kept.
+#define AUTOTUNE_REPEAT  5
+#define AUTOTUNE_WORK_QW (1UL << 18)
+
+// The AVX512 kernels are validated for N >= 2^8.
+#define AUTOTUNE_AVX512_MIN_M 8
+
+// The recursion cut-offs tried for the recursive kernels (in qw), from 4KiB
+// (half of L1) to 128KiB (L2).
+#define AUTOTUNE_REC_BASE_MIN_N (1UL << 9)
+#define AUTOTUNE_REC_BASE_MAX_N (1UL << 14)
+
+#define CPU_MODEL_MAX_LEN   128
+#define KERNEL_NAME_MAX_LEN 64
+
+typedef void (*fwd_func_t)(uint64_t       a[],
+                           const uint64_t N,
+                           const uint64_t q,
+                           const uint64_t w[],
+                           const uint64_t w_con[]);
+
+typedef void (*fwd_base_func_t)(uint64_t       a[],
+                                const uint64_t N,
+                                const uint64_t q,
+                                const uint64_t w[],
+                                const uint64_t w_con[],
+                                const uint64_t base_n);
+
+typedef void (*expand_func_t)(uint64_t       w_expanded[],
+                              const uint64_t w[],
+                              const uint64_t N,
+                              const uint64_t q);
+
+typedef struct ntt_kernel_desc_s {
+  const char *    name;
+  fwd_func_t      fwd;
+  fwd_func_t      fwd_lazy;
+  // The lazy kernel with an explicit recursion cut-off (NULL when the kernel
+  // has none). When set, it is called instead of fwd and fwd_lazy.
+  fwd_base_func_t fwd_base_lazy;
+  expand_func_t   expand;
+  uint64_t        word_size;
+  // The bits q must not have (0 for the scalar kernels).
+  uint64_t        q_mask;
+  // The contract of fwd_lazy: its input must be in [0, in_mod_factor*q) and
+  // its output is in [0, out_mod_factor*q).
+  uint64_t        in_mod_factor;
+  uint64_t        out_mod_factor;
+} ntt_kernel_desc_t;
+
+// All layouts fit in 5N qw.
+#define W_POWERS_MAX_FACTOR 5
+
+static void expand_r4(uint64_t       w_expanded[],
+                      const uint64_t w[],
+                      const uint64_t N,
+                      const uint64_t q)
+{
+  expand_w(w_expanded, w, N, q);
+}
+
+#ifdef AVX512_IFMA_SUPPORT
+static void expand_hexl(uint64_t       w_expanded[],
+                        const uint64_t w[],
+                        const uint64_t N,
+                        UNUSED const uint64_t q)
+{
+  expand_w_hexl(w_expanded, w, N);
+}
+
+static void expand_r4_avx512_ifma(uint64_t       w_expanded[],
+                                  const uint64_t w[],
+                                  const uint64_t N,
+                                  const uint64_t q)
+{
+  expand_w_r4_avx512_ifma(w_expanded, w, N, q, 0);
+}
+
+static void expand_r2_16_avx512_ifma(uint64_t       w_expanded[],
+                                     const uint64_t w[],
+                                     const uint64_t N,
+                                     UNUSED const uint64_t q)
+{
+  expand_w_r2_16_avx512_ifma(w_expanded, w, N);
+}
+#endif
+
+static const ntt_kernel_desc_t kernels[NTT_KERNEL_NUM] = {
+  [NTT_KERNEL_RADIX4] = {"rad4", fwd_ntt_radix4, fwd_ntt_radix4_lazy, NULL,
+                         expand_r4, WORD_SIZE, 0, 1, 8},
+  [NTT_KERNEL_RADIX4X4] = {"rad4x4", fwd_ntt_radix4x4, fwd_ntt_radix4x4_lazy,
+                           NULL, expand_r4, WORD_SIZE, 0, 1, 8},
+  [NTT_KERNEL_RADIX8] = {"rad8", fwd_ntt_radix8, fwd_ntt_radix8_lazy, NULL,
+                         expand_r4, WORD_SIZE, 0, 1, 8},
+  [NTT_KERNEL_RADIX4_REC] = {"rad4-rec", fwd_ntt_radix4_rec,
+                             fwd_ntt_radix4_rec_lazy,
+                             fwd_ntt_radix4_rec_base_lazy, expand_r4,
+                             WORD_SIZE, 0, 1, 8},
+  [NTT_KERNEL_RADIX4_GVEC] = {"rad4-gvec", fwd_ntt_radix4_gvec,
+                              fwd_ntt_radix4_gvec_lazy, NULL, expand_r4,
+                              WORD_SIZE, 0, 1, 8},
+#ifdef AVX512_SUPPORT
+  [NTT_KERNEL_RADIX4_AVX512] = {"r4-avx512", fwd_ntt_radix4_avx512,
+                                fwd_ntt_radix4_avx512_lazy, NULL,
+                                expand_w_r4_leaf_avx512_ifma, WORD_SIZE,
+                                AVX512_MAX_MODULUS_MASK, 1, 4},
+#endif
+#ifdef AVX512_IFMA_SUPPORT
+  [NTT_KERNEL_RADIX2_HEXL] =
+    {"rad2-hexl", fwd_ntt_radix2_hexl, fwd_ntt_radix2_hexl_lazy, NULL,
+     expand_hexl, AVX512_IFMA_WORD_SIZE, AVX512_IFMA_MAX_MODULUS_MASK, 2, 4},
+  [NTT_KERNEL_RADIX4_AVX512_IFMA] =
+    {"rad4-ifma", fwd_ntt_radix4_avx512_ifma, fwd_ntt_radix4_avx512_ifma_lazy,
+     NULL, expand_r4_avx512_ifma, AVX512_IFMA_WORD_SIZE,
+     AVX512_IFMA_MAX_MODULUS_MASK, 1, 8},
+  [NTT_KERNEL_RADIX4_AVX512_IFMA_LEAF] =
+    {"rad4-leaf", fwd_ntt_radix4_avx512_ifma_leaf,
+     fwd_ntt_radix4_avx512_ifma_leaf_lazy, NULL, expand_w_r4_leaf_avx512_ifma,
+     AVX512_IFMA_WORD_SIZE, AVX512_IFMA_MAX_MODULUS_MASK, 1, 8},
+  [NTT_KERNEL_RADIX4_AVX512_IFMA_REC] =
+    {"rec-ifma", fwd_ntt_radix4_avx512_ifma_rec,
+     fwd_ntt_radix4_avx512_ifma_rec_lazy,
+     fwd_ntt_radix4_avx512_ifma_rec_base_lazy, expand_w_r4_leaf_avx512_ifma,
+     AVX512_IFMA_WORD_SIZE, AVX512_IFMA_MAX_MODULUS_MASK, 1, 8},
+  [NTT_KERNEL_R4R2_AVX512_IFMA] =
+    {"r4r2-ifma", fwd_ntt_r4r2_avx512_ifma, fwd_ntt_r4r2_avx512_ifma_lazy, NULL,
+     expand_w_r4r2_avx512_ifma, AVX512_IFMA_WORD_SIZE,
+     AVX512_IFMA_MAX_MODULUS_MASK, 1, 4},
+  [NTT_KERNEL_R2_16_AVX512_IFMA] =
+    {"r216-ifma", fwd_ntt_r2_16_avx512_ifma, fwd_ntt_r2_16_avx512_ifma_lazy,
+     NULL, expand_r2_16_avx512_ifma, AVX512_IFMA_WORD_SIZE,
+     AVX512_IFMA_MAX_MODULUS_MASK, 1, 4},
+  [NTT_KERNEL_RADIX8_AVX512_IFMA] =
+    {"r8-ifma", fwd_ntt_radix8_avx512_ifma, fwd_ntt_radix8_avx512_ifma_lazy,
+     NULL, expand_w_r8_avx512_ifma, AVX512_IFMA_WORD_SIZE,
+     AVX512_IFMA_MAX_MODULUS_MASK, 1, 8},
+#endif
+};
+
+const char *ntt_kernel_name(const ntt_kernel_t kernel)
+{
+  return (kernel < NTT_KERNEL_NUM) ? kernels[kernel].name : "unknown";
+}
+
+static inline uint64_t bit_size(const uint64_t q)
+{
+  return (q == 0) ? 0 : (uint64_t)(64 - __builtin_clzll(q));
+}
+
+static inline int is_applicable(const ntt_kernel_t kernel,
+                                const uint64_t     m,
+                                const uint64_t     q)
+{
+  if(0 == kernels[kernel].q_mask) {
+    return 1;
+  }
+  return (m >= AUTOTUNE_AVX512_MIN_M) && (0 == (q & kernels[kernel].q_mask));
+}
+
+static inline ntt_kernel_t estimate_kernel(UNUSED const uint64_t m,
+                                           UNUSED const uint64_t q)
+{
+#ifdef AVX512_IFMA_SUPPORT
+  if(is_applicable(NTT_KERNEL_RADIX4_AVX512_IFMA_REC, m, q)) {
+    // Beyond L1 the depth-first driver saves passes over memory.
+    return ((1UL << m) > RADIX4_RECURSION_BASE_N)
+             ? NTT_KERNEL_RADIX4_AVX512_IFMA_REC
+             : NTT_KERNEL_RADIX4_AVX512_IFMA_LEAF;
+  }
+#endif
+#ifdef AVX512_SUPPORT
+  if(is_applicable(NTT_KERNEL_RADIX4_AVX512, m, q)) {
+    return NTT_KERNEL_RADIX4_AVX512;
+  }
+#endif
+  return NTT_KERNEL_RADIX4;
+}
+
+static inline void
+set_plan_kernel(ntt_plan_t *plan, const uint64_t w_powers[], ntt_kernel_t kernel)
+{
+  const ntt_kernel_desc_t *k = &kernels[kernel];
+
+  plan->kernel = kernel;
+  memset(plan->w_powers, 0, W_POWERS_MAX_FACTOR * plan->n * sizeof(uint64_t));
+  k->expand(plan->w_powers, w_powers, plan->n, plan->q);
+  calc_w_con(plan->w_powers_con, plan->w_powers, W_POWERS_MAX_FACTOR * plan->n,
+             plan->q, k->word_size);
+}
+
+static inline uint64_t now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000UL + (uint64_t)ts.tv_nsec;
+}
+
+static inline void random_input(uint64_t a[], const uint64_t N, const uint64_t q)
+{
+  // xorshift64
+  uint64_t x = 0x9e3779b97f4a7c15ULL;
+  for(size_t i = 0; i < N; i++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    a[i] = x % q;
+  }
+}
+
+// Returns the best time per transform in ns, or UINT64_MAX when the kernel
+// output does not match the expected one.
+static inline uint64_t measure_kernel(const ntt_plan_t *plan,
+                                      uint64_t          a[],
+                                      const uint64_t    a_in[],
+                                      const uint64_t    a_expected[])
+{
+  const uint64_t N     = plan->n;
+  const uint64_t iters = (AUTOTUNE_WORK_QW / N) + 1;
+  uint64_t       best  = UINT64_MAX;
+
+  memcpy(a, a_in, N * sizeof(uint64_t));
+  ntt_plan_fwd(plan, a);
+  if(0 != memcmp(a, a_expected, N * sizeof(uint64_t))) {
+    return UINT64_MAX;
+  }
+
+  // The output is in [0, q) so it is a valid input for the next iteration.
+  for(size_t r = 0; r < AUTOTUNE_REPEAT; r++) {
+    const uint64_t start = now_ns();
+    for(size_t i = 0; i < iters; i++) {
+      ntt_plan_fwd(plan, a);
+    }
+    const uint64_t elapsed = (now_ns() - start) / iters;
+    best                   = (elapsed < best) ? elapsed : best;
+  }
+
+  return best;
+}
+
+static inline int measure_plan(ntt_plan_t *   plan,
+                               const uint64_t w_powers[],
+                               ntt_kernel_t * best,
+                               uint64_t *     best_base_n)
+{
+  const uint64_t N          = plan->n;
+  uint64_t       best_ns    = UINT64_MAX;
+  void *         a_base     = NULL;
+  uint64_t *     a          = aligned_alloc_qw(&a_base, 3 * N);
+  uint64_t *     a_in       = NULL;
+  uint64_t *     a_expected = NULL;
+
+  if(NULL == a) {
+    return ERROR;
+  }
+  a_in       = &a[N];
+  a_expected = &a[2 * N];
+
+  random_input(a_in, N, plan->q);
+
+  // The radix-4 kernel is the reference for the other candidates.
+  set_plan_kernel(plan, w_powers, NTT_KERNEL_RADIX4);
+  memcpy(a_expected, a_in, N * sizeof(uint64_t));
+  fwd_ntt_radix4(a_expected, N, plan->q, plan->w_powers, plan->w_powers_con);
+
+  *best        = NTT_KERNEL_RADIX4;
+  *best_base_n = RADIX4_RECURSION_BASE_N;
+  for(size_t k = 0; k < NTT_KERNEL_NUM; k++) {
+    const int tune_base_n = (NULL != kernels[k].fwd_base_lazy);
+
+    if(!is_applicable((ntt_kernel_t)k, plan->m, plan->q)) {
+      continue;
+    }
+
+    // The cut-offs of at least N are all the breadth-first transform, only
+    // the smallest one of them is timed.
+    set_plan_kernel(plan, w_powers, (ntt_kernel_t)k);
+    plan->rec_base_n = tune_base_n ? AUTOTUNE_REC_BASE_MIN_N
+                                   : RADIX4_RECURSION_BASE_N;
+    do {
+      const uint64_t ns = measure_kernel(plan, a, a_in, a_expected);
+      if(ns < best_ns) {
+        best_ns      = ns;
+        *best        = (ntt_kernel_t)k;
+        *best_base_n = plan->rec_base_n;
+      }
+      plan->rec_base_n <<= 1;
+    } while(tune_base_n && (plan->rec_base_n <= AUTOTUNE_REC_BASE_MAX_N) &&
+            (plan->rec_base_n < N));
+  }
+
+  free(a_base);
+  return SUCCESS;
+}
+
+// Reads the "model name" of /proc/cpuinfo, spaces are replaced with '_'.
+static inline void cpu_model(char model[CPU_MODEL_MAX_LEN])
+{
+  char  line[256];
+  FILE *f = fopen("/proc/cpuinfo", "r");
+
+  strcpy(model, "unknown");
+  if(NULL == f) {
+    return;
+  }
+
+  while(NULL != fgets(line, sizeof(line), f)) {
+    const char *val = strchr(line, ':');
+    if((0 != strncmp(line, "model name", 10)) || (NULL == val)) {
+      continue;
+    }
+
+    // Skip ": "
+    val += (val[1] == ' ') ? 2 : 1;
+    size_t i = 0;
+    for(; (val[i] != '\0') && (val[i] != '\n') && (i < CPU_MODEL_MAX_LEN - 1);
+        i++) {
+      model[i] = ((val[i] == ' ') || (val[i] == '\t')) ? '_' : val[i];
+    }
+    model[i] = '\0';
+    break;
+  }
+
+  fclose(f);
+}
+
+// The last matching entry wins, so re-tuning only requires appending.
+static inline int lookup_wisdom(const char *   wisdom_path,
+                                const char *   model,
+                                const uint64_t m,
+                                const uint64_t q_bits,
+                                ntt_kernel_t * kernel,
+                                uint64_t *     rec_base_n)
+{
+  char     line[256];
+  char     entry_model[CPU_MODEL_MAX_LEN];
+  char     entry_name[KERNEL_NAME_MAX_LEN];
+  uint64_t entry_m;
+  uint64_t entry_q_bits;
+  uint64_t entry_base_n;
+  int      fields;
+  int      found = 0;
+  FILE *   f     = fopen(wisdom_path, "r");
+
+  if(NULL == f) {
+    return 0;
+  }
+
+  while(NULL != fgets(line, sizeof(line), f)) {
+    fields = (line[0] == '#')
+               ? 0
+               : sscanf(line, "%127s %lu %lu %63s %lu", entry_model, &entry_m,
+                        &entry_q_bits, entry_name, &entry_base_n);
+    if((fields < 4) || (0 != strcmp(entry_model, model)) || (entry_m != m) ||
+       (entry_q_bits != q_bits)) {
+      continue;
+    }
+
+    // Ignore kernels that are not available in this build.
+    for(size_t k = 0; k < NTT_KERNEL_NUM; k++) {
+      if(0 == strcmp(entry_name, kernels[k].name)) {
+        *kernel     = (ntt_kernel_t)k;
+        *rec_base_n = ((fields == 5) && (entry_base_n >= 4))
+                        ? entry_base_n
+                        : RADIX4_RECURSION_BASE_N;
+        found       = 1;
+      }
+    }
+  }
+
+  fclose(f);
+  return found;
+}
+
+static inline int append_wisdom(const char *       wisdom_path,
+                                const char *       model,
+                                const uint64_t     m,
+                                const uint64_t     q_bits,
+                                const ntt_kernel_t kernel,
+                                const uint64_t     rec_base_n)
+{
+  FILE *f = fopen(wisdom_path, "a");
+
+  if(NULL == f) {
+    return ERROR;
+  }
+  fprintf(f, "%s %lu %lu %s", model, m, q_bits, kernels[kernel].name);
+  if(NULL != kernels[kernel].fwd_base_lazy) {
+    fprintf(f, " %lu", rec_base_n);
+  }
+  fprintf(f, "\n");
+  fclose(f);
+
+  return SUCCESS;
+}
+
+int ntt_plan_init(ntt_plan_t *           plan,
+                  const uint64_t         m,
+                  const uint64_t         q,
+                  const uint64_t         w,
+                  const ntt_plan_flags_t flags,
+                  const char *           wisdom_path)
+{
+  const uint64_t N        = 1UL << m;
+  const size_t   w_qw_num = W_POWERS_MAX_FACTOR * N;
+  char           model[CPU_MODEL_MAX_LEN];
+  ntt_kernel_t   kernel     = estimate_kernel(m, q);
+  uint64_t       rec_base_n = RADIX4_RECURSION_BASE_N;
+  uint64_t *     w_powers;
+
+  memset(plan, 0, sizeof(*plan));
+  plan->m = m;
+  plan->n = N;
+  plan->q = q;
+  plan->w = w;
+
+  // The forward w-powers of every layout, and 2N qw each for the inverse
+  // w-powers and their constants.
+  if(NULL == (plan->w_powers =
+                aligned_alloc_qw(&plan->base, (2 * w_qw_num) + (4 * N)))) {
+    return ERROR;
+  }
+  plan->w_powers_con     = &plan->w_powers[w_qw_num];
+  plan->w_inv_powers     = &plan->w_powers[2 * w_qw_num];
+  plan->w_inv_powers_con = &plan->w_inv_powers[2 * N];
+
+  if(NULL == (w_powers = malloc(N * sizeof(uint64_t)))) {
+    ntt_plan_destroy(plan);
+    return ERROR;
+  }
+
+  calc_w_inv(w_powers, inv_mod(w, q), N, q, m);
+  expand_w(plan->w_inv_powers, w_powers, N, q);
+  calc_w_con(plan->w_inv_powers_con, plan->w_inv_powers, 2 * N, q, WORD_SIZE);
+  plan->n_inv.op  = inv_mod(N, q);
+  plan->n_inv.con = calc_ninv_con(plan->n_inv.op, q, WORD_SIZE);
+
+  calc_w(w_powers, w, N, q, m);
+
+  cpu_model(model);
+  if((NULL != wisdom_path) &&
+     lookup_wisdom(wisdom_path, model, m, bit_size(q), &kernel, &rec_base_n) &&
+     is_applicable(kernel, m, q)) {
+    set_plan_kernel(plan, w_powers, kernel);
+    plan->rec_base_n = rec_base_n;
+    free(w_powers);
+    return SUCCESS;
+  }
+
+  if(NTT_PLAN_MEASURE == flags) {
+    if((SUCCESS != measure_plan(plan, w_powers, &kernel, &rec_base_n)) ||
+       ((NULL != wisdom_path) &&
+        (SUCCESS != append_wisdom(wisdom_path, model, m, bit_size(q), kernel,
+                                  rec_base_n)))) {
+      free(w_powers);
+      ntt_plan_destroy(plan);
+      return ERROR;
+    }
+  }
+
+  set_plan_kernel(plan, w_powers, kernel);
+  plan->rec_base_n = rec_base_n;
+  free(w_powers);
+  return SUCCESS;
+}
+
+void ntt_plan_destroy(ntt_plan_t *plan)
+{
+  free(plan->base);
+  plan->base             = NULL;
+  plan->w_powers         = NULL;
+  plan->w_powers_con     = NULL;
+  plan->w_inv_powers     = NULL;
+  plan->w_inv_powers_con = NULL;
+}
+
+void ntt_plan_fwd(const ntt_plan_t *plan, uint64_t a[])
+{
+  ntt_plan_fwd_mod_factor(plan, a, 1, 1);
+}
+
+int ntt_plan_fwd_mod_factor(const ntt_plan_t *plan,
+                            uint64_t          a[],
+                            const uint64_t    input_mod_factor,
+                            const uint64_t    output_mod_factor)
+{
+  const ntt_kernel_desc_t *k = &kernels[plan->kernel];
+
+  if(!IS_MOD_FACTOR(output_mod_factor)) {
+    return ERROR;
+  }
+  GUARD(reduce_mod_factor(a, plan->n, plan->q, input_mod_factor,
+                          k->in_mod_factor));
+
+  // The full kernel has its own (possibly vectorized) final reduction.
+  if((output_mod_factor == 1) && (NULL == k->fwd_base_lazy)) {
+    k->fwd(a, plan->n, plan->q, plan->w_powers, plan->w_powers_con);
+    return SUCCESS;
+  }
+
+  if(NULL != k->fwd_base_lazy) {
+    k->fwd_base_lazy(a, plan->n, plan->q, plan->w_powers, plan->w_powers_con,
+                     plan->rec_base_n);
+  } else {
+    k->fwd_lazy(a, plan->n, plan->q, plan->w_powers, plan->w_powers_con);
+  }
+  CHECK_BOUNDS(a, plan->n, plan->q, k->out_mod_factor);
+
+  if(output_mod_factor == 1) {
+    final_reduce(a, plan->n, plan->q, k->out_mod_factor);
+    return SUCCESS;
+  }
+  return reduce_mod_factor(a, plan->n, plan->q, k->out_mod_factor,
+                           output_mod_factor);
+}
+
+uint64_t ntt_plan_out_mod_factor(const ntt_plan_t *plan)
+{
+  return kernels[plan->kernel].out_mod_factor;
+}
+
+void ntt_plan_inv(const ntt_plan_t *plan, uint64_t a[])
+{
+  ntt_plan_inv_mod_factor(plan, a, 1, 1);
+}
+
+int ntt_plan_inv_mod_factor(const ntt_plan_t *plan,
+                            uint64_t          a[],
+                            const uint64_t    input_mod_factor,
+                            const uint64_t    output_mod_factor)
+{
+  if(!IS_MOD_FACTOR(input_mod_factor) || !IS_MOD_FACTOR(output_mod_factor)) {
+    return ERROR;
+  }
+  CHECK_BOUNDS(a, plan->n, plan->q, input_mod_factor);
+
+  // inv_ntt_radix4 accepts [0, 8q) and its output is in [0, q).
+  inv_ntt_radix4(a, plan->n, plan->q, plan->n_inv, plan->w_inv_powers,
+                 plan->w_inv_powers_con);
+  return SUCCESS;
+}
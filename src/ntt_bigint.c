@@ -0,0 +1,465 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ntt_bigint.h"
+#include "gvec.h"
+#include "ntt_radix4.h"
+#include "ntt_radix4x4.h"
+#include "pre_compute.h"
+
+// q^-1 mod 2^64 with Newton iterations, q * q = 1 mod 8 for an odd q and
+// every iteration doubles the number of correct bits.
+static inline uint64_t calc_q_inv(const uint64_t q)
+{
+  uint64_t x = q;
+  for(size_t i = 0; i < 5; i++) {
+    x *= 2 - (q * x);
+  }
+  return x;
+}
+
+static inline mul_op_t calc_mul_op(const uint64_t op, const uint64_t q)
+{
+  return (mul_op_t){.op = op, .con = calc_ninv_con(op, q, WORD_SIZE)};
+}
+
+int bigint_mul_plan_init(bigint_mul_plan_t *plan, const uint64_t m)
+{
+  const uint64_t N = 1UL << m;
+  uint64_t *     w_powers;
+  uint64_t *     ptr;
+
+  memset(plan, 0, sizeof(*plan));
+  if(m < BIGINT_MIN_M) {
+    return ERROR;
+  }
+  plan->m = m;
+  plan->n = N;
+
+  if(BIGINT_NUM_OF_PRIMES !=
+     find_ntt_primes(plan->q, BIGINT_NUM_OF_PRIMES, 2 * N, BIGINT_PRIME_BITS)) {
+    return ERROR;
+  }
+
+  if(NULL == (ptr = aligned_alloc_qw(&plan->base,
+                                     BIGINT_NUM_OF_PRIMES * 8 * N))) {
+    return ERROR;
+  }
+  if(NULL == (w_powers = malloc(N * sizeof(uint64_t)))) {
+    bigint_mul_plan_destroy(plan);
+    return ERROR;
+  }
+
+  for(size_t j = 0; j < BIGINT_NUM_OF_PRIMES; j++) {
+    const uint64_t q     = plan->q[j];
+    const uint64_t w     = find_primitive_root(2 * N, q);
+    const uint64_t r_mod = (uint64_t)((((__uint128_t)1) << WORD_SIZE) % q);
+
+    plan->w[j]         = &ptr[(8 * j) * N];
+    plan->w_con[j]     = &ptr[(8 * j + 2) * N];
+    plan->w_inv[j]     = &ptr[(8 * j + 4) * N];
+    plan->w_inv_con[j] = &ptr[(8 * j + 6) * N];
+
+    calc_w(w_powers, w, N, q, m);
+    expand_w(plan->w[j], w_powers, N, q);
+    calc_w_con(plan->w_con[j], plan->w[j], 2 * N, q, WORD_SIZE);
+
+    calc_w_inv(w_powers, inv_mod(w, q), N, q, m);
+    expand_w(plan->w_inv[j], w_powers, N, q);
+    calc_w_con(plan->w_inv_con[j], plan->w_inv[j], 2 * N, q, WORD_SIZE);
+
+    plan->q_inv[j] = calc_q_inv(q);
+    plan->n_inv[j] = calc_mul_op(mul_mod(inv_mod(N, q), r_mod, q), q);
+  }
+  free(w_powers);
+
+  plan->crt[0] = calc_mul_op(inv_mod(plan->q[0], plan->q[1]), plan->q[1]);
+  plan->crt[1] = calc_mul_op(inv_mod(plan->q[0], plan->q[2]), plan->q[2]);
+  plan->crt[2] = calc_mul_op(inv_mod(plan->q[1], plan->q[2]), plan->q[2]);
+
+  return SUCCESS;
+}
+
+void bigint_mul_plan_destroy(bigint_mul_plan_t *plan)
+{
+  free(plan->base);
+  plan->base = NULL;
+  for(size_t j = 0; j < BIGINT_NUM_OF_PRIMES; j++) {
+    plan->w[j]         = NULL;
+    plan->w_con[j]     = NULL;
+    plan->w_inv[j]     = NULL;
+    plan->w_inv_con[j] = NULL;
+  }
+}
+
+// a * b * 2^-64 mod q for a, b < q. The low words of a * b and m * q are
+// equal, so the result is the difference of the high words, in (-q, q).
+static inline uint64_t mont_mul(const uint64_t a,
+                                const uint64_t b,
+                                const uint64_t q,
+                                const uint64_t q_inv)
+{
+  const __uint128_t T  = (__uint128_t)a * b;
+  const uint64_t    m  = (uint64_t)T * q_inv;
+  const uint64_t    hi = HIGH_WORD(T);
+  const uint64_t    mq = HIGH_WORD((__uint128_t)m * q);
+
+  return (hi < mq) ? (hi - mq + q) : (hi - mq);
+}
+
+// Writes the limbs mod q to r[0..len) and zeros to r[len..N).
+static inline void reduce_limbs(uint64_t       r[],
+                                const uint64_t a[],
+                                const uint64_t len,
+                                const uint64_t N,
+                                const uint64_t q)
+{
+  // Shoup's multiplication by 1 reduces any 64-bit value to [0, 2q).
+  const mul_op_t one = calc_mul_op(1, q);
+
+  for(size_t i = 0; i < len; i++) {
+    r[i] = fast_mul_mod_q(one, a[i], q);
+  }
+  memset(&r[len], 0, (N - len) * sizeof(uint64_t));
+}
+
+// Garner's algorithm: x = r0 + q0 * y1 + q0 * q1 * y2, where
+// y1 = (r1 - r0) / q0 mod q1 and y2 = ((r2 - r0) / q0 - y1) / q1 mod q2.
+// y1 and y2 replace r1 and r2. Since q0 < q1 < q2, adding q1 (q2) keeps the
+// differences positive.
+static inline void crt_gvec(const bigint_mul_plan_t *plan,
+                            const uint64_t           r0[],
+                            uint64_t                 r1[],
+                            uint64_t                 r2[],
+                            const uint64_t           N)
+{
+  const gvec_t        q1  = gvec_set1(plan->q[1]);
+  const gvec_t        q2  = gvec_set1(plan->q[2]);
+  const mul_op_gvec_t c01 = {gvec_set1(plan->crt[0].op),
+                             gvec_set1(plan->crt[0].con)};
+  const mul_op_gvec_t c02 = {gvec_set1(plan->crt[1].op),
+                             gvec_set1(plan->crt[1].con)};
+  const mul_op_gvec_t c12 = {gvec_set1(plan->crt[2].op),
+                             gvec_set1(plan->crt[2].con)};
+
+  for(size_t i = 0; i < N; i += GVEC_LANES) {
+    const gvec_t x0 = gvec_load(&r0[i]);
+    const gvec_t y1 = fast_mul_mod_q_gvec(c01, gvec_load(&r1[i]) + q1 - x0, q1);
+    const gvec_t u  = fast_mul_mod_q_gvec(c02, gvec_load(&r2[i]) + q2 - x0, q2);
+
+    gvec_store(&r1[i], y1);
+    gvec_store(&r2[i], fast_mul_mod_q_gvec(c12, u + q2 - y1, q2));
+  }
+}
+
+// c[0..L] = sum(x_k * 2^(64k)) for k < L, where x_k < 2^177 is the CRT value
+// of the k'th coefficient. The carry into the next limb is below 2^114.
+static inline void propagate_carries(const bigint_mul_plan_t *plan,
+                                     uint64_t                 c[],
+                                     const uint64_t           r0[],
+                                     const uint64_t           y1[],
+                                     const uint64_t           y2[],
+                                     const uint64_t           L)
+{
+  const __uint128_t q01    = (__uint128_t)plan->q[0] * plan->q[1];
+  const uint64_t    q01_lo = LOW_WORD(q01);
+  const uint64_t    q01_hi = HIGH_WORD(q01);
+  __uint128_t       carry  = 0;
+
+  for(size_t k = 0; k < L; k++) {
+    const __uint128_t x = ((__uint128_t)plan->q[0] * y1[k]) + r0[k];
+    const __uint128_t lo =
+      ((__uint128_t)q01_lo * y2[k]) + LOW_WORD(x) + LOW_WORD(carry);
+
+    c[k]  = LOW_WORD(lo);
+    carry = ((__uint128_t)q01_hi * y2[k]) + HIGH_WORD(x) + HIGH_WORD(carry) +
+            HIGH_WORD(lo);
+  }
+  c[L] = LOW_WORD(carry);
+}
+
+int bigint_mul_ntt(const bigint_mul_plan_t *plan,
+                   uint64_t                 c[],
+                   const uint64_t           a[],
+                   const uint64_t           a_len,
+                   const uint64_t           b[],
+                   const uint64_t           b_len)
+{
+  const uint64_t N      = plan->n;
+  const int      square = (a == b) && (a_len == b_len);
+  void *         base;
+  uint64_t *     r[BIGINT_NUM_OF_PRIMES];
+  uint64_t *     tmp;
+
+  r[0] = aligned_alloc_qw(&base, (BIGINT_NUM_OF_PRIMES + 1) * N);
+  if(NULL == r[0]) {
+    return ERROR;
+  }
+  for(size_t j = 1; j < BIGINT_NUM_OF_PRIMES; j++) {
+    r[j] = &r[0][j * N];
+  }
+  tmp = &r[0][BIGINT_NUM_OF_PRIMES * N];
+
+  // The convolution modulo every prime, the forward NTTs output [0, q) values
+  // for the Montgomery products.
+  for(size_t j = 0; j < BIGINT_NUM_OF_PRIMES; j++) {
+    const uint64_t q = plan->q[j];
+
+    reduce_limbs(r[j], a, a_len, N, q);
+    fwd_ntt_radix4x4(r[j], N, q, plan->w[j], plan->w_con[j]);
+
+    if(square) {
+      memcpy(tmp, r[j], N * sizeof(uint64_t));
+    } else {
+      reduce_limbs(tmp, b, b_len, N, q);
+      fwd_ntt_radix4x4(tmp, N, q, plan->w[j], plan->w_con[j]);
+    }
+
+    for(size_t i = 0; i < N; i++) {
+      r[j][i] = mont_mul(r[j][i], tmp[i], q, plan->q_inv[j]);
+    }
+
+    inv_ntt_radix4(r[j], N, q, plan->n_inv[j], plan->w_inv[j],
+                   plan->w_inv_con[j]);
+  }
+
+  crt_gvec(plan, r[0], r[1], r[2], N);
+  propagate_carries(plan, c, r[0], r[1], r[2], a_len + b_len - 1);
+
+  free(base);
+  return SUCCESS;
+}
+
+void bigint_mul_schoolbook(uint64_t       c[],
+                           const uint64_t a[],
+                           const uint64_t a_len,
+                           const uint64_t b[],
+                           const uint64_t b_len)
+{
+  memset(c, 0, (a_len + b_len) * sizeof(uint64_t));
+
+  for(size_t i = 0; i < a_len; i++) {
+    uint64_t carry = 0;
+    for(size_t j = 0; j < b_len; j++) {
+      // Cannot overflow: (2^64 - 1)^2 + 2 * (2^64 - 1) < 2^128.
+      const __uint128_t t = ((__uint128_t)a[i] * b[j]) + c[i + j] + carry;
+
+      c[i + j] = LOW_WORD(t);
+      carry    = HIGH_WORD(t);
+    }
+    c[i + b_len] = carry;
+  }
+}
+
+// c[0..n) = a + b, returns the carry.
+static inline uint64_t
+add_n(uint64_t c[], const uint64_t a[], const uint64_t b[], const size_t n)
+{
+  uint64_t carry = 0;
+  for(size_t i = 0; i < n; i++) {
+    const __uint128_t t = (__uint128_t)a[i] + b[i] + carry;
+
+    c[i]  = LOW_WORD(t);
+    carry = HIGH_WORD(t);
+  }
+  return carry;
+}
+
+// c[0..n) = a - b, returns the borrow.
+static inline uint64_t
+sub_n(uint64_t c[], const uint64_t a[], const uint64_t b[], const size_t n)
+{
+  uint64_t borrow = 0;
+  for(size_t i = 0; i < n; i++) {
+    const uint64_t t = a[i] - b[i] - borrow;
+
+    borrow = (a[i] < b[i]) || ((a[i] == b[i]) && borrow);
+    c[i]   = t;
+  }
+  return borrow;
+}
+
+// Adds the carry to c[0..n).
+static inline void add_carry(uint64_t c[], uint64_t carry, const size_t n)
+{
+  for(size_t i = 0; (i < n) && carry; i++) {
+    c[i] += carry;
+    carry = (c[i] < carry);
+  }
+}
+
+// Subtracts the borrow from c[0..n).
+static inline void sub_borrow(uint64_t c[], uint64_t borrow, const size_t n)
+{
+  for(size_t i = 0; (i < n) && borrow; i++) {
+    borrow = (0 == c[i]);
+    c[i]--;
+  }
+}
+
+// d[0..l) = |x - y|, where x has l limbs and y has h <= l limbs.
+// Returns 1 if x < y.
+static inline int abs_diff(uint64_t       d[],
+                           const uint64_t x[],
+                           const size_t   l,
+                           const uint64_t y[],
+                           const size_t   h)
+{
+  size_t i = l;
+  int    x_lt_y = 0;
+
+  // x >= y when one of its upper l - h limbs is not zero.
+  while((i > h) && (0 == x[i - 1])) {
+    i--;
+  }
+  if(i == h) {
+    while((i > 0) && (x[i - 1] == y[i - 1])) {
+      i--;
+    }
+    x_lt_y = (i > 0) && (x[i - 1] < y[i - 1]);
+  }
+
+  if(x_lt_y) {
+    sub_n(d, y, x, h);
+    memset(&d[h], 0, (l - h) * sizeof(uint64_t));
+    return 1;
+  }
+
+  const uint64_t borrow = sub_n(d, x, y, h);
+  memcpy(&d[h], &x[h], (l - h) * sizeof(uint64_t));
+  sub_borrow(&d[h], borrow, l - h);
+  return 0;
+}
+
+// With h = n / 2 and l = n - h, a = a0 + a1 * 2^(64h) (and b likewise):
+// a * b = z0 + (z0 + z2 - (a1 - a0)(b1 - b0)) * 2^(64h) + z2 * 2^(128h).
+// The scratch holds 4l + 1 qw per level.
+static void karatsuba(uint64_t       c[],
+                      const uint64_t a[],
+                      const uint64_t b[],
+                      const size_t   n,
+                      uint64_t       scratch[])
+{
+  if(n < BIGINT_KARATSUBA_THRESHOLD) {
+    bigint_mul_schoolbook(c, a, n, b, n);
+    return;
+  }
+
+  const size_t h  = n >> 1;
+  const size_t l  = n - h;
+  uint64_t *   t  = scratch;
+  uint64_t *   da = &scratch[2 * l];
+  uint64_t *   db = &scratch[3 * l];
+  uint64_t *   M  = &scratch[2 * l];
+
+  const int neg = abs_diff(da, &a[h], l, a, h) ^ abs_diff(db, &b[h], l, b, h);
+
+  karatsuba(t, da, db, l, &scratch[4 * l]);
+  karatsuba(c, a, b, h, &scratch[4 * l]);
+  karatsuba(&c[2 * h], &a[h], &b[h], l, &scratch[4 * l]);
+
+  // M = z0 + z2 - (a1 - a0)(b1 - b0) (2l + 1 qw), it is non-negative.
+  memcpy(M, c, 2 * h * sizeof(uint64_t));
+  memset(&M[2 * h], 0, (2 * (l - h) + 1) * sizeof(uint64_t));
+  M[2 * l] = add_n(M, M, &c[2 * h], 2 * l);
+  if(neg) {
+    M[2 * l] += add_n(M, M, t, 2 * l);
+  } else {
+    M[2 * l] -= sub_n(M, M, t, 2 * l);
+  }
+
+  add_carry(&c[h + 2 * l + 1], add_n(&c[h], &c[h], M, 2 * l + 1),
+            (2 * n) - (h + 2 * l + 1));
+}
+
+// The sum of 4l + 1 over the levels, where l <= n / 2^k + 1 at level k.
+static inline size_t karatsuba_scratch_qw(const size_t len)
+{
+  return (4 * len) + (5 * 64);
+}
+
+int bigint_mul_karatsuba(uint64_t       c[],
+                         const uint64_t a[],
+                         const uint64_t b[],
+                         const uint64_t len)
+{
+  uint64_t *scratch = malloc(karatsuba_scratch_qw(len) * sizeof(uint64_t));
+  if(NULL == scratch) {
+    return ERROR;
+  }
+  karatsuba(c, a, b, len, scratch);
+  free(scratch);
+  return SUCCESS;
+}
+
+// c = a * b where b_len <= a_len, by Karatsuba products of a's b_len-limb
+// chunks with b. The last (shorter) chunk is multiplied recursively.
+static int bigint_mul_unbalanced(uint64_t       c[],
+                                 const uint64_t a[],
+                                 const uint64_t a_len,
+                                 const uint64_t b[],
+                                 const uint64_t b_len)
+{
+  const size_t tmp_qw = 2 * b_len;
+  uint64_t *   tmp;
+  int          ret = SUCCESS;
+
+  tmp = malloc((tmp_qw + karatsuba_scratch_qw(b_len)) * sizeof(uint64_t));
+  if(NULL == tmp) {
+    return ERROR;
+  }
+
+  memset(c, 0, (a_len + b_len) * sizeof(uint64_t));
+  for(size_t off = 0; (off < a_len) && (SUCCESS == ret); off += b_len) {
+    const size_t chunk = (a_len - off < b_len) ? (a_len - off) : b_len;
+
+    if(chunk == b_len) {
+      karatsuba(tmp, &a[off], b, b_len, &tmp[tmp_qw]);
+    } else {
+      ret = bigint_mul(tmp, b, b_len, &a[off], chunk);
+    }
+
+    // The partial sums never exceed the product, the carry stops within c.
+    add_carry(&c[off + b_len + chunk],
+              add_n(&c[off], &c[off], tmp, b_len + chunk),
+              a_len - off - chunk);
+  }
+
+  free(tmp);
+  return ret;
+}
+
+int bigint_mul(uint64_t       c[],
+               const uint64_t a[],
+               const uint64_t a_len,
+               const uint64_t b[],
+               const uint64_t b_len)
+{
+  if(a_len < b_len) {
+    return bigint_mul(c, b, b_len, a, a_len);
+  }
+
+  if(b_len < BIGINT_KARATSUBA_THRESHOLD) {
+    bigint_mul_schoolbook(c, a, a_len, b, b_len);
+    return SUCCESS;
+  }
+
+  if((a_len + b_len) <= BIGINT_NTT_THRESHOLD) {
+    return bigint_mul_unbalanced(c, a, a_len, b, b_len);
+  }
+
+  bigint_mul_plan_t plan;
+  uint64_t          m = BIGINT_MIN_M;
+  int               ret;
+
+  while((1UL << m) < (a_len + b_len - 1)) {
+    m++;
+  }
+  GUARD(bigint_mul_plan_init(&plan, m));
+  ret = bigint_mul_ntt(&plan, c, a, a_len, b, b_len);
+  bigint_mul_plan_destroy(&plan);
+  return ret;
+}
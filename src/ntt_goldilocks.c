@@ -0,0 +1,190 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt_goldilocks.h"
+
+// The radix-4 group j of level m (the butterflies at distance t) has the
+// roots of the group g = m + j of level m, and of the groups 2g and 2g + 1 of
+// level 2m.
+static inline void collect_roots(uint64_t       roots[3],
+                                 const uint64_t w[],
+                                 const size_t   g)
+{
+  roots[0] = w[g];
+  roots[1] = w[2 * g];
+  roots[2] = w[2 * g + 1];
+}
+
+static inline void fwd_layer(uint64_t       a[],
+                             const uint64_t w[],
+                             const size_t   m,
+                             const size_t   t)
+{
+  uint64_t roots[3];
+
+  for(size_t j = 0; j < m; j++) {
+    const size_t k = 4 * t * j;
+
+    collect_roots(roots, w, m + j);
+    for(size_t i = k; i < k + t; i++) {
+      goldilocks_radix4_fwd_butterfly(&a[i], &a[i + t], &a[i + 2 * t],
+                                      &a[i + 3 * t], roots);
+    }
+  }
+}
+
+static inline void inv_layer(uint64_t       a[],
+                             const uint64_t w_inv[],
+                             const size_t   m,
+                             const size_t   t)
+{
+  uint64_t roots[3];
+
+  for(size_t j = 0; j < m; j++) {
+    const size_t k = 4 * t * j;
+
+    collect_roots(roots, w_inv, m + j);
+    for(size_t i = k; i < k + t; i++) {
+      goldilocks_radix4_inv_butterfly(&a[i], &a[i + t], &a[i + 2 * t],
+                                      &a[i + 3 * t], roots);
+    }
+  }
+}
+
+void fwd_ntt_goldilocks_lazy(uint64_t a[], const uint64_t N, const uint64_t w[])
+{
+  size_t m = 1;
+
+  // If N=2^m where m is odd, start with one radix-2 iteration.
+  if(!HAS_AN_EVEN_POWER(N)) {
+    for(size_t i = 0; i < (N >> 1); i++) {
+      goldilocks_fwd_butterfly(&a[i], &a[i + (N >> 1)], w[1]);
+    }
+    m = 2;
+  }
+
+  for(size_t t = N / (4 * m); t > 0; m <<= 2, t >>= 2) {
+    fwd_layer(a, w, m, t);
+  }
+}
+
+// The coset NTT is the NTT of in[i] * shift^i. The input at i + kt of the
+// first iteration is multiplied by u = shift^i, and shift^(kt) is folded into
+// the roots: (X + w*s^(2t)*Z) * u, (Y + w*s^(2t)*T) * u * s^t and so on.
+void fwd_ntt_goldilocks_coset_lazy(uint64_t       out[],
+                                   const uint64_t in[],
+                                   const uint64_t N,
+                                   const uint64_t shift,
+                                   const uint64_t w[])
+{
+  uint64_t u = 1;
+  size_t   m;
+
+  if(HAS_AN_EVEN_POWER(N)) {
+    const size_t   t        = N >> 2;
+    const uint64_t s_t      = goldilocks_pow(shift, t);
+    const uint64_t roots[3] = {goldilocks_mul(w[1], goldilocks_mul(s_t, s_t)),
+                               goldilocks_mul(w[2], s_t),
+                               goldilocks_mul(w[3], s_t)};
+
+    for(size_t i = 0; i < t; i++) {
+      uint64_t X = goldilocks_mul(in[i], u);
+      uint64_t Y = goldilocks_mul(in[i + t], u);
+      uint64_t Z = goldilocks_mul(in[i + 2 * t], u);
+      uint64_t T = goldilocks_mul(in[i + 3 * t], u);
+
+      goldilocks_radix4_fwd_butterfly(&X, &Y, &Z, &T, roots);
+      out[i]         = X;
+      out[i + t]     = Y;
+      out[i + 2 * t] = Z;
+      out[i + 3 * t] = T;
+      u              = goldilocks_mul(u, shift);
+    }
+    m = 4;
+  } else {
+    const size_t   t  = N >> 1;
+    const uint64_t w1 = goldilocks_mul(w[1], goldilocks_pow(shift, t));
+
+    for(size_t i = 0; i < t; i++) {
+      uint64_t X = goldilocks_mul(in[i], u);
+      uint64_t Y = goldilocks_mul(in[i + t], u);
+
+      goldilocks_fwd_butterfly(&X, &Y, w1);
+      out[i]     = X;
+      out[i + t] = Y;
+      u          = goldilocks_mul(u, shift);
+    }
+    m = 2;
+  }
+
+  for(size_t t = N / (4 * m); t > 0; m <<= 2, t >>= 2) {
+    fwd_layer(out, w, m, t);
+  }
+}
+
+void lde_goldilocks(uint64_t       out[],
+                    const uint64_t a[],
+                    const uint64_t N,
+                    const uint64_t k,
+                    const uint64_t shifts[],
+                    const uint64_t w[])
+{
+  // The cosets are independent, they share a and w (read-only).
+#ifdef _OPENMP
+#  pragma omp parallel for schedule(static)
+#endif
+  for(size_t j = 0; j < k; j++) {
+#if defined(AVX512_SUPPORT)
+    fwd_ntt_goldilocks_avx512_coset(&out[j * N], a, N, shifts[j], w);
+#elif defined(__AVX2__)
+    fwd_ntt_goldilocks_avx2_coset(&out[j * N], a, N, shifts[j], w);
+#else
+    fwd_ntt_goldilocks_coset(&out[j * N], a, N, shifts[j], w);
+#endif
+  }
+}
+
+void inv_ntt_goldilocks(uint64_t       a[],
+                        const uint64_t N,
+                        const uint64_t n_inv,
+                        const uint64_t w_inv[])
+{
+  const uint64_t w_n = goldilocks_mul(w_inv[1], n_inv);
+  size_t         t   = 1;
+
+  // 1. The radix-4 iterations in reverse order, except for the m = 1 one.
+  for(size_t m = N >> 2; m > 1; m >>= 2, t <<= 2) {
+    inv_layer(a, w_inv, m, t);
+  }
+
+  // 2. The last iteration (radix-4 if N=2^m where m is even, radix-2
+  // otherwise) also normalizes the results, its roots are multiplied by n^-1.
+  if(HAS_AN_EVEN_POWER(N)) {
+    for(size_t i = 0; i < t; i++) {
+      uint64_t *X = &a[i];
+      uint64_t *Y = &a[i + t];
+      uint64_t *Z = &a[i + 2 * t];
+      uint64_t *T = &a[i + 3 * t];
+
+      goldilocks_inv_butterfly(X, Y, w_inv[2]);
+      goldilocks_inv_butterfly(Z, T, w_inv[3]);
+
+      const uint64_t XZ = goldilocks_sub(*X, *Z);
+      const uint64_t YT = goldilocks_sub(*Y, *T);
+
+      *X = goldilocks_canonical(goldilocks_mul(n_inv, goldilocks_add(*X, *Z)));
+      *Y = goldilocks_canonical(goldilocks_mul(n_inv, goldilocks_add(*Y, *T)));
+      *Z = goldilocks_canonical(goldilocks_mul(w_n, XZ));
+      *T = goldilocks_canonical(goldilocks_mul(w_n, YT));
+    }
+    return;
+  }
+
+  for(size_t i = 0; i < t; i++) {
+    const uint64_t X = a[i];
+    const uint64_t Y = a[i + t];
+
+    a[i]     = goldilocks_canonical(goldilocks_mul(n_inv, goldilocks_add(X, Y)));
+    a[i + t] = goldilocks_canonical(goldilocks_mul(w_n, goldilocks_sub(X, Y)));
+  }
+}
@@ -0,0 +1,282 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifdef __AVX2__
+
+#  include "ntt_goldilocks.h"
+
+// The structure follows fwd_ntt_goldilocks_lazy/inv_ntt_goldilocks. The layers
+// with t >= 4 load the coefficients directly and broadcast the roots. With
+// t = 1 a register holds the coefficients of 4 groups, which are transposed in
+// registers, and lane l has the roots of group l.
+
+#  define LOAD(mem)       _mm256_loadu_si256((const __m256i *)(mem))
+#  define STORE(mem, reg) _mm256_storeu_si256((__m256i *)(mem), (reg))
+#  define SET1(val)       _mm256_set1_epi64x((long long)(val))
+
+static inline void
+collect_roots(__m256i roots[3], const uint64_t w[], const size_t g)
+{
+  roots[0] = SET1(w[g]);
+  roots[1] = SET1(w[2 * g]);
+  roots[2] = SET1(w[2 * g + 1]);
+}
+
+// The groups g, ..., g + 3.
+static inline void
+collect_roots_t1(__m256i roots[3], const uint64_t w[], const size_t g)
+{
+  const __m256i lo = LOAD(&w[2 * g]);
+  const __m256i hi = LOAD(&w[2 * g + 4]);
+
+  roots[0] = LOAD(&w[g]);
+  roots[1] = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(lo, hi), 0xd8);
+  roots[2] = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(lo, hi), 0xd8);
+}
+
+// In-place transpose of a 4x4 matrix of qw, where V[i] is the i'th row.
+static inline void transpose_4x4(__m256i V[4])
+{
+  const __m256i T0 = _mm256_unpacklo_epi64(V[0], V[1]);
+  const __m256i T1 = _mm256_unpackhi_epi64(V[0], V[1]);
+  const __m256i T2 = _mm256_unpacklo_epi64(V[2], V[3]);
+  const __m256i T3 = _mm256_unpackhi_epi64(V[2], V[3]);
+
+  V[0] = _mm256_permute2x128_si256(T0, T2, 0x20);
+  V[1] = _mm256_permute2x128_si256(T1, T3, 0x20);
+  V[2] = _mm256_permute2x128_si256(T0, T2, 0x31);
+  V[3] = _mm256_permute2x128_si256(T1, T3, 0x31);
+}
+
+static inline void load4(__m256i V[4], const uint64_t a[], const size_t t)
+{
+  V[0] = LOAD(&a[0]);
+  V[1] = LOAD(&a[t]);
+  V[2] = LOAD(&a[2 * t]);
+  V[3] = LOAD(&a[3 * t]);
+}
+
+static inline void store4(uint64_t a[], const __m256i V[4], const size_t t)
+{
+  STORE(&a[0], V[0]);
+  STORE(&a[t], V[1]);
+  STORE(&a[2 * t], V[2]);
+  STORE(&a[3 * t], V[3]);
+}
+
+static inline void fwd_layer(uint64_t       a[],
+                             const uint64_t w[],
+                             const size_t   m,
+                             const size_t   t)
+{
+  __m256i roots[3];
+  __m256i V[4];
+
+  if(t == 1) {
+    for(size_t j = 0; j < m; j += 4) {
+      load4(V, &a[4 * j], 4);
+      transpose_4x4(V);
+      collect_roots_t1(roots, w, m + j);
+      goldilocks_radix4_fwd_butterfly_avx2(&V[0], &V[1], &V[2], &V[3], roots);
+      transpose_4x4(V);
+      store4(&a[4 * j], V, 4);
+    }
+    return;
+  }
+
+  for(size_t j = 0; j < m; j++) {
+    const size_t k = 4 * t * j;
+
+    collect_roots(roots, w, m + j);
+    for(size_t i = k; i < k + t; i += 4) {
+      load4(V, &a[i], t);
+      goldilocks_radix4_fwd_butterfly_avx2(&V[0], &V[1], &V[2], &V[3], roots);
+      store4(&a[i], V, t);
+    }
+  }
+}
+
+static inline void inv_layer(uint64_t       a[],
+                             const uint64_t w_inv[],
+                             const size_t   m,
+                             const size_t   t)
+{
+  __m256i roots[3];
+  __m256i V[4];
+
+  if(t == 1) {
+    for(size_t j = 0; j < m; j += 4) {
+      load4(V, &a[4 * j], 4);
+      transpose_4x4(V);
+      collect_roots_t1(roots, w_inv, m + j);
+      goldilocks_radix4_inv_butterfly_avx2(&V[0], &V[1], &V[2], &V[3], roots);
+      transpose_4x4(V);
+      store4(&a[4 * j], V, 4);
+    }
+    return;
+  }
+
+  for(size_t j = 0; j < m; j++) {
+    const size_t k = 4 * t * j;
+
+    collect_roots(roots, w_inv, m + j);
+    for(size_t i = k; i < k + t; i += 4) {
+      load4(V, &a[i], t);
+      goldilocks_radix4_inv_butterfly_avx2(&V[0], &V[1], &V[2], &V[3], roots);
+      store4(&a[i], V, t);
+    }
+  }
+}
+
+void fwd_ntt_goldilocks_avx2_lazy(uint64_t       a[],
+                                  const uint64_t N,
+                                  const uint64_t w[])
+{
+  if(N < 64) {
+    fwd_ntt_goldilocks_lazy(a, N, w);
+    return;
+  }
+
+  size_t m = 1;
+
+  // If N=2^m where m is odd, start with one radix-2 iteration.
+  if(!HAS_AN_EVEN_POWER(N)) {
+    const size_t  t  = N >> 1;
+    const __m256i w1 = SET1(w[1]);
+
+    for(size_t i = 0; i < t; i += 4) {
+      const __m256i X = LOAD(&a[i]);
+      const __m256i Y = goldilocks_mul_avx2(w1, LOAD(&a[i + t]));
+
+      STORE(&a[i], goldilocks_add_avx2(X, Y));
+      STORE(&a[i + t], goldilocks_sub_avx2(X, Y));
+    }
+    m = 2;
+  }
+
+  for(size_t t = N / (4 * m); t > 0; m <<= 2, t >>= 2) {
+    fwd_layer(a, w, m, t);
+  }
+}
+
+// See fwd_ntt_goldilocks_coset_lazy. Lane l of u holds shift^(i + l).
+void fwd_ntt_goldilocks_avx2_coset_lazy(uint64_t       out[],
+                                        const uint64_t in[],
+                                        const uint64_t N,
+                                        const uint64_t shift,
+                                        const uint64_t w[])
+{
+  if(N < 64) {
+    fwd_ntt_goldilocks_coset_lazy(out, in, N, shift, w);
+    return;
+  }
+
+  uint64_t u_init[4] = {1};
+  for(size_t l = 1; l < 4; l++) {
+    u_init[l] = goldilocks_mul(u_init[l - 1], shift);
+  }
+
+  const __m256i step = SET1(goldilocks_mul(u_init[3], shift));
+  __m256i       u    = LOAD(u_init);
+  size_t        m;
+
+  if(HAS_AN_EVEN_POWER(N)) {
+    const size_t   t        = N >> 2;
+    const uint64_t s_t      = goldilocks_pow(shift, t);
+    const __m256i  roots[3] = {
+      SET1(goldilocks_mul(w[1], goldilocks_mul(s_t, s_t))),
+      SET1(goldilocks_mul(w[2], s_t)), SET1(goldilocks_mul(w[3], s_t))};
+
+    for(size_t i = 0; i < t; i += 4) {
+      __m256i V[4];
+
+      load4(V, &in[i], t);
+      for(size_t s = 0; s < 4; s++) {
+        V[s] = goldilocks_mul_avx2(V[s], u);
+      }
+      goldilocks_radix4_fwd_butterfly_avx2(&V[0], &V[1], &V[2], &V[3], roots);
+      store4(&out[i], V, t);
+      u = goldilocks_mul_avx2(u, step);
+    }
+    m = 4;
+  } else {
+    const size_t  t  = N >> 1;
+    const __m256i w1 = SET1(goldilocks_mul(w[1], goldilocks_pow(shift, t)));
+
+    for(size_t i = 0; i < t; i += 4) {
+      const __m256i X = goldilocks_mul_avx2(LOAD(&in[i]), u);
+      const __m256i Y =
+        goldilocks_mul_avx2(w1, goldilocks_mul_avx2(LOAD(&in[i + t]), u));
+
+      STORE(&out[i], goldilocks_add_avx2(X, Y));
+      STORE(&out[i + t], goldilocks_sub_avx2(X, Y));
+      u = goldilocks_mul_avx2(u, step);
+    }
+    m = 2;
+  }
+
+  for(size_t t = N / (4 * m); t > 0; m <<= 2, t >>= 2) {
+    fwd_layer(out, w, m, t);
+  }
+}
+
+void inv_ntt_goldilocks_avx2(uint64_t       a[],
+                             const uint64_t N,
+                             const uint64_t n_inv,
+                             const uint64_t w_inv[])
+{
+  if(N < 64) {
+    inv_ntt_goldilocks(a, N, n_inv, w_inv);
+    return;
+  }
+
+  const __m256i n_inv_vec = SET1(n_inv);
+  const __m256i w_n       = SET1(goldilocks_mul(w_inv[1], n_inv));
+  size_t        t         = 1;
+
+  // 1. The radix-4 iterations in reverse order, except for the m = 1 one.
+  for(size_t m = N >> 2; m > 1; m >>= 2, t <<= 2) {
+    inv_layer(a, w_inv, m, t);
+  }
+
+  // 2. The last iteration (radix-4 if N=2^m where m is even, radix-2
+  // otherwise) also normalizes the results, its roots are multiplied by n^-1.
+  if(HAS_AN_EVEN_POWER(N)) {
+    const __m256i w2 = SET1(w_inv[2]);
+    const __m256i w3 = SET1(w_inv[3]);
+
+    for(size_t i = 0; i < t; i += 4) {
+      __m256i V[4];
+
+      load4(V, &a[i], t);
+
+      const __m256i X = goldilocks_add_avx2(V[0], V[1]);
+      const __m256i Y = goldilocks_mul_avx2(w2, goldilocks_sub_avx2(V[0], V[1]));
+      const __m256i Z = goldilocks_add_avx2(V[2], V[3]);
+      const __m256i T = goldilocks_mul_avx2(w3, goldilocks_sub_avx2(V[2], V[3]));
+
+      V[0] = goldilocks_mul_avx2(n_inv_vec, goldilocks_add_avx2(X, Z));
+      V[1] = goldilocks_mul_avx2(n_inv_vec, goldilocks_add_avx2(Y, T));
+      V[2] = goldilocks_mul_avx2(w_n, goldilocks_sub_avx2(X, Z));
+      V[3] = goldilocks_mul_avx2(w_n, goldilocks_sub_avx2(Y, T));
+
+      for(size_t s = 0; s < 4; s++) {
+        V[s] = goldilocks_canonical_avx2(V[s]);
+      }
+      store4(&a[i], V, t);
+    }
+    return;
+  }
+
+  for(size_t i = 0; i < t; i += 4) {
+    const __m256i X = LOAD(&a[i]);
+    const __m256i Y = LOAD(&a[i + t]);
+
+    STORE(&a[i], goldilocks_canonical_avx2(
+                   goldilocks_mul_avx2(n_inv_vec, goldilocks_add_avx2(X, Y))));
+    STORE(&a[i + t], goldilocks_canonical_avx2(
+                       goldilocks_mul_avx2(w_n, goldilocks_sub_avx2(X, Y))));
+  }
+}
+
+#endif
@@ -0,0 +1,364 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifdef AVX512_SUPPORT
+
+#  include "avx512.h"
+#  include "ntt_goldilocks.h"
+
+// The structure follows fwd_ntt_goldilocks_lazy/inv_ntt_goldilocks. The layers
+// with t >= 16 load the coefficients directly and broadcast the roots. With
+// t = 4 (t = 1) a register holds the coefficients of 2 (8) groups, which are
+// rearranged in registers, and lane l has the roots of its group.
+
+static inline void
+collect_roots(__m512i roots[3], const uint64_t w[], const size_t g)
+{
+  roots[0] = SET1(w[g]);
+  roots[1] = SET1(w[2 * g]);
+  roots[2] = SET1(w[2 * g + 1]);
+}
+
+// The groups g and g + 1.
+static inline void
+collect_roots_t4(__m512i roots[3], const uint64_t w[], const size_t g)
+{
+  roots[0] = BROADCAST2HALVES(w[g], w[g + 1]);
+  roots[1] = BROADCAST2HALVES(w[2 * g], w[2 * g + 2]);
+  roots[2] = BROADCAST2HALVES(w[2 * g + 1], w[2 * g + 3]);
+}
+
+// The groups g, ..., g + 7.
+static inline void
+collect_roots_t1(__m512i roots[3], const uint64_t w[], const size_t g)
+{
+  const __m512i idx_even = SETR(0, 2, 4, 6, 8, 10, 12, 14);
+  const __m512i idx_odd  = SETR(1, 3, 5, 7, 9, 11, 13, 15);
+  const __m512i lo       = LOAD(&w[2 * g]);
+  const __m512i hi       = LOAD(&w[2 * g + 8]);
+
+  roots[0] = LOAD(&w[g]);
+  roots[1] = PERM(lo, idx_even, hi);
+  roots[2] = PERM(lo, idx_odd, hi);
+}
+
+// V[i] = a[8i..8i+7] holds the halves of X, Y (i even) or Z, T (i odd) of two
+// groups of 16 coefficients. The transform is its own inverse.
+static inline void shuffle_t4(__m512i V[4])
+{
+  const __m512i X = SHUF(V[0], V[2], 0x44);
+  const __m512i Y = SHUF(V[0], V[2], 0xee);
+  const __m512i Z = SHUF(V[1], V[3], 0x44);
+  const __m512i T = SHUF(V[1], V[3], 0xee);
+
+  V[0] = X;
+  V[1] = Y;
+  V[2] = Z;
+  V[3] = T;
+}
+
+static inline void unshuffle_t4(__m512i V[4])
+{
+  const __m512i V0 = SHUF(V[0], V[1], 0x44);
+  const __m512i V2 = SHUF(V[0], V[1], 0xee);
+  const __m512i V1 = SHUF(V[2], V[3], 0x44);
+  const __m512i V3 = SHUF(V[2], V[3], 0xee);
+
+  V[0] = V0;
+  V[1] = V1;
+  V[2] = V2;
+  V[3] = V3;
+}
+
+// V[i] = a[8i..8i+7] holds the groups of 4 coefficients 2i and 2i + 1, they
+// are transposed to V = {X, Y, Z, T} with lane l holding group l.
+static inline void shuffle_t1(__m512i V[4])
+{
+  const __m512i idx_lo = SETR(0, 4, 8, 12, 1, 5, 9, 13);
+  const __m512i idx_hi = SETR(2, 6, 10, 14, 3, 7, 11, 15);
+
+  const __m512i P = PERM(V[0], idx_lo, V[1]);
+  const __m512i Q = PERM(V[0], idx_hi, V[1]);
+  const __m512i R = PERM(V[2], idx_lo, V[3]);
+  const __m512i S = PERM(V[2], idx_hi, V[3]);
+
+  V[0] = SHUF(P, R, 0x44);
+  V[1] = SHUF(P, R, 0xee);
+  V[2] = SHUF(Q, S, 0x44);
+  V[3] = SHUF(Q, S, 0xee);
+}
+
+static inline void unshuffle_t1(__m512i V[4])
+{
+  const __m512i idx_lo = SETR(0, 4, 8, 12, 1, 5, 9, 13);
+  const __m512i idx_hi = SETR(2, 6, 10, 14, 3, 7, 11, 15);
+
+  const __m512i P = SHUF(V[0], V[1], 0x44);
+  const __m512i R = SHUF(V[0], V[1], 0xee);
+  const __m512i Q = SHUF(V[2], V[3], 0x44);
+  const __m512i S = SHUF(V[2], V[3], 0xee);
+
+  V[0] = PERM(P, idx_lo, Q);
+  V[1] = PERM(P, idx_hi, Q);
+  V[2] = PERM(R, idx_lo, S);
+  V[3] = PERM(R, idx_hi, S);
+}
+
+static inline void load4(__m512i V[4], const uint64_t a[], const size_t t)
+{
+  V[0] = LOAD(&a[0]);
+  V[1] = LOAD(&a[t]);
+  V[2] = LOAD(&a[2 * t]);
+  V[3] = LOAD(&a[3 * t]);
+}
+
+static inline void store4(uint64_t a[], const __m512i V[4], const size_t t)
+{
+  STORE(&a[0], V[0]);
+  STORE(&a[t], V[1]);
+  STORE(&a[2 * t], V[2]);
+  STORE(&a[3 * t], V[3]);
+}
+
+static inline void fwd_layer(uint64_t       a[],
+                             const uint64_t w[],
+                             const size_t   m,
+                             const size_t   t)
+{
+  __m512i roots[3];
+  __m512i V[4];
+
+  if(t == 1) {
+    for(size_t j = 0; j < m; j += 8) {
+      load4(V, &a[4 * j], 8);
+      shuffle_t1(V);
+      collect_roots_t1(roots, w, m + j);
+      goldilocks_radix4_fwd_butterfly_avx512(&V[0], &V[1], &V[2], &V[3], roots);
+      unshuffle_t1(V);
+      store4(&a[4 * j], V, 8);
+    }
+    return;
+  }
+
+  if(t == 4) {
+    for(size_t j = 0; j < m; j += 2) {
+      load4(V, &a[16 * j], 8);
+      shuffle_t4(V);
+      collect_roots_t4(roots, w, m + j);
+      goldilocks_radix4_fwd_butterfly_avx512(&V[0], &V[1], &V[2], &V[3], roots);
+      unshuffle_t4(V);
+      store4(&a[16 * j], V, 8);
+    }
+    return;
+  }
+
+  for(size_t j = 0; j < m; j++) {
+    const size_t k = 4 * t * j;
+
+    collect_roots(roots, w, m + j);
+    for(size_t i = k; i < k + t; i += 8) {
+      load4(V, &a[i], t);
+      goldilocks_radix4_fwd_butterfly_avx512(&V[0], &V[1], &V[2], &V[3], roots);
+      store4(&a[i], V, t);
+    }
+  }
+}
+
+static inline void inv_layer(uint64_t       a[],
+                             const uint64_t w_inv[],
+                             const size_t   m,
+                             const size_t   t)
+{
+  __m512i roots[3];
+  __m512i V[4];
+
+  if(t == 1) {
+    for(size_t j = 0; j < m; j += 8) {
+      load4(V, &a[4 * j], 8);
+      shuffle_t1(V);
+      collect_roots_t1(roots, w_inv, m + j);
+      goldilocks_radix4_inv_butterfly_avx512(&V[0], &V[1], &V[2], &V[3], roots);
+      unshuffle_t1(V);
+      store4(&a[4 * j], V, 8);
+    }
+    return;
+  }
+
+  if(t == 4) {
+    for(size_t j = 0; j < m; j += 2) {
+      load4(V, &a[16 * j], 8);
+      shuffle_t4(V);
+      collect_roots_t4(roots, w_inv, m + j);
+      goldilocks_radix4_inv_butterfly_avx512(&V[0], &V[1], &V[2], &V[3], roots);
+      unshuffle_t4(V);
+      store4(&a[16 * j], V, 8);
+    }
+    return;
+  }
+
+  for(size_t j = 0; j < m; j++) {
+    const size_t k = 4 * t * j;
+
+    collect_roots(roots, w_inv, m + j);
+    for(size_t i = k; i < k + t; i += 8) {
+      load4(V, &a[i], t);
+      goldilocks_radix4_inv_butterfly_avx512(&V[0], &V[1], &V[2], &V[3], roots);
+      store4(&a[i], V, t);
+    }
+  }
+}
+
+void fwd_ntt_goldilocks_avx512_lazy(uint64_t       a[],
+                                    const uint64_t N,
+                                    const uint64_t w[])
+{
+  if(N < 64) {
+    fwd_ntt_goldilocks_lazy(a, N, w);
+    return;
+  }
+
+  size_t m = 1;
+
+  // If N=2^m where m is odd, start with one radix-2 iteration.
+  if(!HAS_AN_EVEN_POWER(N)) {
+    const size_t  t  = N >> 1;
+    const __m512i w1 = SET1(w[1]);
+
+    for(size_t i = 0; i < t; i += 8) {
+      const __m512i X = LOAD(&a[i]);
+      const __m512i Y = goldilocks_mul_avx512(w1, LOAD(&a[i + t]));
+
+      STORE(&a[i], goldilocks_add_avx512(X, Y));
+      STORE(&a[i + t], goldilocks_sub_avx512(X, Y));
+    }
+    m = 2;
+  }
+
+  for(size_t t = N / (4 * m); t > 0; m <<= 2, t >>= 2) {
+    fwd_layer(a, w, m, t);
+  }
+}
+
+// See fwd_ntt_goldilocks_coset_lazy. Lane l of u holds shift^(i + l).
+void fwd_ntt_goldilocks_avx512_coset_lazy(uint64_t       out[],
+                                          const uint64_t in[],
+                                          const uint64_t N,
+                                          const uint64_t shift,
+                                          const uint64_t w[])
+{
+  if(N < 64) {
+    fwd_ntt_goldilocks_coset_lazy(out, in, N, shift, w);
+    return;
+  }
+
+  uint64_t u_init[8] = {1};
+  for(size_t l = 1; l < 8; l++) {
+    u_init[l] = goldilocks_mul(u_init[l - 1], shift);
+  }
+
+  const __m512i step = SET1(goldilocks_mul(u_init[7], shift));
+  __m512i       u    = LOAD(u_init);
+  size_t        m;
+
+  if(HAS_AN_EVEN_POWER(N)) {
+    const size_t   t        = N >> 2;
+    const uint64_t s_t      = goldilocks_pow(shift, t);
+    const __m512i  roots[3] = {
+      SET1(goldilocks_mul(w[1], goldilocks_mul(s_t, s_t))),
+      SET1(goldilocks_mul(w[2], s_t)), SET1(goldilocks_mul(w[3], s_t))};
+
+    for(size_t i = 0; i < t; i += 8) {
+      __m512i V[4];
+
+      load4(V, &in[i], t);
+      for(size_t s = 0; s < 4; s++) {
+        V[s] = goldilocks_mul_avx512(V[s], u);
+      }
+      goldilocks_radix4_fwd_butterfly_avx512(&V[0], &V[1], &V[2], &V[3], roots);
+      store4(&out[i], V, t);
+      u = goldilocks_mul_avx512(u, step);
+    }
+    m = 4;
+  } else {
+    const size_t  t  = N >> 1;
+    const __m512i w1 = SET1(goldilocks_mul(w[1], goldilocks_pow(shift, t)));
+
+    for(size_t i = 0; i < t; i += 8) {
+      const __m512i X = goldilocks_mul_avx512(LOAD(&in[i]), u);
+      const __m512i Y =
+        goldilocks_mul_avx512(w1, goldilocks_mul_avx512(LOAD(&in[i + t]), u));
+
+      STORE(&out[i], goldilocks_add_avx512(X, Y));
+      STORE(&out[i + t], goldilocks_sub_avx512(X, Y));
+      u = goldilocks_mul_avx512(u, step);
+    }
+    m = 2;
+  }
+
+  for(size_t t = N / (4 * m); t > 0; m <<= 2, t >>= 2) {
+    fwd_layer(out, w, m, t);
+  }
+}
+
+void inv_ntt_goldilocks_avx512(uint64_t       a[],
+                               const uint64_t N,
+                               const uint64_t n_inv,
+                               const uint64_t w_inv[])
+{
+  if(N < 64) {
+    inv_ntt_goldilocks(a, N, n_inv, w_inv);
+    return;
+  }
+
+  const __m512i n_inv_vec = SET1(n_inv);
+  const __m512i w_n       = SET1(goldilocks_mul(w_inv[1], n_inv));
+  size_t        t         = 1;
+
+  // 1. The radix-4 iterations in reverse order, except for the m = 1 one.
+  for(size_t m = N >> 2; m > 1; m >>= 2, t <<= 2) {
+    inv_layer(a, w_inv, m, t);
+  }
+
+  // 2. The last iteration (radix-4 if N=2^m where m is even, radix-2
+  // otherwise) also normalizes the results, its roots are multiplied by n^-1.
+  if(HAS_AN_EVEN_POWER(N)) {
+    const __m512i w2 = SET1(w_inv[2]);
+    const __m512i w3 = SET1(w_inv[3]);
+
+    for(size_t i = 0; i < t; i += 8) {
+      __m512i V[4];
+
+      load4(V, &a[i], t);
+
+      const __m512i X  = goldilocks_add_avx512(V[0], V[1]);
+      const __m512i Y0 = goldilocks_sub_avx512(V[0], V[1]);
+      const __m512i Z  = goldilocks_add_avx512(V[2], V[3]);
+      const __m512i T0 = goldilocks_sub_avx512(V[2], V[3]);
+      const __m512i Y  = goldilocks_mul_avx512(w2, Y0);
+      const __m512i T  = goldilocks_mul_avx512(w3, T0);
+
+      V[0] = goldilocks_mul_avx512(n_inv_vec, goldilocks_add_avx512(X, Z));
+      V[1] = goldilocks_mul_avx512(n_inv_vec, goldilocks_add_avx512(Y, T));
+      V[2] = goldilocks_mul_avx512(w_n, goldilocks_sub_avx512(X, Z));
+      V[3] = goldilocks_mul_avx512(w_n, goldilocks_sub_avx512(Y, T));
+
+      for(size_t s = 0; s < 4; s++) {
+        V[s] = goldilocks_canonical_avx512(V[s]);
+      }
+      store4(&a[i], V, t);
+    }
+    return;
+  }
+
+  for(size_t i = 0; i < t; i += 8) {
+    const __m512i X = LOAD(&a[i]);
+    const __m512i Y = LOAD(&a[i + t]);
+
+    STORE(&a[i], goldilocks_canonical_avx512(goldilocks_mul_avx512(
+                   n_inv_vec, goldilocks_add_avx512(X, Y))));
+    STORE(&a[i + t], goldilocks_canonical_avx512(goldilocks_mul_avx512(
+                       w_n, goldilocks_sub_avx512(X, Y))));
+  }
+}
+
+#endif
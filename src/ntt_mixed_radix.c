@@ -0,0 +1,65 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt_mixed_radix.h"
+#include "fast_mul_operators.h"
+#include "ntt_radix4.h"
+
+// The radix-3 roots and twists follow the radix-4 w-powers of size M
+// (see calc_w_mixed_radix3).
+static inline void collect_roots(mul_op_t       roots[4],
+                                 const uint64_t w[],
+                                 const uint64_t w_con[],
+                                 const size_t   M,
+                                 const size_t   i)
+{
+  const size_t tw = (2 * M) + 8 + (2 * i);
+
+  roots[0].op  = w[2 * M];
+  roots[0].con = w_con[2 * M];
+  roots[1].op  = w[(2 * M) + 1];
+  roots[1].con = w_con[(2 * M) + 1];
+  roots[2].op  = w[tw];
+  roots[2].con = w_con[tw];
+  roots[3].op  = w[tw + 1];
+  roots[3].con = w_con[tw + 1];
+}
+
+void fwd_ntt_mixed_radix3_lazy(uint64_t       a[],
+                               const uint64_t N,
+                               const uint64_t q,
+                               const uint64_t w[],
+                               const uint64_t w_con[])
+{
+  const size_t M = N / 3;
+  mul_op_t     roots[4];
+
+  for(size_t i = 0; i < M; i++) {
+    collect_roots(roots, w, w_con, M, i);
+    radix3_fwd_butterfly(&a[i], &a[i + M], &a[i + (2 * M)], roots, q);
+  }
+
+  for(size_t j = 0; j < 3; j++) {
+    fwd_ntt_radix4_lazy(&a[j * M], M, q, w, w_con);
+  }
+}
+
+void inv_ntt_mixed_radix3(uint64_t       a[],
+                          const uint64_t N,
+                          const uint64_t q,
+                          const mul_op_t n_inv,
+                          const uint64_t w[],
+                          const uint64_t w_con[])
+{
+  const size_t M = N / 3;
+  mul_op_t     roots[4];
+
+  for(size_t j = 0; j < 3; j++) {
+    inv_ntt_radix4(&a[j * M], M, q, n_inv, w, w_con);
+  }
+
+  for(size_t i = 0; i < M; i++) {
+    collect_roots(roots, w, w_con, M, i);
+    radix3_inv_butterfly(&a[i], &a[i + M], &a[i + (2 * M)], roots, q);
+  }
+}
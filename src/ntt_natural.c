@@ -0,0 +1,139 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt_natural.h"
+#include "ntt_radix4.h"
+#include "pre_compute.h"
+
+// Tiles are 8x8 qw, i.e. every row is one 64-byte cache line.
+#define TILE_LOG 3
+#define TILE     (1UL << TILE_LOG)
+
+typedef enum
+{
+  NO_REDUCTION = 0,
+  REDUCE_8Q_TO_Q,
+  REDUCE_8Q_TO_2Q
+} reduction_t;
+
+static inline uint64_t
+reduce(const uint64_t val, const uint64_t q, const reduction_t red)
+{
+  switch(red) {
+    case REDUCE_8Q_TO_Q: return reduce_8q_to_q(val, q);
+    case REDUCE_8Q_TO_2Q: return reduce_8q_to_2q(val, q);
+    default: return val;
+  }
+}
+
+static const uint8_t rev3[TILE] = {0, 4, 2, 6, 1, 5, 3, 7};
+
+// Write the tile tile_src (loaded from the middle index mid) to the middle index
+// rev_mid. Index i = hi|mid|lo is sent to rev(lo)|rev(mid)|rev(hi).
+static inline void store_tile(uint64_t          a[],
+                              const uint64_t    tile_src[TILE * TILE],
+                              const uint64_t    rev_mid,
+                              const uint64_t    m,
+                              const uint64_t    q,
+                              const reduction_t red)
+{
+  for(size_t r = 0; r < TILE; r++) {
+    uint64_t *dst = &a[(r << (m - TILE_LOG)) | (rev_mid << TILE_LOG)];
+    for(size_t c = 0; c < TILE; c++) {
+      dst[c] = reduce(tile_src[(rev3[c] * TILE) + rev3[r]], q, red);
+    }
+  }
+}
+
+static inline void load_tile(uint64_t       tile_dst[TILE * TILE],
+                             const uint64_t a[],
+                             const uint64_t mid,
+                             const uint64_t m)
+{
+  for(size_t r = 0; r < TILE; r++) {
+    const uint64_t *src = &a[(r << (m - TILE_LOG)) | (mid << TILE_LOG)];
+    for(size_t c = 0; c < TILE; c++) {
+      tile_dst[r * TILE + c] = src[c];
+    }
+  }
+}
+
+static inline void bit_rev_reduce_in_place(uint64_t          a[],
+                                           const uint64_t    N,
+                                           const uint64_t    q,
+                                           const reduction_t red)
+{
+  uint64_t m = 0;
+  while((1UL << m) < N) {
+    m++;
+  }
+
+  // Small N - a plain swap loop.
+  if(m < 2 * TILE_LOG) {
+    for(size_t i = 0; i < N; i++) {
+      const uint64_t j = bit_rev_idx(i, m);
+      if(i < j) {
+        const uint64_t tmp = a[i];
+        a[i]               = a[j];
+        a[j]               = tmp;
+      }
+    }
+    for(size_t i = 0; i < N; i++) {
+      a[i] = reduce(a[i], q, red);
+    }
+    return;
+  }
+
+  // Process the pairs (mid, rev(mid)) of middle indices together. Both tiles
+  // are fully loaded before storing, so the permutation can be done in place.
+  const uint64_t     mid_width = m - 2 * TILE_LOG;
+  ALIGN(64) uint64_t tile1[TILE * TILE];
+  ALIGN(64) uint64_t tile2[TILE * TILE];
+
+  for(size_t mid = 0; mid < (1UL << mid_width); mid++) {
+    const uint64_t rev_mid = bit_rev_idx(mid, mid_width);
+    if(mid > rev_mid) {
+      continue;
+    }
+
+    load_tile(tile1, a, mid, m);
+    if(mid == rev_mid) {
+      store_tile(a, tile1, mid, m, q, red);
+      continue;
+    }
+
+    load_tile(tile2, a, rev_mid, m);
+    store_tile(a, tile1, rev_mid, m, q, red);
+    store_tile(a, tile2, mid, m, q, red);
+  }
+}
+
+void bit_rev_in_place(uint64_t a[], const uint64_t N)
+{
+  bit_rev_reduce_in_place(a, N, 0, NO_REDUCTION);
+}
+
+void fwd_ntt_radix4_natural(uint64_t       a[],
+                            const uint64_t N,
+                            const uint64_t q,
+                            const uint64_t w[],
+                            const uint64_t w_con[])
+{
+  fwd_ntt_radix4_lazy(a, N, q, w, w_con);
+
+  // Final reduction merged with the permutation
+  bit_rev_reduce_in_place(a, N, q, REDUCE_8Q_TO_Q);
+}
+
+void inv_ntt_radix4_natural(uint64_t       a[],
+                            const uint64_t N,
+                            const uint64_t q,
+                            const mul_op_t n_inv,
+                            const uint64_t w[],
+                            const uint64_t w_con[])
+{
+  // Initial reduction merged with the permutation
+  bit_rev_reduce_in_place(a, N, q, REDUCE_8Q_TO_2Q);
+
+  inv_ntt_radix4_reduced_input(a, N, q, n_inv, w, w_con);
+}
@@ -0,0 +1,474 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ntt_nd.h"
+#include "final_reduce.h"
+#include "gvec.h"
+#include "ntt_radix4_gvec.h"
+#include "pre_compute.h"
+
+// A block of cnt strided transforms, element i of transform b is
+// a[i * stride + b * bs]. Every butterfly is applied to all the transforms of
+// the block: with bs == 1 the first vec_cnt of them are processed with
+// generic vectors whose lanes are adjacent transforms, and the remaining ones
+// with the scalar butterflies.
+typedef struct block_s {
+  uint64_t *a;
+  size_t    stride;
+  size_t    cnt;
+  size_t    bs;
+  size_t    vec_cnt;
+} block_t;
+
+// The block of transforms b..b+NTT_ND_COLUMN_BLOCK (at most count).
+static inline block_t init_block(uint64_t     a[],
+                                 const size_t stride,
+                                 const size_t count,
+                                 const size_t bs,
+                                 const size_t b)
+{
+  const size_t rem     = count - b;
+  const size_t cnt     = (rem < NTT_ND_COLUMN_BLOCK) ? rem : NTT_ND_COLUMN_BLOCK;
+  const size_t vec_cnt = (bs == 1) ? (cnt - (cnt % GVEC_LANES)) : 0;
+
+  return (block_t){
+    .a = &a[b * bs], .stride = stride, .cnt = cnt, .bs = bs, .vec_cnt = vec_cnt};
+}
+
+static inline void collect_roots(mul_op_t       roots[5],
+                                 mul_op_gvec_t  roots_vec[5],
+                                 const uint64_t w[],
+                                 const uint64_t w_con[],
+                                 const size_t   m,
+                                 const size_t   j)
+{
+  const uint64_t m1     = 2 * (m + j);
+  const uint64_t idx[5] = {m1, 2 * m1, 2 * m1 + 1, 2 * m1 + 2, 2 * m1 + 3};
+
+  for(size_t s = 0; s < 5; s++) {
+    roots[s].op      = w[idx[s]];
+    roots[s].con     = w_con[idx[s]];
+    roots_vec[s].op  = gvec_set1(w[idx[s]]);
+    roots_vec[s].con = gvec_set1(w_con[idx[s]]);
+  }
+}
+
+static inline void load4(gvec_t V[4], const uint64_t x[], const size_t d)
+{
+  V[0] = gvec_load(&x[0]);
+  V[1] = gvec_load(&x[d]);
+  V[2] = gvec_load(&x[2 * d]);
+  V[3] = gvec_load(&x[3 * d]);
+}
+
+static inline void store4(uint64_t x[], const gvec_t V[4], const size_t d)
+{
+  gvec_store(&x[0], V[0]);
+  gvec_store(&x[d], V[1]);
+  gvec_store(&x[2 * d], V[2]);
+  gvec_store(&x[3 * d], V[3]);
+}
+
+// The radix-4 butterflies of the elements i, i + t, i + 2t and i + 3t.
+static inline void fwd_rows(const block_t *     blk,
+                            const size_t        i,
+                            const size_t        t,
+                            const mul_op_t      roots[5],
+                            const mul_op_gvec_t roots_vec[5],
+                            const uint64_t      q)
+{
+  uint64_t *   x     = &blk->a[i * blk->stride];
+  const size_t d     = t * blk->stride;
+  const gvec_t q_vec = gvec_set1(q);
+  gvec_t       V[4];
+  size_t       b = 0;
+
+  for(; b < blk->vec_cnt; b += GVEC_LANES) {
+    load4(V, &x[b], d);
+    radix4_fwd_butterfly_gvec(&V[0], &V[1], &V[2], &V[3], roots_vec, q_vec);
+    store4(&x[b], V, d);
+  }
+
+  for(; b < blk->cnt; b++) {
+    uint64_t *y = &x[b * blk->bs];
+    radix4_fwd_butterfly(&y[0], &y[d], &y[2 * d], &y[3 * d], roots, q);
+  }
+}
+
+static inline void inv_rows(const block_t *     blk,
+                            const size_t        i,
+                            const size_t        t,
+                            const mul_op_t      roots[5],
+                            const mul_op_gvec_t roots_vec[5],
+                            const uint64_t      q)
+{
+  uint64_t *   x     = &blk->a[i * blk->stride];
+  const size_t d     = t * blk->stride;
+  const gvec_t q_vec = gvec_set1(q);
+  gvec_t       V[4];
+  size_t       b = 0;
+
+  for(; b < blk->vec_cnt; b += GVEC_LANES) {
+    load4(V, &x[b], d);
+    radix4_inv_butterfly_gvec(&V[0], &V[1], &V[2], &V[3], roots_vec, q_vec);
+    store4(&x[b], V, d);
+  }
+
+  for(; b < blk->cnt; b++) {
+    uint64_t *y = &x[b * blk->bs];
+    radix4_inv_butterfly(&y[0], &y[d], &y[2 * d], &y[3 * d], roots, q);
+  }
+}
+
+// The last inverse iteration, the roots are multiplied by n^-1.
+static inline void inv_rows_final(const block_t *     blk,
+                                  const size_t        i,
+                                  const size_t        t,
+                                  const mul_op_t      roots[5],
+                                  const mul_op_gvec_t roots_vec[5],
+                                  const mul_op_t      n_inv,
+                                  const uint64_t      q)
+{
+  const mul_op_gvec_t n_inv_vec = {gvec_set1(n_inv.op), gvec_set1(n_inv.con)};
+  uint64_t *          x         = &blk->a[i * blk->stride];
+  const size_t        d         = t * blk->stride;
+  const gvec_t        q_vec     = gvec_set1(q);
+  gvec_t              V[4];
+  size_t              b = 0;
+
+  for(; b < blk->vec_cnt; b += GVEC_LANES) {
+    load4(V, &x[b], d);
+    radix4_inv_butterfly_final_gvec(&V[0], &V[1], &V[2], &V[3], roots_vec,
+                                    n_inv_vec, q_vec);
+    store4(&x[b], V, d);
+  }
+
+  for(; b < blk->cnt; b++) {
+    uint64_t *y = &x[b * blk->bs];
+    radix4_inv_butterfly_final(&y[0], &y[d], &y[2 * d], &y[3 * d], roots,
+                               n_inv, q);
+  }
+}
+
+// The radix-2 iterations of odd powers on the elements i and i + 1.
+static inline void fwd_radix2_rows(const block_t *blk,
+                                   const size_t   i,
+                                   const mul_op_t w1,
+                                   const uint64_t q)
+{
+  const mul_op_gvec_t w1_vec = {gvec_set1(w1.op), gvec_set1(w1.con)};
+  uint64_t *          x      = &blk->a[i * blk->stride];
+  const size_t        d      = blk->stride;
+  const gvec_t        q_vec  = gvec_set1(q);
+  const gvec_t        q4_vec = gvec_set1(q << 2);
+  size_t              b      = 0;
+
+  for(; b < blk->vec_cnt; b += GVEC_LANES) {
+    gvec_t X = gvec_reduce_if_greater(gvec_load(&x[b]), q4_vec);
+    gvec_t Y = gvec_load(&x[b + d]);
+
+    harvey_fwd_butterfly_gvec(&X, &Y, w1_vec, q_vec);
+    gvec_store(&x[b], X);
+    gvec_store(&x[b + d], Y);
+  }
+
+  for(; b < blk->cnt; b++) {
+    uint64_t *y = &x[b * blk->bs];
+
+    y[0] = reduce_8q_to_4q(y[0], q);
+    harvey_fwd_butterfly(&y[0], &y[d], w1, q);
+  }
+}
+
+static inline void inv_radix2_rows(const block_t *blk,
+                                   const size_t   i,
+                                   const mul_op_t w1,
+                                   const uint64_t q)
+{
+  const mul_op_gvec_t w1_vec = {gvec_set1(w1.op), gvec_set1(w1.con)};
+  uint64_t *          x      = &blk->a[i * blk->stride];
+  const size_t        d      = blk->stride;
+  const gvec_t        q_vec  = gvec_set1(q);
+  size_t              b      = 0;
+
+  for(; b < blk->vec_cnt; b += GVEC_LANES) {
+    gvec_t X = gvec_load(&x[b]);
+    gvec_t Y = gvec_load(&x[b + d]);
+
+    harvey_bkw_butterfly_gvec(&X, &Y, w1_vec, q_vec);
+    gvec_store(&x[b], X);
+    gvec_store(&x[b + d], Y);
+  }
+
+  for(; b < blk->cnt; b++) {
+    uint64_t *y = &x[b * blk->bs];
+    harvey_bkw_butterfly(&y[0], &y[d], w1, q);
+  }
+}
+
+// Reduces the N elements of every transform of the block from [0, 8q) to
+// [0, q).
+static inline void
+reduce_rows(const block_t *blk, const uint64_t N, const uint64_t q)
+{
+  for(size_t i = 0; i < N; i++) {
+    uint64_t *x = &blk->a[i * blk->stride];
+
+    if(blk->bs == 1) {
+      final_reduce_q8(x, blk->cnt, q);
+      continue;
+    }
+
+    for(size_t b = 0; b < blk->cnt; b++) {
+      x[b * blk->bs] = reduce_8q_to_q(x[b * blk->bs], q);
+    }
+  }
+}
+
+// The same iterations as fwd_ntt_radix4, followed by the final reduction.
+static void fwd_block(const block_t *blk,
+                      const uint64_t N,
+                      const uint64_t q,
+                      const uint64_t w[],
+                      const uint64_t w_con[])
+{
+  const uint64_t bound_r4 = HAS_AN_EVEN_POWER(N) ? N : (N >> 1);
+  mul_op_t       roots[5];
+  mul_op_gvec_t  roots_vec[5];
+  size_t         t = N >> 2;
+
+  for(size_t m = 1; m < bound_r4; m <<= 2, t >>= 2) {
+    for(size_t j = 0; j < m; j++) {
+      const uint64_t k = 4 * t * j;
+
+      collect_roots(roots, roots_vec, w, w_con, m, j);
+      for(size_t i = k; i < k + t; i++) {
+        fwd_rows(blk, i, t, roots, roots_vec, q);
+      }
+    }
+  }
+
+  if(!HAS_AN_EVEN_POWER(N)) {
+    for(size_t i = 0; i < N; i += 2) {
+      const mul_op_t w1 = {w[N + i], w_con[N + i]};
+      fwd_radix2_rows(blk, i, w1, q);
+    }
+  }
+
+  reduce_rows(blk, N, q);
+}
+
+// The same iterations as inv_ntt_radix4_reduced_input, after the inputs are
+// reduced.
+static void inv_block(const block_t *blk,
+                      const uint64_t N,
+                      const uint64_t q,
+                      const mul_op_t n_inv,
+                      const uint64_t w[],
+                      const uint64_t w_con[])
+{
+  uint64_t      w_n[8]     = {0};
+  uint64_t      w_n_con[8] = {0};
+  mul_op_t      roots[5];
+  mul_op_gvec_t roots_vec[5];
+  size_t        t = 1;
+  size_t        m = N;
+
+  reduce_rows(blk, N, q);
+
+  if(!HAS_AN_EVEN_POWER(N)) {
+    for(size_t i = 0; i < N; i += 2) {
+      const mul_op_t w1 = {w[N + i], w_con[N + i]};
+      inv_radix2_rows(blk, i, w1, q);
+    }
+    m >>= 1;
+    t <<= 1;
+  }
+
+  for(m >>= 2; m > 1; m >>= 2, t <<= 2) {
+    for(size_t j = 0; j < m; j++) {
+      const uint64_t k = 4 * t * j;
+
+      collect_roots(roots, roots_vec, w, w_con, m, j);
+      for(size_t i = k; i < k + t; i++) {
+        inv_rows(blk, i, t, roots, roots_vec, q);
+      }
+    }
+  }
+
+  // The last iteration (m=1, t=N/4), see inv_last_layer in ntt_radix4.c.
+  calc_w_n_inv(&w_n[2], &w_n_con[2], &w[2], 6, n_inv.op, q, WORD_SIZE);
+  collect_roots(roots, roots_vec, w_n, w_n_con, 1, 0);
+  for(size_t i = 0; i < t; i++) {
+    inv_rows_final(blk, i, t, roots, roots_vec, n_inv, q);
+  }
+}
+
+void fwd_ntt_radix4_strided(uint64_t       a[],
+                            const uint64_t N,
+                            const uint64_t stride,
+                            const uint64_t count,
+                            const uint64_t batch_stride,
+                            const uint64_t q,
+                            const uint64_t w[],
+                            const uint64_t w_con[])
+{
+  if(stride == 1) {
+    for(size_t b = 0; b < count; b++) {
+      fwd_ntt_radix4_gvec(&a[b * batch_stride], N, q, w, w_con);
+    }
+    return;
+  }
+
+  for(size_t b = 0; b < count; b += NTT_ND_COLUMN_BLOCK) {
+    const block_t blk = init_block(a, stride, count, batch_stride, b);
+    fwd_block(&blk, N, q, w, w_con);
+  }
+}
+
+void inv_ntt_radix4_strided(uint64_t       a[],
+                            const uint64_t N,
+                            const uint64_t stride,
+                            const uint64_t count,
+                            const uint64_t batch_stride,
+                            const uint64_t q,
+                            const mul_op_t n_inv,
+                            const uint64_t w[],
+                            const uint64_t w_con[])
+{
+  if(stride == 1) {
+    for(size_t b = 0; b < count; b++) {
+      inv_ntt_radix4_gvec(&a[b * batch_stride], N, q, n_inv, w, w_con);
+    }
+    return;
+  }
+
+  for(size_t b = 0; b < count; b += NTT_ND_COLUMN_BLOCK) {
+    const block_t blk = init_block(a, stride, count, batch_stride, b);
+    inv_block(&blk, N, q, n_inv, w, w_con);
+  }
+}
+
+int ntt_nd_plan_init(ntt_nd_plan_t *plan,
+                     const uint64_t m[],
+                     const uint64_t d,
+                     const uint64_t q)
+{
+  size_t    qw_num = 0;
+  size_t    n_max  = 0;
+  uint64_t *w_powers;
+  uint64_t *ptr;
+
+  memset(plan, 0, sizeof(*plan));
+  if((d == 0) || (d > NTT_ND_MAX_DIMS)) {
+    return ERROR;
+  }
+  plan->d = d;
+  plan->q = q;
+
+  for(size_t k = 0; k < d; k++) {
+    // Every dimension needs N >= 4 and a 2N'th root of unity mod q.
+    if((m[k] < 2) || (m[k] >= 62) || (0 != ((q - 1) % (2UL << m[k])))) {
+      return ERROR;
+    }
+    plan->n[k] = 1UL << m[k];
+    qw_num += 8 * plan->n[k];
+    n_max = (plan->n[k] > n_max) ? plan->n[k] : n_max;
+  }
+
+  if(NULL == (ptr = aligned_alloc_qw(&plan->base, qw_num))) {
+    return ERROR;
+  }
+  if(NULL == (w_powers = malloc(n_max * sizeof(uint64_t)))) {
+    ntt_nd_plan_destroy(plan);
+    return ERROR;
+  }
+
+  for(size_t k = 0; k < d; k++) {
+    const uint64_t N = plan->n[k];
+    const uint64_t w = find_primitive_root(2 * N, q);
+
+    if(0 == w) {
+      free(w_powers);
+      ntt_nd_plan_destroy(plan);
+      return ERROR;
+    }
+
+    plan->w[k]         = &ptr[0];
+    plan->w_con[k]     = &ptr[2 * N];
+    plan->w_inv[k]     = &ptr[4 * N];
+    plan->w_inv_con[k] = &ptr[6 * N];
+    ptr += 8 * N;
+
+    calc_w(w_powers, w, N, q, m[k]);
+    expand_w(plan->w[k], w_powers, N, q);
+    calc_w_con(plan->w_con[k], plan->w[k], 2 * N, q, WORD_SIZE);
+
+    calc_w_inv(w_powers, inv_mod(w, q), N, q, m[k]);
+    expand_w(plan->w_inv[k], w_powers, N, q);
+    calc_w_con(plan->w_inv_con[k], plan->w_inv[k], 2 * N, q, WORD_SIZE);
+
+    plan->n_inv[k].op  = inv_mod(N, q);
+    plan->n_inv[k].con = calc_ninv_con(plan->n_inv[k].op, q, WORD_SIZE);
+  }
+  free(w_powers);
+
+  return SUCCESS;
+}
+
+void ntt_nd_plan_destroy(ntt_nd_plan_t *plan)
+{
+  free(plan->base);
+  plan->base = NULL;
+  for(size_t k = 0; k < NTT_ND_MAX_DIMS; k++) {
+    plan->w[k]         = NULL;
+    plan->w_con[k]     = NULL;
+    plan->w_inv[k]     = NULL;
+    plan->w_inv_con[k] = NULL;
+  }
+}
+
+// Axis k of the array is outer x n[k] x inner, the NTTs along it have stride
+// inner and the inner ones of every outer index are adjacent (batch stride 1).
+// For the last axis inner is 1 and every row is a contiguous NTT.
+void fwd_ntt_nd(const ntt_nd_plan_t *plan, uint64_t a[])
+{
+  size_t inner = 1;
+
+  for(size_t k = 0; k < plan->d; k++) {
+    inner *= plan->n[k];
+  }
+
+  for(size_t k = 0, outer = 1; k < plan->d; outer *= plan->n[k], k++) {
+    const uint64_t N = plan->n[k];
+
+    inner /= N;
+    for(size_t o = 0; o < outer; o++) {
+      fwd_ntt_radix4_strided(&a[o * N * inner], N, inner, inner, 1, plan->q,
+                             plan->w[k], plan->w_con[k]);
+    }
+  }
+}
+
+void inv_ntt_nd(const ntt_nd_plan_t *plan, uint64_t a[])
+{
+  size_t inner = 1;
+
+  for(size_t k = 0; k < plan->d; k++) {
+    inner *= plan->n[k];
+  }
+
+  for(size_t k = 0, outer = 1; k < plan->d; outer *= plan->n[k], k++) {
+    const uint64_t N = plan->n[k];
+
+    inner /= N;
+    for(size_t o = 0; o < outer; o++) {
+      inv_ntt_radix4_strided(&a[o * N * inner], N, inner, inner, 1, plan->q,
+                             plan->n_inv[k], plan->w_inv[k],
+                             plan->w_inv_con[k]);
+    }
+  }
+}
@@ -0,0 +1,254 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt_partial.h"
+#include "pre_compute.h"
+
+// The selected slots: a mask of N bits, or the range [first, last) when mask
+// is NULL.
+typedef struct slots_s {
+  const uint64_t *mask;
+  size_t          first;
+  size_t          last;
+} slots_t;
+
+// Returns whether a slot of [lo, hi) is selected.
+static inline int any_slot(const slots_t *s, const size_t lo, const size_t hi)
+{
+  if(NULL == s->mask) {
+    return (lo < s->last) && (s->first < hi);
+  }
+
+  for(size_t i = lo; i < hi; i = (i | 63) + 1) {
+    const size_t   len  = ((((i | 63) + 1) < hi) ? ((i | 63) + 1) : hi) - i;
+    const uint64_t bits = s->mask[i >> 6] >> (i & 63);
+
+    if(0 != ((len == 64) ? bits : (bits & ((1UL << len) - 1)))) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Writes the first (at most) max selected slots to idx and returns their
+// number, or max + 1 when there are more.
+static inline size_t collect_slots(size_t         idx[],
+                                   const slots_t *s,
+                                   const size_t   N,
+                                   const size_t   max)
+{
+  size_t num = 0;
+
+  if(NULL == s->mask) {
+    if((s->last - s->first) > max) {
+      return max + 1;
+    }
+    for(size_t k = s->first; k < s->last; k++) {
+      idx[num++] = k;
+    }
+    return num;
+  }
+
+  for(size_t i = 0; i < N; i += 64) {
+    for(uint64_t bits = s->mask[i >> 6]; 0 != bits; bits &= (bits - 1)) {
+      const size_t k = i + (size_t)__builtin_ctzll(bits);
+      if(k >= N) {
+        break;
+      }
+      if(num == max) {
+        return max + 1;
+      }
+      idx[num++] = k;
+    }
+  }
+  return num;
+}
+
+static inline void collect_roots(mul_op_t       w1[5],
+                                 const uint64_t w[],
+                                 const uint64_t w_con[],
+                                 const size_t   m,
+                                 const size_t   j)
+{
+  const uint64_t m1 = 2 * (m + j);
+  w1[0].op          = w[m1];
+  w1[1].op          = w[2 * m1];
+  w1[2].op          = w[2 * m1 + 1];
+  w1[3].op          = w[2 * m1 + 2];
+  w1[4].op          = w[2 * m1 + 3];
+
+  w1[0].con = w_con[m1];
+  w1[1].con = w_con[2 * m1];
+  w1[2].con = w_con[2 * m1 + 1];
+  w1[3].con = w_con[2 * m1 + 2];
+  w1[4].con = w_con[2 * m1 + 3];
+}
+
+// The cost of the pruned tree below group j of level m (a block of N/m qw),
+// in Horner steps.
+static size_t tree_cost(const slots_t *s,
+                        const size_t   N,
+                        const size_t   m,
+                        const size_t   j)
+{
+  const size_t bound_r4 = HAS_AN_EVEN_POWER(N) ? N : (N >> 1);
+  const size_t b        = N / m;
+
+  if(!any_slot(s, b * j, b * (j + 1))) {
+    return 0;
+  }
+  if(m >= bound_r4) {
+    return b >> 1;
+  }
+
+  size_t cost = (b >> 2) * NTT_PARTIAL_R4_COST;
+  for(size_t c = 0; c < 4; c++) {
+    cost += tree_cost(s, N, 4 * m, 4 * j + c);
+  }
+  return cost;
+}
+
+// Performs the butterflies of group j of level m when its block holds a
+// selected slot, and recurses into its four quarters. The last (radix-2
+// or empty) level reduces the selected slots.
+static void fwd_tree(uint64_t       a[],
+                     const slots_t *s,
+                     const uint64_t N,
+                     const uint64_t q,
+                     const uint64_t w[],
+                     const uint64_t w_con[],
+                     const size_t   m,
+                     const size_t   j)
+{
+  const size_t bound_r4 = HAS_AN_EVEN_POWER(N) ? N : (N >> 1);
+  const size_t b        = N / m;
+  const size_t k        = b * j;
+  mul_op_t     roots[5];
+
+  if(!any_slot(s, k, k + b)) {
+    return;
+  }
+
+  if(m >= bound_r4) {
+    if(b == 2) {
+      const mul_op_t w1 = {w[N + k], w_con[N + k]};
+      a[k]              = reduce_8q_to_4q(a[k], q);
+      harvey_fwd_butterfly(&a[k], &a[k + 1], w1, q);
+    }
+    for(size_t i = k; i < k + b; i++) {
+      a[i] = reduce_8q_to_q(a[i], q);
+    }
+    return;
+  }
+
+  const size_t t = b >> 2;
+
+  collect_roots(roots, w, w_con, m, j);
+  for(size_t i = k; i < k + t; i++) {
+    radix4_fwd_butterfly(&a[i], &a[i + t], &a[i + 2 * t], &a[i + 3 * t], roots,
+                         q);
+  }
+
+  for(size_t c = 0; c < 4; c++) {
+    fwd_tree(a, s, N, q, w, w_con, 4 * m, 4 * j + c);
+  }
+}
+
+// Evaluates a at the roots of the num slots of idx. A single Horner chain is
+// bound by the latency of the multiplications, so every slot runs four
+// independent chains:
+// a(x) = A_0(x^4) + x * A_1(x^4) + x^2 * A_2(x^4) + x^3 * A_3(x^4).
+// The slots are written at the end, as a is read for every slot.
+static inline void fwd_horner(uint64_t       a[],
+                              const size_t   idx[],
+                              const size_t   num,
+                              const uint64_t N,
+                              const uint64_t q,
+                              const uint64_t w[])
+{
+  // w[N] is w_rev[N/2] = psi (see expand_w).
+  const uint64_t psi   = w[N];
+  const uint64_t width = (uint64_t)__builtin_ctzll(N);
+  uint64_t       res[NTT_PARTIAL_MAX_HORNER_SLOTS];
+
+  for(size_t s = 0; s < num; s++) {
+    const uint64_t x_op  = pow_mod(psi, (2 * bit_rev_idx(idx[s], width)) + 1, q);
+    const uint64_t x4_op = pow_mod(x_op, 4, q);
+    const mul_op_t x     = {x_op, calc_ninv_con(x_op, q, WORD_SIZE)};
+    const mul_op_t x4    = {x4_op, calc_ninv_con(x4_op, q, WORD_SIZE)};
+    uint64_t       y0    = 0;
+    uint64_t       y1    = 0;
+    uint64_t       y2    = 0;
+    uint64_t       y3    = 0;
+
+    // a is reduced to [0, 2q), so the y values stay below 4q (a below 8q
+    // would take them to 10q, which overflows for q > 2^60).
+    for(size_t i = N; i > 0; i -= 4) {
+      y0 = fast_mul_mod_q2(x4, y0, q) + reduce_8q_to_2q(a[i - 4], q);
+      y1 = fast_mul_mod_q2(x4, y1, q) + reduce_8q_to_2q(a[i - 3], q);
+      y2 = fast_mul_mod_q2(x4, y2, q) + reduce_8q_to_2q(a[i - 2], q);
+      y3 = fast_mul_mod_q2(x4, y3, q) + reduce_8q_to_2q(a[i - 1], q);
+    }
+
+    y2     = fast_mul_mod_q2(x, y3, q) + y2;
+    y1     = fast_mul_mod_q2(x, y2, q) + y1;
+    y0     = fast_mul_mod_q2(x, y1, q) + y0;
+    res[s] = y0 % q;
+  }
+
+  for(size_t s = 0; s < num; s++) {
+    a[idx[s]] = res[s];
+  }
+}
+
+static void fwd_partial(uint64_t                   a[],
+                        const slots_t             *s,
+                        const uint64_t             N,
+                        const uint64_t             q,
+                        const uint64_t             w[],
+                        const uint64_t             w_con[],
+                        const ntt_partial_method_t method)
+{
+  size_t idx[NTT_PARTIAL_MAX_HORNER_SLOTS];
+  size_t num = NTT_PARTIAL_MAX_HORNER_SLOTS + 1;
+
+  if(NTT_PARTIAL_TREE != method) {
+    num = collect_slots(idx, s, N, NTT_PARTIAL_MAX_HORNER_SLOTS);
+  }
+
+  if((num <= NTT_PARTIAL_MAX_HORNER_SLOTS) &&
+     ((NTT_PARTIAL_HORNER == method) ||
+      ((num * N) < tree_cost(s, N, 1, 0)))) {
+    fwd_horner(a, idx, num, N, q, w);
+    return;
+  }
+
+  fwd_tree(a, s, N, q, w, w_con, 1, 0);
+}
+
+void fwd_ntt_radix4_partial_range(uint64_t                   a[],
+                                  const uint64_t             N,
+                                  const uint64_t             first,
+                                  const uint64_t             count,
+                                  const uint64_t             q,
+                                  const uint64_t             w[],
+                                  const uint64_t             w_con[],
+                                  const ntt_partial_method_t method)
+{
+  const slots_t s = {NULL, first, first + count};
+
+  fwd_partial(a, &s, N, q, w, w_con, method);
+}
+
+void fwd_ntt_radix4_partial_mask(uint64_t                   a[],
+                                 const uint64_t             N,
+                                 const uint64_t             mask[],
+                                 const uint64_t             q,
+                                 const uint64_t             w[],
+                                 const uint64_t             w_con[],
+                                 const ntt_partial_method_t method)
+{
+  const slots_t s = {mask, 0, 0};
+
+  fwd_partial(a, &s, N, q, w, w_con, method);
+}
@@ -3,6 +3,7 @@
 
 #include "ntt_radix4.h"
 #include "fast_mul_operators.h"
+#include "pre_compute.h"
 
 static inline void collect_roots(mul_op_t       w1[5],
                                  const uint64_t w[],
@@ -24,41 +25,298 @@ static inline void collect_roots(mul_op_t       w1[5],
   w1[4].con = w_con[2 * m1 + 3];
 }
 
+// The last inverse iteration (m=1, j=0, t=N/4). Its roots are multiplied by
+// n^-1 so that it also normalizes the results, instead of an extra pass.
+static inline void inv_last_layer(uint64_t       a[],
+                                  const uint64_t N,
+                                  const uint64_t q,
+                                  const mul_op_t n_inv,
+                                  const uint64_t w[])
+{
+  const size_t t          = N >> 2;
+  uint64_t     w_n[8]     = {0};
+  uint64_t     w_n_con[8] = {0};
+  mul_op_t     roots[5];
+
+  // The roots of group 0 in level 1 are w[2] and w[4..7].
+  calc_w_n_inv(&w_n[2], &w_n_con[2], &w[2], 6, n_inv.op, q, WORD_SIZE);
+  collect_roots(roots, w_n, w_n_con, 1, 0);
+
+  for(size_t i = 0; i < t; i++) {
+    radix4_inv_butterfly_final(&a[i], &a[i + t], &a[i + 2 * t], &a[i + 3 * t],
+                               roots, n_inv, q);
+  }
+  CHECK_BOUNDS(a, N, q, 1);
+}
+
+// Performs the radix-4 iterations from level m (with distance t), and the
+// radix-2 one when N=2^m where m is odd.
+static inline void fwd_layers(uint64_t       a[],
+                              const uint64_t N,
+                              const uint64_t q,
+                              const uint64_t w[],
+                              const uint64_t w_con[],
+                              size_t         m,
+                              size_t         t)
+{
+  const uint64_t bound_r4 = HAS_AN_EVEN_POWER(N) ? N : (N >> 1);
+  mul_op_t       roots[5];
+
+  for(; m < bound_r4; m <<= 2) {
+    for(size_t j = 0; j < m; j++) {
+      const uint64_t k = 4 * t * j;
+
+      collect_roots(roots, w, w_con, m, j);
+      for(size_t i = k; i < k + t; i++) {
+        radix4_fwd_butterfly(&a[i], &a[i + t], &a[i + 2 * t], &a[i + 3 * t],
+                             roots, q);
+      }
+    }
+    t >>= 2;
+    CHECK_BOUNDS(a, N, q, 8);
+  }
+
+  // Check whether N=2^m where m is odd.
+  // If not perform extra radix-2 iteration.
+  if(HAS_AN_EVEN_POWER(N)) {
+    return;
+  }
+
+  for(size_t i = 0; i < N; i += 2) {
+    const mul_op_t w1 = {w[N + i], w_con[N + i]};
+    a[i]              = reduce_8q_to_4q(a[i], q);
+
+    harvey_fwd_butterfly(&a[i], &a[i + 1], w1, q);
+  }
+  CHECK_BOUNDS(a, N, q, 4);
+}
+
 void fwd_ntt_radix4_lazy(uint64_t       a[],
                          const uint64_t N,
                          const uint64_t q,
                          const uint64_t w[],
                          const uint64_t w_con[])
+{
+  fwd_layers(a, N, q, w, w_con, 1, N >> 2);
+}
+
+void fwd_ntt_radix4_trunc_lazy(uint64_t       a[],
+                               const uint64_t N,
+                               const uint64_t len,
+                               const uint64_t q,
+                               const uint64_t w[],
+                               const uint64_t w_con[])
 {
   const uint64_t bound_r4 = HAS_AN_EVEN_POWER(N) ? N : (N >> 1);
+  size_t         m        = 1;
+  size_t         t        = N >> 2;
   mul_op_t       roots[5];
-  size_t         t = N >> 2;
 
-  for(size_t m = 1; m < bound_r4; m <<= 2) {
+  // Every 4t qw block starts with the len nonzero coefficients and Y, Z and T
+  // are zero, so the butterflies copy X to their four outputs.
+  for(; (m < bound_r4) && (len <= t); m <<= 2, t >>= 2) {
+    for(size_t k = 0; k < N; k += 4 * t) {
+      for(size_t i = k; i < k + len; i++) {
+        a[i + t]     = a[i];
+        a[i + 2 * t] = a[i];
+        a[i + 3 * t] = a[i];
+      }
+    }
+  }
+
+  // Z and T are zero, and so is Y from len - t on.
+  if((m < bound_r4) && (len <= 2 * t)) {
     for(size_t j = 0; j < m; j++) {
       const uint64_t k = 4 * t * j;
 
+      collect_roots(roots, w, w_con, m, j);
+      for(size_t i = k; i < k + len - t; i++) {
+        radix4_fwd_butterfly_half(&a[i], &a[i + t], &a[i + 2 * t],
+                                  &a[i + 3 * t], roots, q);
+      }
+      for(size_t i = k + len - t; i < k + t; i++) {
+        a[i + t]     = a[i];
+        a[i + 2 * t] = a[i];
+        a[i + 3 * t] = a[i];
+      }
+    }
+    m <<= 2;
+    t >>= 2;
+    CHECK_BOUNDS(a, N, q, 8);
+  }
+
+  fwd_layers(a, N, q, w, w_con, m, t);
+}
+
+void fwd_ntt_radix4_oop_lazy(uint64_t       dst[],
+                             const uint64_t src[],
+                             const uint64_t N,
+                             const uint64_t q,
+                             const uint64_t w[],
+                             const uint64_t w_con[])
+{
+  const size_t t = N >> 2;
+  mul_op_t     roots[5];
+
+  // The first iteration (m=1) reads src and writes dst. Every butterfly
+  // loads its four inputs before it stores, so dst may be src.
+  collect_roots(roots, w, w_con, 1, 0);
+  for(size_t i = 0; i < t; i++) {
+    uint64_t X = src[i];
+    uint64_t Y = src[i + t];
+    uint64_t Z = src[i + 2 * t];
+    uint64_t T = src[i + 3 * t];
+
+    radix4_fwd_butterfly(&X, &Y, &Z, &T, roots, q);
+    dst[i]         = X;
+    dst[i + t]     = Y;
+    dst[i + 2 * t] = Z;
+    dst[i + 3 * t] = T;
+  }
+  CHECK_BOUNDS(dst, N, q, 8);
+
+  fwd_layers(dst, N, q, w, w_con, 4, t >> 2);
+}
+
+// Computes the sub-transform of the 4t qw block of group j0 in level m0,
+// breadth-first, down to the last layer.
+static inline void fwd_block(uint64_t       a[],
+                             const uint64_t N,
+                             const uint64_t q,
+                             const uint64_t w[],
+                             const uint64_t w_con[],
+                             const size_t   m0,
+                             const size_t   j0,
+                             const size_t   t0)
+{
+  const uint64_t bound_r4 = HAS_AN_EVEN_POWER(N) ? N : (N >> 1);
+  const size_t   start    = 4 * t0 * j0;
+  mul_op_t       roots[5];
+
+  for(size_t m = m0, jb = j0, t = t0; m < bound_r4; m <<= 2, jb <<= 2, t >>= 2) {
+    for(size_t j = jb; j < jb + (m / m0); j++) {
+      const uint64_t k = 4 * t * j;
+
       collect_roots(roots, w, w_con, m, j);
       for(size_t i = k; i < k + t; i++) {
         radix4_fwd_butterfly(&a[i], &a[i + t], &a[i + 2 * t], &a[i + 3 * t],
                              roots, q);
       }
     }
-    t >>= 2;
+    CHECK_BOUNDS(&a[start], 4 * t0, q, 8);
   }
 
-  // Check whether N=2^m where m is odd.
-  // If not perform extra radix-2 iteration.
   if(HAS_AN_EVEN_POWER(N)) {
     return;
   }
 
-  for(size_t i = 0; i < N; i += 2) {
+  for(size_t i = start; i < start + 4 * t0; i += 2) {
     const mul_op_t w1 = {w[N + i], w_con[N + i]};
     a[i]              = reduce_8q_to_4q(a[i], q);
 
     harvey_fwd_butterfly(&a[i], &a[i + 1], w1, q);
   }
+  CHECK_BOUNDS(&a[start], 4 * t0, q, 4);
+}
+
+static void fwd_rec(uint64_t       a[],
+                    const uint64_t N,
+                    const uint64_t q,
+                    const uint64_t w[],
+                    const uint64_t w_con[],
+                    const size_t   m,
+                    const size_t   j,
+                    const size_t   t,
+                    const uint64_t base_n)
+{
+  if((4 * t) <= base_n) {
+    fwd_block(a, N, q, w, w_con, m, j, t);
+    return;
+  }
+
+  // Perform the top layer of the block and recurse into its four quarters.
+  const uint64_t k = 4 * t * j;
+  mul_op_t       roots[5];
+
+  collect_roots(roots, w, w_con, m, j);
+  for(size_t i = k; i < k + t; i++) {
+    radix4_fwd_butterfly(&a[i], &a[i + t], &a[i + 2 * t], &a[i + 3 * t], roots,
+                         q);
+  }
+
+  for(size_t c = 0; c < 4; c++) {
+    fwd_rec(a, N, q, w, w_con, 4 * m, 4 * j + c, t >> 2, base_n);
+  }
+}
+
+void fwd_ntt_radix4_rec_lazy(uint64_t       a[],
+                             const uint64_t N,
+                             const uint64_t q,
+                             const uint64_t w[],
+                             const uint64_t w_con[])
+{
+  fwd_rec(a, N, q, w, w_con, 1, 0, N >> 2, RADIX4_RECURSION_BASE_N);
+}
+
+void fwd_ntt_radix4_rec_base_lazy(uint64_t       a[],
+                                  const uint64_t N,
+                                  const uint64_t q,
+                                  const uint64_t w[],
+                                  const uint64_t w_con[],
+                                  const uint64_t base_n)
+{
+  fwd_rec(a, N, q, w, w_con, 1, 0, N >> 2, base_n);
+}
+
+// The radix-2 first iteration of an odd power N, which reduces its inputs
+// from [0, 8q) first. It reads src and writes dst, which may be src.
+static inline void inv_radix2_first_layer(uint64_t       dst[],
+                                          const uint64_t src[],
+                                          const uint64_t N,
+                                          const uint64_t q,
+                                          const uint64_t w[],
+                                          const uint64_t w_con[])
+{
+  for(size_t i = 0; i < N; i += 2) {
+    const mul_op_t w1 = {w[N + i], w_con[N + i]};
+    uint64_t       X  = reduce_8q_to_2q(src[i], q);
+    uint64_t       Y  = reduce_8q_to_2q(src[i + 1], q);
+
+    harvey_bkw_butterfly(&X, &Y, w1, q);
+    dst[i]     = X;
+    dst[i + 1] = Y;
+  }
+  CHECK_BOUNDS(dst, N, q, 2);
+}
+
+// Performs the radix-4 iterations from level m (with distance t) down to the
+// last one, which also normalizes the results.
+static inline void inv_layers(uint64_t       a[],
+                              const uint64_t N,
+                              const uint64_t q,
+                              const mul_op_t n_inv,
+                              const uint64_t w[],
+                              const uint64_t w_con[],
+                              size_t         m,
+                              size_t         t)
+{
+  mul_op_t roots[5];
+
+  for(; m > 1; m >>= 2) {
+    for(size_t j = 0; j < m; j++) {
+      const uint64_t k = 4 * t * j;
+      collect_roots(roots, w, w_con, m, j);
+
+      for(size_t i = k; i < k + t; i++) {
+        radix4_inv_butterfly(&a[i], &a[i + t], &a[i + 2 * t], &a[i + 3 * t],
+                             roots, q);
+      }
+    }
+    t <<= 2;
+    CHECK_BOUNDS(a, N, q, 2);
+  }
+
+  inv_last_layer(a, N, q, n_inv, w);
 }
 
 void inv_ntt_radix4(uint64_t       a[],
@@ -68,47 +326,180 @@ void inv_ntt_radix4(uint64_t       a[],
                     const uint64_t w[],
                     const uint64_t w_con[])
 {
-  uint64_t t = 1;
-  uint64_t m = N;
-  mul_op_t roots[5];
+  inv_ntt_radix4_oop(a, a, N, q, n_inv, w, w_con);
+}
 
-  // 1. Check whether N=2^m where m is even.
-  // If yes, reduce all values modulo 2q, this also can be done outside of this
-  // function. Otherwise, perform one radix-2 iteration.
-  if(HAS_AN_EVEN_POWER(N)) {
+void inv_ntt_radix4_oop(uint64_t       dst[],
+                        const uint64_t src[],
+                        const uint64_t N,
+                        const uint64_t q,
+                        const mul_op_t n_inv,
+                        const uint64_t w[],
+                        const uint64_t w_con[])
+{
+  CHECK_BOUNDS(src, N, q, 8);
+
+  // 1. If N=2^m where m is odd, the radix-2 iteration reduces its own inputs.
+  if(!HAS_AN_EVEN_POWER(N)) {
+    inv_radix2_first_layer(dst, src, N, q, w, w_con);
+    inv_layers(dst, N, q, n_inv, w, w_con, N >> 3, 2);
+    return;
+  }
+
+  // 2. When N=4 the first iteration is also the last one.
+  if(N == 4) {
     for(size_t i = 0; i < N; i++) {
-      a[i] = reduce_8q_to_2q(a[i], q);
+      dst[i] = reduce_8q_to_2q(src[i], q);
     }
+    inv_last_layer(dst, N, q, n_inv, w);
+    return;
+  }
+
+  // 3. Otherwise, the first radix-4 iteration (t=1) reduces its own inputs.
+  mul_op_t roots[5];
+  for(size_t j = 0; j < (N >> 2); j++) {
+    uint64_t X = src[4 * j];
+    uint64_t Y = src[4 * j + 1];
+    uint64_t Z = src[4 * j + 2];
+    uint64_t T = src[4 * j + 3];
 
-  } else {
-    // Perform the first iteration as a radix-2 iteration.
-    for(size_t i = 0; i < N; i += 2) {
+    collect_roots(roots, w, w_con, N >> 2, j);
+    radix4_inv_butterfly_first(&X, &Y, &Z, &T, roots, q);
+    dst[4 * j]     = X;
+    dst[4 * j + 1] = Y;
+    dst[4 * j + 2] = Z;
+    dst[4 * j + 3] = T;
+  }
+  CHECK_BOUNDS(dst, N, q, 2);
+
+  inv_layers(dst, N, q, n_inv, w, w_con, N >> 4, 4);
+}
+
+void inv_ntt_radix4_reduced_input(uint64_t       a[],
+                                  const uint64_t N,
+                                  const uint64_t q,
+                                  const mul_op_t n_inv,
+                                  const uint64_t w[],
+                                  const uint64_t w_con[])
+{
+  uint64_t t = 1;
+  uint64_t m = N;
+
+  CHECK_BOUNDS(a, N, q, HAS_AN_EVEN_POWER(N) ? 2 : 8);
+
+  // 1. If N=2^m where m is odd, perform one radix-2 iteration.
+  if(!HAS_AN_EVEN_POWER(N)) {
+    inv_radix2_first_layer(a, a, N, q, w, w_con);
+    m >>= 1;
+    t <<= 1;
+  }
+
+  // 2. Perform radix-4 NTT iterations, the last one also normalizes the
+  // results.
+  inv_layers(a, N, q, n_inv, w, w_con, m >> 2, t);
+}
+
+// Computes the inverse sub-transform of the 4t qw block of group j0 in level
+// m0, breadth-first, from the first layer up to level m0.
+static inline void inv_block(uint64_t       a[],
+                             const uint64_t N,
+                             const uint64_t q,
+                             const uint64_t w[],
+                             const uint64_t w_con[],
+                             const size_t   m0,
+                             const size_t   j0,
+                             const size_t   t0)
+{
+  const size_t start = 4 * t0 * j0;
+  size_t       t     = 1;
+  size_t       m     = m0 * t0;
+  mul_op_t     roots[5];
+
+  if(!HAS_AN_EVEN_POWER(N)) {
+    for(size_t i = start; i < start + 4 * t0; i += 2) {
       const mul_op_t w1 = {w[N + i], w_con[N + i]};
 
-      a[i] = reduce_8q_to_4q(a[i], q);
+      a[i]     = reduce_8q_to_2q(a[i], q);
+      a[i + 1] = reduce_8q_to_2q(a[i + 1], q);
       harvey_bkw_butterfly(&a[i], &a[i + 1], w1, q);
     }
+    CHECK_BOUNDS(&a[start], 4 * t0, q, 2);
 
     m >>= 1;
     t <<= 1;
   }
 
-  // 2. Perform radix-4 NTT iterations.
-  for(m >>= 2; m > 0; m >>= 2) {
-    for(size_t j = 0; j < m; j++) {
+  for(; m >= m0; m >>= 2, t <<= 2) {
+    const size_t jb = j0 * (m / m0);
+    for(size_t j = jb; j < jb + (m / m0); j++) {
       const uint64_t k = 4 * t * j;
       collect_roots(roots, w, w_con, m, j);
 
+      // The inputs of the first iteration (t=1) are in the range [0, 8q).
+      if(t == 1) {
+        radix4_inv_butterfly_first(&a[k], &a[k + 1], &a[k + 2], &a[k + 3],
+                                   roots, q);
+        continue;
+      }
+
       for(size_t i = k; i < k + t; i++) {
         radix4_inv_butterfly(&a[i], &a[i + t], &a[i + 2 * t], &a[i + 3 * t],
                              roots, q);
       }
     }
-    t <<= 2;
+    CHECK_BOUNDS(&a[start], 4 * t0, q, 2);
   }
+}
 
-  // 3. Normalize the results
-  for(size_t i = 0; i < N; i++) {
-    a[i] = fast_mul_mod_q(n_inv, a[i], q);
+static void inv_rec(uint64_t       a[],
+                    const uint64_t N,
+                    const uint64_t q,
+                    const uint64_t w[],
+                    const uint64_t w_con[],
+                    const size_t   m,
+                    const size_t   j,
+                    const size_t   t)
+{
+  if((4 * t) <= RADIX4_RECURSION_BASE_N) {
+    inv_block(a, N, q, w, w_con, m, j, t);
+    return;
   }
+
+  for(size_t c = 0; c < 4; c++) {
+    inv_rec(a, N, q, w, w_con, 4 * m, 4 * j + c, t >> 2);
+  }
+
+  // Perform the last layer of the block once its four quarters are done.
+  const uint64_t k = 4 * t * j;
+  mul_op_t       roots[5];
+
+  collect_roots(roots, w, w_con, m, j);
+  for(size_t i = k; i < k + t; i++) {
+    radix4_inv_butterfly(&a[i], &a[i + t], &a[i + 2 * t], &a[i + 3 * t], roots,
+                         q);
+  }
+}
+
+void inv_ntt_radix4_rec(uint64_t       a[],
+                        const uint64_t N,
+                        const uint64_t q,
+                        const mul_op_t n_inv,
+                        const uint64_t w[],
+                        const uint64_t w_con[])
+{
+  CHECK_BOUNDS(a, N, q, 8);
+
+  // A single block, the iterative variant computes it the same way.
+  if(N <= RADIX4_RECURSION_BASE_N) {
+    inv_ntt_radix4(a, N, q, n_inv, w, w_con);
+    return;
+  }
+
+  // The four quarters of the top block, then its last layer that also
+  // normalizes the results.
+  for(size_t c = 0; c < 4; c++) {
+    inv_rec(a, N, q, w, w_con, 4, c, N >> 4);
+  }
+
+  inv_last_layer(a, N, q, n_inv, w);
 }
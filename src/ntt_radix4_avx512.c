@@ -0,0 +1,396 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifdef AVX512_SUPPORT
+
+#  include "avx512_64.h"
+#  include "ntt_avx512.h"
+
+// The structure follows fwd_ntt_radix4_avx512_ifma_leaf_lazy, with 64-bit
+// multiplications instead of the 52-bit IFMA ones. The forward butterflies
+// keep their values in [0, 4q) instead of [0, 8q), so q may have 62 bits.
+// See expand_w_r4_leaf_avx512_ifma for the layout of the w-powers table.
+
+static inline void collect_roots_fwd1(mul_op_m512_t  w1[5],
+                                      const uint64_t w[],
+                                      const uint64_t w_con[],
+                                      const size_t   idx)
+{
+  w1[0].op = LOADA(&w[idx]);
+  w1[1].op = LOADA(&w[idx + 8]);
+  w1[2].op = LOADA(&w[idx + 16]);
+  w1[3].op = LOADA(&w[idx + 24]);
+  w1[4].op = LOADA(&w[idx + 32]);
+
+  w1[0].con = LOADA(&w_con[idx]);
+  w1[1].con = LOADA(&w_con[idx + 8]);
+  w1[2].con = LOADA(&w_con[idx + 16]);
+  w1[3].con = LOADA(&w_con[idx + 24]);
+  w1[4].con = LOADA(&w_con[idx + 32]);
+}
+
+static inline void collect_roots_fwd8(mul_op_m512_t  w1[5],
+                                      const uint64_t w[],
+                                      const uint64_t w_con[],
+                                      const size_t   idx)
+{
+  w1[0].op = SET1(w[idx]);
+  w1[1].op = SET1(w[idx + 1]);
+  w1[2].op = SET1(w[idx + 2]);
+  w1[3].op = SET1(w[idx + 3]);
+  w1[4].op = SET1(w[idx + 4]);
+
+  w1[0].con = SET1(w_con[idx]);
+  w1[1].con = SET1(w_con[idx + 1]);
+  w1[2].con = SET1(w_con[idx + 2]);
+  w1[3].con = SET1(w_con[idx + 3]);
+  w1[4].con = SET1(w_con[idx + 4]);
+}
+
+// The radix-4 butterflies of in[i + s*t] (s = 0..3) are stored to out, which
+// may be in.
+static inline void fwd8(uint64_t *          out,
+                        const uint64_t *    in,
+                        const size_t        i,
+                        const size_t        t,
+                        const mul_op_m512_t w[5],
+                        const uint64_t      q_64)
+{
+  __m512i X = LOAD(&in[i]);
+  __m512i Y = LOAD(&in[i + t]);
+  __m512i Z = LOAD(&in[i + 2 * t]);
+  __m512i T = LOAD(&in[i + 3 * t]);
+
+  fwd_radix4_butterfly_m512_64(&X, &Y, &Z, &T, w, q_64);
+
+  STORE(&out[i], X);
+  STORE(&out[i + t], Y);
+  STORE(&out[i + 2 * t], Z);
+  STORE(&out[i + 3 * t], T);
+}
+
+static inline void inv8(uint64_t *          X_64,
+                        uint64_t *          Y_64,
+                        uint64_t *          Z_64,
+                        uint64_t *          T_64,
+                        const mul_op_m512_t w[5],
+                        const uint64_t      q_64)
+{
+  __m512i X = LOAD(X_64);
+  __m512i Y = LOAD(Y_64);
+  __m512i Z = LOAD(Z_64);
+  __m512i T = LOAD(T_64);
+
+  inv_radix4_butterfly_m512_64(&X, &Y, &Z, &T, w, q_64);
+
+  STORE(X_64, X);
+  STORE(Y_64, Y);
+  STORE(Z_64, Z);
+  STORE(T_64, T);
+}
+
+// Performs the last two radix-4 iterations (t=4 and t=1) on a block of 128 qw.
+// Register i holds the i'th element of eight 16-qw blocks.
+// When reduce is set the outputs are reduced to [0, q), and when nt_store is
+// set they are written with non-temporal stores (out is 64-byte aligned).
+static inline void fwd128_leaf(uint64_t *     out,
+                               const uint64_t in[],
+                               const uint64_t w[],
+                               const uint64_t w_con[],
+                               const size_t   idx,
+                               const uint64_t q_64,
+                               const int      reduce,
+                               const int      nt_store)
+{
+  mul_op_m512_t roots[5];
+  __m512i       X[16];
+
+  LOOP_UNROLL_8
+  for(size_t r = 0; r < 8; r++) {
+    X[r]     = LOAD(&in[16 * r]);
+    X[r + 8] = LOAD(&in[16 * r + 8]);
+  }
+  transpose_8x8_m512(&X[0]);
+  transpose_8x8_m512(&X[8]);
+
+  // t=4
+  collect_roots_fwd1(roots, w, w_con, idx);
+  LOOP_UNROLL_4
+  for(size_t s = 0; s < 4; s++) {
+    fwd_radix4_butterfly_m512_64(&X[s], &X[s + 4], &X[s + 8], &X[s + 12], roots,
+                                 q_64);
+  }
+
+  // t=1
+  LOOP_UNROLL_4
+  for(size_t u = 0; u < 4; u++) {
+    collect_roots_fwd1(roots, w, w_con, idx + (5 * 8) * (u + 1));
+    fwd_radix4_butterfly_m512_64(&X[4 * u], &X[4 * u + 1], &X[4 * u + 2],
+                                 &X[4 * u + 3], roots, q_64);
+  }
+
+  transpose_8x8_m512(&X[0]);
+  transpose_8x8_m512(&X[8]);
+
+  if(reduce) {
+    const __m512i q  = SET1(q_64);
+    const __m512i q2 = SET1(q_64 << 1);
+
+    LOOP_UNROLL_8
+    for(size_t r = 0; r < 16; r++) {
+      X[r] = reduce_if_greater(reduce_if_greater(X[r], q2), q);
+    }
+  }
+
+  if(nt_store) {
+    LOOP_UNROLL_8
+    for(size_t r = 0; r < 8; r++) {
+      STREAM(&out[16 * r], X[r]);
+      STREAM(&out[16 * r + 8], X[r + 8]);
+    }
+    return;
+  }
+
+  LOOP_UNROLL_8
+  for(size_t r = 0; r < 8; r++) {
+    STORE(&out[16 * r], X[r]);
+    STORE(&out[16 * r + 8], X[r + 8]);
+  }
+}
+
+// The inverse of fwd128_leaf, the inputs are in the range [0, 8q) (or in
+// [0, 4q) when 8q does not fit in 64 bits) and the outputs in [0, 2q).
+static inline void inv128_leaf(uint64_t *     out,
+                               const uint64_t in[],
+                               const uint64_t w[],
+                               const uint64_t w_con[],
+                               const size_t   idx,
+                               const uint64_t q_64)
+{
+  const __m512i q2 = SET1(q_64 << 1);
+  const __m512i q4 = SET1(q_64 << 2);
+  mul_op_m512_t roots[5];
+  __m512i       X[16];
+
+  LOOP_UNROLL_8
+  for(size_t r = 0; r < 8; r++) {
+    X[r]     = LOAD(&in[16 * r]);
+    X[r + 8] = LOAD(&in[16 * r + 8]);
+  }
+  LOOP_UNROLL_8
+  for(size_t r = 0; r < 16; r++) {
+    X[r] = reduce_if_greater(reduce_if_greater(X[r], q4), q2);
+  }
+  transpose_8x8_m512(&X[0]);
+  transpose_8x8_m512(&X[8]);
+
+  // t=1
+  LOOP_UNROLL_4
+  for(size_t u = 0; u < 4; u++) {
+    collect_roots_fwd1(roots, w, w_con, idx + (5 * 8) * (u + 1));
+    inv_radix4_butterfly_m512_64(&X[4 * u], &X[4 * u + 1], &X[4 * u + 2],
+                                 &X[4 * u + 3], roots, q_64);
+  }
+
+  // t=4
+  collect_roots_fwd1(roots, w, w_con, idx);
+  LOOP_UNROLL_4
+  for(size_t s = 0; s < 4; s++) {
+    inv_radix4_butterfly_m512_64(&X[s], &X[s + 4], &X[s + 8], &X[s + 12], roots,
+                                 q_64);
+  }
+
+  transpose_8x8_m512(&X[0]);
+  transpose_8x8_m512(&X[8]);
+  LOOP_UNROLL_8
+  for(size_t r = 0; r < 8; r++) {
+    STORE(&out[16 * r], X[r]);
+    STORE(&out[16 * r + 8], X[r + 8]);
+  }
+}
+
+// The first iteration reads src and the following ones dst, see
+// fwd128_leaf for reduce and nt_store.
+static inline void fwd_oop(uint64_t       dst[],
+                           const uint64_t src[],
+                           const uint64_t N,
+                           const uint64_t q,
+                           const uint64_t w[],
+                           const uint64_t w_con[],
+                           const int      reduce,
+                           const int      nt_store)
+{
+  const uint64_t *in = src;
+  mul_op_m512_t   roots[5];
+  size_t          t   = N >> 1;
+  size_t          m   = 1;
+  size_t          idx = 1;
+
+  // Check whether N=2^m where m is odd.
+  // If not perform extra radix-2 iteration.
+  if(!HAS_AN_EVEN_POWER(N)) {
+    const mul_op_m512_t w1 = {SET1(w[1]), SET1(w_con[1])};
+
+    for(size_t j = 0; j < t; j += 8) {
+      __m512i X = LOAD(&in[j]);
+      __m512i Y = LOAD(&in[j + t]);
+
+      fwd_radix2_butterfly_m512_64(&X, &Y, &w1, q);
+
+      STORE(&dst[j], X);
+      STORE(&dst[j + t], Y);
+    }
+    in = dst;
+    t >>= 1;
+    m <<= 1;
+    idx++;
+  }
+
+  // Adjust to radix-4
+  t >>= 1;
+
+  for(; t >= 8; m <<= 2, t >>= 2) {
+    for(size_t j = 0; j < m; j++, idx += 5) {
+      const uint64_t k = 4 * t * j;
+      collect_roots_fwd8(roots, w, w_con, idx);
+      for(size_t i = k; i < k + t; i += 8) {
+        fwd8(dst, in, i, t, roots, q);
+      }
+    }
+    in = dst;
+  }
+
+  // Align on an 8-qw boundary, every leaf uses 25 vectors of roots.
+  idx = ((idx >> 3) << 3) + 8;
+  for(size_t j = 0; j < N; j += 128, idx += 25 * 8) {
+    fwd128_leaf(&dst[j], &in[j], w, w_con, idx, q, reduce, nt_store);
+  }
+
+  if(nt_store) {
+    SFENCE();
+  }
+}
+
+void fwd_ntt_radix4_avx512_lazy(uint64_t       a[],
+                                const uint64_t N,
+                                const uint64_t q,
+                                const uint64_t w[],
+                                const uint64_t w_con[])
+{
+  fwd_oop(a, a, N, q, w, w_con, 0, 0);
+}
+
+void fwd_ntt_radix4_avx512_oop_lazy(uint64_t       dst[],
+                                    const uint64_t src[],
+                                    const uint64_t N,
+                                    const uint64_t q,
+                                    const uint64_t w[],
+                                    const uint64_t w_con[],
+                                    const int      nt_store)
+{
+  fwd_oop(dst, src, N, q, w, w_con, 0, nt_store && IS_ALIGNED_64(dst));
+}
+
+void fwd_ntt_radix4_avx512_oop(uint64_t       dst[],
+                               const uint64_t src[],
+                               const uint64_t N,
+                               const uint64_t q,
+                               const uint64_t w[],
+                               const uint64_t w_con[],
+                               const int      nt_store)
+{
+  fwd_oop(dst, src, N, q, w, w_con, 1, nt_store && IS_ALIGNED_64(dst));
+}
+
+void inv_ntt_radix4_avx512(uint64_t       a[],
+                           const uint64_t N,
+                           const uint64_t q,
+                           const mul_op_t n_inv,
+                           const uint64_t w[],
+                           const uint64_t w_con[])
+{
+  inv_ntt_radix4_avx512_oop(a, a, N, q, n_inv, w, w_con, 0);
+}
+
+void inv_ntt_radix4_avx512_oop(uint64_t       dst[],
+                               const uint64_t src[],
+                               const uint64_t N,
+                               const uint64_t q,
+                               const mul_op_t n_inv,
+                               const uint64_t w[],
+                               const uint64_t w_con[],
+                               const int      nt_store)
+{
+  mul_op_m512_t roots[5];
+  size_t        lvl_idx[WORD_SIZE];
+  size_t        lvl_num = 0;
+  size_t        t       = N >> 2;
+  size_t        m       = 1;
+  size_t        idx     = 1;
+
+  if(!HAS_AN_EVEN_POWER(N)) {
+    t >>= 1;
+    m <<= 1;
+    idx++;
+  }
+
+  // The roots of the levels are stored top-down (see the forward transform).
+  for(; t >= 8; m <<= 2, t >>= 2) {
+    lvl_idx[lvl_num++] = idx;
+    idx += 5 * m;
+  }
+
+  // The leaves are the first iterations, they read src.
+  idx = ((idx >> 3) << 3) + 8;
+  for(size_t j = 0; j < N; j += 128, idx += 25 * 8) {
+    inv128_leaf(&dst[j], &src[j], w, w_con, idx, q);
+  }
+
+  while(lvl_num-- > 0) {
+    m >>= 2;
+    t <<= 2;
+    for(size_t j = 0; j < m; j++) {
+      const uint64_t k = 4 * t * j;
+      collect_roots_fwd8(roots, w, w_con, lvl_idx[lvl_num] + 5 * j);
+      for(size_t i = k; i < k + t; i += 8) {
+        inv8(&dst[i], &dst[i + t], &dst[i + 2 * t], &dst[i + 3 * t], roots, q);
+      }
+    }
+  }
+
+  if(!HAS_AN_EVEN_POWER(N)) {
+    const mul_op_m512_t w1   = {SET1(w[1]), SET1(w_con[1])};
+    const size_t        half = N >> 1;
+
+    for(size_t j = 0; j < half; j += 8) {
+      __m512i X = LOAD(&dst[j]);
+      __m512i Y = LOAD(&dst[j + half]);
+
+      inv_radix2_butterfly_m512_64(&X, &Y, &w1, q);
+
+      STORE(&dst[j], X);
+      STORE(&dst[j + half], Y);
+    }
+  }
+
+  // Normalize the results
+  const mul_op_m512_t n_inv_m512 = {SET1(n_inv.op), SET1(n_inv.con)};
+  const __m512i       q_m512     = SET1(q);
+
+  if(nt_store && IS_ALIGNED_64(dst)) {
+    for(size_t i = 0; i < N; i += 8) {
+      const __m512i X =
+        fast_mul_mod_q2_m512_64(n_inv_m512, LOAD(&dst[i]), q_m512);
+      STREAM(&dst[i], reduce_if_greater(X, q_m512));
+    }
+    SFENCE();
+    return;
+  }
+
+  for(size_t i = 0; i < N; i += 8) {
+    const __m512i X = fast_mul_mod_q2_m512_64(n_inv_m512, LOAD(&dst[i]), q_m512);
+    STORE(&dst[i], reduce_if_greater(X, q_m512));
+  }
+}
+
+#endif
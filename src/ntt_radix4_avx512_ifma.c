@@ -3,6 +3,8 @@
 
 #ifdef AVX512_IFMA_SUPPORT
 
+#  include <string.h>
+
 #  include "ntt_avx512_ifma.h"
 
 static inline void collect_roots_fwd1(mul_op_m512_t  w1[5],
@@ -109,37 +111,103 @@ fwd4(uint64_t *a, const mul_op_m512_t w[5], const uint64_t q_64)
   STORE(&a[24], T1);
 }
 
-static inline void fwd8(uint64_t *          X_64,
-                        uint64_t *          Y_64,
-                        uint64_t *          Z_64,
-                        uint64_t *          T_64,
+// The radix-4 butterflies of in[i + s*t] (s = 0..3) are stored to out, which
+// may be in.
+static inline void fwd8(uint64_t *          out,
+                        const uint64_t *    in,
+                        const size_t        i,
+                        const size_t        t,
                         const mul_op_m512_t w[5],
                         const uint64_t      q_64)
 {
-  __m512i X = LOAD(X_64);
-  __m512i Y = LOAD(Y_64);
-  __m512i Z = LOAD(Z_64);
-  __m512i T = LOAD(T_64);
+  __m512i X = LOAD(&in[i]);
+  __m512i Y = LOAD(&in[i + t]);
+  __m512i Z = LOAD(&in[i + 2 * t]);
+  __m512i T = LOAD(&in[i + 3 * t]);
 
   fwd_radix4_butterfly_m512(&X, &Y, &Z, &T, w, q_64);
 
-  STORE(X_64, X);
-  STORE(Y_64, Y);
-  STORE(Z_64, Z);
-  STORE(T_64, T);
+  STORE(&out[i], X);
+  STORE(&out[i + t], Y);
+  STORE(&out[i + 2 * t], Z);
+  STORE(&out[i + 3 * t], T);
 }
 
-void fwd_ntt_radix4_avx512_ifma_lazy(uint64_t       a[],
-                                     const uint64_t N,
-                                     const uint64_t q,
-                                     const uint64_t w[],
-                                     const uint64_t w_con[])
+// Performs the last two radix-4 iterations (t=4 and t=1) on a block of 128 qw.
+// The block is loaded once and transposed (two 8x8 transposes), so that
+// register i holds the i'th element of eight 16-qw blocks. When nt_store is
+// set the block is written back with non-temporal stores (a is 64-byte
+// aligned).
+static inline void fwd128_leaf(uint64_t *     a,
+                               const uint64_t w[],
+                               const uint64_t w_con[],
+                               size_t *       idx,
+                               const uint64_t q_64,
+                               const int      nt_store)
 {
   mul_op_m512_t roots[5];
-  size_t        bound_r4 = N;
-  size_t        t        = N >> 1;
-  size_t        m        = 1;
-  size_t        idx      = 1;
+  __m512i       X[16];
+
+  LOOP_UNROLL_8
+  for(size_t r = 0; r < 8; r++) {
+    X[r]     = LOAD(&a[16 * r]);
+    X[r + 8] = LOAD(&a[16 * r + 8]);
+  }
+  transpose_8x8_m512(&X[0]);
+  transpose_8x8_m512(&X[8]);
+
+  // t=4
+  collect_roots_fwd1(roots, w, w_con, idx);
+  LOOP_UNROLL_4
+  for(size_t s = 0; s < 4; s++) {
+    fwd_radix4_butterfly_m512(&X[s], &X[s + 4], &X[s + 8], &X[s + 12], roots,
+                              q_64);
+  }
+
+  // t=1
+  LOOP_UNROLL_4
+  for(size_t u = 0; u < 4; u++) {
+    collect_roots_fwd1(roots, w, w_con, idx);
+    fwd_radix4_butterfly_m512(&X[4 * u], &X[4 * u + 1], &X[4 * u + 2],
+                              &X[4 * u + 3], roots, q_64);
+  }
+
+  transpose_8x8_m512(&X[0]);
+  transpose_8x8_m512(&X[8]);
+
+  if(nt_store) {
+    LOOP_UNROLL_8
+    for(size_t r = 0; r < 8; r++) {
+      STREAM(&a[16 * r], X[r]);
+      STREAM(&a[16 * r + 8], X[r + 8]);
+    }
+    return;
+  }
+
+  LOOP_UNROLL_8
+  for(size_t r = 0; r < 8; r++) {
+    STORE(&a[16 * r], X[r]);
+    STORE(&a[16 * r + 8], X[r + 8]);
+  }
+}
+
+// The first iteration reads src and the following ones a, which may be src.
+// nt_store applies to the leaf pass only (see fwd128_leaf).
+static inline void _fwd_ntt_radix4_avx512_ifma_lazy(uint64_t       a[],
+                                                    const uint64_t src[],
+                                                    const uint64_t N,
+                                                    const uint64_t q,
+                                                    const uint64_t w[],
+                                                    const uint64_t w_con[],
+                                                    const int      use_leaf,
+                                                    const int      nt_store)
+{
+  const uint64_t *in = src;
+  mul_op_m512_t   roots[5];
+  size_t          bound_r4 = N;
+  size_t          t        = N >> 1;
+  size_t          m        = 1;
+  size_t          idx      = 1;
 
   // Check whether N=2^m where m is odd.
   // If not perform extra radix-2 iteration.
@@ -147,14 +215,15 @@ void fwd_ntt_radix4_avx512_ifma_lazy(uint64_t       a[],
     const mul_op_m512_t w1 = {SET1(w[1]), SET1(w_con[1])};
 
     for(size_t j = 0; j < t; j += 8) {
-      __m512i X = LOAD(&a[j]);
-      __m512i Y = LOAD(&a[j + t]);
+      __m512i X = LOAD(&in[j]);
+      __m512i Y = LOAD(&in[j + t]);
 
       fwd_radix2_butterfly_m512(&X, &Y, &w1, q);
 
       STORE(&a[j], X);
       STORE(&a[j + t], Y);
     }
+    in = a;
     bound_r4 >>= 1;
     t >>= 1;
     m <<= 1;
@@ -164,15 +233,33 @@ void fwd_ntt_radix4_avx512_ifma_lazy(uint64_t       a[],
   // Adjust to radix-4
   t >>= 1;
 
+  // The in-place iterations below run only for N < 32 when no earlier one
+  // read src.
+  if((t < 8) && (in != a)) {
+    memcpy(a, in, N * sizeof(uint64_t));
+  }
+
   for(; m < bound_r4; m <<= 2) {
     if(t >= 8) {
       for(size_t j = 0; j < m; j++) {
         const uint64_t k = 4 * t * j;
         collect_roots_fwd8(roots, w, w_con, &idx);
         for(size_t i = k; i < k + t; i += 8) {
-          fwd8(&a[i], &a[i + t], &a[i + 2 * t], &a[i + 3 * t], roots, q);
+          fwd8(a, in, i, t, roots, q);
         }
       }
+      in = a;
+    } else if(use_leaf) {
+      // The last two iterations (t=4 and t=1) in a single pass.
+      idx = ((idx >> 3) << 3) + 8;
+
+      for(size_t j = 0; j < N; j += 128) {
+        fwd128_leaf(&a[j], w, w_con, &idx, q, nt_store);
+      }
+      if(nt_store) {
+        SFENCE();
+      }
+      return;
     } else if(t == 4) {
       for(size_t j = 0; j < m; j += 2) {
         collect_roots_fwd4(roots, w, w_con, &idx);
@@ -192,4 +279,165 @@ void fwd_ntt_radix4_avx512_ifma_lazy(uint64_t       a[],
   }
 }
 
+void fwd_ntt_radix4_avx512_ifma_lazy(uint64_t       a[],
+                                     const uint64_t N,
+                                     const uint64_t q,
+                                     const uint64_t w[],
+                                     const uint64_t w_con[])
+{
+  _fwd_ntt_radix4_avx512_ifma_lazy(a, a, N, q, w, w_con, 0, 0);
+}
+
+void fwd_ntt_radix4_avx512_ifma_oop_lazy(uint64_t       dst[],
+                                         const uint64_t src[],
+                                         const uint64_t N,
+                                         const uint64_t q,
+                                         const uint64_t w[],
+                                         const uint64_t w_con[])
+{
+  _fwd_ntt_radix4_avx512_ifma_lazy(dst, src, N, q, w, w_con, 0, 0);
+}
+
+void fwd_ntt_radix4_avx512_ifma_leaf_lazy(uint64_t       a[],
+                                          const uint64_t N,
+                                          const uint64_t q,
+                                          const uint64_t w[],
+                                          const uint64_t w_con[])
+{
+  _fwd_ntt_radix4_avx512_ifma_lazy(a, a, N, q, w, w_con,
+                                   N >= RADIX4_AVX512_IFMA_LEAF_MIN_N, 0);
+}
+
+void fwd_ntt_radix4_avx512_ifma_leaf_oop_lazy(uint64_t       dst[],
+                                              const uint64_t src[],
+                                              const uint64_t N,
+                                              const uint64_t q,
+                                              const uint64_t w[],
+                                              const uint64_t w_con[],
+                                              const int      nt_store)
+{
+  _fwd_ntt_radix4_avx512_ifma_lazy(dst, src, N, q, w, w_con,
+                                   N >= RADIX4_AVX512_IFMA_LEAF_MIN_N,
+                                   nt_store && IS_ALIGNED_64(dst));
+}
+
+// Computes the sub-transform of the 4t qw block of group j in level m.
+// Level m's roots start at w[lvl_idx] and the leaf roots at w[leaf_idx]
+// (see expand_w_r4_leaf_avx512_ifma).
+static void fwd_rec(uint64_t       a[],
+                    const uint64_t q,
+                    const uint64_t w[],
+                    const uint64_t w_con[],
+                    const size_t   m,
+                    const size_t   j,
+                    const size_t   t,
+                    const size_t   lvl_idx,
+                    const size_t   leaf_idx,
+                    const uint64_t base_n)
+{
+  mul_op_m512_t roots[5];
+  size_t        idx;
+
+  // The quarters must hold at least one leaf block.
+  if(((4 * t) > base_n) && (t >= 128)) {
+    // Perform the top layer of the block and recurse into its four quarters.
+    const uint64_t k = 4 * t * j;
+
+    idx = lvl_idx + 5 * j;
+    collect_roots_fwd8(roots, w, w_con, &idx);
+    for(size_t i = k; i < k + t; i += 8) {
+      fwd8(a, a, i, t, roots, q);
+    }
+
+    for(size_t c = 0; c < 4; c++) {
+      fwd_rec(a, q, w, w_con, 4 * m, 4 * j + c, t >> 2, lvl_idx + 5 * m,
+              leaf_idx, base_n);
+    }
+    return;
+  }
+
+  size_t lvl = lvl_idx;
+  size_t mm  = m;
+  size_t jb  = j;
+  size_t tt  = t;
+  for(; tt >= 8; lvl += 5 * mm, mm <<= 2, jb <<= 2, tt >>= 2) {
+    for(size_t jj = jb; jj < jb + (mm / m); jj++) {
+      const uint64_t k = 4 * tt * jj;
+
+      idx = lvl + 5 * jj;
+      collect_roots_fwd8(roots, w, w_con, &idx);
+      for(size_t i = k; i < k + tt; i += 8) {
+        fwd8(a, a, i, tt, roots, q);
+      }
+    }
+  }
+
+  // Each 128-qw leaf block consumes 25 vectors of roots.
+  for(size_t i = 4 * t * j; i < 4 * t * (j + 1); i += 128) {
+    idx = leaf_idx + (i / 128) * 25 * 8;
+    fwd128_leaf(&a[i], w, w_con, &idx, q, 0);
+  }
+}
+
+void fwd_ntt_radix4_avx512_ifma_rec_lazy(uint64_t       a[],
+                                         const uint64_t N,
+                                         const uint64_t q,
+                                         const uint64_t w[],
+                                         const uint64_t w_con[])
+{
+  fwd_ntt_radix4_avx512_ifma_rec_base_lazy(a, N, q, w, w_con,
+                                           RADIX4_RECURSION_BASE_N);
+}
+
+void fwd_ntt_radix4_avx512_ifma_rec_base_lazy(uint64_t       a[],
+                                              const uint64_t N,
+                                              const uint64_t q,
+                                              const uint64_t w[],
+                                              const uint64_t w_con[],
+                                              const uint64_t base_n)
+{
+  // Small N are computed breadth-first, also when N/2 does not hold a
+  // leaf block.
+  if((N <= base_n) || (N < 256) ||
+     (N < RADIX4_AVX512_IFMA_LEAF_MIN_N)) {
+    _fwd_ntt_radix4_avx512_ifma_lazy(a, a, N, q, w, w_con,
+                                     N >= RADIX4_AVX512_IFMA_LEAF_MIN_N, 0);
+    return;
+  }
+
+  size_t m   = 1;
+  size_t t   = N >> 2;
+  size_t idx = 1;
+
+  // Check whether N=2^m where m is odd.
+  // If not perform extra radix-2 iteration.
+  if(!HAS_AN_EVEN_POWER(N)) {
+    const mul_op_m512_t w1 = {SET1(w[1]), SET1(w_con[1])};
+
+    for(size_t j = 0; j < (N >> 1); j += 8) {
+      __m512i X = LOAD(&a[j]);
+      __m512i Y = LOAD(&a[j + (N >> 1)]);
+
+      fwd_radix2_butterfly_m512(&X, &Y, &w1, q);
+
+      STORE(&a[j], X);
+      STORE(&a[j + (N >> 1)], Y);
+    }
+    m <<= 1;
+    t >>= 1;
+    idx++;
+  }
+
+  // The leaf roots follow the (aligned) roots of the t >= 8 levels.
+  size_t leaf_idx = idx;
+  for(size_t mm = m, tt = t; tt >= 8; mm <<= 2, tt >>= 2) {
+    leaf_idx += 5 * mm;
+  }
+  leaf_idx = ((leaf_idx >> 3) << 3) + 8;
+
+  for(size_t j = 0; j < m; j++) {
+    fwd_rec(a, q, w, w_con, m, j, t, idx, leaf_idx, base_n);
+  }
+}
+
 #endif
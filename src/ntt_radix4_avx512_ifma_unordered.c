@@ -124,6 +124,73 @@ static inline void fwd8(uint64_t *          X_64,
   STORE(T_64, T);
 }
 
+// The inverse of fwd1 followed by the inverse of fwd4 on a block of 32 qw.
+// The input is in the permuted order of fwd1 and in the range [0, 8q). Instead
+// of scattering the t=1 results back to memory (as fwd1 gathers them), the
+// block is transposed in registers to the layout of fwd4. The t=4 results are
+// then shuffled back to their natural order.
+static inline void inv32(uint64_t *          a,
+                         const mul_op_m512_t w1[5],
+                         const mul_op_m512_t w4[5],
+                         const uint64_t      q_64)
+{
+  const __m512i q2 = SET1(q_64 << 1);
+  const __m512i q4 = SET1(q_64 << 2);
+
+  __m512i X = reduce_if_greater(reduce_if_greater(LOAD(&a[0]), q4), q2);
+  __m512i Y = reduce_if_greater(reduce_if_greater(LOAD(&a[8]), q4), q2);
+  __m512i Z = reduce_if_greater(reduce_if_greater(LOAD(&a[16]), q4), q2);
+  __m512i T = reduce_if_greater(reduce_if_greater(LOAD(&a[24]), q4), q2);
+
+  // t=1
+  inv_radix4_butterfly_m512(&X, &Y, &Z, &T, w1, q_64);
+
+  // Lane 4h+r of the i'th register of fwd4 is lane 2i+h of the r'th register
+  // of fwd1, e.g. X = (X0, Y0, Z0, T0, X1, Y1, Z1, T1).
+  const __m512i XY_lo = _mm512_unpacklo_epi64(X, Y);
+  const __m512i XY_hi = _mm512_unpackhi_epi64(X, Y);
+  const __m512i ZT_lo = _mm512_unpacklo_epi64(Z, T);
+  const __m512i ZT_hi = _mm512_unpackhi_epi64(Z, T);
+
+  const __m512i P0 = SHUF(XY_lo, ZT_lo, 0x44);
+  const __m512i P1 = SHUF(XY_hi, ZT_hi, 0x44);
+  const __m512i P2 = SHUF(XY_lo, ZT_lo, 0xee);
+  const __m512i P3 = SHUF(XY_hi, ZT_hi, 0xee);
+
+  X = SHUF(P0, P1, 0x88);
+  Y = SHUF(P0, P1, 0xdd);
+  Z = SHUF(P2, P3, 0x88);
+  T = SHUF(P2, P3, 0xdd);
+
+  // t=4
+  inv_radix4_butterfly_m512(&X, &Y, &Z, &T, w4, q_64);
+
+  STORE(&a[0], SHUF(X, Y, 0x44));
+  STORE(&a[8], SHUF(Z, T, 0x44));
+  STORE(&a[16], SHUF(X, Y, 0xee));
+  STORE(&a[24], SHUF(Z, T, 0xee));
+}
+
+static inline void inv8(uint64_t *          X_64,
+                        uint64_t *          Y_64,
+                        uint64_t *          Z_64,
+                        uint64_t *          T_64,
+                        const mul_op_m512_t w[5],
+                        const uint64_t      q_64)
+{
+  __m512i X = LOAD(X_64);
+  __m512i Y = LOAD(Y_64);
+  __m512i Z = LOAD(Z_64);
+  __m512i T = LOAD(T_64);
+
+  inv_radix4_butterfly_m512(&X, &Y, &Z, &T, w, q_64);
+
+  STORE(X_64, X);
+  STORE(Y_64, Y);
+  STORE(Z_64, Z);
+  STORE(T_64, T);
+}
+
 void fwd_ntt_radix4_avx512_ifma_lazy_unordered(uint64_t       a[],
                                                const uint64_t N,
                                                const uint64_t q,
@@ -189,4 +256,116 @@ void fwd_ntt_radix4_avx512_ifma_lazy_unordered(uint64_t       a[],
   }
 }
 
+void inv_ntt_radix4_avx512_ifma_unordered(uint64_t       a[],
+                                          const uint64_t N,
+                                          const uint64_t q,
+                                          const mul_op_t n_inv,
+                                          const uint64_t w[],
+                                          const uint64_t w_con[])
+{
+  mul_op_m512_t roots[5];
+  mul_op_m512_t roots4[5];
+  size_t        lvl_idx[WORD_SIZE];
+  size_t        lvl_num = 0;
+  size_t        t       = N >> 2;
+  size_t        m       = 1;
+  size_t        idx     = 1;
+
+  if(!HAS_AN_EVEN_POWER(N)) {
+    t >>= 1;
+    m <<= 1;
+    idx++;
+  }
+
+  // The roots of the levels are stored top-down (see the forward transform).
+  for(; t >= 8; m <<= 2, t >>= 2) {
+    lvl_idx[lvl_num++] = idx;
+    idx += 5 * m;
+  }
+
+  // The roots of t=4, followed by those of t=1 (on an 8-qw boundary).
+  size_t idx4 = idx;
+  idx         = (((idx + 5 * m) >> 3) << 3) + 8;
+
+  // 1. The t=1 and t=4 iterations, the output is in the natural order.
+  for(size_t j = 0; j < N; j += 32) {
+    collect_roots_fwd1(roots, w, w_con, &idx);
+    collect_roots_fwd4(roots4, w, w_con, &idx4);
+    inv32(&a[j], roots, roots4, q);
+  }
+
+  // 2. The rest of the radix-4 iterations.
+  while(lvl_num-- > 0) {
+    m >>= 2;
+    t <<= 2;
+    idx = lvl_idx[lvl_num];
+    for(size_t j = 0; j < m; j++) {
+      const uint64_t k = 4 * t * j;
+      collect_roots_fwd8(roots, w, w_con, &idx);
+      for(size_t i = k; i < k + t; i += 8) {
+        inv8(&a[i], &a[i + t], &a[i + 2 * t], &a[i + 3 * t], roots, q);
+      }
+    }
+  }
+
+  // 3. Perform the extra radix-2 iteration if needed.
+  if(!HAS_AN_EVEN_POWER(N)) {
+    const mul_op_m512_t w1   = {SET1(w[1]), SET1(w_con[1])};
+    const size_t        half = N >> 1;
+
+    for(size_t j = 0; j < half; j += 8) {
+      __m512i X = LOAD(&a[j]);
+      __m512i Y = LOAD(&a[j + half]);
+
+      inv_radix2_butterfly_m512(&X, &Y, &w1, q);
+
+      STORE(&a[j], X);
+      STORE(&a[j + half], Y);
+    }
+  }
+
+  // 4. Normalize the results
+  const mul_op_m512_t n_inv_m512 = {SET1(n_inv.op), SET1(n_inv.con)};
+  const __m512i       neg_q      = SET1(-1 * q);
+  const __m512i       q_m512     = SET1(q);
+
+  for(size_t i = 0; i < N; i += 8) {
+    const __m512i X = fast_mul_mod_q2_m512(n_inv_m512, LOAD(&a[i]), neg_q);
+    STORE(&a[i], reduce_if_greater(X, q_m512));
+  }
+}
+
+// The pointwise operations are order-agnostic, so they apply directly to the
+// permuted output of fwd_ntt_radix4_avx512_ifma_lazy_unordered.
+
+void pointwise_mul_avx512_ifma(uint64_t       a[],
+                               const uint64_t b[],
+                               const uint64_t b_con[],
+                               const uint64_t N,
+                               const uint64_t q)
+{
+  const __m512i neg_q = SET1(-1 * q);
+
+  LOOP_UNROLL_4
+  for(size_t i = 0; i < N; i += 8) {
+    const mul_op_m512_t B = {LOAD(&b[i]), LOAD(&b_con[i])};
+    STORE(&a[i], fast_mul_mod_q2_m512(B, LOAD(&a[i]), neg_q));
+  }
+}
+
+void pointwise_add_avx512_ifma(uint64_t       a[],
+                               const uint64_t b[],
+                               const uint64_t N,
+                               const uint64_t q)
+{
+  const __m512i q4 = SET1(q << 2);
+
+  LOOP_UNROLL_4
+  for(size_t i = 0; i < N; i += 8) {
+    const __m512i A = reduce_if_greater(LOAD(&a[i]), q4);
+    const __m512i B = reduce_if_greater(LOAD(&b[i]), q4);
+    STORE(&a[i], ADD(A, B));
+  }
+}
+
 #endif
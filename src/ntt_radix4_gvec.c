@@ -0,0 +1,312 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt_radix4_gvec.h"
+#include "gvec.h"
+#include "ntt_radix4.h"
+#include "pre_compute.h"
+
+// Lane l of a vector handles the butterfly at offset (l % t) of group
+// (j + l / t). When t >= GVEC_LANES, all the lanes belong to group j, the
+// roots are broadcast and the coefficients are loaded directly. Otherwise,
+// GVEC_LANES / t groups are processed together and the coefficients are
+// gathered lane by lane.
+
+static inline void collect_roots(mul_op_gvec_t  roots[5],
+                                 const uint64_t w[],
+                                 const uint64_t w_con[],
+                                 const size_t   m,
+                                 const size_t   j,
+                                 const size_t   t)
+{
+  uint64_t op[5][GVEC_LANES];
+  uint64_t con[5][GVEC_LANES];
+
+  for(size_t l = 0; l < GVEC_LANES; l++) {
+    const uint64_t m1 = 2 * (m + j + (l / t));
+
+    op[0][l] = w[m1];
+    op[1][l] = w[2 * m1];
+    op[2][l] = w[2 * m1 + 1];
+    op[3][l] = w[2 * m1 + 2];
+    op[4][l] = w[2 * m1 + 3];
+
+    con[0][l] = w_con[m1];
+    con[1][l] = w_con[2 * m1];
+    con[2][l] = w_con[2 * m1 + 1];
+    con[3][l] = w_con[2 * m1 + 2];
+    con[4][l] = w_con[2 * m1 + 3];
+  }
+
+  for(size_t s = 0; s < 5; s++) {
+    roots[s].op  = gvec_load(op[s]);
+    roots[s].con = gvec_load(con[s]);
+  }
+}
+
+static inline void gather(gvec_t         V[4],
+                          const uint64_t a[],
+                          const size_t   k,
+                          const size_t   t)
+{
+  uint64_t tmp[4][GVEC_LANES];
+
+  for(size_t l = 0; l < GVEC_LANES; l++) {
+    const size_t i = k + (4 * t * (l / t)) + (l % t);
+
+    tmp[0][l] = a[i];
+    tmp[1][l] = a[i + t];
+    tmp[2][l] = a[i + 2 * t];
+    tmp[3][l] = a[i + 3 * t];
+  }
+
+  for(size_t s = 0; s < 4; s++) {
+    V[s] = gvec_load(tmp[s]);
+  }
+}
+
+static inline void
+scatter(uint64_t a[], const gvec_t V[4], const size_t k, const size_t t)
+{
+  uint64_t tmp[4][GVEC_LANES];
+
+  for(size_t s = 0; s < 4; s++) {
+    gvec_store(tmp[s], V[s]);
+  }
+
+  for(size_t l = 0; l < GVEC_LANES; l++) {
+    const size_t i = k + (4 * t * (l / t)) + (l % t);
+
+    a[i]         = tmp[0][l];
+    a[i + t]     = tmp[1][l];
+    a[i + 2 * t] = tmp[2][l];
+    a[i + 3 * t] = tmp[3][l];
+  }
+}
+
+static inline void fwd_layer(uint64_t       a[],
+                             const uint64_t w[],
+                             const uint64_t w_con[],
+                             const size_t   m,
+                             const size_t   t,
+                             const gvec_t   q)
+{
+  mul_op_gvec_t roots[5];
+  gvec_t        V[4];
+
+  if(t < GVEC_LANES) {
+    for(size_t j = 0; j < m; j += GVEC_LANES / t) {
+      collect_roots(roots, w, w_con, m, j, t);
+      gather(V, a, 4 * t * j, t);
+      radix4_fwd_butterfly_gvec(&V[0], &V[1], &V[2], &V[3], roots, q);
+      scatter(a, V, 4 * t * j, t);
+    }
+    return;
+  }
+
+  for(size_t j = 0; j < m; j++) {
+    const uint64_t k = 4 * t * j;
+
+    collect_roots(roots, w, w_con, m, j, t);
+    for(size_t i = k; i < k + t; i += GVEC_LANES) {
+      V[0] = gvec_load(&a[i]);
+      V[1] = gvec_load(&a[i + t]);
+      V[2] = gvec_load(&a[i + 2 * t]);
+      V[3] = gvec_load(&a[i + 3 * t]);
+
+      radix4_fwd_butterfly_gvec(&V[0], &V[1], &V[2], &V[3], roots, q);
+
+      gvec_store(&a[i], V[0]);
+      gvec_store(&a[i + t], V[1]);
+      gvec_store(&a[i + 2 * t], V[2]);
+      gvec_store(&a[i + 3 * t], V[3]);
+    }
+  }
+}
+
+static inline void inv_layer(uint64_t       a[],
+                             const uint64_t w[],
+                             const uint64_t w_con[],
+                             const size_t   m,
+                             const size_t   t,
+                             const gvec_t   q)
+{
+  mul_op_gvec_t roots[5];
+  gvec_t        V[4];
+
+  if(t < GVEC_LANES) {
+    for(size_t j = 0; j < m; j += GVEC_LANES / t) {
+      collect_roots(roots, w, w_con, m, j, t);
+      gather(V, a, 4 * t * j, t);
+      radix4_inv_butterfly_gvec(&V[0], &V[1], &V[2], &V[3], roots, q);
+      scatter(a, V, 4 * t * j, t);
+    }
+    return;
+  }
+
+  for(size_t j = 0; j < m; j++) {
+    const uint64_t k = 4 * t * j;
+
+    collect_roots(roots, w, w_con, m, j, t);
+    for(size_t i = k; i < k + t; i += GVEC_LANES) {
+      V[0] = gvec_load(&a[i]);
+      V[1] = gvec_load(&a[i + t]);
+      V[2] = gvec_load(&a[i + 2 * t]);
+      V[3] = gvec_load(&a[i + 3 * t]);
+
+      radix4_inv_butterfly_gvec(&V[0], &V[1], &V[2], &V[3], roots, q);
+
+      gvec_store(&a[i], V[0]);
+      gvec_store(&a[i + t], V[1]);
+      gvec_store(&a[i + 2 * t], V[2]);
+      gvec_store(&a[i + 3 * t], V[3]);
+    }
+  }
+}
+
+// The radix-2 layer of odd powers, every pair (a[i], a[i+1]) has its own
+// root w[N+i]. Lane l handles the pair at i + 2l.
+static inline void collect_radix2_lanes(mul_op_gvec_t *w1,
+                                        gvec_t *       X,
+                                        gvec_t *       Y,
+                                        const uint64_t a[],
+                                        const uint64_t w[],
+                                        const uint64_t w_con[],
+                                        const size_t   i)
+{
+  uint64_t tmp[4][GVEC_LANES];
+
+  for(size_t l = 0; l < GVEC_LANES; l++) {
+    tmp[0][l] = w[i + 2 * l];
+    tmp[1][l] = w_con[i + 2 * l];
+    tmp[2][l] = a[i + 2 * l];
+    tmp[3][l] = a[i + 2 * l + 1];
+  }
+
+  w1->op  = gvec_load(tmp[0]);
+  w1->con = gvec_load(tmp[1]);
+  *X      = gvec_load(tmp[2]);
+  *Y      = gvec_load(tmp[3]);
+}
+
+static inline void
+store_radix2_lanes(uint64_t a[], const gvec_t X, const gvec_t Y, const size_t i)
+{
+  uint64_t tmp[2][GVEC_LANES];
+
+  gvec_store(tmp[0], X);
+  gvec_store(tmp[1], Y);
+  for(size_t l = 0; l < GVEC_LANES; l++) {
+    a[i + 2 * l]     = tmp[0][l];
+    a[i + 2 * l + 1] = tmp[1][l];
+  }
+}
+
+void fwd_ntt_radix4_gvec_lazy(uint64_t       a[],
+                              const uint64_t N,
+                              const uint64_t q,
+                              const uint64_t w[],
+                              const uint64_t w_con[])
+{
+  // Every layer needs at least GVEC_LANES butterflies.
+  if(N < 4 * GVEC_LANES) {
+    fwd_ntt_radix4_lazy(a, N, q, w, w_con);
+    return;
+  }
+
+  const uint64_t bound_r4 = HAS_AN_EVEN_POWER(N) ? N : (N >> 1);
+  const gvec_t   q_vec    = gvec_set1(q);
+  const gvec_t   q4_vec   = gvec_set1(q << 2);
+  size_t         t        = N >> 2;
+
+  for(size_t m = 1; m < bound_r4; m <<= 2, t >>= 2) {
+    fwd_layer(a, w, w_con, m, t, q_vec);
+  }
+
+  // Check whether N=2^m where m is odd.
+  // If not perform extra radix-2 iteration.
+  if(HAS_AN_EVEN_POWER(N)) {
+    return;
+  }
+
+  for(size_t i = 0; i < N; i += 2 * GVEC_LANES) {
+    mul_op_gvec_t w1;
+    gvec_t        X;
+    gvec_t        Y;
+
+    collect_radix2_lanes(&w1, &X, &Y, a, &w[N], &w_con[N], i);
+    X = gvec_reduce_if_greater(X, q4_vec);
+    harvey_fwd_butterfly_gvec(&X, &Y, w1, q_vec);
+    store_radix2_lanes(a, X, Y, i);
+  }
+}
+
+void inv_ntt_radix4_gvec(uint64_t       a[],
+                         const uint64_t N,
+                         const uint64_t q,
+                         const mul_op_t n_inv,
+                         const uint64_t w[],
+                         const uint64_t w_con[])
+{
+  if(N < 4 * GVEC_LANES) {
+    inv_ntt_radix4(a, N, q, n_inv, w, w_con);
+    return;
+  }
+
+  const gvec_t q_vec  = gvec_set1(q);
+  const gvec_t q2_vec = gvec_set1(q << 1);
+  const gvec_t q4_vec = gvec_set1(q << 2);
+  uint64_t     t      = 1;
+  uint64_t     m      = N;
+
+  // 1. If N=2^m where m is odd, perform one radix-2 iteration,
+  // otherwise reduce all values modulo 2q.
+  if(HAS_AN_EVEN_POWER(N)) {
+    for(size_t i = 0; i < N; i += GVEC_LANES) {
+      const gvec_t X = gvec_reduce_if_greater(gvec_load(&a[i]), q4_vec);
+      gvec_store(&a[i], gvec_reduce_if_greater(X, q2_vec));
+    }
+  } else {
+    for(size_t i = 0; i < N; i += 2 * GVEC_LANES) {
+      mul_op_gvec_t w1;
+      gvec_t        X;
+      gvec_t        Y;
+
+      collect_radix2_lanes(&w1, &X, &Y, a, &w[N], &w_con[N], i);
+      X = gvec_reduce_if_greater(X, q4_vec);
+      harvey_bkw_butterfly_gvec(&X, &Y, w1, q_vec);
+      store_radix2_lanes(a, X, Y, i);
+    }
+
+    m >>= 1;
+    t <<= 1;
+  }
+
+  // 2. Perform radix-4 NTT iterations, except for the last one.
+  for(m >>= 2; m > 1; m >>= 2, t <<= 2) {
+    inv_layer(a, w, w_con, m, t, q_vec);
+  }
+
+  // 3. The last iteration (t = N/4 >= GVEC_LANES) also normalizes the results,
+  // its roots are multiplied by n^-1.
+  const mul_op_gvec_t n_inv_vec  = {gvec_set1(n_inv.op), gvec_set1(n_inv.con)};
+  uint64_t            w_n[8]     = {0};
+  uint64_t            w_n_con[8] = {0};
+  mul_op_gvec_t       roots[5];
+
+  calc_w_n_inv(&w_n[2], &w_n_con[2], &w[2], 6, n_inv.op, q, WORD_SIZE);
+  collect_roots(roots, w_n, w_n_con, 1, 0, t);
+
+  for(size_t i = 0; i < t; i += GVEC_LANES) {
+    gvec_t V[4] = {gvec_load(&a[i]), gvec_load(&a[i + t]),
+                   gvec_load(&a[i + 2 * t]), gvec_load(&a[i + 3 * t])};
+
+    radix4_inv_butterfly_final_gvec(&V[0], &V[1], &V[2], &V[3], roots,
+                                    n_inv_vec, q_vec);
+
+    gvec_store(&a[i], V[0]);
+    gvec_store(&a[i + t], V[1]);
+    gvec_store(&a[i + 2 * t], V[2]);
+    gvec_store(&a[i + 3 * t], V[3]);
+  }
+}
@@ -1,19 +1,29 @@
 // Copyright IBM Inc. All Rights Reserved.
 // SPDX-License-Identifier: Apache-2.0
 
-#include <vecintrin.h>
+#ifdef S390X_EMU
+#  include "s390x_emu.h"
+#else
+#  include <vecintrin.h>
+#endif
 
 #define L_HIGH_WORD HIGH_VMSL_WORD
 
 #include "fast_mul_operators.h"
 #include "ntt_radix4_s390x_vef.h"
+#include "pre_compute.h"
 
 #define UL_VMSL_Z(a, b, ctx) (ul_vec) vec_msum_u128(a, b, (ctx)->zero, 0)
 #define UL_VMSL              (ul_vec) vec_msum_u128
 #define VEC_BYTES            16
 
+#ifdef S390X_EMU
+typedef s390x_emu_ul_vec ul_vec;
+typedef s390x_emu_uc_vec uc_vec;
+#else
 typedef vector unsigned long long ul_vec;
 typedef vector unsigned char      uc_vec;
+#endif
 
 typedef struct loop_ctx_s {
   mul_op_t w1;
@@ -34,6 +44,10 @@ typedef struct loop_ctx_s {
   ul_vec   q4_vec;
 
   uc_vec zero;
+
+  // Only used by the last inverse iteration.
+  mul_op_t n_inv;
+  ul_vec   q_vec;
 } loop_ctx_t;
 
 /******************************
@@ -52,6 +66,19 @@ static inline ul_vec extended_shoup_multiply(const ul_vec      r,
   return UL_VMSL(neg_q, t1, (uc_vec)t2, 0);
 }
 
+// Simple Shoup multiply of the two elements of X by w, the results are in
+// the range [0, 2q).
+static inline ul_vec
+simple_shoup_multiply(const mul_op_t w, const ul_vec X, const loop_ctx_t *ctx)
+{
+  const ul_vec t1  = {w.op, ctx->neg_q};
+  ul_vec       Q_1 = {X[0], HIGH_VMSL_WORD(w.con * X[0])};
+  ul_vec       Q_2 = {X[1], HIGH_VMSL_WORD(w.con * X[1])};
+  Q_1              = UL_VMSL_Z(t1, Q_1, ctx);
+  Q_2              = UL_VMSL_Z(t1, Q_2, ctx);
+  return LOW_VMSL_WORD(vec_mergel(Q_1, Q_2));
+}
+
 static inline void single_fwd_butterfly(uint64_t          a[],
                                         const uint64_t    q,
                                         const loop_ctx_t *ctx,
@@ -100,16 +127,11 @@ static inline void double_fwd_butterfly(uint64_t          a[],
   X = vec_sel(X, X - ctx->q4_vec, vec_cmpge(X, ctx->q4_vec));
 
   // Simple Shoup multiply on two elements in parallel.
-  ul_vec t1  = {ctx->w1.op, ctx->neg_q};
-  ul_vec Q_1 = {Z[0], HIGH_VMSL_WORD(ctx->w1.con * Z[0])};
-  ul_vec Q_2 = {Z[1], HIGH_VMSL_WORD(ctx->w1.con * Z[1])};
-  Q_1        = UL_VMSL_Z(t1, Q_1, ctx);
-  Q_2        = UL_VMSL_Z(t1, Q_2, ctx);
-  Z          = LOW_VMSL_WORD(vec_mergel(Q_1, Q_2));
+  Z = simple_shoup_multiply(ctx->w1, Z, ctx);
 
   // Extended Shoup multiply on two elements in parallel.
-  t1[0]       = 0;
-  ul_vec r4_1 = extended_shoup_multiply(ctx->r1, ctx->r1_con, YT1, t1, ctx);
+  const ul_vec t1   = {0, ctx->neg_q};
+  ul_vec       r4_1 = extended_shoup_multiply(ctx->r1, ctx->r1_con, YT1, t1, ctx);
   ul_vec r4_2 = extended_shoup_multiply(ctx->r1, ctx->r1_con, YT2, t1, ctx);
   ul_vec r5_1 = extended_shoup_multiply(ctx->r2, ctx->r2_con, YT1, t1, ctx);
   ul_vec r5_2 = extended_shoup_multiply(ctx->r2, ctx->r2_con, YT2, t1, ctx);
@@ -203,120 +225,265 @@ static inline void single_inv_butterfly(uint64_t          a[],
   a[i + 3 * t] = Y2;
 }
 
-// Assumption t is even.
-static inline void double_inv_butterfly(uint64_t          a[],
-                                        const loop_ctx_t *ctx,
-                                        const size_t      i,
-                                        const size_t      t)
+// Same as single_inv_butterfly for the first iteration of an even power N,
+// where the inputs are in the range [0, 8q). Reducing them here, while they
+// are in registers, replaces a separate reduction pass over a.
+static inline void single_inv_butterfly_first(uint64_t          a[],
+                                              const uint64_t    q,
+                                              const loop_ctx_t *ctx,
+                                              const size_t      i,
+                                              const uint64_t    t)
 {
-  // We use vector pointers to load two coefficients of "a" at once.
-  ul_vec *a_vec = (ul_vec *)&a[i];
+  a[i + 0 * t] = reduce_8q_to_2q(a[i + 0 * t], q);
+  a[i + 1 * t] = reduce_8q_to_2q(a[i + 1 * t], q);
+  a[i + 2 * t] = reduce_8q_to_2q(a[i + 2 * t], q);
+  a[i + 3 * t] = reduce_8q_to_2q(a[i + 3 * t], q);
 
-  const ul_vec X = a_vec[0 * t];
-  const ul_vec Y = a_vec[1 * t];
-  const ul_vec Z = a_vec[2 * t];
-  const ul_vec T = a_vec[3 * t];
+  single_inv_butterfly(a, q, ctx, i, t);
+}
 
-  const ul_vec T0 = Z + T;
-  ul_vec       T1 = X + Y;
-  ul_vec       T4 = ctx->q4_vec + T1 - T0;
+// Same as single_inv_butterfly for the last iteration, where the roots in ctx
+// are already multiplied by n^-1. The outputs are in the range [0, q).
+static inline void single_inv_butterfly_final(uint64_t          a[],
+                                              const uint64_t    q,
+                                              const loop_ctx_t *ctx,
+                                              const size_t      i,
+                                              const uint64_t    t)
+{
+  single_inv_butterfly(a, q, ctx, i, t);
+
+  a[i + 0 * t] = fast_mul_mod_q(ctx->n_inv, a[i + 0 * t], q);
+  a[i + 1 * t] = reduce_2q_to_q(a[i + 1 * t], q);
+  a[i + 2 * t] = reduce_2q_to_q(a[i + 2 * t], q);
+  a[i + 3 * t] = reduce_2q_to_q(a[i + 3 * t], q);
+}
+
+static inline void double_inv_butterfly_core(ul_vec *          X,
+                                             ul_vec *          Y,
+                                             ul_vec *          Z,
+                                             ul_vec *          T,
+                                             const loop_ctx_t *ctx)
+{
+  const ul_vec T0 = *Z + *T;
+  ul_vec       T1 = *X + *Y;
 
   // Simple Shoup multiply on two elements in parallel.
-  ul_vec t1  = {ctx->w1.op, ctx->neg_q};
-  ul_vec Q_1 = {T4[0], HIGH_VMSL_WORD(ctx->w1.con * T4[0])};
-  ul_vec Q_2 = {T4[1], HIGH_VMSL_WORD(ctx->w1.con * T4[1])};
-  Q_1        = UL_VMSL_Z(t1, Q_1, ctx);
-  Q_2        = UL_VMSL_Z(t1, Q_2, ctx);
-  T4         = LOW_VMSL_WORD(vec_mergel(Q_1, Q_2));
-
-  ul_vec T2   = ctx->q4_vec + X - Y;
-  ul_vec T3   = ctx->q4_vec + Z - T;
+  const ul_vec T4 =
+    simple_shoup_multiply(ctx->w1, ctx->q4_vec + T1 - T0, ctx);
+
+  ul_vec T2   = ctx->q4_vec + *X - *Y;
+  ul_vec T3   = ctx->q4_vec + *Z - *T;
   ul_vec T23a = {T2[0], T3[0]};
   ul_vec T23b = {T2[1], T3[1]};
 
   // Extended Shoup multiply on two elements in parallel.
-  t1[0]       = 0;
+  const ul_vec t1 = {0, ctx->neg_q};
   ul_vec r4_1 = extended_shoup_multiply(ctx->r1, ctx->r1_con, T23a, t1, ctx);
   ul_vec r4_2 = extended_shoup_multiply(ctx->r1, ctx->r1_con, T23b, t1, ctx);
   ul_vec r5_1 = extended_shoup_multiply(ctx->r2, ctx->r2_con, T23a, t1, ctx);
   ul_vec r5_2 = extended_shoup_multiply(ctx->r2, ctx->r2_con, T23b, t1, ctx);
 
-  const ul_vec Y1 = LOW_VMSL_WORD(vec_mergel(r4_1, r4_2));
-  const ul_vec Y2 = LOW_VMSL_WORD(vec_mergel(r5_1, r5_2));
+  T1 = T1 + T0;
+  T1 = vec_sel(T1, T1 - ctx->q4_vec, vec_cmpge(T1, ctx->q4_vec));
+  T1 = vec_sel(T1, T1 - ctx->q2_vec, vec_cmpge(T1, ctx->q2_vec));
 
-  T1           = T1 + T0;
-  T1           = vec_sel(T1, T1 - ctx->q4_vec, vec_cmpge(T1, ctx->q4_vec));
-  T1           = vec_sel(T1, T1 - ctx->q2_vec, vec_cmpge(T1, ctx->q2_vec));
-  a_vec[0 * t] = T1;
-  a_vec[1 * t] = Y1;
-  a_vec[2 * t] = T4;
-  a_vec[3 * t] = Y2;
+  *X = T1;
+  *Y = LOW_VMSL_WORD(vec_mergel(r4_1, r4_2));
+  *Z = T4;
+  *T = LOW_VMSL_WORD(vec_mergel(r5_1, r5_2));
 }
 
-void inv_ntt_radix4_intrinsic(uint64_t       a[],
-                              const uint64_t N,
-                              const uint64_t q,
-                              const mul_op_t n_inv,
-                              const uint64_t w[],
-                              const uint64_t w_con[])
+// Assumption t is even.
+static inline void double_inv_butterfly(uint64_t          a[],
+                                        const loop_ctx_t *ctx,
+                                        const size_t      i,
+                                        const size_t      t)
 {
-  size_t t = 1;
-  size_t m = N;
+  // We use vector pointers to load two coefficients of "a" at once.
+  ul_vec *a_vec = (ul_vec *)&a[i];
 
-  // Check whether N=2^m where m is odd.
+  ul_vec X = a_vec[0 * t];
+  ul_vec Y = a_vec[1 * t];
+  ul_vec Z = a_vec[2 * t];
+  ul_vec T = a_vec[3 * t];
+
+  double_inv_butterfly_core(&X, &Y, &Z, &T, ctx);
+
+  a_vec[0 * t] = X;
+  a_vec[1 * t] = Y;
+  a_vec[2 * t] = Z;
+  a_vec[3 * t] = T;
+}
+
+static inline ul_vec reduce_2q_to_q_vec(const ul_vec X, const loop_ctx_t *ctx)
+{
+  return vec_sel(X, X - ctx->q_vec, vec_cmpge(X, ctx->q_vec));
+}
+
+// Same as double_inv_butterfly for the last iteration, where the roots in ctx
+// are already multiplied by n^-1. The outputs are in the range [0, q).
+static inline void double_inv_butterfly_final(uint64_t          a[],
+                                              const loop_ctx_t *ctx,
+                                              const size_t      i,
+                                              const size_t      t)
+{
+  ul_vec *a_vec = (ul_vec *)&a[i];
+
+  ul_vec X = a_vec[0 * t];
+  ul_vec Y = a_vec[1 * t];
+  ul_vec Z = a_vec[2 * t];
+  ul_vec T = a_vec[3 * t];
+
+  double_inv_butterfly_core(&X, &Y, &Z, &T, ctx);
+
+  a_vec[0 * t] =
+    reduce_2q_to_q_vec(simple_shoup_multiply(ctx->n_inv, X, ctx), ctx);
+  a_vec[1 * t] = reduce_2q_to_q_vec(Y, ctx);
+  a_vec[2 * t] = reduce_2q_to_q_vec(Z, ctx);
+  a_vec[3 * t] = reduce_2q_to_q_vec(T, ctx);
+}
+
+static inline loop_ctx_t inv_loop_ctx(const uint64_t w[],
+                                      const uint64_t w_con[],
+                                      const size_t   m1,
+                                      const uint64_t q)
+{
+  const uint64_t   m2  = 2 * m1;
+  const loop_ctx_t ctx = {.w1     = {w[m1], w_con[m1]},
+                          .r1     = {w[m2 + 0], w[m2 + 2]},
+                          .r2     = {w[m2 + 1], w[m2 + 3]},
+                          .r1_con = {w_con[m2 + 0], w_con[m2 + 2]},
+                          .r2_con = {w_con[m2 + 1], w_con[m2 + 3]},
+                          .zero   = {0},
+                          .neg_q  = (-1 * q) & VMSL_WORD_SIZE_MASK,
+                          .q2     = 2 * q,
+                          .q4     = 4 * q,
+                          .q2_vec = {2 * q, 2 * q},
+                          .q4_vec = {4 * q, 4 * q},
+                          .q_vec  = {q, q}};
+  return ctx;
+}
+
+// The roots of the last iteration (m1=2, m2=4) multiplied by n^-1.
+static inline loop_ctx_t inv_last_loop_ctx(const uint64_t w[],
+                                           const uint64_t q,
+                                           const mul_op_t n_inv)
+{
+  uint64_t w_last[8]     = {0};
+  uint64_t w_last_con[8] = {0};
+
+  calc_w_n_inv(&w_last[2], &w_last_con[2], &w[2], 6, n_inv.op, q,
+               VMSL_WORD_SIZE);
+
+  loop_ctx_t ctx = inv_loop_ctx(w_last, w_last_con, 2, q);
+  ctx.n_inv      = n_inv;
+  return ctx;
+}
+
+static inline void inv_first_iteration(uint64_t       a[],
+                                       const uint64_t N,
+                                       const uint64_t q,
+                                       const uint64_t w[],
+                                       const uint64_t w_con[])
+{
+  // Check whether N=2^m where m is odd. Otherwise, the first radix-4
+  // iteration reduces its inputs (see single_inv_butterfly_first), unless it
+  // is also the last one (N=4).
   if(HAS_AN_EVEN_POWER(N)) {
+    if(N > 4) {
+      return;
+    }
+
     for(size_t i = 0; i < N; i++) {
       a[i] = reduce_8q_to_2q(a[i], q);
     }
-  } else {
-    // Perform the first iteration as a radix-2 iteration.
-    for(size_t i = 0; i < N; i += 2) {
-      const mul_op_t w1 = {w[i + N], w_con[i + N]};
-      a[i]              = reduce_8q_to_4q(a[i], q);
-      harvey_bkw_butterfly(&a[i], &a[i + 1], w1, q);
-    }
+    return;
+  }
+
+  // Perform the first iteration as a radix-2 iteration.
+  for(size_t i = 0; i < N; i += 2) {
+    const mul_op_t w1 = {w[i + N], w_con[i + N]};
+    a[i]              = reduce_8q_to_2q(a[i], q);
+    a[i + 1]          = reduce_8q_to_2q(a[i + 1], q);
+    harvey_bkw_butterfly(&a[i], &a[i + 1], w1, q);
+  }
+}
+
+// When a2 is NULL only a1 is transformed. The multiplication by n^-1 is
+// folded into the last radix-4 iteration.
+// Assumption N >= 4.
+static inline void _inv_ntt_radix4_intrinsic(uint64_t       a1[],
+                                             uint64_t       a2[],
+                                             const uint64_t N,
+                                             const uint64_t q,
+                                             const mul_op_t n_inv,
+                                             const uint64_t w[],
+                                             const uint64_t w_con[])
+{
+  size_t t = 1;
+  size_t m = N;
+
+  inv_first_iteration(a1, N, q, w, w_con);
+  if(a2 != NULL) {
+    inv_first_iteration(a2, N, q, w, w_con);
+  }
+
+  if(!HAS_AN_EVEN_POWER(N)) {
     m >>= 1;
     t <<= 1;
   }
 
-  while(m > 0) {
-    m >>= 2;
+  for(m >>= 2; m > 1; m >>= 2, t <<= 2) {
     for(size_t j = 0; j < m; j++) {
-      const uint64_t   m1  = 2 * (m + j);
-      const uint64_t   m2  = 2 * m1;
       const uint64_t   k   = 4 * t * j;
-      const loop_ctx_t ctx = {.w1     = {w[m1], w_con[m1]},
-                              .r1     = {w[m2 + 0], w[m2 + 2]},
-                              .r2     = {w[m2 + 1], w[m2 + 3]},
-                              .r1_con = {w_con[m2 + 0], w_con[m2 + 2]},
-                              .r2_con = {w_con[m2 + 1], w_con[m2 + 3]},
-                              .zero   = {0},
-                              .neg_q  = (-1 * q) & VMSL_WORD_SIZE_MASK,
-                              .q2     = 2 * q,
-                              .q4     = 4 * q,
-                              .q2_vec = {2 * q, 2 * q},
-                              .q4_vec = {4 * q, 4 * q}};
+      const loop_ctx_t ctx = inv_loop_ctx(w, w_con, 2 * (m + j), q);
 
+      // t=1 only in the first iteration of an even power N.
       if(t == 1) {
-        for(size_t i = k; i < k + t; i++) {
-          single_inv_butterfly(a, q, &ctx, i, t);
+        single_inv_butterfly_first(a1, q, &ctx, k, t);
+        if(a2 != NULL) {
+          single_inv_butterfly_first(a2, q, &ctx, k, t);
         }
       } else {
         for(size_t i = k; i < k + t; i += 2) {
-          double_inv_butterfly(a, &ctx, i, t >> 1);
+          double_inv_butterfly(a1, &ctx, i, t >> 1);
+          if(a2 != NULL) {
+            double_inv_butterfly(a2, &ctx, i, t >> 1);
+          }
         }
       }
     }
+  }
 
-    t <<= 2;
+  // The last iteration (m=1) also multiplies by n^-1 mod q.
+  const loop_ctx_t ctx = inv_last_loop_ctx(w, q, n_inv);
+
+  if(t == 1) {
+    single_inv_butterfly_final(a1, q, &ctx, 0, t);
+    if(a2 != NULL) {
+      single_inv_butterfly_final(a2, q, &ctx, 0, t);
+    }
+    return;
   }
 
-  for(size_t i = 0; i < N; i++) {
-    // At the last iteration, multiply by n^-1 mod q
-    a[i] = fast_mul_mod_q(n_inv, a[i], q);
+  for(size_t i = 0; i < t; i += 2) {
+    double_inv_butterfly_final(a1, &ctx, i, t >> 1);
+    if(a2 != NULL) {
+      double_inv_butterfly_final(a2, &ctx, i, t >> 1);
+    }
   }
 }
 
+void inv_ntt_radix4_intrinsic(uint64_t       a[],
+                              const uint64_t N,
+                              const uint64_t q,
+                              const mul_op_t n_inv,
+                              const uint64_t w[],
+                              const uint64_t w_con[])
+{
+  _inv_ntt_radix4_intrinsic(a, NULL, N, q, n_inv, w, w_con);
+}
+
 /******************************
        Double input
 ******************************/
@@ -374,3 +541,14 @@ void fwd_ntt_radix4_intrinsic_lazy_dbl(uint64_t       a1[],
     harvey_fwd_butterfly(&a2[i], &a2[i + 1], w1, q);
   }
 }
+
+void inv_ntt_radix4_intrinsic_dbl(uint64_t       a1[],
+                                  uint64_t       a2[],
+                                  const uint64_t N,
+                                  const uint64_t q,
+                                  const mul_op_t n_inv,
+                                  const uint64_t w[],
+                                  const uint64_t w_con[])
+{
+  _inv_ntt_radix4_intrinsic(a1, a2, N, q, n_inv, w, w_con);
+}
@@ -0,0 +1,160 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt_radix8.h"
+#include "fast_mul_operators.h"
+
+static inline void collect_roots(mul_op_t       w1[5],
+                                 const uint64_t w[],
+                                 const uint64_t w_con[],
+                                 const size_t   m,
+                                 const size_t   j)
+{
+  const uint64_t m1 = 2 * (m + j);
+  w1[0].op          = w[m1];
+  w1[1].op          = w[2 * m1];
+  w1[2].op          = w[2 * m1 + 1];
+  w1[3].op          = w[2 * m1 + 2];
+  w1[4].op          = w[2 * m1 + 3];
+
+  w1[0].con = w_con[m1];
+  w1[1].con = w_con[2 * m1];
+  w1[2].con = w_con[2 * m1 + 1];
+  w1[3].con = w_con[2 * m1 + 2];
+  w1[4].con = w_con[2 * m1 + 3];
+}
+
+// A radix-8 butterfly of group j out of m is a radix-2 layer with m groups
+// followed by a radix-4 layer with 2m groups.
+static inline void collect_roots_r8(mul_op_t       w1[11],
+                                    const uint64_t w[],
+                                    const uint64_t w_con[],
+                                    const size_t   m,
+                                    const size_t   j)
+{
+  const uint64_t m1 = 2 * (m + j);
+  w1[0].op          = w[m1];
+  w1[0].con         = w_con[m1];
+
+  collect_roots(&w1[1], w, w_con, 2 * m, 2 * j);
+  collect_roots(&w1[6], w, w_con, 2 * m, 2 * j + 1);
+}
+
+// Returns log2(N) mod 3
+static inline uint64_t get_r8_reminder(uint64_t N)
+{
+  uint64_t log_n = 0;
+  for(; N > 1; N >>= 1) {
+    log_n++;
+  }
+  return log_n % 3;
+}
+
+void fwd_ntt_radix8_lazy(uint64_t       a[],
+                         const uint64_t N,
+                         const uint64_t q,
+                         const uint64_t w[],
+                         const uint64_t w_con[])
+{
+  mul_op_t roots[11];
+  size_t   m = 1;
+  size_t   t;
+
+  // Perform the extra iteration first, where there is only a single group.
+  switch(get_r8_reminder(N)) {
+    case 1: {
+      const mul_op_t w1 = {w[2], w_con[2]};
+      t                 = N >> 1;
+      for(size_t i = 0; i < t; i++) {
+        a[i] = reduce_8q_to_4q(a[i], q);
+        harvey_fwd_butterfly(&a[i], &a[i + t], w1, q);
+      }
+      m = 2;
+      break;
+    }
+    case 2:
+      t = N >> 2;
+      collect_roots(roots, w, w_con, 1, 0);
+      for(size_t i = 0; i < t; i++) {
+        radix4_fwd_butterfly(&a[i], &a[i + t], &a[i + 2 * t], &a[i + 3 * t],
+                             roots, q);
+      }
+      m = 4;
+      break;
+    default: break;
+  }
+
+  for(t = N / (8 * m); m < N; m <<= 3, t >>= 3) {
+    for(size_t j = 0; j < m; j++) {
+      const uint64_t k = 8 * t * j;
+
+      collect_roots_r8(roots, w, w_con, m, j);
+      for(size_t i = k; i < k + t; i++) {
+        radix8_fwd_butterfly(&a[i], t, roots, q);
+      }
+    }
+  }
+}
+
+void inv_ntt_radix8(uint64_t       a[],
+                    const uint64_t N,
+                    const uint64_t q,
+                    const mul_op_t n_inv,
+                    const uint64_t w[],
+                    const uint64_t w_con[])
+{
+  const uint64_t rem   = get_r8_reminder(N);
+  const uint64_t bound = 1UL << rem;
+  mul_op_t       roots[11];
+  size_t         m = N >> 3;
+  size_t         t = 1;
+
+  // 1. The first radix-8 iteration also reduces the input to [0, 2q).
+  for(size_t j = 0; j < m; j++) {
+    uint64_t *X = &a[8 * j];
+    for(size_t s = 0; s < 8; s++) {
+      X[s] = reduce_8q_to_2q(X[s], q);
+    }
+
+    collect_roots_r8(roots, w, w_con, m, j);
+    radix8_inv_butterfly(X, 1, roots, q);
+  }
+
+  // 2. Perform the rest of the radix-8 iterations.
+  for(m >>= 3, t <<= 3; m >= bound; m >>= 3, t <<= 3) {
+    for(size_t j = 0; j < m; j++) {
+      const uint64_t k = 8 * t * j;
+
+      collect_roots_r8(roots, w, w_con, m, j);
+      for(size_t i = k; i < k + t; i++) {
+        radix8_inv_butterfly(&a[i], t, roots, q);
+      }
+    }
+  }
+
+  // 3. Perform the extra iteration if needed.
+  switch(rem) {
+    case 1: {
+      const mul_op_t w1 = {w[2], w_con[2]};
+      t                 = N >> 1;
+      for(size_t i = 0; i < t; i++) {
+        harvey_bkw_butterfly(&a[i], &a[i + t], w1, q);
+      }
+      break;
+    }
+    case 2:
+      t = N >> 2;
+      collect_roots(roots, w, w_con, 1, 0);
+      for(size_t i = 0; i < t; i++) {
+        radix4_inv_butterfly(&a[i], &a[i + t], &a[i + 2 * t], &a[i + 3 * t],
+                             roots, q);
+      }
+      break;
+    default: break;
+  }
+
+  // 4. Normalize the results
+  for(size_t i = 0; i < N; i++) {
+    a[i] = fast_mul_mod_q(n_inv, a[i], q);
+  }
+}
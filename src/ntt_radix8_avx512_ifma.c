@@ -0,0 +1,277 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifdef AVX512_IFMA_SUPPORT
+
+#  include "ntt_avx512_ifma.h"
+
+// See expand_w_r8_avx512_ifma for the layout of the w-powers table.
+
+static inline void collect_roots_r8_bcast(mul_op_m512_t  w1[11],
+                                          const uint64_t w[],
+                                          const uint64_t w_con[],
+                                          const size_t   idx)
+{
+  for(size_t k = 0; k < 11; k++) {
+    w1[k].op  = SET1(w[idx + k]);
+    w1[k].con = SET1(w_con[idx + k]);
+  }
+}
+
+static inline void collect_roots_r8_lanes(mul_op_m512_t  w1[11],
+                                          const uint64_t w[],
+                                          const uint64_t w_con[],
+                                          const size_t   idx)
+{
+  for(size_t k = 0; k < 11; k++) {
+    w1[k].op  = LOADA(&w[idx + 8 * k]);
+    w1[k].con = LOADA(&w_con[idx + 8 * k]);
+  }
+}
+
+static inline size_t level_size(const size_t m)
+{
+  return (((11 * m) + 7) >> 3) << 3;
+}
+
+static inline uint64_t get_r8_reminder(uint64_t N)
+{
+  uint64_t log_n = 0;
+  for(; N > 1; N >>= 1) {
+    log_n++;
+  }
+  return log_n % 3;
+}
+
+static inline void fwd8_r8(uint64_t *          a,
+                           const size_t        t,
+                           const mul_op_m512_t w[11],
+                           const uint64_t      q)
+{
+  __m512i X[8];
+
+  LOOP_UNROLL_8
+  for(size_t s = 0; s < 8; s++) {
+    X[s] = LOAD(&a[s * t]);
+  }
+
+  fwd_radix8_butterfly_m512(X, w, q);
+
+  LOOP_UNROLL_8
+  for(size_t s = 0; s < 8; s++) {
+    STORE(&a[s * t], X[s]);
+  }
+}
+
+static inline void inv8_r8(uint64_t *          a,
+                           const size_t        t,
+                           const mul_op_m512_t w[11],
+                           const uint64_t      q)
+{
+  __m512i X[8];
+
+  LOOP_UNROLL_8
+  for(size_t s = 0; s < 8; s++) {
+    X[s] = LOAD(&a[s * t]);
+  }
+
+  inv_radix8_butterfly_m512(X, w, q);
+
+  LOOP_UNROLL_8
+  for(size_t s = 0; s < 8; s++) {
+    STORE(&a[s * t], X[s]);
+  }
+}
+
+// The last radix-8 iteration (t=1) on a block of 64 qw. The block is transposed
+// so that every register holds the same butterfly input of 8 different groups.
+static inline void
+fwd64_r8(uint64_t *a, const mul_op_m512_t w[11], const uint64_t q)
+{
+  __m512i X[8];
+
+  LOOP_UNROLL_8
+  for(size_t s = 0; s < 8; s++) {
+    X[s] = LOAD(&a[8 * s]);
+  }
+
+  transpose_8x8_m512(X);
+  fwd_radix8_butterfly_m512(X, w, q);
+  transpose_8x8_m512(X);
+
+  LOOP_UNROLL_8
+  for(size_t s = 0; s < 8; s++) {
+    STORE(&a[8 * s], X[s]);
+  }
+}
+
+// Also reduces the inputs from [0, 8q) to [0, 2q).
+static inline void
+inv64_r8(uint64_t *a, const mul_op_m512_t w[11], const uint64_t q_64)
+{
+  const __m512i q2 = SET1(q_64 << 1);
+  const __m512i q4 = SET1(q_64 << 2);
+  __m512i       X[8];
+
+  LOOP_UNROLL_8
+  for(size_t s = 0; s < 8; s++) {
+    X[s] = reduce_if_greater(reduce_if_greater(LOAD(&a[8 * s]), q4), q2);
+  }
+
+  transpose_8x8_m512(X);
+  inv_radix8_butterfly_m512(X, w, q_64);
+  transpose_8x8_m512(X);
+
+  LOOP_UNROLL_8
+  for(size_t s = 0; s < 8; s++) {
+    STORE(&a[8 * s], X[s]);
+  }
+}
+
+void fwd_ntt_radix8_avx512_ifma_lazy(uint64_t       a[],
+                                     const uint64_t N,
+                                     const uint64_t q,
+                                     const uint64_t w[],
+                                     const uint64_t w_con[])
+{
+  mul_op_m512_t roots[11];
+  size_t        m   = 1;
+  size_t        idx = 8;
+  size_t        t;
+
+  // Perform the extra iteration first, where there is only a single group.
+  switch(get_r8_reminder(N)) {
+    case 1:
+      collect_roots_r8_bcast(roots, w, w_con, 0);
+      t = N >> 1;
+      for(size_t i = 0; i < t; i += 8) {
+        __m512i X = LOAD(&a[i]);
+        __m512i Y = LOAD(&a[i + t]);
+
+        fwd_radix2_butterfly_m512(&X, &Y, &roots[0], q);
+
+        STORE(&a[i], X);
+        STORE(&a[i + t], Y);
+      }
+      m = 2;
+      break;
+    case 2:
+      collect_roots_r8_bcast(roots, w, w_con, 0);
+      t = N >> 2;
+      for(size_t i = 0; i < t; i += 8) {
+        __m512i X = LOAD(&a[i]);
+        __m512i Y = LOAD(&a[i + t]);
+        __m512i Z = LOAD(&a[i + 2 * t]);
+        __m512i T = LOAD(&a[i + 3 * t]);
+
+        fwd_radix4_butterfly_m512(&X, &Y, &Z, &T, roots, q);
+
+        STORE(&a[i], X);
+        STORE(&a[i + t], Y);
+        STORE(&a[i + 2 * t], Z);
+        STORE(&a[i + 3 * t], T);
+      }
+      m = 4;
+      break;
+    default: break;
+  }
+
+  for(t = N / (8 * m); t >= 8; m <<= 3, t >>= 3) {
+    for(size_t j = 0; j < m; j++) {
+      const uint64_t k = 8 * t * j;
+
+      collect_roots_r8_bcast(roots, w, w_con, idx + 11 * j);
+      for(size_t i = k; i < k + t; i += 8) {
+        fwd8_r8(&a[i], t, roots, q);
+      }
+    }
+    idx += level_size(m);
+  }
+
+  // Last iteration (t=1)
+  for(size_t j = 0; j < m; j += 8, idx += 8 * 11) {
+    collect_roots_r8_lanes(roots, w, w_con, idx);
+    fwd64_r8(&a[8 * j], roots, q);
+  }
+}
+
+void inv_ntt_radix8_avx512_ifma(uint64_t       a[],
+                                const uint64_t N,
+                                const uint64_t q,
+                                const mul_op_t n_inv,
+                                const uint64_t w[],
+                                const uint64_t w_con[])
+{
+  const uint64_t rem   = get_r8_reminder(N);
+  const uint64_t bound = 1UL << rem;
+  mul_op_m512_t  roots[11];
+  size_t         idx = 8;
+  size_t         m;
+  size_t         t;
+
+  // Find the offset of the last radix-8 iteration in the table
+  for(m = bound; m < (N >> 3); m <<= 3) {
+    idx += level_size(m);
+  }
+
+  // 1. The first radix-8 iteration (t=1) also reduces the input to [0, 2q).
+  for(size_t j = 0; j < m; j += 8) {
+    collect_roots_r8_lanes(roots, w, w_con, idx + 11 * j);
+    inv64_r8(&a[8 * j], roots, q);
+  }
+
+  // 2. Perform the rest of the radix-8 iterations.
+  for(m >>= 3, t = 8; m >= bound; m >>= 3, t <<= 3) {
+    idx -= level_size(m);
+    for(size_t j = 0; j < m; j++) {
+      const uint64_t k = 8 * t * j;
+
+      collect_roots_r8_bcast(roots, w, w_con, idx + 11 * j);
+      for(size_t i = k; i < k + t; i += 8) {
+        inv8_r8(&a[i], t, roots, q);
+      }
+    }
+  }
+
+  // 3. Perform the extra iteration if needed.
+  if(rem == 1) {
+    collect_roots_r8_bcast(roots, w, w_con, 0);
+    t = N >> 1;
+    for(size_t i = 0; i < t; i += 8) {
+      __m512i X = LOAD(&a[i]);
+      __m512i Y = LOAD(&a[i + t]);
+
+      inv_radix2_butterfly_m512(&X, &Y, &roots[0], q);
+
+      STORE(&a[i], X);
+      STORE(&a[i + t], Y);
+    }
+  } else if(rem == 2) {
+    collect_roots_r8_bcast(roots, w, w_con, 0);
+    t = N >> 2;
+    for(size_t i = 0; i < t; i += 8) {
+      __m512i X = LOAD(&a[i]);
+      __m512i Y = LOAD(&a[i + t]);
+      __m512i Z = LOAD(&a[i + 2 * t]);
+      __m512i T = LOAD(&a[i + 3 * t]);
+
+      inv_radix4_butterfly_m512(&X, &Y, &Z, &T, roots, q);
+
+      STORE(&a[i], X);
+      STORE(&a[i + t], Y);
+      STORE(&a[i + 2 * t], Z);
+      STORE(&a[i + 3 * t], T);
+    }
+  }
+
+  // 4. Normalize the results
+  const mul_op_m512_t n_inv_m512 = {SET1(n_inv.op), SET1(n_inv.con)};
+  const __m512i       neg_q      = SET1(-1 * q);
+  const __m512i       q_m512     = SET1(q);
+  for(size_t i = 0; i < N; i += 8) {
+    const __m512i X = fast_mul_mod_q2_m512(n_inv_m512, LOAD(&a[i]), neg_q);
+    STORE(&a[i], reduce_if_greater(X, q_m512));
+  }
+}
+
+#endif
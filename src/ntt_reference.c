@@ -27,6 +27,7 @@ void fwd_ntt_ref_harvey_lazy(uint64_t       a[],
       }
       k = k + (2 * t);
     }
+    CHECK_BOUNDS(a, N, q, 4);
   }
 }
 
@@ -50,6 +51,7 @@ void inv_ntt_ref_harvey(uint64_t       a[],
       }
       k = k + (2 * t);
     }
+    CHECK_BOUNDS(a, N, q, 2);
   }
 
   // Final round - the harvey_bkw_butterfly, where the output is multiplies by
@@ -63,6 +65,7 @@ void inv_ntt_ref_harvey(uint64_t       a[],
   for(size_t j = 0; j < t; j++) {
     harvey_bkw_butterfly_final(&a[j], &a[j + t], w1, n_inv, q);
   }
+  CHECK_BOUNDS(a, N, q, 1);
 }
 
 /******************************
@@ -5,7 +5,9 @@
 
 #include "measurements.h"
 #include "ntt_radix4.h"
+#include "ntt_radix4_gvec.h"
 #include "ntt_radix4x4.h"
+#include "ntt_radix8.h"
 #include "ntt_reference.h"
 #include "ntt_seal.h"
 #include "tests.h"
@@ -15,6 +17,10 @@
 #  include "ntt_radix4_s390x_vef.h"
 #endif
 
+#ifdef AVX512_SUPPORT
+#  include "ntt_avx512.h"
+#endif
+
 #ifdef AVX512_IFMA_SUPPORT
 #  include "ntt_avx512_ifma.h"
 #  include "ntt_hexl.h"
@@ -23,23 +29,32 @@
 void report_test_fwd_perf_headers(void)
 {
   printf("                     |            fwd                                  "
-         "                  |          fwd-lazy\n");
+         "                                                                              |          fwd-lazy\n");
   printf("-----------------------------------------------------------------------"
-         "---------------------");
+         "---------------------------------------------------------------------------------");
   printf("--------------------------------------\n");
   printf("  N                q");
   printf("  rad2-ref");
   printf(" rad2-SEAL");
   printf("      rad4");
   printf("    rad4x4");
+  printf("      rad8");
+  printf("  rad4-rec");
+  printf(" rad4-gvec");
+#ifdef AVX512_SUPPORT
+  printf(" r4-avx512");
+#endif
 #ifdef S390X
   printf(" rad4-vmsl");
 #elif AVX512_IFMA_SUPPORT
   printf(" rad2-hexl");
   printf(" rad2-ifma");
+  printf(" rad4-leaf");
+  printf("  rec-ifma");
   printf(" rad2-ifma2");
   printf(" r4r2-ifma");
   printf(" r216-ifma");
+  printf("   r8-ifma");
 #endif
   printf("  rad2-dbl");
 #ifdef S390X
@@ -77,6 +92,23 @@ static inline void test_fwd_perf(const test_case_t *t,
   MEASURE(fwd_ntt_radix4x4(a, n, q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr));
   memcpy(a, a_cpy, n * sizeof(uint64_t));
 
+  MEASURE(fwd_ntt_radix8(a, n, q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr));
+  memcpy(a, a_cpy, n * sizeof(uint64_t));
+
+  MEASURE(
+    fwd_ntt_radix4_rec(a, n, q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr));
+  memcpy(a, a_cpy, n * sizeof(uint64_t));
+
+  MEASURE(
+    fwd_ntt_radix4_gvec(a, n, q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr));
+  memcpy(a, a_cpy, n * sizeof(uint64_t));
+
+#ifdef AVX512_SUPPORT
+  MEASURE(fwd_ntt_radix4_avx512(a, n, q, t->w_powers_r4_avx512.ptr,
+                                t->w_powers_con_r4_avx512.ptr));
+  memcpy(a, a_cpy, n * sizeof(uint64_t));
+#endif
+
 #ifdef S390X
   MEASURE(fwd_ntt_radix4_intrinsic(a, n, q, t->w_powers_r4.ptr,
                                    t->w_powers_con_r4_vmsl.ptr));
@@ -91,6 +123,16 @@ static inline void test_fwd_perf(const test_case_t *t,
                                      t->w_powers_con_r4_avx512_ifma.ptr));
   memcpy(a, a_cpy, n * sizeof(uint64_t));
 
+  MEASURE(fwd_ntt_radix4_avx512_ifma_leaf(
+    a, t->n, t->q, t->w_powers_r4_leaf_avx512_ifma.ptr,
+    t->w_powers_con_r4_leaf_avx512_ifma.ptr));
+  memcpy(a, a_cpy, n * sizeof(uint64_t));
+
+  MEASURE(fwd_ntt_radix4_avx512_ifma_rec(
+    a, t->n, t->q, t->w_powers_r4_leaf_avx512_ifma.ptr,
+    t->w_powers_con_r4_leaf_avx512_ifma.ptr));
+  memcpy(a, a_cpy, n * sizeof(uint64_t));
+
   MEASURE(fwd_ntt_radix4_avx512_ifma_unordered(
     a, t->n, t->q, t->w_powers_r4_avx512_ifma_unordered.ptr,
     t->w_powers_con_r4_avx512_ifma_unordered.ptr));
@@ -105,6 +147,11 @@ static inline void test_fwd_perf(const test_case_t *t,
                                     t->w_powers_r2_16_avx512_ifma.ptr,
                                     t->w_powers_con_r2_16_avx512_ifma.ptr));
   memcpy(a, a_cpy, n * sizeof(uint64_t));
+
+  MEASURE(fwd_ntt_radix8_avx512_ifma(a, t->n, t->q,
+                                     t->w_powers_r8_avx512_ifma.ptr,
+                                     t->w_powers_con_r8_avx512_ifma.ptr));
+  memcpy(a, a_cpy, n * sizeof(uint64_t));
 #endif
 
   MEASURE(fwd_ntt_ref_harvey_dbl(a, b, t->n, t->q, t->w_powers.ptr,
@@ -168,9 +215,11 @@ void test_unaligned_fwd_perf(const test_case_t *t)
   unaligned64_ptr_t a;
   unaligned64_ptr_t b;
   unaligned64_ptr_t a_cpy;
-  allocate_unaligned_array(&a, n);
-  allocate_unaligned_array(&b, n);
-  allocate_unaligned_array(&a_cpy, n);
+  if((SUCCESS != allocate_unaligned_array(&a, n)) ||
+     (SUCCESS != allocate_unaligned_array(&b, n)) ||
+     (SUCCESS != allocate_unaligned_array(&a_cpy, n))) {
+    return;
+  }
 
   random_buf(a.ptr, n, q);
   memset(a_cpy.ptr, 0, n * sizeof(uint64_t));
@@ -188,15 +237,27 @@ void test_unaligned_fwd_perf(const test_case_t *t)
 void report_test_inv_perf_headers(void)
 {
   printf("                     |            inv\n");
-  printf("------------------------------------------------------\n");
+  printf("--------------------------------------------------------------------"
+         "----------------\n");
   printf("  N                q");
 
   printf("  rad2-ref");
   printf(" rad2-SEAL");
   printf("      rad4");
+  printf("      rad8");
+  printf("  rad4-rec");
+  printf(" rad4-gvec");
+#ifdef AVX512_SUPPORT
+  printf(" r4-avx512");
+#endif
 
 #ifdef S390X
   printf(" rad4-vmsl");
+  printf(" rad4v-dbl");
+#elif AVX512_IFMA_SUPPORT
+  printf(" rad2-hexl");
+  printf("   r8-ifma");
+  printf(" r4-ifma-u");
 #endif
 
   printf("\n");
@@ -229,14 +290,235 @@ void test_inv_perf(const test_case_t *t)
                          t->w_inv_powers_con_r4.ptr));
   memcpy(a, a_cpy, sizeof(a));
 
+  MEASURE(inv_ntt_radix8(a, n, q, t->n_inv, t->w_inv_powers_r4.ptr,
+                         t->w_inv_powers_con_r4.ptr));
+  memcpy(a, a_cpy, sizeof(a));
+
+  MEASURE(inv_ntt_radix4_rec(a, n, q, t->n_inv, t->w_inv_powers_r4.ptr,
+                             t->w_inv_powers_con_r4.ptr));
+  memcpy(a, a_cpy, sizeof(a));
+
+  MEASURE(inv_ntt_radix4_gvec(a, n, q, t->n_inv, t->w_inv_powers_r4.ptr,
+                              t->w_inv_powers_con_r4.ptr));
+  memcpy(a, a_cpy, sizeof(a));
+
+#ifdef AVX512_SUPPORT
+  MEASURE(inv_ntt_radix4_avx512(a, n, q, t->n_inv, t->w_inv_powers_r4_avx512.ptr,
+                                t->w_inv_powers_con_r4_avx512.ptr));
+  memcpy(a, a_cpy, sizeof(a));
+#endif
+
 #ifdef S390X
   MEASURE(inv_ntt_radix4_intrinsic(a, n, q, t->n_inv_vmsl, t->w_inv_powers_r4.ptr,
                                    t->w_inv_powers_con_r4_vmsl.ptr));
+  memcpy(a, a_cpy, sizeof(a));
+
+  uint64_t b[n];
+  memcpy(b, a_cpy, sizeof(b));
+  MEASURE(inv_ntt_radix4_intrinsic_dbl(a, b, n, q, t->n_inv_vmsl,
+                                       t->w_inv_powers_r4.ptr,
+                                       t->w_inv_powers_con_r4_vmsl.ptr));
+#elif AVX512_IFMA_SUPPORT
+  MEASURE(inv_ntt_radix2_hexl(a, n, q, t->w_inv_powers_hexl.ptr,
+                              t->w_inv_powers_con_hexl.ptr));
+  memcpy(a, a_cpy, sizeof(a));
+
+  MEASURE(inv_ntt_radix8_avx512_ifma(a, n, q, t->n_inv_avx512_ifma,
+                                     t->w_inv_powers_r8_avx512_ifma.ptr,
+                                     t->w_inv_powers_con_r8_avx512_ifma.ptr));
+  memcpy(a, a_cpy, sizeof(a));
+
+  MEASURE(inv_ntt_radix4_avx512_ifma_unordered(
+    a, n, q, t->n_inv_avx512_ifma, t->w_inv_powers_r4_avx512_ifma_unordered.ptr,
+    t->w_inv_powers_con_r4_avx512_ifma_unordered.ptr));
 #endif
 
   printf("\n");
 }
 
+void report_test_cyclic_perf_headers(void)
+{
+  printf("                     |     cyclic N     |  negacyclic 2N\n");
+  printf("--------------------------------------------------------------\n");
+  printf("  N                q");
+  printf("      rad4");
+#ifdef AVX512_SUPPORT
+  printf(" r4-avx512");
+#endif
+  printf("      rad4");
+#ifdef AVX512_SUPPORT
+  printf(" r4-avx512");
+#endif
+  printf("\n");
+}
+
+// A fwd + inv pair (the transforms of a cyclic convolution) with the cyclic
+// tables of t, against the same pair on the input zero-padded to 2N with a
+// negacyclic NTT, which computes the same cyclic convolution. The 2N case
+// uses a generated prime of the same size as q, the row is skipped if there
+// is none.
+void test_cyclic_perf(const test_case_t *t)
+{
+  const uint64_t n      = t->n;
+  const uint64_t q      = t->q;
+  const uint64_t q_bits = 64 - __builtin_clzl(q);
+  test_case_t    t2;
+
+  if(!init_generated_test(&t2, t->m + 1, q_bits)) {
+    return;
+  }
+
+  aligned64_ptr_t a;
+  if(SUCCESS != allocate_aligned_array(&a, 2 * n)) {
+    _destroy_test(&t2);
+    return;
+  }
+
+  printf("%3.0lu 0x%14.0lx ", t->m, q);
+
+  // Every fwd + inv pair returns the input, so a does not need a reset.
+  random_buf(a.ptr, n, q);
+  MEASURE(fwd_ntt_radix4(a.ptr, n, q, t->w_powers_cyclic_r4.ptr,
+                         t->w_powers_con_cyclic_r4.ptr);
+          inv_ntt_radix4(a.ptr, n, q, t->n_inv, t->w_inv_powers_cyclic_r4.ptr,
+                         t->w_inv_powers_con_cyclic_r4.ptr));
+
+#ifdef AVX512_SUPPORT
+  if(!(q & AVX512_MAX_MODULUS_MASK) && (n >= RADIX4_AVX512_IFMA_LEAF_MIN_N)) {
+    MEASURE(
+      fwd_ntt_radix4_avx512(a.ptr, n, q, t->w_powers_cyclic_r4_avx512.ptr,
+                            t->w_powers_con_cyclic_r4_avx512.ptr);
+      inv_ntt_radix4_avx512(a.ptr, n, q, t->n_inv,
+                            t->w_inv_powers_cyclic_r4_avx512.ptr,
+                            t->w_inv_powers_con_cyclic_r4_avx512.ptr));
+  } else {
+    printf("%9s ", "-");
+  }
+#endif
+
+  random_buf(a.ptr, n, t2.q);
+  memset(&a.ptr[n], 0, n * sizeof(uint64_t));
+  MEASURE(fwd_ntt_radix4(a.ptr, t2.n, t2.q, t2.w_powers_r4.ptr,
+                         t2.w_powers_con_r4.ptr);
+          inv_ntt_radix4(a.ptr, t2.n, t2.q, t2.n_inv, t2.w_inv_powers_r4.ptr,
+                         t2.w_inv_powers_con_r4.ptr));
+
+#ifdef AVX512_SUPPORT
+  if(!(t2.q & AVX512_MAX_MODULUS_MASK)) {
+    MEASURE(fwd_ntt_radix4_avx512(a.ptr, t2.n, t2.q, t2.w_powers_r4_avx512.ptr,
+                                  t2.w_powers_con_r4_avx512.ptr);
+            inv_ntt_radix4_avx512(a.ptr, t2.n, t2.q, t2.n_inv,
+                                  t2.w_inv_powers_r4_avx512.ptr,
+                                  t2.w_inv_powers_con_r4_avx512.ptr));
+  } else {
+    printf("%9s ", "-");
+  }
+#endif
+
+  printf("\n");
+  free_aligned_array(&a);
+  _destroy_test(&t2);
+}
+
+void report_test_oop_perf_headers(void)
+{
+  printf("                     |          fwd        ");
+#ifdef AVX512_SUPPORT
+  printf("|                 fwd            |                 inv          ");
+#endif
+#ifdef AVX512_IFMA_SUPPORT
+  printf("|      fwd ifma");
+#endif
+  printf("\n");
+  printf("-----------------------------------------");
+#ifdef AVX512_SUPPORT
+  printf("------------------------------------------------------------------");
+#endif
+#ifdef AVX512_IFMA_SUPPORT
+  printf("--------------------");
+#endif
+  printf("\n  N                q");
+  printf("  cpy+rad4");
+  printf("  rad4-oop");
+#ifdef AVX512_SUPPORT
+  printf("cpy+avx512");
+  printf("avx512-oop");
+  printf(" avx512-nt");
+  printf("cpy+avx512");
+  printf("avx512-oop");
+  printf(" avx512-nt");
+#endif
+#ifdef AVX512_IFMA_SUPPORT
+  printf("  cpy+ifma");
+  printf("  ifma-oop");
+#endif
+  printf("\n");
+}
+
+// The copy of the input followed by an in-place NTT, against the out-of-place
+// NTT of the same input, and with non-temporal stores (nt) of the output.
+void test_oop_perf(const test_case_t *t)
+{
+  const uint64_t  n = t->n;
+  const uint64_t  q = t->q;
+  aligned64_ptr_t src;
+  aligned64_ptr_t dst;
+
+  if(SUCCESS != allocate_aligned_array(&src, n)) {
+    return;
+  }
+  if(SUCCESS != allocate_aligned_array(&dst, n)) {
+    free_aligned_array(&src);
+    return;
+  }
+
+  printf("%3.0lu 0x%14.0lx ", t->m, q);
+  random_buf(src.ptr, n, q);
+
+  MEASURE(memcpy(dst.ptr, src.ptr, n * sizeof(uint64_t));
+          fwd_ntt_radix4(dst.ptr, n, q, t->w_powers_r4.ptr,
+                         t->w_powers_con_r4.ptr));
+  MEASURE(fwd_ntt_radix4_oop(dst.ptr, src.ptr, n, q, t->w_powers_r4.ptr,
+                             t->w_powers_con_r4.ptr));
+
+#ifdef AVX512_SUPPORT
+  if(!(q & AVX512_MAX_MODULUS_MASK) && (n >= RADIX4_AVX512_IFMA_LEAF_MIN_N)) {
+    const uint64_t *w         = t->w_powers_r4_avx512.ptr;
+    const uint64_t *w_con     = t->w_powers_con_r4_avx512.ptr;
+    const uint64_t *w_inv     = t->w_inv_powers_r4_avx512.ptr;
+    const uint64_t *w_inv_con = t->w_inv_powers_con_r4_avx512.ptr;
+
+    MEASURE(memcpy(dst.ptr, src.ptr, n * sizeof(uint64_t));
+            fwd_ntt_radix4_avx512(dst.ptr, n, q, w, w_con));
+    MEASURE(fwd_ntt_radix4_avx512_oop(dst.ptr, src.ptr, n, q, w, w_con, 0));
+    MEASURE(fwd_ntt_radix4_avx512_oop(dst.ptr, src.ptr, n, q, w, w_con, 1));
+
+    // src is in [0, q), a valid input of the inverse NTT.
+    MEASURE(memcpy(dst.ptr, src.ptr, n * sizeof(uint64_t));
+            inv_ntt_radix4_avx512(dst.ptr, n, q, t->n_inv, w_inv, w_inv_con));
+    MEASURE(inv_ntt_radix4_avx512_oop(dst.ptr, src.ptr, n, q, t->n_inv, w_inv,
+                                      w_inv_con, 0));
+    MEASURE(inv_ntt_radix4_avx512_oop(dst.ptr, src.ptr, n, q, t->n_inv, w_inv,
+                                      w_inv_con, 1));
+  }
+#endif
+
+#ifdef AVX512_IFMA_SUPPORT
+  if(!(q & AVX512_IFMA_MAX_MODULUS_MASK)) {
+    const uint64_t *w     = t->w_powers_r4_avx512_ifma.ptr;
+    const uint64_t *w_con = t->w_powers_con_r4_avx512_ifma.ptr;
+
+    MEASURE(memcpy(dst.ptr, src.ptr, n * sizeof(uint64_t));
+            fwd_ntt_radix4_avx512_ifma(dst.ptr, n, q, w, w_con));
+    MEASURE(fwd_ntt_radix4_avx512_ifma_oop(dst.ptr, src.ptr, n, q, w, w_con));
+  }
+#endif
+
+  printf("\n");
+  free_aligned_array(&src);
+  free_aligned_array(&dst);
+}
+
 void test_fwd_single_case(const test_case_t *t, const func_num_t func_num)
 {
   const uint64_t n = t->n;
@@ -265,6 +547,24 @@ void test_fwd_single_case(const test_case_t *t, const func_num_t func_num)
       MEASURE(
         fwd_ntt_radix4x4(a, n, q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr));
       break;
+    case FWD_R4_REC:
+      MEASURE(fwd_ntt_radix4_rec(a, t->n, t->q, t->w_powers_r4.ptr,
+                                 t->w_powers_con_r4.ptr));
+      break;
+    case FWD_R8:
+      MEASURE(
+        fwd_ntt_radix8(a, n, q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr));
+      break;
+    case FWD_R4_GVEC:
+      MEASURE(fwd_ntt_radix4_gvec(a, n, q, t->w_powers_r4.ptr,
+                                  t->w_powers_con_r4.ptr));
+      break;
+#ifdef AVX512_SUPPORT
+    case FWD_R4_AVX512:
+      MEASURE(fwd_ntt_radix4_avx512(a, n, q, t->w_powers_r4_avx512.ptr,
+                                    t->w_powers_con_r4_avx512.ptr));
+      break;
+#endif
     case FWD_R4_VMSL:
 #ifdef S390X
       MEASURE(fwd_ntt_radix4_intrinsic(a, n, q, t->w_powers_r4.ptr,
@@ -280,6 +580,16 @@ void test_fwd_single_case(const test_case_t *t, const func_num_t func_num)
                                          t->w_powers_r4_avx512_ifma.ptr,
                                          t->w_powers_con_r4_avx512_ifma.ptr));
       break;
+    case FWD_R4_AVX512_IFMA_LEAF:
+      MEASURE(fwd_ntt_radix4_avx512_ifma_leaf(
+        a, t->n, t->q, t->w_powers_r4_leaf_avx512_ifma.ptr,
+        t->w_powers_con_r4_leaf_avx512_ifma.ptr));
+      break;
+    case FWD_R4_AVX512_IFMA_REC:
+      MEASURE(fwd_ntt_radix4_avx512_ifma_rec(
+        a, t->n, t->q, t->w_powers_r4_leaf_avx512_ifma.ptr,
+        t->w_powers_con_r4_leaf_avx512_ifma.ptr));
+      break;
     case FWD_R4_AVX512_IFMA_UNORDERED:
       MEASURE(fwd_ntt_radix4_avx512_ifma_unordered(
         a, t->n, t->q, t->w_powers_r4_avx512_ifma_unordered.ptr,
@@ -295,6 +605,11 @@ void test_fwd_single_case(const test_case_t *t, const func_num_t func_num)
                                         t->w_powers_r2_16_avx512_ifma.ptr,
                                         t->w_powers_con_r2_16_avx512_ifma.ptr));
       break;
+    case FWD_R8_AVX512_IFMA:
+      MEASURE(fwd_ntt_radix8_avx512_ifma(a, t->n, t->q,
+                                         t->w_powers_r8_avx512_ifma.ptr,
+                                         t->w_powers_con_r8_avx512_ifma.ptr));
+      break;
 #endif
     default: break;
   }
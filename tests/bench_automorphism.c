@@ -0,0 +1,145 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+// A slot rotation (Galois element 5) of 1..8 RNS limbs of 2^12..2^16
+// coefficients: the NTT-domain permutation (scalar and AVX512-F gathers)
+// against the inverse NTT, the automorphism in the coefficient domain and the
+// forward NTT of every limb. The output is CSV, in ns per rotation.
+
+#include <string.h>
+
+#include "measurements.h"
+#include "ntt_automorphism.h"
+#include "ntt_radix4.h"
+#include "pre_compute.h"
+#include "tests.h"
+#include "utils.h"
+
+#if defined(TEST_SPEED) && !defined(INTEL_SDE)
+
+#  define GALOIS_BENCH_MIN_M     12
+#  define GALOIS_BENCH_MAX_M     16
+#  define GALOIS_BENCH_MAX_LIMBS 8
+
+typedef struct galois_bench_s {
+  uint64_t  n;
+  uint64_t  q;
+  uint64_t  g;
+  mul_op_t  n_inv;
+  uint64_t *w;
+  uint64_t *w_con;
+  uint64_t *w_inv;
+  uint64_t *w_inv_con;
+} galois_bench_t;
+
+// The rotation through the coefficient domain: out = NTT(sigma_g(NTT^-1(in))).
+// in is used as a scratch buffer.
+static inline void rotate_via_coeffs(const galois_bench_t *b,
+                                     uint64_t              out[],
+                                     uint64_t              in[],
+                                     const uint64_t        num_limbs)
+{
+  const uint64_t n = b->n;
+
+  for(size_t l = 0; l < num_limbs; l++) {
+    uint64_t *src = &in[l * n];
+    uint64_t *dst = &out[l * n];
+
+    inv_ntt_radix4(src, n, b->q, b->n_inv, b->w_inv, b->w_inv_con);
+    for(size_t i = 0; i < n; i++) {
+      const size_t j = (i * b->g) % (2 * n);
+      if(j < n) {
+        dst[j] = src[i];
+      } else {
+        dst[j - n] = b->q - src[i];
+      }
+    }
+    fwd_ntt_radix4_lazy(dst, n, b->q, b->w, b->w_con);
+  }
+}
+
+static inline int bench_galois_size(const uint64_t m, const uint64_t q_bits)
+{
+  const uint64_t  n     = 1UL << m;
+  const uint64_t  iters = BENCH_ITERS(n);
+  const uint64_t  q     = find_ntt_prime(2 * n, q_bits);
+  const uint64_t  ninv  = inv_mod(n, q);
+  aligned64_ptr_t in    = {0};
+  aligned64_ptr_t out   = {0};
+  aligned64_ptr_t tbl   = {0};
+  galois_bench_t  b     = {0};
+
+  if((0 == q) ||
+     (SUCCESS !=
+      allocate_aligned_array(&in, GALOIS_BENCH_MAX_LIMBS * n)) ||
+     (SUCCESS !=
+      allocate_aligned_array(&out, GALOIS_BENCH_MAX_LIMBS * n)) ||
+     (SUCCESS != allocate_aligned_array(&tbl, 9 * n))) {
+    free_aligned_array(&in);
+    free_aligned_array(&out);
+    free_aligned_array(&tbl);
+    return ERROR;
+  }
+
+  // The map (n uint32_t) follows the four tables of 2n qw.
+  uint32_t *map = (uint32_t *)&tbl.ptr[8 * n];
+
+  b.n           = n;
+  b.q           = q;
+  b.g           = galois_elt_rotation(1, n);
+  b.n_inv.op    = ninv;
+  b.n_inv.con   = calc_ninv_con(ninv, q, WORD_SIZE);
+  b.w           = tbl.ptr;
+  b.w_con       = &tbl.ptr[2 * n];
+  b.w_inv       = &tbl.ptr[4 * n];
+  b.w_inv_con   = &tbl.ptr[6 * n];
+
+  // The w-powers are computed in out and expanded into the tables.
+  const uint64_t psi = find_primitive_root(2 * n, q);
+  calc_w(out.ptr, psi, n, q, m);
+  expand_w(b.w, out.ptr, n, q);
+  calc_w_con(b.w_con, b.w, 2 * n, q, WORD_SIZE);
+  calc_w_inv(out.ptr, inv_mod(psi, q), n, q, m);
+  expand_w(b.w_inv, out.ptr, n, q);
+  calc_w_con(b.w_inv_con, b.w_inv, 2 * n, q, WORD_SIZE);
+  calc_automorphism_map(map, b.g, n, m);
+
+  // Every output is a valid input, so the buffers are not reset between the
+  // calls.
+  random_buf(in.ptr, GALOIS_BENCH_MAX_LIMBS * n, q);
+
+  for(uint64_t limbs = 1; limbs <= GALOIS_BENCH_MAX_LIMBS; limbs <<= 1) {
+    printf("%lu,%lu", m, limbs);
+    MEASURE_ITERS(iters, ntt_automorphism(out.ptr, in.ptr, map, n, limbs));
+    printf(",%.0f", total_clk);
+#  ifdef AVX512_SUPPORT
+    MEASURE_ITERS(iters,
+                  ntt_automorphism_avx512(out.ptr, in.ptr, map, n, limbs));
+    printf(",%.0f", total_clk);
+#  else
+    printf(",");
+#  endif
+    MEASURE_ITERS(iters, rotate_via_coeffs(&b, out.ptr, in.ptr, limbs));
+    printf(",%.0f", total_clk);
+    printf("\n");
+  }
+
+  free_aligned_array(&in);
+  free_aligned_array(&out);
+  free_aligned_array(&tbl);
+  return SUCCESS;
+}
+
+void run_galois_bench(const uint64_t q_bits)
+{
+  printf("logN,limbs,perm_ns,perm_avx512_ns,via_coeffs_ns\n");
+
+  for(uint64_t m = GALOIS_BENCH_MIN_M; m <= GALOIS_BENCH_MAX_M; m += 2) {
+    if(SUCCESS != bench_galois_size(m, q_bits)) {
+      printf("# no prime for 2^%lu and %lu bits\n", m, q_bits);
+      return;
+    }
+  }
+}
+
+#endif
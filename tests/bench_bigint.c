@@ -0,0 +1,110 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+// Big-integer multiplication: the NTT against the schoolbook and Karatsuba
+// multiplications for 10^4..10^8-bit operands. The output is CSV, in ns per
+// product. The quadratic and Karatsuba columns stop at the sizes where a
+// single product takes seconds.
+
+#include <string.h>
+
+#include "measurements.h"
+#include "ntt_bigint.h"
+#include "tests.h"
+#include "utils.h"
+
+#if defined(TEST_SPEED) && !defined(INTEL_SDE)
+
+#  define BIGINT_BENCH_SCHOOLBOOK_MAX_LIMBS (1UL << 14)
+#  define BIGINT_BENCH_KARATSUBA_MAX_LIMBS  (1UL << 18)
+
+static const uint64_t bigint_bench_bits[] = {
+  10000,    30000,    100000,   300000,   1000000,
+  3000000,  10000000, 30000000, 100000000};
+
+#  define BIGINT_BENCH_NUM_OF_SIZES \
+    (sizeof(bigint_bench_bits) / sizeof(bigint_bench_bits[0]))
+
+// Full 64-bit limbs (rand() has at least 15 random bits).
+static inline void random_limbs(uint64_t a[], const size_t len)
+{
+  for(size_t i = 0; i < len; i++) {
+    a[i] = ((uint64_t)rand() << 48) ^ ((uint64_t)rand() << 32) ^
+           ((uint64_t)rand() << 16) ^ (uint64_t)rand();
+  }
+}
+
+static inline int bench_products(uint64_t       c[],
+                                 const uint64_t a[],
+                                 const uint64_t b[],
+                                 const uint64_t len)
+{
+  const uint64_t    iters = BENCH_ITERS(len);
+  uint64_t          m     = BIGINT_MIN_M;
+  bigint_mul_plan_t plan;
+
+  while((1UL << m) < (2 * len - 1)) {
+    m++;
+  }
+  printf("%lu,%lu,", len, m);
+
+  if(len <= BIGINT_BENCH_SCHOOLBOOK_MAX_LIMBS) {
+    MEASURE_ITERS(1, bigint_mul_schoolbook(c, a, len, b, len));
+    printf("%.0f", total_clk);
+  }
+  printf(",");
+
+  if(len <= BIGINT_BENCH_KARATSUBA_MAX_LIMBS) {
+    MEASURE_ITERS(1, bigint_mul_karatsuba(c, a, b, len));
+    printf("%.0f", total_clk);
+  }
+  printf(",");
+
+  // The plan is created once, as for repeated products of the same size.
+  if(SUCCESS != bigint_mul_plan_init(&plan, m)) {
+    printf("\n");
+    return ERROR;
+  }
+  MEASURE_ITERS(iters, bigint_mul_ntt(&plan, c, a, len, b, len));
+  printf("%.0f\n", total_clk);
+  bigint_mul_plan_destroy(&plan);
+
+  return SUCCESS;
+}
+
+static inline int bench_bigint_size(const uint64_t bits)
+{
+  const uint64_t  len = (bits + 63) / 64;
+  aligned64_ptr_t a   = {0};
+  aligned64_ptr_t b   = {0};
+  aligned64_ptr_t c   = {0};
+  int             ret = ERROR;
+
+  if((SUCCESS == allocate_aligned_array(&a, len)) &&
+     (SUCCESS == allocate_aligned_array(&b, len)) &&
+     (SUCCESS == allocate_aligned_array(&c, 2 * len))) {
+    random_limbs(a.ptr, len);
+    random_limbs(b.ptr, len);
+    printf("%lu,", bits);
+    ret = bench_products(c.ptr, a.ptr, b.ptr, len);
+  }
+
+  free_aligned_array(&a);
+  free_aligned_array(&b);
+  free_aligned_array(&c);
+  return ret;
+}
+
+void run_bigint_bench(void)
+{
+  printf("bits,limbs,logN,schoolbook_ns,karatsuba_ns,ntt_ns\n");
+
+  for(size_t i = 0; i < BIGINT_BENCH_NUM_OF_SIZES; i++) {
+    if(SUCCESS != bench_bigint_size(bigint_bench_bits[i])) {
+      printf("# allocation failure for %lu bits\n", bigint_bench_bits[i]);
+      return;
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,117 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+// The Goldilocks NTTs (scalar, AVX2 and AVX512-F) for N = 2^16..2^24: the
+// lazy forward and the inverse NTT of every variant, in ns per NTT. Each size
+// also checks that the inverse NTT of the forward one returns the input, the
+// correctness tests stop at 2^17. The output is CSV, the columns of the
+// variants that are not built are empty.
+
+#include <string.h>
+
+#include "measurements.h"
+#include "ntt_goldilocks.h"
+#include "pre_compute.h"
+#include "tests.h"
+#include "utils.h"
+
+#if defined(TEST_SPEED) && !defined(INTEL_SDE)
+
+#  define GOLDILOCKS_BENCH_MIN_M 16
+#  define GOLDILOCKS_BENCH_MAX_M 24
+
+typedef void (*goldilocks_fwd_t)(uint64_t a[], uint64_t N, const uint64_t w[]);
+typedef void (*goldilocks_inv_t)(uint64_t       a[],
+                                 uint64_t       N,
+                                 uint64_t       n_inv,
+                                 const uint64_t w_inv[]);
+
+typedef struct goldilocks_bench_s {
+  uint64_t  n;
+  uint64_t  n_inv;
+  uint64_t *w;
+  uint64_t *w_inv;
+  uint64_t *a;
+  uint64_t *src;
+} goldilocks_bench_t;
+
+// Times fwd and inv on b->a and returns 1 when inv(fwd(src)) == src.
+static inline int bench_variant(const goldilocks_bench_t *b,
+                                const goldilocks_fwd_t    fwd,
+                                const goldilocks_inv_t    inv)
+{
+  const uint64_t n     = b->n;
+  // 4x the usual work (~2^24 coefficients), as the sizes go up to 2^24.
+  const uint64_t iters = 4 * BENCH_ITERS(n);
+
+  // The lazy output is any 64-bit value and the inverse output is in [0, p),
+  // both are valid inputs, so a is not reset between the calls.
+  MEASURE_ITERS(iters, fwd(b->a, n, b->w));
+  printf(",%.0f", total_clk);
+  MEASURE_ITERS(iters, inv(b->a, n, b->n_inv, b->w_inv));
+  printf(",%.0f", total_clk);
+
+  memcpy(b->a, b->src, n * sizeof(uint64_t));
+  fwd(b->a, n, b->w);
+  inv(b->a, n, b->n_inv, b->w_inv);
+  return 0 == memcmp(b->a, b->src, n * sizeof(uint64_t));
+}
+
+static inline int bench_goldilocks_size(const uint64_t m)
+{
+  const uint64_t     n   = 1UL << m;
+  const uint64_t     psi = find_primitive_root(2 * n, GOLDILOCKS_Q);
+  aligned64_ptr_t    tbl = {0};
+  goldilocks_bench_t b   = {0};
+  int                ok  = 1;
+
+  // w, w_inv, a and src.
+  if((0 == psi) || (SUCCESS != allocate_aligned_array(&tbl, 4 * n))) {
+    return ERROR;
+  }
+
+  b.n     = n;
+  b.n_inv = inv_mod(n, GOLDILOCKS_Q);
+  b.w     = tbl.ptr;
+  b.w_inv = &tbl.ptr[n];
+  b.a     = &tbl.ptr[2 * n];
+  b.src   = &tbl.ptr[3 * n];
+
+  calc_w(b.w, psi, n, GOLDILOCKS_Q, m);
+  calc_w_inv(b.w_inv, inv_mod(psi, GOLDILOCKS_Q), n, GOLDILOCKS_Q, m);
+  random_buf(b.src, n, GOLDILOCKS_Q);
+  memcpy(b.a, b.src, n * sizeof(uint64_t));
+
+  printf("%lu", m);
+  ok &= bench_variant(&b, fwd_ntt_goldilocks_lazy, inv_ntt_goldilocks);
+#  ifdef __AVX2__
+  ok &= bench_variant(&b, fwd_ntt_goldilocks_avx2_lazy, inv_ntt_goldilocks_avx2);
+#  else
+  printf(",,");
+#  endif
+#  ifdef AVX512_SUPPORT
+  ok &= bench_variant(&b, fwd_ntt_goldilocks_avx512_lazy,
+                      inv_ntt_goldilocks_avx512);
+#  else
+  printf(",,");
+#  endif
+  printf(",%s\n", ok ? "ok" : "mismatch");
+
+  free_aligned_array(&tbl);
+  return SUCCESS;
+}
+
+void run_goldilocks_bench(void)
+{
+  printf("logN,fwd_ns,inv_ns,fwd_avx2_ns,inv_avx2_ns,fwd_avx512_ns,"
+         "inv_avx512_ns,roundtrip\n");
+
+  for(uint64_t m = GOLDILOCKS_BENCH_MIN_M; m <= GOLDILOCKS_BENCH_MAX_M; m += 2) {
+    if(SUCCESS != bench_goldilocks_size(m)) {
+      printf("# allocation failure for 2^%lu\n", m);
+      return;
+    }
+  }
+}
+
+#endif
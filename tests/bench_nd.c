@@ -0,0 +1,132 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+// 2D NTTs of 2^7 x 2^7 .. 2^10 x 2^10 grids: fwd_ntt_nd/inv_ntt_nd, whose
+// column NTTs run on vectors spanning adjacent columns, against a 2D NTT that
+// transposes the grid (twice) to transform the columns as rows, and one that
+// gathers every column into a contiguous buffer. The output is CSV, in ns per
+// 2D NTT.
+
+#include <string.h>
+
+#include "measurements.h"
+#include "ntt_nd.h"
+#include "ntt_radix4_gvec.h"
+#include "pre_compute.h"
+#include "tests.h"
+#include "utils.h"
+
+#if defined(TEST_SPEED) && !defined(INTEL_SDE)
+
+#  define ND_BENCH_MIN_M 7
+#  define ND_BENCH_MAX_M 10
+
+// The transposes are blocked in ND_BENCH_TILE x ND_BENCH_TILE tiles.
+#  define ND_BENCH_TILE 16
+
+// out = in^T, where in is rows x cols (both multiples of ND_BENCH_TILE).
+static inline void transpose(uint64_t       out[],
+                             const uint64_t in[],
+                             const size_t   rows,
+                             const size_t   cols)
+{
+  for(size_t r0 = 0; r0 < rows; r0 += ND_BENCH_TILE) {
+    for(size_t c0 = 0; c0 < cols; c0 += ND_BENCH_TILE) {
+      for(size_t r = r0; r < r0 + ND_BENCH_TILE; r++) {
+        for(size_t c = c0; c < c0 + ND_BENCH_TILE; c++) {
+          out[c * rows + r] = in[r * cols + c];
+        }
+      }
+    }
+  }
+}
+
+static inline void fwd_2d_transpose(const ntt_nd_plan_t *plan,
+                                    uint64_t             a[],
+                                    uint64_t             tmp[])
+{
+  const size_t rows = plan->n[0];
+  const size_t cols = plan->n[1];
+
+  fwd_ntt_radix4_strided(a, cols, 1, rows, cols, plan->q, plan->w[1],
+                         plan->w_con[1]);
+  transpose(tmp, a, rows, cols);
+  fwd_ntt_radix4_strided(tmp, rows, 1, cols, rows, plan->q, plan->w[0],
+                         plan->w_con[0]);
+  transpose(a, tmp, cols, rows);
+}
+
+static inline void
+fwd_2d_gather(const ntt_nd_plan_t *plan, uint64_t a[], uint64_t tmp[])
+{
+  const size_t rows = plan->n[0];
+  const size_t cols = plan->n[1];
+
+  fwd_ntt_radix4_strided(a, cols, 1, rows, cols, plan->q, plan->w[1],
+                         plan->w_con[1]);
+  for(size_t c = 0; c < cols; c++) {
+    for(size_t r = 0; r < rows; r++) {
+      tmp[r] = a[r * cols + c];
+    }
+    fwd_ntt_radix4_gvec(tmp, rows, plan->q, plan->w[0], plan->w_con[0]);
+    for(size_t r = 0; r < rows; r++) {
+      a[r * cols + c] = tmp[r];
+    }
+  }
+}
+
+static inline int bench_single_grid(const uint64_t m, const uint64_t q_bits)
+{
+  const uint64_t  n      = 1UL << (2 * m);
+  const uint64_t  iters  = BENCH_ITERS(n);
+  const uint64_t  dims[] = {m, m};
+  const uint64_t  q      = find_ntt_prime(2UL << m, q_bits);
+  aligned64_ptr_t a      = {0};
+  aligned64_ptr_t tmp    = {0};
+  ntt_nd_plan_t   plan;
+
+  if((0 == q) || (SUCCESS != ntt_nd_plan_init(&plan, dims, 2, q))) {
+    return ERROR;
+  }
+
+  if((SUCCESS != allocate_aligned_array(&a, n)) ||
+     (SUCCESS != allocate_aligned_array(&tmp, n))) {
+    free_aligned_array(&a);
+    free_aligned_array(&tmp);
+    ntt_nd_plan_destroy(&plan);
+    return ERROR;
+  }
+
+  // Every output is a valid input, so a is not reset between the calls.
+  random_buf(a.ptr, n, q);
+  printf("%lu,%lu", m, m);
+  MEASURE_ITERS(iters, fwd_ntt_nd(&plan, a.ptr));
+  printf(",%.0f", total_clk);
+  MEASURE_ITERS(iters, inv_ntt_nd(&plan, a.ptr));
+  printf(",%.0f", total_clk);
+  MEASURE_ITERS(iters, fwd_2d_transpose(&plan, a.ptr, tmp.ptr));
+  printf(",%.0f", total_clk);
+  MEASURE_ITERS(iters, fwd_2d_gather(&plan, a.ptr, tmp.ptr));
+  printf(",%.0f", total_clk);
+  printf("\n");
+
+  free_aligned_array(&a);
+  free_aligned_array(&tmp);
+  ntt_nd_plan_destroy(&plan);
+  return SUCCESS;
+}
+
+void run_nd_bench(const uint64_t q_bits)
+{
+  printf("log_rows,log_cols,fwd_nd_ns,inv_nd_ns,fwd_transpose_ns,"
+         "fwd_gather_ns\n");
+
+  for(uint64_t m = ND_BENCH_MIN_M; m <= ND_BENCH_MAX_M; m++) {
+    if(SUCCESS != bench_single_grid(m, q_bits)) {
+      printf("# no plan for 2^%lu x 2^%lu and %lu-bit q\n", m, m, q_bits);
+      return;
+    }
+  }
+}
+
+#endif
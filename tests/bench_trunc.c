@@ -0,0 +1,100 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+// The truncated forward NTT against the full one for zero-padded inputs of
+// 2^12, 2^14 and 2^16 coefficients, of which len = N/16 .. N are nonzero.
+// Every call starts from a fresh copy of the input (the truncated NTT needs
+// the zeros), the copy is timed separately and subtracted from both columns.
+// The output is CSV, in ns per NTT.
+
+#include <string.h>
+
+#include "measurements.h"
+#include "ntt_radix4.h"
+#include "pre_compute.h"
+#include "tests.h"
+#include "utils.h"
+
+#if defined(TEST_SPEED) && !defined(INTEL_SDE)
+
+static const uint64_t trunc_bench_m[] = {12, 14, 16};
+
+// The nonzero length in N/16 units.
+static const uint64_t trunc_bench_len16[] = {1, 2, 4, 6, 8, 12, 16};
+
+#  define TRUNC_BENCH_NUM_OF(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static inline int bench_trunc_size(const uint64_t m, const uint64_t q_bits)
+{
+  const uint64_t  n     = 1UL << m;
+  const uint64_t  iters = BENCH_ITERS(n);
+  const uint64_t  q     = find_ntt_prime(2 * n, q_bits);
+  aligned64_ptr_t a     = {0};
+  aligned64_ptr_t src   = {0};
+  aligned64_ptr_t w     = {0};
+  aligned64_ptr_t w_con = {0};
+  double          copy_ns;
+  double          full_ns;
+
+  if(0 == q) {
+    return ERROR;
+  }
+
+  if((SUCCESS != allocate_aligned_array(&a, n)) ||
+     (SUCCESS != allocate_aligned_array(&src, n)) ||
+     (SUCCESS != allocate_aligned_array(&w, 2 * n)) ||
+     (SUCCESS != allocate_aligned_array(&w_con, 2 * n))) {
+    free_aligned_array(&a);
+    free_aligned_array(&src);
+    free_aligned_array(&w);
+    free_aligned_array(&w_con);
+    return ERROR;
+  }
+
+  // The w-powers are computed in a and expanded into w.
+  calc_w(a.ptr, find_primitive_root(2 * n, q), n, q, m);
+  expand_w(w.ptr, a.ptr, n, q);
+  calc_w_con(w_con.ptr, w.ptr, 2 * n, q, WORD_SIZE);
+
+  for(size_t l = 0; l < TRUNC_BENCH_NUM_OF(trunc_bench_len16); l++) {
+    const uint64_t len = (trunc_bench_len16[l] * n) / 16;
+
+    memset(src.ptr, 0, n * sizeof(uint64_t));
+    random_buf(src.ptr, len, q);
+
+    MEASURE_ITERS(iters, memcpy(a.ptr, src.ptr, n * sizeof(uint64_t)));
+    copy_ns = total_clk;
+
+    MEASURE_ITERS(iters, memcpy(a.ptr, src.ptr, n * sizeof(uint64_t));
+                  fwd_ntt_radix4_lazy(a.ptr, n, q, w.ptr, w_con.ptr));
+    full_ns = total_clk - copy_ns;
+
+    MEASURE_ITERS(iters, memcpy(a.ptr, src.ptr, n * sizeof(uint64_t));
+                  fwd_ntt_radix4_trunc_lazy(a.ptr, n, len, q, w.ptr,
+                                            w_con.ptr));
+    total_clk -= copy_ns;
+
+    printf("%lu,%lu,%.0f,%.0f,%.0f,%.2f\n", m, len, copy_ns, full_ns,
+           total_clk, full_ns / total_clk);
+  }
+
+  free_aligned_array(&a);
+  free_aligned_array(&src);
+  free_aligned_array(&w);
+  free_aligned_array(&w_con);
+  return SUCCESS;
+}
+
+void run_trunc_bench(const uint64_t q_bits)
+{
+  printf("logN,len,copy_ns,full_ns,trunc_ns,speedup\n");
+
+  for(size_t i = 0; i < TRUNC_BENCH_NUM_OF(trunc_bench_m); i++) {
+    if(SUCCESS != bench_trunc_size(trunc_bench_m[i], q_bits)) {
+      printf("# no prime for 2^%lu and %lu bits\n", trunc_bench_m[i], q_bits);
+      return;
+    }
+  }
+}
+
+#endif
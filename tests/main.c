@@ -1,6 +1,8 @@
 // Copyright IBM Inc. All Rights Reserved.
 // SPDX-License-Identifier: Apache-2.0
 
+#include <string.h>
+
 #include "pre_compute.h"
 #include "tests.h"
 
@@ -9,6 +11,57 @@ int main(UNUSED int argc, UNUSED char *argv[])
   init_test_cases();
 
 #ifdef TEST_SPEED
+#  ifndef INTEL_SDE
+  // Usage: --sweep [q_bits] (default 49 bits, the AVX512-IFMA limit).
+  if((argc >= 2) && (0 == strcmp(argv[1], "--sweep"))) {
+    run_roofline_sweep((argc == 3) ? strtoul(argv[2], NULL, 0) : 49); // NOLINT
+    destroy_test_cases();
+    return SUCCESS;
+  }
+
+  // Usage: --tune <wisdom-file> [q_bits]
+  if((argc >= 3) && (0 == strcmp(argv[1], "--tune"))) {
+    run_autotune(argv[2], (argc == 4) ? strtoul(argv[3], NULL, 0) : 49); // NOLINT
+    destroy_test_cases();
+    return SUCCESS;
+  }
+
+  // Usage: --bigint
+  if((argc == 2) && (0 == strcmp(argv[1], "--bigint"))) {
+    run_bigint_bench();
+    destroy_test_cases();
+    return SUCCESS;
+  }
+
+  // Usage: --goldilocks
+  if((argc == 2) && (0 == strcmp(argv[1], "--goldilocks"))) {
+    run_goldilocks_bench();
+    destroy_test_cases();
+    return SUCCESS;
+  }
+
+  // Usage: --nd [q_bits] (default 50 bits)
+  if((argc >= 2) && (0 == strcmp(argv[1], "--nd"))) {
+    run_nd_bench((argc == 3) ? strtoul(argv[2], NULL, 0) : 50); // NOLINT
+    destroy_test_cases();
+    return SUCCESS;
+  }
+
+  // Usage: --galois [q_bits] (default 50 bits)
+  if((argc >= 2) && (0 == strcmp(argv[1], "--galois"))) {
+    run_galois_bench((argc == 3) ? strtoul(argv[2], NULL, 0) : 50); // NOLINT
+    destroy_test_cases();
+    return SUCCESS;
+  }
+
+  // Usage: --trunc [q_bits] (default 50 bits)
+  if((argc >= 2) && (0 == strcmp(argv[1], "--trunc"))) {
+    run_trunc_bench((argc == 3) ? strtoul(argv[2], NULL, 0) : 50); // NOLINT
+    destroy_test_cases();
+    return SUCCESS;
+  }
+#  endif
+
   if(argc == 2) {
     printf("Testing test 9 and func %ld cycle=", strtol(argv[1], NULL, 0));
     test_fwd_single_case(&tests[9], strtol(argv[1], NULL, 0));
@@ -34,6 +87,18 @@ int main(UNUSED int argc, UNUSED char *argv[])
     test_inv_perf(&tests[i]);
   }
 
+  printf("Testing cyclic NTT against the zero-padded negacyclic NTT\n\n");
+  report_test_cyclic_perf_headers();
+  for(size_t i = 0; i < NUM_OF_TEST_CASES; i++) {
+    test_cyclic_perf(&tests[i]);
+  }
+
+  printf("Testing out-of-place NTT against a copy and an in-place NTT\n\n");
+  report_test_oop_perf_headers();
+  for(size_t i = 0; i < NUM_OF_TEST_CASES; i++) {
+    test_oop_perf(&tests[i]);
+  }
+
 #else
 
   for(size_t i = 0; i < NUM_OF_TEST_CASES; i++) {
@@ -43,6 +108,25 @@ int main(UNUSED int argc, UNUSED char *argv[])
       return SUCCESS;
     }
   }
+
+  for(size_t i = 0; i < NUM_OF_GENERATED_CASES; i++) {
+    test_case_t t;
+    int         ret;
+
+    printf("Test %2.0lu (generated %lu-bit q, N=2^%lu)\n",
+           NUM_OF_TEST_CASES + i, generated_cases[i].q_bits,
+           generated_cases[i].m);
+    if(!init_generated_test(&t, generated_cases[i].m,
+                            generated_cases[i].q_bits)) {
+      printf("Bad generated test case\n");
+      break;
+    }
+    ret = test_correctness(&t);
+    _destroy_test(&t);
+    if(SUCCESS != ret) {
+      break;
+    }
+  }
 #endif
 
   destroy_test_cases();
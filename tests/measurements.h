@@ -33,6 +33,7 @@ static inline void SDE_SSC_MARK(unsigned int mark_id)
         x;             \
       } while(0);      \
       SDE_SSC_STOP
+#    define MEASURE_ITERS(iters, x) MEASURE(x)
 
 #  else
 #    define WARMUP        10
@@ -74,12 +75,36 @@ static inline uint64_t cpucycles(void)
       }                                                                  \
       printf("%9.0lu ", (uint64_t)total_clk);
 
+// The best of ITERS_REPEAT runs of iters calls, without a warmup and a print.
+// total_clk is left in ns per call. For the benches whose calls take up to
+// seconds, which scale iters with the input size.
+#    define ITERS_REPEAT 5
+#    define MEASURE_ITERS(iters, x)                                    \
+      do {                                                             \
+        total_clk = DBL_MAX;                                           \
+        for(size_t outer_itr = 0; outer_itr < ITERS_REPEAT;           \
+            outer_itr++) {                                             \
+          start_clk = cpucycles();                                     \
+          for(size_t clk_itr = 0; clk_itr < (iters); clk_itr++) {      \
+            x;                                                         \
+          }                                                            \
+          end_clk  = cpucycles();                                      \
+          temp_clk = (double)(end_clk - start_clk) / (double)(iters);  \
+          if(total_clk > temp_clk) total_clk = temp_clk;               \
+        }                                                              \
+      } while(0)
+
 #  endif
 #else
 #  define MEASURE(x) \
     do {             \
       x;             \
     } while(0)
+#  define MEASURE_ITERS(iters, x) MEASURE(x)
 #endif
 
+// The iters of MEASURE_ITERS that keep the clocked work roughly constant
+// (~2^22 elements) for inputs of n elements.
+#define BENCH_ITERS(n) (((1UL << 22) / (n)) + 1)
+
 EXTERNC_END
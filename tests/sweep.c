@@ -0,0 +1,399 @@
+// Copyright IBM Inc. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+// Roofline sweep: every forward kernel over N = 2^8..2^20 with generated primes.
+// The output is CSV. Each row carries the measured time, a traffic model,
+// and a STREAM-like bandwidth baseline measured at the same working-set size.
+
+#include <string.h>
+#include <unistd.h>
+
+#include "measurements.h"
+#include "ntt_autotune.h"
+#include "ntt_radix4.h"
+#include "ntt_radix4_gvec.h"
+#include "ntt_radix4x4.h"
+#include "ntt_radix8.h"
+#include "ntt_reference.h"
+#include "ntt_seal.h"
+#include "tests.h"
+#include "utils.h"
+
+#ifdef S390X
+#  include "ntt_radix4_s390x_vef.h"
+#endif
+
+#ifdef AVX512_SUPPORT
+#  include "ntt_avx512.h"
+#endif
+
+#ifdef AVX512_IFMA_SUPPORT
+#  include "ntt_avx512_ifma.h"
+#  include "ntt_hexl.h"
+#endif
+
+#if defined(TEST_SPEED) && !defined(INTEL_SDE)
+
+#  define SWEEP_MIN_M 8
+#  define SWEEP_MAX_M 20
+
+// The bits q must not have. The scalar radix-2 kernels keep their values in
+// [0, 4q) and the radix-4/8 ones in [0, 8q), the VMSL kernels keep [0, 8q) in
+// 56-bit words.
+#  define SWEEP_R2_Q_MASK   (~((1UL << 62) - 1))
+#  define SWEEP_R4_Q_MASK   (~((1UL << 61) - 1))
+#  define SWEEP_VMSL_Q_MASK (~((1UL << (VMSL_WORD_SIZE - 3)) - 1))
+
+// The traffic model counts, for every pass over the coefficient array, one read
+// and one write of N 64-bit words. Twiddles are counted once per root used by
+// the algorithm (op and con words), independently of the table layout.
+// Kernels that keep several layers in cache therefore report an effective
+// bandwidth above the STREAM baseline.
+
+static inline uint64_t r2_passes(const uint64_t m) { return m + 1; }
+
+static inline uint64_t r4_passes(const uint64_t m) { return ((m + 1) >> 1) + 1; }
+
+// The leaf merges the last two radix-4 iterations.
+static inline uint64_t r4_leaf_passes(const uint64_t m)
+{
+  return r4_passes(m) - 1;
+}
+
+// The recursive drivers stream through memory once per radix-4 layer above
+// the recursion base, and once more for the cache-resident base blocks.
+static inline uint64_t r4_rec_passes(const uint64_t m)
+{
+  uint64_t base_m = 0;
+  while((1UL << (base_m + 1)) <= RADIX4_RECURSION_BASE_N) {
+    base_m++;
+  }
+  return ((m > base_m) ? ((m - base_m + 1) >> 1) : 0) + 1 + 1;
+}
+
+static inline uint64_t r4x4_passes(const uint64_t m)
+{
+  const uint64_t rem = m & 3;
+  return (m >> 2) + ((rem == 3) ? 2 : (rem != 0)) + 1;
+}
+
+static inline uint64_t r4r2_passes(const uint64_t m)
+{
+  // Radix-4 passes down to a 16 (even m) or 8 (odd m) element fused leaf.
+  return ((m - ((m & 1) ? 3 : 4)) >> 1) + 1 + 1;
+}
+
+static inline uint64_t r2_16_passes(const uint64_t m) { return (m - 4) + 1 + 1; }
+
+static inline uint64_t r8_passes(const uint64_t m) { return ((m + 2) / 3) + 1; }
+
+static inline uint64_t r2_twiddles(const uint64_t m) { return 2 * (1UL << m); }
+
+// Every radix-8 group uses 11 roots.
+static inline uint64_t r8_twiddles(const uint64_t m)
+{
+  // The extra radix-2 (one root) or radix-4 (five roots) iteration.
+  uint64_t words  = 2 * ((m % 3 == 1) ? 1 : (m % 3 == 2) ? 5 : 0);
+  uint64_t groups = 1UL << (m % 3);
+
+  for(uint64_t layers = m - (m % 3); layers >= 3; layers -= 3, groups <<= 3) {
+    words += 2 * 11 * groups;
+  }
+  return words;
+}
+
+static inline uint64_t r4_twiddles(const uint64_t m)
+{
+  uint64_t words  = 0;
+  uint64_t groups = 1;
+  uint64_t layers = m;
+
+  // Odd powers perform one radix-2 layer (N/2 roots at the last level).
+  if(layers & 1) {
+    words += 2 * (1UL << (m - 1));
+    layers--;
+  }
+  for(; layers >= 2; layers -= 2, groups <<= 2) {
+    words += 2 * 5 * groups;
+  }
+  return words;
+}
+
+typedef struct sweep_kernel_s {
+  const char *name;
+  uint64_t (*passes)(uint64_t m);
+  uint64_t (*twiddles)(uint64_t m);
+  uint64_t q_mask;
+} sweep_kernel_t;
+
+typedef enum
+{
+  SWEEP_REF = 0,
+  SWEEP_SEAL,
+  SWEEP_R4,
+  SWEEP_R4x4,
+  SWEEP_R8,
+  SWEEP_R4_REC,
+  SWEEP_R4_GVEC,
+#  ifdef AVX512_SUPPORT
+  SWEEP_R4_AVX512,
+#  endif
+#  ifdef S390X
+  SWEEP_R4_VMSL,
+#  endif
+#  ifdef AVX512_IFMA_SUPPORT
+  SWEEP_HEXL,
+  SWEEP_R4_IFMA,
+  SWEEP_R4_IFMA_LEAF,
+  SWEEP_R4_IFMA_REC,
+  SWEEP_R4_IFMA_UNORDERED,
+  SWEEP_R4R2_IFMA,
+  SWEEP_R2_16_IFMA,
+  SWEEP_R8_IFMA,
+#  endif
+  SWEEP_NUM_OF_KERNELS
+} sweep_kernel_num_t;
+
+static const sweep_kernel_t sweep_kernels[SWEEP_NUM_OF_KERNELS] = {
+  [SWEEP_REF]     = {"rad2-ref", r2_passes, r2_twiddles, SWEEP_R2_Q_MASK},
+  [SWEEP_SEAL]    = {"rad2-SEAL", r2_passes, r2_twiddles, SWEEP_R2_Q_MASK},
+  [SWEEP_R4]      = {"rad4", r4_passes, r4_twiddles, SWEEP_R4_Q_MASK},
+  [SWEEP_R4x4]    = {"rad4x4", r4x4_passes, r4_twiddles, SWEEP_R4_Q_MASK},
+  [SWEEP_R8]      = {"rad8", r8_passes, r8_twiddles, SWEEP_R4_Q_MASK},
+  [SWEEP_R4_REC]  = {"rad4-rec", r4_rec_passes, r4_twiddles, SWEEP_R4_Q_MASK},
+  [SWEEP_R4_GVEC] = {"rad4-gvec", r4_passes, r4_twiddles, SWEEP_R4_Q_MASK},
+#  ifdef AVX512_SUPPORT
+  [SWEEP_R4_AVX512] = {"r4-avx512", r4_leaf_passes, r4_twiddles,
+                       AVX512_MAX_MODULUS_MASK},
+#  endif
+#  ifdef S390X
+  [SWEEP_R4_VMSL] = {"rad4-vmsl", r4_passes, r4_twiddles, SWEEP_VMSL_Q_MASK},
+#  endif
+#  ifdef AVX512_IFMA_SUPPORT
+  [SWEEP_HEXL]              = {"rad2-hexl", r2_passes, r2_twiddles,
+                               AVX512_IFMA_MAX_MODULUS_MASK},
+  [SWEEP_R4_IFMA]           = {"rad4-ifma", r4_passes, r4_twiddles,
+                               AVX512_IFMA_MAX_MODULUS_MASK},
+  [SWEEP_R4_IFMA_LEAF]      = {"rad4-leaf", r4_leaf_passes, r4_twiddles,
+                               AVX512_IFMA_MAX_MODULUS_MASK},
+  [SWEEP_R4_IFMA_REC]       = {"rec-ifma", r4_rec_passes, r4_twiddles,
+                               AVX512_IFMA_MAX_MODULUS_MASK},
+  [SWEEP_R4_IFMA_UNORDERED] = {"rad4-ifma2", r4_passes, r4_twiddles,
+                               AVX512_IFMA_MAX_MODULUS_MASK},
+  [SWEEP_R4R2_IFMA]         = {"r4r2-ifma", r4r2_passes, r4_twiddles,
+                               AVX512_IFMA_MAX_MODULUS_MASK},
+  [SWEEP_R2_16_IFMA]        = {"r216-ifma", r2_16_passes, r2_twiddles,
+                               AVX512_IFMA_MAX_MODULUS_MASK},
+  [SWEEP_R8_IFMA]           = {"r8-ifma", r8_passes, r8_twiddles,
+                               AVX512_IFMA_MAX_MODULUS_MASK},
+#  endif
+};
+
+static inline void run_kernel(const test_case_t *      t,
+                              uint64_t *               a,
+                              const sweep_kernel_num_t k)
+{
+  const uint64_t n = t->n;
+  const uint64_t q = t->q;
+
+  switch(k) {
+    case SWEEP_REF:
+      fwd_ntt_ref_harvey(a, n, q, t->w_powers.ptr, t->w_powers_con.ptr);
+      break;
+    case SWEEP_SEAL:
+      fwd_ntt_seal(a, n, q, t->w_powers.ptr, t->w_powers_con.ptr);
+      break;
+    case SWEEP_R4:
+      fwd_ntt_radix4(a, n, q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr);
+      break;
+    case SWEEP_R4x4:
+      fwd_ntt_radix4x4(a, n, q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr);
+      break;
+    case SWEEP_R8:
+      fwd_ntt_radix8(a, n, q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr);
+      break;
+    case SWEEP_R4_REC:
+      fwd_ntt_radix4_rec(a, n, q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr);
+      break;
+    case SWEEP_R4_GVEC:
+      fwd_ntt_radix4_gvec(a, n, q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr);
+      break;
+#  ifdef AVX512_SUPPORT
+    case SWEEP_R4_AVX512:
+      fwd_ntt_radix4_avx512(a, n, q, t->w_powers_r4_avx512.ptr,
+                            t->w_powers_con_r4_avx512.ptr);
+      break;
+#  endif
+#  ifdef S390X
+    case SWEEP_R4_VMSL:
+      fwd_ntt_radix4_intrinsic(a, n, q, t->w_powers_r4.ptr,
+                               t->w_powers_con_r4_vmsl.ptr);
+      break;
+#  endif
+#  ifdef AVX512_IFMA_SUPPORT
+    case SWEEP_HEXL:
+      fwd_ntt_radix2_hexl(a, n, q, t->w_powers_hexl.ptr,
+                          t->w_powers_con_hexl.ptr);
+      break;
+    case SWEEP_R4_IFMA:
+      fwd_ntt_radix4_avx512_ifma(a, n, q, t->w_powers_r4_avx512_ifma.ptr,
+                                 t->w_powers_con_r4_avx512_ifma.ptr);
+      break;
+    case SWEEP_R4_IFMA_LEAF:
+      fwd_ntt_radix4_avx512_ifma_leaf(a, n, q,
+                                      t->w_powers_r4_leaf_avx512_ifma.ptr,
+                                      t->w_powers_con_r4_leaf_avx512_ifma.ptr);
+      break;
+    case SWEEP_R4_IFMA_REC:
+      fwd_ntt_radix4_avx512_ifma_rec(a, n, q,
+                                     t->w_powers_r4_leaf_avx512_ifma.ptr,
+                                     t->w_powers_con_r4_leaf_avx512_ifma.ptr);
+      break;
+    case SWEEP_R4_IFMA_UNORDERED:
+      fwd_ntt_radix4_avx512_ifma_unordered(
+        a, n, q, t->w_powers_r4_avx512_ifma_unordered.ptr,
+        t->w_powers_con_r4_avx512_ifma_unordered.ptr);
+      break;
+    case SWEEP_R4R2_IFMA:
+      fwd_ntt_r4r2_avx512_ifma(a, n, q, t->w_powers_r4r2_avx512_ifma.ptr,
+                               t->w_powers_con_r4r2_avx512_ifma.ptr);
+      break;
+    case SWEEP_R2_16_IFMA:
+      fwd_ntt_r2_16_avx512_ifma(a, n, q, t->w_powers_r2_16_avx512_ifma.ptr,
+                                t->w_powers_con_r2_16_avx512_ifma.ptr);
+      break;
+    case SWEEP_R8_IFMA:
+      fwd_ntt_radix8_avx512_ifma(a, n, q, t->w_powers_r8_avx512_ifma.ptr,
+                                 t->w_powers_con_r8_avx512_ifma.ptr);
+      break;
+#  endif
+    default: break;
+  }
+}
+
+// A read-modify-write pass over n words (16 bytes per element), i.e. the
+// access pattern of a single NTT layer. The volatile scalar stops the compiler
+// from folding repetitions.
+static inline double stream_rw_gbps(uint64_t *a, const uint64_t n)
+{
+  static volatile uint64_t s = 3;
+  const uint64_t           iters = BENCH_ITERS(n);
+
+  MEASURE_ITERS(iters, {
+    const uint64_t x = s;
+    for(size_t i = 0; i < n; i++) {
+      a[i] = a[i] * x + 1;
+    }
+  });
+
+  return (double)(2 * n * sizeof(uint64_t)) / total_clk;
+}
+
+static inline void print_cache_sizes(void)
+{
+#  if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL3_CACHE_SIZE)
+  printf("# L1d=%ld L2=%ld L3=%ld bytes\n", sysconf(_SC_LEVEL1_DCACHE_SIZE),
+         sysconf(_SC_LEVEL2_CACHE_SIZE), sysconf(_SC_LEVEL3_CACHE_SIZE));
+#  endif
+}
+
+static inline int sweep_single_n(const uint64_t m, const uint64_t q_bits)
+{
+  test_case_t     t;
+  aligned64_ptr_t a;
+  aligned64_ptr_t a_cpy;
+  double          stream_gbps;
+
+  if(!init_generated_test(&t, m, q_bits)) {
+    printf("# no %lu-bit NTT prime for N=2^%lu\n", q_bits, m);
+    return ERROR;
+  }
+
+  if((SUCCESS != allocate_aligned_array(&a, t.n)) ||
+     (SUCCESS != allocate_aligned_array(&a_cpy, t.n))) {
+    _destroy_test(&t);
+    return ERROR;
+  }
+
+  random_buf(a.ptr, t.n, t.q);
+  memcpy(a_cpy.ptr, a.ptr, t.n * sizeof(uint64_t));
+  stream_gbps = stream_rw_gbps(a_cpy.ptr, t.n);
+  memcpy(a_cpy.ptr, a.ptr, t.n * sizeof(uint64_t));
+
+  for(size_t k = 0; k < SWEEP_NUM_OF_KERNELS; k++) {
+    const sweep_kernel_t *kr     = &sweep_kernels[k];
+    const uint64_t        iters  = BENCH_ITERS(t.n);
+    const uint64_t        passes = kr->passes(m);
+    const uint64_t        bytes =
+      (passes * 2 * t.n + kr->twiddles(m)) * sizeof(uint64_t);
+    // Normalize to (N/2)log(N) radix-2 butterflies, one modmul each.
+    const double modmuls = (double)(t.n >> 1) * (double)m;
+
+    // The kernels that do not support q are listed by run_roofline_sweep.
+    if(t.q & kr->q_mask) {
+      continue;
+    }
+
+    // The fully reduced kernels map [0, q) to [0, q),
+    // therefore they can be chained without resetting the input.
+    MEASURE_ITERS(iters, run_kernel(&t, a.ptr, (sweep_kernel_num_t)k));
+    memcpy(a.ptr, a_cpy.ptr, t.n * sizeof(uint64_t));
+
+    printf("%s,%lu,%lu,%lu,%.1f,%lu,%lu,%.3f,%.3f,%.4f,%.3f\n", kr->name, m,
+           t.n, q_bits, total_clk, passes, bytes, (double)bytes / total_clk,
+           modmuls / total_clk,
+           modmuls / (double)bytes, stream_gbps);
+  }
+
+  free_aligned_array(&a);
+  free_aligned_array(&a_cpy);
+  _destroy_test(&t);
+  return SUCCESS;
+}
+
+void run_roofline_sweep(const uint64_t q_bits)
+{
+  print_cache_sizes();
+  for(size_t k = 0; k < SWEEP_NUM_OF_KERNELS; k++) {
+    if((q_bits > 0) && (q_bits <= 64) &&
+       ((1UL << (q_bits - 1)) & sweep_kernels[k].q_mask)) {
+      printf("# %s skipped, it does not support %lu-bit moduli\n",
+             sweep_kernels[k].name, q_bits);
+    }
+  }
+  printf("kernel,logN,N,q_bits,ns,passes,bytes,GBps,Gmodmul_per_s,"
+         "modmul_per_byte,stream_GBps\n");
+
+  for(uint64_t m = SWEEP_MIN_M; m <= SWEEP_MAX_M; m++) {
+    if(SUCCESS != sweep_single_n(m, q_bits)) {
+      return;
+    }
+  }
+}
+
+// Offline tuning: measure a plan for every N of the sweep and append the
+// winners to the wisdom file.
+void run_autotune(const char *wisdom_path, const uint64_t q_bits)
+{
+  printf("logN,q_bits,kernel,rec_base_n\n");
+
+  for(uint64_t m = SWEEP_MIN_M; m <= SWEEP_MAX_M; m++) {
+    const uint64_t n = 1UL << m;
+    const uint64_t q = find_ntt_prime(2 * n, q_bits);
+    ntt_plan_t     plan;
+
+    if(0 == q) {
+      return;
+    }
+    if(SUCCESS != ntt_plan_init(&plan, m, q, find_primitive_root(2 * n, q),
+                                NTT_PLAN_MEASURE, wisdom_path)) {
+      printf("Failed to tune N=2^%lu\n", m);
+      return;
+    }
+    printf("%lu,%lu,%s,%lu\n", m, q_bits, ntt_kernel_name(plan.kernel),
+           plan.rec_base_n);
+    ntt_plan_destroy(&plan);
+  }
+}
+
+#endif
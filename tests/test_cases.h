@@ -4,6 +4,7 @@
 #pragma once
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "fast_mul_operators.h"
 #include "pre_compute.h"
@@ -83,6 +84,19 @@ typedef struct test_case_s {
   aligned64_ptr_t w_inv_powers_r4;
   aligned64_ptr_t w_inv_powers_con_r4;
 
+  // For the cyclic (mod X^N - 1) radix-4 tests, with w^2 and w_inv^2
+  aligned64_ptr_t w_powers_cyclic;
+  aligned64_ptr_t w_inv_powers_cyclic;
+  aligned64_ptr_t w_powers_cyclic_r4;
+  aligned64_ptr_t w_powers_con_cyclic_r4;
+  aligned64_ptr_t w_inv_powers_cyclic_r4;
+  aligned64_ptr_t w_inv_powers_con_cyclic_r4;
+
+  // For the Goldilocks prime (the roots are independent of q)
+  aligned64_ptr_t w_powers_goldilocks;
+  aligned64_ptr_t w_inv_powers_goldilocks;
+  uint64_t        n_inv_goldilocks;
+
 #ifdef S390X
   // For radix-4 tests with VMSL (56-bits instead of 64-bits)
   aligned64_ptr_t w_powers_con_r4_vmsl;
@@ -90,22 +104,51 @@ typedef struct test_case_s {
   mul_op_t        n_inv_vmsl;
 #endif
 
+#ifdef AVX512_SUPPORT
+  // For radix-4 tests with 64-bit AVX512 multiplications
+  aligned64_ptr_t w_powers_r4_avx512;
+  aligned64_ptr_t w_powers_con_r4_avx512;
+  aligned64_ptr_t w_inv_powers_r4_avx512;
+  aligned64_ptr_t w_inv_powers_con_r4_avx512;
+
+  aligned64_ptr_t w_powers_cyclic_r4_avx512;
+  aligned64_ptr_t w_powers_con_cyclic_r4_avx512;
+  aligned64_ptr_t w_inv_powers_cyclic_r4_avx512;
+  aligned64_ptr_t w_inv_powers_con_cyclic_r4_avx512;
+#endif
+
 #ifdef AVX512_IFMA_SUPPORT
   // For radix-2 tests with AVX512-IFMA on X86-64 bit platofrms (52-bits)
   aligned64_ptr_t w_powers_hexl;
   aligned64_ptr_t w_powers_con_hexl;
+  aligned64_ptr_t w_inv_powers_hexl;
+  aligned64_ptr_t w_inv_powers_con_hexl;
 
   aligned64_ptr_t w_powers_r4_avx512_ifma;
   aligned64_ptr_t w_powers_con_r4_avx512_ifma;
 
+  aligned64_ptr_t w_powers_r4_leaf_avx512_ifma;
+  aligned64_ptr_t w_powers_con_r4_leaf_avx512_ifma;
+
+  aligned64_ptr_t w_powers_cyclic_r4_leaf_avx512_ifma;
+  aligned64_ptr_t w_powers_con_cyclic_r4_leaf_avx512_ifma;
+
   aligned64_ptr_t w_powers_r4_avx512_ifma_unordered;
   aligned64_ptr_t w_powers_con_r4_avx512_ifma_unordered;
+  aligned64_ptr_t w_inv_powers_r4_avx512_ifma_unordered;
+  aligned64_ptr_t w_inv_powers_con_r4_avx512_ifma_unordered;
 
   aligned64_ptr_t w_powers_r4r2_avx512_ifma;
   aligned64_ptr_t w_powers_con_r4r2_avx512_ifma;
 
   aligned64_ptr_t w_powers_r2_16_avx512_ifma;
   aligned64_ptr_t w_powers_con_r2_16_avx512_ifma;
+
+  aligned64_ptr_t w_powers_r8_avx512_ifma;
+  aligned64_ptr_t w_powers_con_r8_avx512_ifma;
+  aligned64_ptr_t w_inv_powers_r8_avx512_ifma;
+  aligned64_ptr_t w_inv_powers_con_r8_avx512_ifma;
+  mul_op_t        n_inv_avx512_ifma;
 #endif
 
 } test_case_t;
@@ -205,7 +248,13 @@ static test_case_t tests[] = {
    .q        = 0x100180001,       // NOLINT
    .w        = 79247,
    .w_inv    = 4203069932,   // NOLINT
-   .n_inv.op = 4296507381}}; // NOLINT
+   .n_inv.op = 4296507381}, // NOLINT
+  // The largest q < 2^61 with q = 1 mod 2^15, where 8q is close to 2^64.
+  {.m        = 14,
+   .q        = 0x1fffffffffe10001, // NOLINT
+   .w        = 2046744674361858571,
+   .w_inv    = 836991373341885203,    // NOLINT
+   .n_inv.op = 2305702271723307133}}; // NOLINT
 
 #define NUM_OF_TEST_CASES (sizeof(tests) / sizeof(test_case_t))
 
@@ -250,8 +299,44 @@ static inline int _init_test(test_case_t *t)
   calc_w_con(t->w_inv_powers_con_r4.ptr, t->w_inv_powers_r4.ptr, 2 * n, q,
              WORD_SIZE);
 
+  // For the cyclic NTT, w^2 is a primitive n'th root of unity.
+  const uint64_t w_cyclic     = mul_mod(w, w, q);
+  const uint64_t w_inv_cyclic = mul_mod(w_inv, w_inv, q);
+
+  allocate_aligned_array(&t->w_powers_cyclic, n);
+  calc_w_cyclic(t->w_powers_cyclic.ptr, w_cyclic, n, q, m);
+
+  allocate_aligned_array(&t->w_inv_powers_cyclic, n);
+  calc_w_inv_cyclic(t->w_inv_powers_cyclic.ptr, w_inv_cyclic, n, q, m);
+
+  allocate_aligned_array(&t->w_powers_cyclic_r4, 2 * n);
+  expand_w(t->w_powers_cyclic_r4.ptr, t->w_powers_cyclic.ptr, n, q);
+
+  allocate_aligned_array(&t->w_powers_con_cyclic_r4, 2 * n);
+  calc_w_con(t->w_powers_con_cyclic_r4.ptr, t->w_powers_cyclic_r4.ptr, 2 * n, q,
+             WORD_SIZE);
+
+  allocate_aligned_array(&t->w_inv_powers_cyclic_r4, 2 * n);
+  expand_w(t->w_inv_powers_cyclic_r4.ptr, t->w_inv_powers_cyclic.ptr, n, q);
+
+  allocate_aligned_array(&t->w_inv_powers_con_cyclic_r4, 2 * n);
+  calc_w_con(t->w_inv_powers_con_cyclic_r4.ptr, t->w_inv_powers_cyclic_r4.ptr,
+             2 * n, q, WORD_SIZE);
+
+  // For the Goldilocks prime
+  const uint64_t w_goldilocks = find_primitive_root(2 * n, GOLDILOCKS_Q);
+
+  allocate_aligned_array(&t->w_powers_goldilocks, n);
+  calc_w(t->w_powers_goldilocks.ptr, w_goldilocks, n, GOLDILOCKS_Q, m);
+
+  allocate_aligned_array(&t->w_inv_powers_goldilocks, n);
+  calc_w_inv(t->w_inv_powers_goldilocks.ptr,
+             inv_mod(w_goldilocks, GOLDILOCKS_Q), n, GOLDILOCKS_Q, m);
+
+  t->n_inv_goldilocks = inv_mod(n, GOLDILOCKS_Q);
+
 #ifdef S390X
-  t->n_inv_vmsl.con = calc_ninv_con(&t->n_inv.op, q, VMSL_WORD_SIZE);
+  t->n_inv_vmsl.con = calc_ninv_con(t->n_inv.op, q, VMSL_WORD_SIZE);
   t->n_inv_vmsl.op  = t->n_inv.op;
 
   // for radix-4 vmsl
@@ -264,6 +349,40 @@ static inline int _init_test(test_case_t *t)
              t->q, VMSL_WORD_SIZE);
 #endif
 
+#ifdef AVX512_SUPPORT
+  allocate_aligned_array(&t->w_powers_r4_avx512, n * 5);
+  expand_w_r4_leaf_avx512_ifma(t->w_powers_r4_avx512.ptr, t->w_powers.ptr, n,
+                               q);
+
+  allocate_aligned_array(&t->w_powers_con_r4_avx512, n * 5);
+  calc_w_con(t->w_powers_con_r4_avx512.ptr, t->w_powers_r4_avx512.ptr, n * 5, q,
+             WORD_SIZE);
+
+  allocate_aligned_array(&t->w_inv_powers_r4_avx512, n * 5);
+  expand_w_r4_leaf_avx512_ifma(t->w_inv_powers_r4_avx512.ptr,
+                               t->w_inv_powers.ptr, n, q);
+
+  allocate_aligned_array(&t->w_inv_powers_con_r4_avx512, n * 5);
+  calc_w_con(t->w_inv_powers_con_r4_avx512.ptr, t->w_inv_powers_r4_avx512.ptr,
+             n * 5, q, WORD_SIZE);
+
+  allocate_aligned_array(&t->w_powers_cyclic_r4_avx512, n * 5);
+  expand_w_r4_leaf_avx512_ifma(t->w_powers_cyclic_r4_avx512.ptr,
+                               t->w_powers_cyclic.ptr, n, q);
+
+  allocate_aligned_array(&t->w_powers_con_cyclic_r4_avx512, n * 5);
+  calc_w_con(t->w_powers_con_cyclic_r4_avx512.ptr,
+             t->w_powers_cyclic_r4_avx512.ptr, n * 5, q, WORD_SIZE);
+
+  allocate_aligned_array(&t->w_inv_powers_cyclic_r4_avx512, n * 5);
+  expand_w_r4_leaf_avx512_ifma(t->w_inv_powers_cyclic_r4_avx512.ptr,
+                               t->w_inv_powers_cyclic.ptr, n, q);
+
+  allocate_aligned_array(&t->w_inv_powers_con_cyclic_r4_avx512, n * 5);
+  calc_w_con(t->w_inv_powers_con_cyclic_r4_avx512.ptr,
+             t->w_inv_powers_cyclic_r4_avx512.ptr, n * 5, q, WORD_SIZE);
+#endif
+
 #ifdef AVX512_IFMA_SUPPORT
   // For avx512-ifma
   // In fact, we only need to allocate 1.25n but we allocate 2n just in case.
@@ -274,6 +393,13 @@ static inline int _init_test(test_case_t *t)
   calc_w_con(t->w_powers_con_hexl.ptr, t->w_powers_hexl.ptr, n * 2, q,
              AVX512_IFMA_WORD_SIZE);
 
+  allocate_aligned_array(&t->w_inv_powers_hexl, n);
+  expand_w_inv_hexl(t->w_inv_powers_hexl.ptr, t->w_inv_powers.ptr, n);
+
+  allocate_aligned_array(&t->w_inv_powers_con_hexl, n);
+  calc_w_con(t->w_inv_powers_con_hexl.ptr, t->w_inv_powers_hexl.ptr, n, q,
+             AVX512_IFMA_WORD_SIZE);
+
   allocate_aligned_array(&t->w_powers_r4_avx512_ifma, n * 5);
   expand_w_r4_avx512_ifma(t->w_powers_r4_avx512_ifma.ptr, t->w_powers.ptr, n, q,
                           0);
@@ -282,6 +408,24 @@ static inline int _init_test(test_case_t *t)
   calc_w_con(t->w_powers_con_r4_avx512_ifma.ptr, t->w_powers_r4_avx512_ifma.ptr,
              5 * n, q, AVX512_IFMA_WORD_SIZE);
 
+  allocate_aligned_array(&t->w_powers_r4_leaf_avx512_ifma, n * 5);
+  expand_w_r4_leaf_avx512_ifma(t->w_powers_r4_leaf_avx512_ifma.ptr,
+                               t->w_powers.ptr, n, q);
+
+  allocate_aligned_array(&t->w_powers_con_r4_leaf_avx512_ifma, n * 5);
+  calc_w_con(t->w_powers_con_r4_leaf_avx512_ifma.ptr,
+             t->w_powers_r4_leaf_avx512_ifma.ptr, 5 * n, q,
+             AVX512_IFMA_WORD_SIZE);
+
+  allocate_aligned_array(&t->w_powers_cyclic_r4_leaf_avx512_ifma, n * 5);
+  expand_w_r4_leaf_avx512_ifma(t->w_powers_cyclic_r4_leaf_avx512_ifma.ptr,
+                               t->w_powers_cyclic.ptr, n, q);
+
+  allocate_aligned_array(&t->w_powers_con_cyclic_r4_leaf_avx512_ifma, n * 5);
+  calc_w_con(t->w_powers_con_cyclic_r4_leaf_avx512_ifma.ptr,
+             t->w_powers_cyclic_r4_leaf_avx512_ifma.ptr, 5 * n, q,
+             AVX512_IFMA_WORD_SIZE);
+
   allocate_aligned_array(&t->w_powers_r4_avx512_ifma_unordered, n * 5);
   expand_w_r4_avx512_ifma(t->w_powers_r4_avx512_ifma_unordered.ptr,
                           t->w_powers.ptr, n, q, 1);
@@ -291,6 +435,15 @@ static inline int _init_test(test_case_t *t)
              t->w_powers_r4_avx512_ifma_unordered.ptr, n * 5, q,
              AVX512_IFMA_WORD_SIZE);
 
+  allocate_aligned_array(&t->w_inv_powers_r4_avx512_ifma_unordered, n * 5);
+  expand_w_r4_avx512_ifma(t->w_inv_powers_r4_avx512_ifma_unordered.ptr,
+                          t->w_inv_powers.ptr, n, q, 1);
+
+  allocate_aligned_array(&t->w_inv_powers_con_r4_avx512_ifma_unordered, n * 5);
+  calc_w_con(t->w_inv_powers_con_r4_avx512_ifma_unordered.ptr,
+             t->w_inv_powers_r4_avx512_ifma_unordered.ptr, n * 5, q,
+             AVX512_IFMA_WORD_SIZE);
+
   allocate_aligned_array(&t->w_powers_r4r2_avx512_ifma, n * 5);
   expand_w_r4r2_avx512_ifma(t->w_powers_r4r2_avx512_ifma.ptr, t->w_powers.ptr, n,
                             q);
@@ -306,10 +459,79 @@ static inline int _init_test(test_case_t *t)
   allocate_aligned_array(&t->w_powers_con_r2_16_avx512_ifma, n * 3);
   calc_w_con(t->w_powers_con_r2_16_avx512_ifma.ptr,
              t->w_powers_r2_16_avx512_ifma.ptr, n * 3, q, AVX512_IFMA_WORD_SIZE);
+
+  // For radix-8
+  allocate_aligned_array(&t->w_powers_r8_avx512_ifma, n * 2);
+  expand_w_r8_avx512_ifma(t->w_powers_r8_avx512_ifma.ptr, t->w_powers.ptr, n, q);
+
+  allocate_aligned_array(&t->w_powers_con_r8_avx512_ifma, n * 2);
+  calc_w_con(t->w_powers_con_r8_avx512_ifma.ptr, t->w_powers_r8_avx512_ifma.ptr,
+             n * 2, q, AVX512_IFMA_WORD_SIZE);
+
+  allocate_aligned_array(&t->w_inv_powers_r8_avx512_ifma, n * 2);
+  expand_w_r8_avx512_ifma(t->w_inv_powers_r8_avx512_ifma.ptr,
+                          t->w_inv_powers.ptr, n, q);
+
+  allocate_aligned_array(&t->w_inv_powers_con_r8_avx512_ifma, n * 2);
+  calc_w_con(t->w_inv_powers_con_r8_avx512_ifma.ptr,
+             t->w_inv_powers_r8_avx512_ifma.ptr, n * 2, q,
+             AVX512_IFMA_WORD_SIZE);
+
+  t->n_inv_avx512_ifma.op = t->n_inv.op;
+  t->n_inv_avx512_ifma.con =
+    calc_ninv_con(t->n_inv.op, q, AVX512_IFMA_WORD_SIZE);
 #endif
   return 1;
 }
 
+// Fill t with generated parameters: q is the smallest q_bits-bit prime with
+// q = 1 mod 2^(m+1), and w is a primitive 2^(m+1)-th root of unity mod q.
+static inline int init_generated_test(test_case_t *  t,
+                                      const uint64_t m,
+                                      const uint64_t q_bits)
+{
+  const uint64_t n = 1UL << m;
+
+  memset(t, 0, sizeof(*t));
+  t->m = m;
+  t->q = find_ntt_prime(2 * n, q_bits);
+  if(0 == t->q) {
+    return 0;
+  }
+  t->w        = find_primitive_root(2 * n, t->q);
+  t->w_inv    = inv_mod(t->w, t->q);
+  t->n_inv.op = inv_mod(n, t->q);
+
+  return _init_test(t);
+}
+
+// Generated cases (see init_generated_test) for the moduli that no
+// predefined case covers: the AVX512-IFMA kernels up to their 49-bit limit
+// (for N=2^15 and 2^16 the 48-bit q is 0x800000020001) and the 64-bit AVX512
+// kernels up to their 62-bit limit.
+typedef struct generated_case_s {
+  uint64_t m;
+  uint64_t q_bits;
+} generated_case_t;
+
+static const generated_case_t generated_cases[] = {
+  {.m = 15, .q_bits = 44}, // NOLINT
+  {.m = 15, .q_bits = 45}, // NOLINT
+  {.m = 15, .q_bits = 46}, // NOLINT
+  {.m = 15, .q_bits = 47}, // NOLINT
+  {.m = 15, .q_bits = 48}, // NOLINT
+  {.m = 16, .q_bits = 48}, // NOLINT
+  {.m = 15, .q_bits = 49}, // NOLINT
+  {.m = 16, .q_bits = 49}, // NOLINT
+  {.m = 14, .q_bits = 60}, // NOLINT
+  {.m = 14, .q_bits = 61}, // NOLINT
+  {.m = 14, .q_bits = 62}, // NOLINT
+  {.m = 15, .q_bits = 62}, // NOLINT
+};
+
+#define NUM_OF_GENERATED_CASES \
+  (sizeof(generated_cases) / sizeof(generated_case_t))
+
 static inline int init_test_cases(void)
 {
   for(size_t i = 0; i < NUM_OF_TEST_CASES; i++) {
@@ -334,28 +556,68 @@ static inline void _destroy_test(test_case_t *t)
   free_aligned_array(&t->w_inv_powers_r4);
   free_aligned_array(&t->w_inv_powers_con_r4);
 
+  // for the cyclic radix-4
+  free_aligned_array(&t->w_powers_cyclic);
+  free_aligned_array(&t->w_inv_powers_cyclic);
+  free_aligned_array(&t->w_powers_cyclic_r4);
+  free_aligned_array(&t->w_powers_con_cyclic_r4);
+  free_aligned_array(&t->w_inv_powers_cyclic_r4);
+  free_aligned_array(&t->w_inv_powers_con_cyclic_r4);
+
+  // for the Goldilocks prime
+  free_aligned_array(&t->w_powers_goldilocks);
+  free_aligned_array(&t->w_inv_powers_goldilocks);
+
 #ifdef S390X
   // for VMSL
   free_aligned_array(&t->w_powers_con_r4_vmsl);
   free_aligned_array(&t->w_inv_powers_con_r4_vmsl);
 
+#endif
+#ifdef AVX512_SUPPORT
+  // for AVX512 (64-bit)
+  free_aligned_array(&t->w_powers_r4_avx512);
+  free_aligned_array(&t->w_powers_con_r4_avx512);
+  free_aligned_array(&t->w_inv_powers_r4_avx512);
+  free_aligned_array(&t->w_inv_powers_con_r4_avx512);
+
+  free_aligned_array(&t->w_powers_cyclic_r4_avx512);
+  free_aligned_array(&t->w_powers_con_cyclic_r4_avx512);
+  free_aligned_array(&t->w_inv_powers_cyclic_r4_avx512);
+  free_aligned_array(&t->w_inv_powers_con_cyclic_r4_avx512);
+
 #endif
 #ifdef AVX512_IFMA_SUPPORT
   // for AVX512-IFMA
   free_aligned_array(&t->w_powers_hexl);
   free_aligned_array(&t->w_powers_con_hexl);
+  free_aligned_array(&t->w_inv_powers_hexl);
+  free_aligned_array(&t->w_inv_powers_con_hexl);
 
   free_aligned_array(&t->w_powers_r4_avx512_ifma);
   free_aligned_array(&t->w_powers_con_r4_avx512_ifma);
 
+  free_aligned_array(&t->w_powers_r4_leaf_avx512_ifma);
+  free_aligned_array(&t->w_powers_con_r4_leaf_avx512_ifma);
+
+  free_aligned_array(&t->w_powers_cyclic_r4_leaf_avx512_ifma);
+  free_aligned_array(&t->w_powers_con_cyclic_r4_leaf_avx512_ifma);
+
   free_aligned_array(&t->w_powers_r4_avx512_ifma_unordered);
   free_aligned_array(&t->w_powers_con_r4_avx512_ifma_unordered);
+  free_aligned_array(&t->w_inv_powers_r4_avx512_ifma_unordered);
+  free_aligned_array(&t->w_inv_powers_con_r4_avx512_ifma_unordered);
 
   free_aligned_array(&t->w_powers_r4r2_avx512_ifma);
   free_aligned_array(&t->w_powers_con_r4r2_avx512_ifma);
 
   free_aligned_array(&t->w_powers_r2_16_avx512_ifma);
   free_aligned_array(&t->w_powers_con_r2_16_avx512_ifma);
+
+  free_aligned_array(&t->w_powers_r8_avx512_ifma);
+  free_aligned_array(&t->w_powers_con_r8_avx512_ifma);
+  free_aligned_array(&t->w_inv_powers_r8_avx512_ifma);
+  free_aligned_array(&t->w_inv_powers_con_r8_avx512_ifma);
 #endif
 }
 
@@ -2,9 +2,21 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <string.h>
+#include <unistd.h>
 
+#include "final_reduce.h"
+#include "ntt_automorphism.h"
+#include "ntt_autotune.h"
+#include "ntt_bigint.h"
+#include "ntt_goldilocks.h"
+#include "ntt_mixed_radix.h"
+#include "ntt_natural.h"
+#include "ntt_nd.h"
+#include "ntt_partial.h"
 #include "ntt_radix4.h"
+#include "ntt_radix4_gvec.h"
 #include "ntt_radix4x4.h"
+#include "ntt_radix8.h"
 #include "ntt_reference.h"
 #include "ntt_seal.h"
 #include "pre_compute.h"
@@ -15,11 +27,41 @@
 #  include "ntt_radix4_s390x_vef.h"
 #endif
 
+#ifdef AVX512_SUPPORT
+#  include "ntt_avx512.h"
+#endif
+
 #ifdef AVX512_IFMA_SUPPORT
 #  include "ntt_avx512_ifma.h"
 #  include "ntt_hexl.h"
 #endif
 
+// The scalar radix-4/8 kernels keep their values in [0, 8q), so q < 2^61.
+#define LAZY8_MAX_MODULUS_MASK (~((1UL << 61) - 1))
+
+// Prints a line and returns 1 when q has bits in mask, i.e. when it is too
+// large for the kernels of the named tests.
+static inline int
+skip_tests(const test_case_t *t, const uint64_t mask, const char *name)
+{
+  if(0 == (t->q & mask)) {
+    return 0;
+  }
+  printf("Skipping the %s tests, q=0x%lx is too large\n", name, t->q);
+  return 1;
+}
+
+// Sets a to a_ntt + 3q in the even and to a_ntt + 4q in the odd coefficients.
+// The first inverse radix-4 iteration reduces them to a_ntt + 3q and a_ntt,
+// which drives its differences close to 8q, the worst case of a lazy input.
+static inline void
+set_worst_lazy_input(uint64_t a[], const uint64_t a_ntt[], const test_case_t *t)
+{
+  for(size_t i = 0; i < t->n; i++) {
+    a[i] = a_ntt[i] + (((i & 1) ? 4 : 3) * t->q);
+  }
+}
+
 static inline int test_radix2_scalar(const test_case_t *t, uint64_t a_orig[])
 {
   uint64_t a[t->n];
@@ -94,6 +136,213 @@ test_radix4_scalar(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
 
   GUARD_MSG(memcmp(a_orig, a, sizeof(a)), "Bad results after radix-4 inv\n");
 
+  // The inverse accepts the [0, 8q) output of the lazy forward NTT.
+  printf("Running inv_ntt_radix4 on lazy input\n");
+  fwd_ntt_radix4_lazy(a, t->n, t->q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr);
+  inv_ntt_radix4(a, t->n, t->q, t->n_inv, t->w_inv_powers_r4.ptr,
+                 t->w_inv_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after radix-4 inv on lazy input\n");
+
+  // The out-of-place variants must not modify their inputs.
+  uint64_t b[t->n];
+
+  printf("Running fwd/inv_ntt_radix4_oop\n");
+  fwd_ntt_radix4_oop(a, a_orig, t->n, t->q, t->w_powers_r4.ptr,
+                     t->w_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad results after out-of-place radix-4 fwd\n");
+
+  inv_ntt_radix4_oop(b, a, t->n, t->q, t->n_inv, t->w_inv_powers_r4.ptr,
+                     t->w_inv_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, b, sizeof(b)),
+            "Bad results after out-of-place radix-4 inv\n");
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad input after out-of-place radix-4 inv\n");
+
+  fwd_ntt_radix4_oop_lazy(a, a_orig, t->n, t->q, t->w_powers_r4.ptr,
+                          t->w_powers_con_r4.ptr);
+  inv_ntt_radix4_oop(b, a, t->n, t->q, t->n_inv, t->w_inv_powers_r4.ptr,
+                     t->w_inv_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, b, sizeof(b)),
+            "Bad results after out-of-place radix-4 inv on lazy input\n");
+
+  printf("Running inv_ntt_radix4 on worst-case lazy input\n");
+  set_worst_lazy_input(a, a_ntt, t);
+  inv_ntt_radix4_oop(b, a, t->n, t->q, t->n_inv, t->w_inv_powers_r4.ptr,
+                     t->w_inv_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, b, sizeof(b)),
+            "Bad results after out-of-place radix-4 inv on worst-case input\n");
+
+  inv_ntt_radix4(a, t->n, t->q, t->n_inv, t->w_inv_powers_r4.ptr,
+                 t->w_inv_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after radix-4 inv on worst-case lazy input\n");
+
+  return SUCCESS;
+}
+
+// Inputs with len nonzero leading coefficients, for lengths around the
+// quarter and half points where the truncated layers change.
+static inline int test_radix4_trunc(const test_case_t *t, const uint64_t a_orig[])
+{
+  const size_t n        = t->n;
+  const size_t lens[]   = {0,         1,           n / 16, (n / 4) - 1,
+                           n / 4,     (n / 4) + 1, n / 2,  (n / 2) + 1,
+                           3 * n / 4, n};
+  const size_t num_lens = sizeof(lens) / sizeof(lens[0]);
+  uint64_t     a[t->n];
+  uint64_t     ref[t->n];
+
+  printf("Running fwd_ntt_radix4_trunc\n");
+  for(size_t l = 0; l < num_lens; l++) {
+    memset(ref, 0, sizeof(ref));
+    memcpy(ref, a_orig, lens[l] * sizeof(uint64_t));
+    memcpy(a, ref, sizeof(a));
+
+    fwd_ntt_radix4(ref, n, t->q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr);
+    fwd_ntt_radix4_trunc(a, n, lens[l], t->q, t->w_powers_r4.ptr,
+                         t->w_powers_con_r4.ptr);
+    if(0 != memcmp(ref, a, sizeof(a))) {
+      printf("Bad results after truncated radix-4 fwd (len %lu)\n", lens[l]);
+      return ERROR;
+    }
+  }
+
+  return SUCCESS;
+}
+
+// Compares the selected slots of a against a_ntt.
+static inline int check_slots(const uint64_t a[],
+                              const uint64_t a_ntt[],
+                              const uint64_t mask[],
+                              const size_t   n)
+{
+  for(size_t k = 0; k < n; k++) {
+    if(((mask[k / 64] >> (k % 64)) & 1) && (a[k] != a_ntt[k])) {
+      return ERROR;
+    }
+  }
+  return SUCCESS;
+}
+
+// Ranges and masks of a single slot up to all of them, with every method.
+static inline int
+test_radix4_partial(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
+{
+  const size_t n           = t->n;
+  const size_t ranges[][2] = {{n / 3, 1}, {5, (n / 4) + 3}, {0, n}};
+  uint64_t       a[t->n];
+  uint64_t       mask[(t->n + 63) / 64];
+
+  printf("Running fwd_ntt_radix4_partial\n");
+  for(size_t method = NTT_PARTIAL_AUTO; method <= NTT_PARTIAL_HORNER; method++) {
+    for(size_t r = 0; r < 3; r++) {
+      memcpy(a, a_orig, sizeof(a));
+      fwd_ntt_radix4_partial_range(a, n, ranges[r][0], ranges[r][1], t->q,
+                                   t->w_powers_r4.ptr, t->w_powers_con_r4.ptr,
+                                   (ntt_partial_method_t)method);
+      memset(mask, 0, sizeof(mask));
+      for(size_t k = ranges[r][0]; k < ranges[r][0] + ranges[r][1]; k++) {
+        mask[k / 64] |= 1UL << (k % 64);
+      }
+      GUARD_MSG(check_slots(a, a_ntt, mask, n),
+                "Bad results after partial radix-4 fwd (range)\n");
+    }
+
+    // A few scattered slots, and every fifth one.
+    for(size_t step = 0; step < 2; step++) {
+      memset(mask, 0, sizeof(mask));
+      for(size_t k = 1; k < n; k += (step == 0) ? (n / 3) : 5) {
+        mask[k / 64] |= 1UL << (k % 64);
+      }
+      memcpy(a, a_orig, sizeof(a));
+      fwd_ntt_radix4_partial_mask(a, n, mask, t->q, t->w_powers_r4.ptr,
+                                  t->w_powers_con_r4.ptr,
+                                  (ntt_partial_method_t)method);
+      GUARD_MSG(check_slots(a, a_ntt, mask, n),
+                "Bad results after partial radix-4 fwd (mask)\n");
+    }
+
+    // Lazy inputs at the top of [0, 8q), a single slot and all of them.
+    for(size_t r = 0; r < 3; r += 2) {
+      for(size_t i = 0; i < n; i++) {
+        a[i] = a_orig[i] + 7 * t->q;
+      }
+      fwd_ntt_radix4_partial_range(a, n, ranges[r][0], ranges[r][1], t->q,
+                                   t->w_powers_r4.ptr, t->w_powers_con_r4.ptr,
+                                   (ntt_partial_method_t)method);
+      memset(mask, 0, sizeof(mask));
+      for(size_t k = ranges[r][0]; k < ranges[r][0] + ranges[r][1]; k++) {
+        mask[k / 64] |= 1UL << (k % 64);
+      }
+      GUARD_MSG(check_slots(a, a_ntt, mask, n),
+                "Bad results after partial radix-4 fwd (lazy input)\n");
+    }
+  }
+
+  return SUCCESS;
+}
+
+static inline int
+test_radix4_rec(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
+{
+  uint64_t a[t->n];
+  memcpy(a, a_orig, sizeof(a));
+
+  printf("Running fwd_ntt_radix4_rec\n");
+  fwd_ntt_radix4_rec(a, t->n, t->q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad results after recursive radix-4 fwd\n");
+
+  printf("Running inv_ntt_radix4_rec\n");
+  inv_ntt_radix4_rec(a, t->n, t->q, t->n_inv, t->w_inv_powers_r4.ptr,
+                     t->w_inv_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after recursive radix-4 inv\n");
+
+  printf("Running inv_ntt_radix4_rec on lazy input\n");
+  fwd_ntt_radix4_rec_lazy(a, t->n, t->q, t->w_powers_r4.ptr,
+                          t->w_powers_con_r4.ptr);
+  inv_ntt_radix4_rec(a, t->n, t->q, t->n_inv, t->w_inv_powers_r4.ptr,
+                     t->w_inv_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after recursive radix-4 inv on lazy input\n");
+
+  set_worst_lazy_input(a, a_ntt, t);
+  inv_ntt_radix4_rec(a, t->n, t->q, t->n_inv, t->w_inv_powers_r4.ptr,
+                     t->w_inv_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after recursive radix-4 inv on worst-case input\n");
+
+  // A small cut-off, which recurses down to 64-qw blocks.
+  printf("Running fwd_ntt_radix4_rec_base_lazy\n");
+  fwd_ntt_radix4_rec_base_lazy(a, t->n, t->q, t->w_powers_r4.ptr,
+                               t->w_powers_con_r4.ptr, 64);
+  final_reduce_q8(a, t->n, t->q);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad results after recursive radix-4 fwd with a 64-qw base\n");
+
+  return SUCCESS;
+}
+
+static inline int
+test_radix4_gvec(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
+{
+  uint64_t a[t->n];
+  memcpy(a, a_orig, sizeof(a));
+
+  printf("Running fwd_ntt_radix4_gvec\n");
+  fwd_ntt_radix4_gvec(a, t->n, t->q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad results after generic-vector radix-4 fwd\n");
+
+  printf("Running inv_ntt_radix4_gvec\n");
+  inv_ntt_radix4_gvec(a, t->n, t->q, t->n_inv, t->w_inv_powers_r4.ptr,
+                      t->w_inv_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after generic-vector radix-4 inv\n");
+
   return SUCCESS;
 }
 
@@ -110,6 +359,121 @@ test_radix4x4_scalar(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
   return SUCCESS;
 }
 
+static inline int
+test_radix8_scalar(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
+{
+  uint64_t a[t->n];
+  memcpy(a, a_orig, sizeof(a));
+
+  printf("Running fwd_ntt_radix8\n");
+  fwd_ntt_radix8(a, t->n, t->q, t->w_powers_r4.ptr, t->w_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)), "Bad results after radix-8 fwd\n");
+
+  printf("Running inv_ntt_radix8\n");
+  inv_ntt_radix8(a, t->n, t->q, t->n_inv, t->w_inv_powers_r4.ptr,
+                 t->w_inv_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)), "Bad results after radix-8 inv\n");
+
+  return SUCCESS;
+}
+
+static inline int
+test_radix4_natural(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
+{
+  uint64_t a[t->n];
+  uint64_t a_ntt_natural[t->n];
+  memcpy(a, a_orig, sizeof(a));
+  bit_rev(a_ntt_natural, a_ntt, t->n, t->m);
+
+  printf("Running bit_rev_in_place\n");
+  bit_rev_in_place(a, t->n);
+  bit_rev_in_place(a, t->n);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)), "Bad results after bit_rev_in_place\n");
+
+  printf("Running fwd_ntt_radix4_natural\n");
+  fwd_ntt_radix4_natural(a, t->n, t->q, t->w_powers_r4.ptr,
+                         t->w_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_ntt_natural, a, sizeof(a)),
+            "Bad results after radix-4 natural-order fwd\n");
+
+  printf("Running inv_ntt_radix4_natural\n");
+  inv_ntt_radix4_natural(a, t->n, t->q, t->n_inv, t->w_inv_powers_r4.ptr,
+                         t->w_inv_powers_con_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after radix-4 natural-order inv\n");
+
+  return SUCCESS;
+}
+
+// The cyclic NTT evaluates a at w^(2k) (w_cyclic = w^2), which is the
+// negacyclic NTT (evaluation at w^(2k+1)) of a[i] * w^(-i). The same kernels
+// run with the tables of calc_w_cyclic.
+static inline int test_cyclic(const test_case_t *t, const uint64_t a_orig[])
+{
+  uint64_t a[t->n];
+  uint64_t a_ntt[t->n];
+  uint64_t w_inv_power = 1;
+
+  for(size_t i = 0; i < t->n; i++) {
+    a_ntt[i]    = mul_mod(a_orig[i], w_inv_power, t->q);
+    w_inv_power = mul_mod(w_inv_power, t->w_inv, t->q);
+  }
+  fwd_ntt_ref_harvey(a_ntt, t->n, t->q, t->w_powers.ptr, t->w_powers_con.ptr);
+
+  printf("Running fwd/inv_ntt_radix4 (cyclic)\n");
+  memcpy(a, a_orig, sizeof(a));
+  fwd_ntt_radix4(a, t->n, t->q, t->w_powers_cyclic_r4.ptr,
+                 t->w_powers_con_cyclic_r4.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad results after cyclic radix-4 fwd\n");
+
+  inv_ntt_radix4(a, t->n, t->q, t->n_inv, t->w_inv_powers_cyclic_r4.ptr,
+                 t->w_inv_powers_con_cyclic_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after cyclic radix-4 inv\n");
+
+  printf("Running fwd/inv_ntt_radix4_gvec (cyclic)\n");
+  fwd_ntt_radix4_gvec(a, t->n, t->q, t->w_powers_cyclic_r4.ptr,
+                      t->w_powers_con_cyclic_r4.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad results after cyclic generic-vector radix-4 fwd\n");
+
+  inv_ntt_radix4_gvec(a, t->n, t->q, t->n_inv, t->w_inv_powers_cyclic_r4.ptr,
+                      t->w_inv_powers_con_cyclic_r4.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after cyclic generic-vector radix-4 inv\n");
+
+#ifdef AVX512_SUPPORT
+  if(!(t->q & AVX512_MAX_MODULUS_MASK) &&
+     (t->n >= RADIX4_AVX512_IFMA_LEAF_MIN_N)) {
+    printf("Running fwd/inv_ntt_radix4_avx512 (cyclic)\n");
+    fwd_ntt_radix4_avx512(a, t->n, t->q, t->w_powers_cyclic_r4_avx512.ptr,
+                          t->w_powers_con_cyclic_r4_avx512.ptr);
+    GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+              "Bad results after cyclic radix-4 with AVX512 fwd\n");
+
+    inv_ntt_radix4_avx512(a, t->n, t->q, t->n_inv,
+                          t->w_inv_powers_cyclic_r4_avx512.ptr,
+                          t->w_inv_powers_con_cyclic_r4_avx512.ptr);
+    GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+              "Bad results after cyclic radix-4 with AVX512 inv\n");
+  }
+#endif
+
+#ifdef AVX512_IFMA_SUPPORT
+  if(!(t->q & AVX512_IFMA_MAX_MODULUS_MASK)) {
+    printf("Running fwd_ntt_radix4_avx512_ifma_leaf (cyclic)\n");
+    fwd_ntt_radix4_avx512_ifma_leaf(
+      a, t->n, t->q, t->w_powers_cyclic_r4_leaf_avx512_ifma.ptr,
+      t->w_powers_con_cyclic_r4_leaf_avx512_ifma.ptr);
+    GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+              "Bad results after cyclic radix-4 with AVX512-IFMA leaf fwd\n");
+  }
+#endif
+
+  return SUCCESS;
+}
+
 #ifdef S390X
 static inline int
 test_radix4_intrinsic(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
@@ -130,6 +494,14 @@ test_radix4_intrinsic(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
   GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
             "Bad results after radix-4 inv with intrinsic\n");
 
+  printf("Running inv_ntt_radix4_intrinsic on lazy input\n");
+  fwd_ntt_radix4_intrinsic_lazy(a, t->n, t->q, t->w_powers_r4.ptr,
+                                t->w_powers_con_r4_vmsl.ptr);
+  inv_ntt_radix4_intrinsic(a, t->n, t->q, t->n_inv_vmsl, t->w_inv_powers_r4.ptr,
+                           t->w_inv_powers_con_r4_vmsl.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after radix-4 inv with intrinsic on lazy input\n");
+
   return SUCCESS;
 }
 
@@ -151,10 +523,92 @@ static inline int test_radix4_intrinsic_dbl(const test_case_t *t,
   GUARD_MSG(memcmp(a_ntt, b, sizeof(b)),
             "Bad results after radix-2 scalar double for b\n");
 
+  printf("Running inv_ntt_radix4_intrinsic_dbl\n");
+  inv_ntt_radix4_intrinsic_dbl(a, b, t->n, t->q, t->n_inv_vmsl,
+                               t->w_inv_powers_r4.ptr,
+                               t->w_inv_powers_con_r4_vmsl.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after radix-4 inv double with intrinsic for a\n");
+  GUARD_MSG(memcmp(b_orig, b, sizeof(b)),
+            "Bad results after radix-4 inv double with intrinsic for b\n");
+
   return SUCCESS;
 }
 #endif
 
+#ifdef AVX512_SUPPORT
+static inline int
+test_radix4_avx512(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
+{
+  // The leaf layout requires N >= RADIX4_AVX512_IFMA_LEAF_MIN_N.
+  if((t->q & AVX512_MAX_MODULUS_MASK) ||
+     (t->n < RADIX4_AVX512_IFMA_LEAF_MIN_N)) {
+    return SUCCESS;
+  }
+
+  uint64_t a[t->n];
+  memcpy(a, a_orig, sizeof(a));
+
+  printf("Running fwd_ntt_radix4_avx512\n");
+  fwd_ntt_radix4_avx512(a, t->n, t->q, t->w_powers_r4_avx512.ptr,
+                        t->w_powers_con_r4_avx512.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad results after radix-4 with AVX512 fwd\n");
+
+  printf("Running inv_ntt_radix4_avx512\n");
+  inv_ntt_radix4_avx512(a, t->n, t->q, t->n_inv, t->w_inv_powers_r4_avx512.ptr,
+                        t->w_inv_powers_con_r4_avx512.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after radix-4 with AVX512 inv\n");
+
+  // The out-of-place variants with regular and non-temporal stores, on an
+  // aligned dst and on a misaligned one (which ignores nt_store).
+  aligned64_ptr_t x;
+  aligned64_ptr_t y;
+  int             ret = SUCCESS;
+
+  GUARD(allocate_aligned_array(&x, t->n + 8));
+  if(SUCCESS != allocate_aligned_array(&y, t->n + 8)) {
+    free_aligned_array(&x);
+    return ERROR;
+  }
+
+  printf("Running fwd/inv_ntt_radix4_avx512_oop\n");
+  for(size_t c = 0; (c < 4) && (SUCCESS == ret); c++) {
+    const int       nt_store = (int)(c & 1);
+    uint64_t *      dst      = &x.ptr[c >> 1];
+    uint64_t *      dst2     = &y.ptr[c >> 1];
+    const uint64_t *w        = t->w_powers_r4_avx512.ptr;
+    const uint64_t *w_con    = t->w_powers_con_r4_avx512.ptr;
+
+    fwd_ntt_radix4_avx512_oop(dst, a_orig, t->n, t->q, w, w_con, nt_store);
+    if(0 != memcmp(a_ntt, dst, sizeof(a))) {
+      printf("Bad results after out-of-place radix-4 with AVX512 fwd\n");
+      ret = ERROR;
+    }
+
+    fwd_ntt_radix4_avx512_oop_lazy(dst, a_orig, t->n, t->q, w, w_con, nt_store);
+    inv_ntt_radix4_avx512_oop(dst2, dst, t->n, t->q, t->n_inv,
+                              t->w_inv_powers_r4_avx512.ptr,
+                              t->w_inv_powers_con_r4_avx512.ptr, nt_store);
+    if(0 != memcmp(a_orig, dst2, sizeof(a))) {
+      printf("Bad results after out-of-place radix-4 with AVX512 inv\n");
+      ret = ERROR;
+    }
+
+    final_reduce_q8(dst, t->n, t->q);
+    if(0 != memcmp(a_ntt, dst, sizeof(a))) {
+      printf("Bad input after out-of-place radix-4 with AVX512 inv\n");
+      ret = ERROR;
+    }
+  }
+
+  free_aligned_array(&x);
+  free_aligned_array(&y);
+  return ret;
+}
+#endif
+
 #ifdef AVX512_IFMA_SUPPORT
 static inline int
 test_radix2_hexl(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
@@ -173,6 +627,12 @@ test_radix2_hexl(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
   GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
             "Bad results after HEXL radix-2 with AVX512-IFMA intrinsic fwd\n");
 
+  printf("Running inv_ntt_radix2_hexl\n");
+  inv_ntt_radix2_hexl(a, t->n, t->q, t->w_inv_powers_hexl.ptr,
+                      t->w_inv_powers_con_hexl.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after HEXL radix-2 with AVX512-IFMA intrinsic inv\n");
+
   return SUCCESS;
 }
 
@@ -225,6 +685,71 @@ test_radix4_avx512_ifma(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[
   GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
             "Bad results after radix-4 with AVX512-IFMA intrinsic fwd\n");
 
+  // The lazy output must stay in [0, 8q).
+  memcpy(a, a_orig, sizeof(a));
+  printf("Running fwd_ntt_radix4_avx512_ifma_lazy\n");
+  fwd_ntt_radix4_avx512_ifma_lazy(a, t->n, t->q, t->w_powers_r4_avx512_ifma.ptr,
+                                  t->w_powers_con_r4_avx512_ifma.ptr);
+  for(size_t i = 0; i < t->n; i++) {
+    if((a[i] >= 8 * t->q) || ((a[i] % t->q) != a_ntt[i])) {
+      printf("Bad results after lazy radix-4 with AVX512-IFMA fwd\n");
+      return ERROR;
+    }
+  }
+
+  memcpy(a, a_orig, sizeof(a));
+  printf("Running fwd_ntt_radix4_avx512_ifma_leaf\n");
+  fwd_ntt_radix4_avx512_ifma_leaf(a, t->n, t->q,
+                                  t->w_powers_r4_leaf_avx512_ifma.ptr,
+                                  t->w_powers_con_r4_leaf_avx512_ifma.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad results after radix-4 with AVX512-IFMA leaf fwd\n");
+
+  // The out-of-place variants, b is the untouched source.
+  uint64_t b[t->n];
+  memcpy(b, a_orig, sizeof(b));
+  printf("Running fwd_ntt_radix4_avx512_ifma_oop and _leaf_oop\n");
+  fwd_ntt_radix4_avx512_ifma_oop(a, b, t->n, t->q,
+                                 t->w_powers_r4_avx512_ifma.ptr,
+                                 t->w_powers_con_r4_avx512_ifma.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)) | memcmp(a_orig, b, sizeof(b)),
+            "Bad results after out-of-place radix-4 with AVX512-IFMA fwd\n");
+  fwd_ntt_radix4_avx512_ifma_leaf_oop(a, b, t->n, t->q,
+                                      t->w_powers_r4_leaf_avx512_ifma.ptr,
+                                      t->w_powers_con_r4_leaf_avx512_ifma.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)) | memcmp(a_orig, b, sizeof(b)),
+            "Bad results after out-of-place radix-4 with AVX512-IFMA leaf fwd\n");
+
+  // With non-temporal stores into a 64-byte aligned dst.
+  aligned64_ptr_t c;
+  int             ret;
+  GUARD(allocate_aligned_array(&c, t->n))
+  fwd_ntt_radix4_avx512_ifma_leaf_oop_lazy(
+    c.ptr, b, t->n, t->q, t->w_powers_r4_leaf_avx512_ifma.ptr,
+    t->w_powers_con_r4_leaf_avx512_ifma.ptr, 1);
+  final_reduce_q8(c.ptr, t->n, t->q);
+  ret = memcmp(a_ntt, c.ptr, sizeof(a));
+  free_aligned_array(&c);
+  GUARD_MSG(ret, "Bad results after AVX512-IFMA leaf fwd with nt stores\n");
+
+  memcpy(a, a_orig, sizeof(a));
+  printf("Running fwd_ntt_radix4_avx512_ifma_rec\n");
+  fwd_ntt_radix4_avx512_ifma_rec(a, t->n, t->q,
+                                 t->w_powers_r4_leaf_avx512_ifma.ptr,
+                                 t->w_powers_con_r4_leaf_avx512_ifma.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad results after recursive radix-4 with AVX512-IFMA fwd\n");
+
+  memcpy(a, a_orig, sizeof(a));
+  printf("Running fwd_ntt_radix4_avx512_ifma_rec_base_lazy\n");
+  fwd_ntt_radix4_avx512_ifma_rec_base_lazy(
+    a, t->n, t->q, t->w_powers_r4_leaf_avx512_ifma.ptr,
+    t->w_powers_con_r4_leaf_avx512_ifma.ptr, 512);
+  final_reduce_q8(a, t->n, t->q);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad results after recursive radix-4 with AVX512-IFMA fwd and a "
+            "512-qw base\n");
+
   memcpy(a, a_orig, sizeof(a));
   printf("Running fwd_ntt_radix4_avx512_ifma_unordered\n");
   fwd_ntt_radix4_avx512_ifma_unordered(
@@ -235,6 +760,19 @@ test_radix4_avx512_ifma(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[
     memcmp(a_ntt, a, sizeof(a)),
     "Bad results after radix-4 with AVX512-IFMA intrinsic unordered fwd\n");
 
+  printf("Running inv_ntt_radix4_avx512_ifma_unordered on lazy input\n");
+  memcpy(a, a_orig, sizeof(a));
+  fwd_ntt_radix4_avx512_ifma_lazy_unordered(
+    a, t->n, t->q, t->w_powers_r4_avx512_ifma_unordered.ptr,
+    t->w_powers_con_r4_avx512_ifma_unordered.ptr);
+  inv_ntt_radix4_avx512_ifma_unordered(
+    a, t->n, t->q, t->n_inv_avx512_ifma,
+    t->w_inv_powers_r4_avx512_ifma_unordered.ptr,
+    t->w_inv_powers_con_r4_avx512_ifma_unordered.ptr);
+  GUARD_MSG(
+    memcmp(a_orig, a, sizeof(a)),
+    "Bad results after radix-4 with AVX512-IFMA intrinsic unordered inv\n");
+
   memcpy(a, a_orig, sizeof(a));
   printf("Running fwd_ntt_r4r2_avx512_ifma\n");
   fwd_ntt_r4r2_avx512_ifma(a, t->n, t->q, t->w_powers_r4r2_avx512_ifma.ptr,
@@ -249,10 +787,807 @@ test_radix4_avx512_ifma(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[
   GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
             "Bad results after r2_16 with AVX512-IFMA intrinsic fwd\n");
 
+  memcpy(a, a_orig, sizeof(a));
+  printf("Running fwd_ntt_radix8_avx512_ifma\n");
+  fwd_ntt_radix8_avx512_ifma(a, t->n, t->q, t->w_powers_r8_avx512_ifma.ptr,
+                             t->w_powers_con_r8_avx512_ifma.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad results after radix-8 with AVX512-IFMA intrinsic fwd\n");
+
+  printf("Running inv_ntt_radix8_avx512_ifma\n");
+  inv_ntt_radix8_avx512_ifma(a, t->n, t->q, t->n_inv_avx512_ifma,
+                             t->w_inv_powers_r8_avx512_ifma.ptr,
+                             t->w_inv_powers_con_r8_avx512_ifma.ptr);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)),
+            "Bad results after radix-8 with AVX512-IFMA intrinsic inv\n");
+
+  return SUCCESS;
+}
+
+// fwd -> pointwise mul/add -> inv in the unordered domain, against the same
+// pipeline with the reference NTT (in the natural order). The second operand
+// is a_orig reversed, only three arrays are used to limit the stack usage.
+static inline int test_pointwise_avx512_ifma(const test_case_t *t,
+                                             const uint64_t     a_orig[])
+{
+  if(t->q & AVX512_IFMA_MAX_MODULUS_MASK) {
+    return SUCCESS;
+  }
+
+  const size_t n = t->n;
+  uint64_t     a[n];
+  uint64_t     b[n];
+  uint64_t     c[n];
+
+  // a * b
+  memcpy(a, a_orig, sizeof(a));
+  for(size_t i = 0; i < n; i++) {
+    b[i] = a_orig[n - 1 - i];
+  }
+  fwd_ntt_radix4_avx512_ifma_lazy_unordered(
+    a, n, t->q, t->w_powers_r4_avx512_ifma_unordered.ptr,
+    t->w_powers_con_r4_avx512_ifma_unordered.ptr);
+  fwd_ntt_radix4_avx512_ifma_unordered(
+    b, n, t->q, t->w_powers_r4_avx512_ifma_unordered.ptr,
+    t->w_powers_con_r4_avx512_ifma_unordered.ptr);
+  calc_w_con(c, b, n, t->q, AVX512_IFMA_WORD_SIZE);
+
+  printf("Running pointwise_mul_avx512_ifma\n");
+  pointwise_mul_avx512_ifma(a, b, c, n, t->q);
+  inv_ntt_radix4_avx512_ifma_unordered(
+    a, n, t->q, t->n_inv_avx512_ifma,
+    t->w_inv_powers_r4_avx512_ifma_unordered.ptr,
+    t->w_inv_powers_con_r4_avx512_ifma_unordered.ptr);
+
+  memcpy(b, a_orig, sizeof(b));
+  for(size_t i = 0; i < n; i++) {
+    c[i] = a_orig[n - 1 - i];
+  }
+  fwd_ntt_ref_harvey(b, n, t->q, t->w_powers.ptr, t->w_powers_con.ptr);
+  fwd_ntt_ref_harvey(c, n, t->q, t->w_powers.ptr, t->w_powers_con.ptr);
+  for(size_t i = 0; i < n; i++) {
+    b[i] = mul_mod(b[i], c[i], t->q);
+  }
+  inv_ntt_ref_harvey(b, n, t->q, t->n_inv, WORD_SIZE, t->w_inv_powers.ptr,
+                     t->w_inv_powers_con.ptr);
+  GUARD_MSG(memcmp(b, a, sizeof(a)),
+            "Bad results after AVX512-IFMA unordered pointwise mul\n");
+
+  // a + b
+  memcpy(a, a_orig, sizeof(a));
+  for(size_t i = 0; i < n; i++) {
+    b[i] = a_orig[n - 1 - i];
+    c[i] = (a[i] + b[i]) % t->q;
+  }
+  fwd_ntt_radix4_avx512_ifma_lazy_unordered(
+    a, n, t->q, t->w_powers_r4_avx512_ifma_unordered.ptr,
+    t->w_powers_con_r4_avx512_ifma_unordered.ptr);
+  fwd_ntt_radix4_avx512_ifma_lazy_unordered(
+    b, n, t->q, t->w_powers_r4_avx512_ifma_unordered.ptr,
+    t->w_powers_con_r4_avx512_ifma_unordered.ptr);
+
+  printf("Running pointwise_add_avx512_ifma\n");
+  pointwise_add_avx512_ifma(a, b, n, t->q);
+  inv_ntt_radix4_avx512_ifma_unordered(
+    a, n, t->q, t->n_inv_avx512_ifma,
+    t->w_inv_powers_r4_avx512_ifma_unordered.ptr,
+    t->w_inv_powers_con_r4_avx512_ifma_unordered.ptr);
+  GUARD_MSG(memcmp(c, a, sizeof(a)),
+            "Bad results after AVX512-IFMA unordered pointwise add\n");
+
   return SUCCESS;
 }
 #endif
 
+// Arbitrary 64-bit inputs, including non-canonical ones in [p, 2^64).
+static inline uint64_t goldilocks_input(const uint64_t a_orig[], const size_t i)
+{
+  if(i % 3 == 0) {
+    return UINT64_MAX - (a_orig[i] & GOLDILOCKS_EPS);
+  }
+  return a_orig[i] * 0x9e3779b97f4a7c15UL; // NOLINT
+}
+
+// A plain radix-2 NTT modulo the Goldilocks prime, with 128-bit modular
+// arithmetic.
+static inline void fwd_ntt_goldilocks_ref(uint64_t       a[],
+                                          const uint64_t N,
+                                          const uint64_t w[])
+{
+  const uint64_t p = GOLDILOCKS_Q;
+
+  for(size_t i = 0; i < N; i++) {
+    a[i] %= p;
+  }
+
+  for(size_t m = 1, t = N >> 1; m < N; m <<= 1, t >>= 1) {
+    for(size_t j = 0; j < m; j++) {
+      for(size_t k = 2 * t * j; k < (2 * t * j) + t; k++) {
+        const uint64_t T = mul_mod(w[m + j], a[k + t], p);
+
+        a[k + t] = (uint64_t)(((__uint128_t)a[k] + p - T) % p);
+        a[k]     = (uint64_t)(((__uint128_t)a[k] + T) % p);
+      }
+    }
+  }
+}
+
+typedef void (*goldilocks_fwd_func_t)(uint64_t       a[],
+                                      uint64_t       N,
+                                      const uint64_t w[]);
+typedef void (*goldilocks_inv_func_t)(uint64_t       a[],
+                                      uint64_t       N,
+                                      uint64_t       n_inv,
+                                      const uint64_t w_inv[]);
+
+static inline int test_goldilocks_variant(const test_case_t *   t,
+                                          const uint64_t        a_orig[],
+                                          const uint64_t        a_ntt[],
+                                          goldilocks_fwd_func_t fwd,
+                                          goldilocks_fwd_func_t fwd_lazy,
+                                          goldilocks_inv_func_t inv)
+{
+  uint64_t a[t->n];
+
+  for(size_t i = 0; i < t->n; i++) {
+    a[i] = goldilocks_input(a_orig, i);
+  }
+  fwd(a, t->n, t->w_powers_goldilocks.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)), "Bad results after Goldilocks fwd\n");
+
+  for(size_t i = 0; i < t->n; i++) {
+    a[i] = goldilocks_input(a_orig, i);
+  }
+  fwd_lazy(a, t->n, t->w_powers_goldilocks.ptr);
+  for(size_t i = 0; i < t->n; i++) {
+    if(goldilocks_canonical(a[i]) != a_ntt[i]) {
+      printf("Bad results after Goldilocks lazy fwd\n");
+      return ERROR;
+    }
+  }
+
+  inv(a, t->n, t->n_inv_goldilocks, t->w_inv_powers_goldilocks.ptr);
+  for(size_t i = 0; i < t->n; i++) {
+    if(a[i] != (goldilocks_input(a_orig, i) % GOLDILOCKS_Q)) {
+      printf("Bad results after Goldilocks inv\n");
+      return ERROR;
+    }
+  }
+
+  return SUCCESS;
+}
+
+static inline int test_goldilocks(const test_case_t *t, const uint64_t a_orig[])
+{
+  uint64_t a_ntt[t->n];
+
+  for(size_t i = 0; i < t->n; i++) {
+    a_ntt[i] = goldilocks_input(a_orig, i);
+  }
+  fwd_ntt_goldilocks_ref(a_ntt, t->n, t->w_powers_goldilocks.ptr);
+
+  printf("Running fwd/inv_ntt_goldilocks\n");
+  GUARD(test_goldilocks_variant(t, a_orig, a_ntt, fwd_ntt_goldilocks,
+                                fwd_ntt_goldilocks_lazy, inv_ntt_goldilocks))
+
+#ifdef __AVX2__
+  printf("Running fwd/inv_ntt_goldilocks_avx2\n");
+  GUARD(test_goldilocks_variant(t, a_orig, a_ntt, fwd_ntt_goldilocks_avx2,
+                                fwd_ntt_goldilocks_avx2_lazy,
+                                inv_ntt_goldilocks_avx2))
+#endif
+
+#ifdef AVX512_SUPPORT
+  printf("Running fwd/inv_ntt_goldilocks_avx512\n");
+  GUARD(test_goldilocks_variant(t, a_orig, a_ntt, fwd_ntt_goldilocks_avx512,
+                                fwd_ntt_goldilocks_avx512_lazy,
+                                inv_ntt_goldilocks_avx512))
+#endif
+
+  return SUCCESS;
+}
+
+typedef void (*goldilocks_coset_func_t)(uint64_t       out[],
+                                        const uint64_t in[],
+                                        uint64_t       N,
+                                        uint64_t       shift,
+                                        const uint64_t w[]);
+
+static inline int test_goldilocks_coset_variant(const test_case_t *     t,
+                                                const uint64_t          a_orig[],
+                                                const uint64_t          a_ntt[],
+                                                goldilocks_coset_func_t coset)
+{
+  uint64_t a[t->n];
+
+  for(size_t i = 0; i < t->n; i++) {
+    a[i] = goldilocks_input(a_orig, i);
+  }
+  coset(a, a, t->n, GOLDILOCKS_GENERATOR, t->w_powers_goldilocks.ptr);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)),
+            "Bad results after Goldilocks coset fwd\n");
+
+  return SUCCESS;
+}
+
+static inline int test_goldilocks_coset(const test_case_t *t,
+                                        const uint64_t     a_orig[])
+{
+  const uint64_t k = 4;
+  uint64_t       a_ntt[t->n];
+  uint64_t       b[t->n];
+  uint64_t       shifts[k];
+
+  // The reference scales the input explicitly.
+  for(size_t i = 0; i < t->n; i++) {
+    a_ntt[i] = mul_mod(goldilocks_input(a_orig, i) % GOLDILOCKS_Q,
+                       pow_mod(GOLDILOCKS_GENERATOR, i, GOLDILOCKS_Q),
+                       GOLDILOCKS_Q);
+  }
+  fwd_ntt_goldilocks_ref(a_ntt, t->n, t->w_powers_goldilocks.ptr);
+
+  printf("Running fwd_ntt_goldilocks_coset\n");
+  GUARD(test_goldilocks_coset_variant(t, a_orig, a_ntt,
+                                      fwd_ntt_goldilocks_coset))
+#ifdef __AVX2__
+  printf("Running fwd_ntt_goldilocks_avx2_coset\n");
+  GUARD(test_goldilocks_coset_variant(t, a_orig, a_ntt,
+                                      fwd_ntt_goldilocks_avx2_coset))
+#endif
+#ifdef AVX512_SUPPORT
+  printf("Running fwd_ntt_goldilocks_avx512_coset\n");
+  GUARD(test_goldilocks_coset_variant(t, a_orig, a_ntt,
+                                      fwd_ntt_goldilocks_avx512_coset))
+#endif
+
+  // Every coset of the LDE against a separate (in-place) coset NTT.
+  aligned64_ptr_t out;
+  GUARD(allocate_aligned_array(&out, k * t->n));
+
+  printf("Running lde_goldilocks\n");
+  calc_lde_shifts(shifts, k, t->n, GOLDILOCKS_GENERATOR, GOLDILOCKS_Q);
+  lde_goldilocks(out.ptr, a_orig, t->n, k, shifts, t->w_powers_goldilocks.ptr);
+
+  int ret = SUCCESS;
+  for(size_t j = 0; (j < k) && (SUCCESS == ret); j++) {
+    memcpy(b, a_orig, sizeof(b));
+    fwd_ntt_goldilocks_coset(b, b, t->n, shifts[j], t->w_powers_goldilocks.ptr);
+    if(0 != memcmp(b, &out.ptr[j * t->n], sizeof(b))) {
+      printf("Bad results after lde_goldilocks\n");
+      ret = ERROR;
+    }
+  }
+
+  free_aligned_array(&out);
+  return ret;
+}
+
+// (2^(64k) - 1)^2 = 2^(128k) - 2^(64k + 1) + 1.
+static inline int check_all_ones_square(const uint64_t c[], const size_t k)
+{
+  for(size_t i = 0; i < 2 * k; i++) {
+    const uint64_t expected = (i == 0)   ? 1
+                              : (i < k)  ? 0
+                              : (i == k) ? (UINT64_MAX - 1)
+                                         : UINT64_MAX;
+    if(c[i] != expected) {
+      return ERROR;
+    }
+  }
+  return SUCCESS;
+}
+
+// The NTT, Karatsuba and bigint_mul against the schoolbook multiplication,
+// with full 64-bit limbs. Squares of 2^(64k) - 1 give the largest convolution
+// coefficients and the longest carry chains.
+static inline int test_bigint(const test_case_t *t, const uint64_t a_orig[])
+{
+  const uint64_t    a_len = (t->n >> 3) + 1;
+  const uint64_t    b_len = (t->n >> 4) + 3;
+  uint64_t          a[a_len];
+  uint64_t          b[b_len];
+  uint64_t          c[2 * a_len];
+  uint64_t          ref[2 * a_len];
+  bigint_mul_plan_t plan;
+  int               ret = SUCCESS;
+
+  for(size_t i = 0; i < a_len; i++) {
+    a[i] = a_orig[i] * 0x9e3779b97f4a7c15UL; // NOLINT
+  }
+  for(size_t i = 0; i < b_len; i++) {
+    b[i] = ~(a_orig[a_len + i] * 0xc2b2ae3d27d4eb4fUL); // NOLINT
+  }
+  bigint_mul_schoolbook(ref, a, a_len, b, b_len);
+
+  printf("Running bigint_mul_ntt\n");
+  if(SUCCESS == bigint_mul_plan_init(&plan, BIGINT_MIN_M - 1)) {
+    bigint_mul_plan_destroy(&plan);
+    printf("bigint_mul_plan_init accepted m < BIGINT_MIN_M\n");
+    return ERROR;
+  }
+  GUARD(bigint_mul_plan_init(&plan, t->m - 2));
+  if((SUCCESS != bigint_mul_ntt(&plan, c, a, a_len, b, b_len)) ||
+     (0 != memcmp(ref, c, (a_len + b_len) * sizeof(uint64_t)))) {
+    printf("Bad results after bigint_mul_ntt\n");
+    ret = ERROR;
+  }
+
+  memset(a, 0xff, sizeof(a));
+  if((SUCCESS == ret) &&
+     ((SUCCESS != bigint_mul_ntt(&plan, c, a, a_len - 1, a, a_len - 1)) ||
+      (SUCCESS != check_all_ones_square(c, a_len - 1)))) {
+    printf("Bad results after bigint_mul_ntt of the largest operands\n");
+    ret = ERROR;
+  }
+  bigint_mul_plan_destroy(&plan);
+  GUARD(ret)
+
+  printf("Running bigint_mul_karatsuba\n");
+  GUARD(bigint_mul_karatsuba(c, a, a, a_len))
+  GUARD_MSG(check_all_ones_square(c, a_len),
+            "Bad results after bigint_mul_karatsuba of the largest operands\n");
+
+  for(size_t i = 0; i < b_len; i++) {
+    a[i] = a_orig[i] * 0x9e3779b97f4a7c15UL; // NOLINT
+  }
+  bigint_mul_schoolbook(ref, a, b_len, b, b_len);
+  GUARD(bigint_mul_karatsuba(c, a, b, b_len))
+  GUARD_MSG(memcmp(ref, c, 2 * b_len * sizeof(uint64_t)),
+            "Bad results after bigint_mul_karatsuba\n");
+
+  printf("Running bigint_mul\n");
+  for(size_t i = 0; i < a_len; i++) {
+    a[i] = a_orig[i] * 0x9e3779b97f4a7c15UL; // NOLINT
+  }
+  bigint_mul_schoolbook(ref, a, a_len, b, b_len);
+  GUARD(bigint_mul(c, b, b_len, a, a_len))
+  GUARD_MSG(memcmp(ref, c, (a_len + b_len) * sizeof(uint64_t)),
+            "Bad results after bigint_mul\n");
+
+  return SUCCESS;
+}
+
+// The NTTs of the count lines a[b * bs + i * stride] (i < N), every line is
+// copied to a contiguous buffer and transformed with fwd_ntt_radix4.
+static inline void fwd_lines_ref(uint64_t       a[],
+                                 const uint64_t N,
+                                 const uint64_t stride,
+                                 const uint64_t count,
+                                 const uint64_t bs,
+                                 const uint64_t q,
+                                 const uint64_t w[],
+                                 const uint64_t w_con[])
+{
+  uint64_t line[N];
+
+  for(size_t b = 0; b < count; b++) {
+    for(size_t i = 0; i < N; i++) {
+      line[i] = a[b * bs + i * stride];
+    }
+    fwd_ntt_radix4(line, N, q, w, w_con);
+    for(size_t i = 0; i < N; i++) {
+      a[b * bs + i * stride] = line[i];
+    }
+  }
+}
+
+static inline void fwd_ntt_nd_ref(const ntt_nd_plan_t *plan, uint64_t a[])
+{
+  size_t inner = 1;
+
+  for(size_t k = 0; k < plan->d; k++) {
+    inner *= plan->n[k];
+  }
+
+  for(size_t k = 0, outer = 1; k < plan->d; outer *= plan->n[k], k++) {
+    inner /= plan->n[k];
+    for(size_t o = 0; o < outer; o++) {
+      fwd_lines_ref(&a[o * plan->n[k] * inner], plan->n[k], inner, inner, 1,
+                    plan->q, plan->w[k], plan->w_con[k]);
+    }
+  }
+}
+
+// An array of shape 2^m[0] x ... x 2^m[d-1] = t->n.
+static inline int test_nd_shape(const test_case_t *t,
+                                const uint64_t     a_orig[],
+                                const uint64_t     m[],
+                                const uint64_t     d)
+{
+  uint64_t      a[t->n];
+  uint64_t      ref[t->n];
+  ntt_nd_plan_t plan;
+  int           ret = SUCCESS;
+
+  GUARD(ntt_nd_plan_init(&plan, m, d, t->q));
+  memcpy(a, a_orig, sizeof(a));
+  memcpy(ref, a_orig, sizeof(ref));
+
+  fwd_ntt_nd(&plan, a);
+  fwd_ntt_nd_ref(&plan, ref);
+  if(0 != memcmp(ref, a, sizeof(a))) {
+    printf("Bad results after fwd_ntt_nd\n");
+    ret = ERROR;
+  }
+
+  inv_ntt_nd(&plan, a);
+  if(0 != memcmp(a_orig, a, sizeof(a))) {
+    printf("Bad results after inv_ntt_nd\n");
+    ret = ERROR;
+  }
+
+  ntt_nd_plan_destroy(&plan);
+  return ret;
+}
+
+// The column NTTs of a rows x cols grid on two sets of columns: all but the
+// first one (the count is not a multiple of the vector lanes) and every other
+// one (batch stride 2, scalar butterflies only).
+static inline int test_strided(const test_case_t *t,
+                               const uint64_t     a_orig[],
+                               const uint64_t     m[2])
+{
+  const size_t  cols       = 1UL << m[1];
+  const size_t  sets[2][3] = {{1, cols - 1, 1}, {0, cols / 2, 2}};
+  uint64_t      a[t->n];
+  uint64_t      ref[t->n];
+  ntt_nd_plan_t plan;
+  int           ret = SUCCESS;
+
+  GUARD(ntt_nd_plan_init(&plan, m, 2, t->q));
+
+  for(size_t s = 0; (s < 2) && (SUCCESS == ret); s++) {
+    const size_t off = sets[s][0];
+    const size_t cnt = sets[s][1];
+    const size_t bs  = sets[s][2];
+
+    memcpy(a, a_orig, sizeof(a));
+    memcpy(ref, a_orig, sizeof(ref));
+
+    fwd_ntt_radix4_strided(&a[off], plan.n[0], cols, cnt, bs, t->q, plan.w[0],
+                           plan.w_con[0]);
+    fwd_lines_ref(&ref[off], plan.n[0], cols, cnt, bs, t->q, plan.w[0],
+                  plan.w_con[0]);
+    if(0 != memcmp(ref, a, sizeof(a))) {
+      printf("Bad results after fwd_ntt_radix4_strided\n");
+      ret = ERROR;
+    }
+
+    inv_ntt_radix4_strided(&a[off], plan.n[0], cols, cnt, bs, t->q,
+                           plan.n_inv[0], plan.w_inv[0], plan.w_inv_con[0]);
+    if(0 != memcmp(a_orig, a, sizeof(a))) {
+      printf("Bad results after inv_ntt_radix4_strided\n");
+      ret = ERROR;
+    }
+  }
+
+  ntt_nd_plan_destroy(&plan);
+  return ret;
+}
+
+static inline int test_nd(const test_case_t *t, const uint64_t a_orig[])
+{
+  const uint64_t m2[]    = {t->m / 2, t->m - (t->m / 2)};
+  const uint64_t m3[]    = {t->m / 3, t->m / 3, t->m - 2 * (t->m / 3)};
+  const uint64_t m_bad[] = {1, t->m - 1};
+  ntt_nd_plan_t  plan;
+
+  // N = 2 is rejected, and so is q = 2^31 - 1, where q - 1 = 2 * odd.
+  if((SUCCESS == ntt_nd_plan_init(&plan, m_bad, 2, t->q)) ||
+     (SUCCESS == ntt_nd_plan_init(&plan, m2, 2, 0x7fffffff))) {
+    ntt_nd_plan_destroy(&plan);
+    printf("ntt_nd_plan_init accepted an invalid shape or modulus\n");
+    return ERROR;
+  }
+
+  printf("Running fwd/inv_ntt_nd (2D)\n");
+  GUARD(test_nd_shape(t, a_orig, m2, 2))
+
+  printf("Running fwd/inv_ntt_nd (3D)\n");
+  GUARD(test_nd_shape(t, a_orig, m3, 3))
+
+  printf("Running fwd/inv_ntt_radix4_strided\n");
+  GUARD(test_strided(t, a_orig, m2))
+
+  return SUCCESS;
+}
+
+// a(x) of N coefficients (Horner).
+static inline uint64_t eval_poly(const uint64_t a[],
+                                 const size_t   N,
+                                 const uint64_t x,
+                                 const uint64_t q)
+{
+  uint64_t y = 0;
+  for(size_t i = N; i > 0; i--) {
+    y = (mul_mod(y, x, q) + a[i - 1]) % q;
+  }
+  return y;
+}
+
+// N = 3 * t->n / 4 with a prime whose q - 1 has the factor 3. The outputs
+// j * M + l, for 16 values of l, are compared against a direct evaluation.
+static inline int test_mixed_radix3(const test_case_t *t, const uint64_t a_orig[])
+{
+  const uint64_t  k      = t->m - 2;
+  const uint64_t  M      = 1UL << k;
+  const uint64_t  N      = 3 * M;
+  const uint64_t  size   = MIXED_RADIX3_W_SIZE(N);
+  const uint64_t  q      = find_ntt_prime(2 * N, 50);
+  const uint64_t  psi    = find_primitive_root(2 * N, q);
+  const uint64_t  ninv   = inv_mod(N, q);
+  const mul_op_t  n_inv  = {ninv, calc_ninv_con(ninv, q, WORD_SIZE)};
+  aligned64_ptr_t tables = {0};
+  uint64_t        a[N];
+  uint64_t        ref[N];
+  int             ret    = SUCCESS;
+
+  GUARD(allocate_aligned_array(&tables, 4 * size));
+  uint64_t *w         = tables.ptr;
+  uint64_t *w_con     = &w[size];
+  uint64_t *w_inv     = &w[2 * size];
+  uint64_t *w_inv_con = &w[3 * size];
+
+  calc_w_mixed_radix3(w, psi, N, q, k);
+  calc_w_con(w_con, w, size, q, WORD_SIZE);
+  calc_w_mixed_radix3(w_inv, inv_mod(psi, q), N, q, k);
+  calc_w_con(w_inv_con, w_inv, size, q, WORD_SIZE);
+
+  for(size_t i = 0; i < N; i++) {
+    ref[i] = a_orig[i] % q;
+  }
+
+  printf("Running fwd/inv_ntt_mixed_radix3\n");
+  memcpy(a, ref, sizeof(a));
+  fwd_ntt_mixed_radix3(a, N, q, w, w_con);
+  for(size_t j = 0; j < 3; j++) {
+    for(size_t l = 0; l < M; l += M / 16) {
+      const uint64_t e = (2 * ((3 * bit_rev_idx(l, k)) + j)) + 1;
+      if(a[(j * M) + l] != eval_poly(ref, N, pow_mod(psi, e, q), q)) {
+        printf("Bad results after fwd_ntt_mixed_radix3 (%lu)\n", (j * M) + l);
+        ret = ERROR;
+      }
+    }
+  }
+
+  inv_ntt_mixed_radix3(a, N, q, n_inv, w_inv, w_inv_con);
+  if(0 != memcmp(ref, a, sizeof(a))) {
+    printf("Bad results after inv_ntt_mixed_radix3\n");
+    ret = ERROR;
+  }
+
+  // The inverse NTT accepts the output of the lazy forward NTT.
+  fwd_ntt_mixed_radix3_lazy(a, N, q, w, w_con);
+  inv_ntt_mixed_radix3(a, N, q, n_inv, w_inv, w_inv_con);
+  if(0 != memcmp(ref, a, sizeof(a))) {
+    printf("Bad results after fwd_ntt_mixed_radix3_lazy\n");
+    ret = ERROR;
+  }
+
+  free_aligned_array(&tables);
+  return ret;
+}
+
+// b(X) = a(X^g) mod X^N + 1 in the coefficient domain.
+static inline void automorphism_ref(uint64_t       b[],
+                                    const uint64_t a[],
+                                    const uint64_t g,
+                                    const uint64_t N,
+                                    const uint64_t q)
+{
+  for(size_t i = 0; i < N; i++) {
+    const size_t j = (i * g) % (2 * N);
+    if(j < N) {
+      b[j] = a[i];
+    } else {
+      b[j - N] = (q - a[i]) % q;
+    }
+  }
+}
+
+// Rotations, and the conjugation, of two limbs (a and a reversed) in the NTT
+// domain against the automorphisms in the coefficient domain.
+static inline int test_automorphism(const test_case_t *t, const uint64_t a_orig[])
+{
+  const size_t    n         = t->n;
+  const int64_t   steps[]   = {1, 3, -1, -(int64_t)(n / 4) - 1};
+  const size_t    num_steps = sizeof(steps) / sizeof(steps[0]);
+  aligned64_ptr_t buf       = {0};
+  uint32_t        map[t->n];
+  int             ret = SUCCESS;
+
+  GUARD(allocate_aligned_array(&buf, 6 * n));
+  uint64_t *x   = buf.ptr;
+  uint64_t *ref = &x[2 * n];
+  uint64_t *out = &x[4 * n];
+
+  for(size_t i = 0; i < n; i++) {
+    x[i]     = a_orig[i];
+    x[n + i] = a_orig[n - 1 - i];
+  }
+
+  printf("Running ntt_automorphism\n");
+  for(size_t s = 0; (s <= num_steps) && (SUCCESS == ret); s++) {
+    const uint64_t g = (s < num_steps) ? galois_elt_rotation(steps[s], n)
+                                       : (2 * n) - 1;
+
+    calc_automorphism_map(map, g, n, t->m);
+    for(size_t l = 0; l < 2; l++) {
+      automorphism_ref(&ref[l * n], &x[l * n], g, n, t->q);
+      fwd_ntt_radix4(&ref[l * n], n, t->q, t->w_powers_r4.ptr,
+                     t->w_powers_con_r4.ptr);
+    }
+
+    // x is transformed in place for the NTT-domain automorphism and back.
+    for(size_t l = 0; l < 2; l++) {
+      fwd_ntt_radix4(&x[l * n], n, t->q, t->w_powers_r4.ptr,
+                     t->w_powers_con_r4.ptr);
+    }
+
+    ntt_automorphism(out, x, map, n, 2);
+    if(0 != memcmp(ref, out, 2 * n * sizeof(uint64_t))) {
+      printf("Bad results after ntt_automorphism (g = %lu)\n", g);
+      ret = ERROR;
+    }
+
+#ifdef AVX512_SUPPORT
+    if(n >= 8) {
+      memset(out, 0, 2 * n * sizeof(uint64_t));
+      ntt_automorphism_avx512(out, x, map, n, 2);
+      if(0 != memcmp(ref, out, 2 * n * sizeof(uint64_t))) {
+        printf("Bad results after ntt_automorphism_avx512 (g = %lu)\n", g);
+        ret = ERROR;
+      }
+    }
+#endif
+
+    for(size_t l = 0; l < 2; l++) {
+      inv_ntt_radix4(&x[l * n], n, t->q, t->n_inv, t->w_inv_powers_r4.ptr,
+                     t->w_inv_powers_con_r4.ptr);
+    }
+  }
+
+  free_aligned_array(&buf);
+  return ret;
+}
+
+// Every final reduction path against the scalar one, on N-3 values (to cover
+// the scalar tail) that span [0, f*q) including its upper edge.
+static inline int test_final_reduce(const test_case_t *t, const uint64_t a_orig[])
+{
+  const size_t n = t->n - 3;
+  uint64_t     a[n];
+  uint64_t     b[n];
+  uint64_t     c[n];
+
+  printf("Running final_reduce\n");
+  for(uint64_t f = 2; f <= 8; f <<= 1) {
+    for(size_t i = 0; i < n; i++) {
+      a[i] = (i % 7 == 0) ? (f * t->q) - 1 : a_orig[i] + ((i % f) * t->q);
+    }
+    memcpy(b, a, sizeof(a));
+    final_reduce_scalar(b, n, t->q, f);
+
+    memcpy(c, a, sizeof(a));
+    final_reduce_scalar(&c[final_reduce_gvec(c, n, t->q, f)], n % GVEC_LANES,
+                        t->q, f);
+    GUARD_MSG(memcmp(b, c, sizeof(c)), "Bad results after final_reduce_gvec\n");
+
+#ifdef __AVX2__
+    memcpy(c, a, sizeof(a));
+    final_reduce_scalar(&c[final_reduce_avx2(c, n, t->q, f)], n % 4, t->q, f);
+    GUARD_MSG(memcmp(b, c, sizeof(c)), "Bad results after final_reduce_avx2\n");
+#endif
+
+#ifdef AVX512_SUPPORT
+    memcpy(c, a, sizeof(a));
+    final_reduce_scalar(&c[final_reduce_avx512(c, n, t->q, f)], n % 8, t->q, f);
+    GUARD_MSG(memcmp(b, c, sizeof(c)),
+              "Bad results after final_reduce_avx512\n");
+#endif
+
+    final_reduce(a, n, t->q, f);
+    GUARD_MSG(memcmp(b, a, sizeof(a)), "Bad results after final_reduce\n");
+    for(size_t i = 0; i < n; i++) {
+      if(b[i] >= t->q) {
+        printf("Bad results after final_reduce_scalar\n");
+        return ERROR;
+      }
+    }
+  }
+
+  return SUCCESS;
+}
+
+static inline int
+test_autotune(const test_case_t *t, uint64_t a_orig[], uint64_t a_ntt[])
+{
+  uint64_t   a[t->n];
+  ntt_plan_t plan;
+  char       wisdom_path[] = "/tmp/ntt_wisdom_XXXXXX";
+  int        fd;
+  int        ret = SUCCESS;
+
+  memcpy(a, a_orig, sizeof(a));
+  printf("Running ntt_plan_fwd (estimate)\n");
+  GUARD(ntt_plan_init(&plan, t->m, t->q, t->w, NTT_PLAN_ESTIMATE, NULL));
+  ntt_plan_fwd(&plan, a);
+  GUARD_MSG(memcmp(a_ntt, a, sizeof(a)), "Bad results after estimated plan\n");
+
+  printf("Running ntt_plan_inv\n");
+  ntt_plan_inv(&plan, a);
+  GUARD_MSG(memcmp(a_orig, a, sizeof(a)), "Bad results after plan inv\n");
+
+  // Lazy input in [0, 2q) and the lazy output of the kernel, which feeds
+  // the inverse without any reduction.
+  printf("Running ntt_plan_fwd/inv_mod_factor\n");
+  const uint64_t out_mod_factor = ntt_plan_out_mod_factor(&plan);
+  for(size_t i = 0; i < t->n; i++) {
+    a[i] = a_orig[i] + ((i & 1) * t->q);
+  }
+  if((SUCCESS != ntt_plan_fwd_mod_factor(&plan, a, 3, 1)) &&
+     (SUCCESS != ntt_plan_fwd_mod_factor(&plan, a, 2, 16)) &&
+     (SUCCESS != ntt_plan_inv_mod_factor(&plan, a, 0, 1))) {
+    ret = ntt_plan_fwd_mod_factor(&plan, a, 2, out_mod_factor);
+  } else {
+    ret = ERROR;
+  }
+  for(size_t i = 0; (i < t->n) && (SUCCESS == ret); i++) {
+    if((a[i] >= out_mod_factor * t->q) || ((a[i] % t->q) != a_ntt[i])) {
+      ret = ERROR;
+    }
+  }
+  if(SUCCESS == ret) {
+    ret = ntt_plan_inv_mod_factor(&plan, a, out_mod_factor, 1);
+  }
+  ntt_plan_destroy(&plan);
+  GUARD_MSG(ret | memcmp(a_orig, a, sizeof(a)),
+            "Bad results after ntt_plan_fwd/inv_mod_factor\n");
+
+  // Measuring times every kernel, so it runs once, for the first N that
+  // leaves the recursive kernels more than one cut-off to try.
+  static int measured = 0;
+  if(measured || (t->n < 2048)) {
+    return SUCCESS;
+  }
+  measured = 1;
+
+  if(-1 == (fd = mkstemp(wisdom_path))) {
+    return ERROR;
+  }
+  close(fd);
+
+  memcpy(a, a_orig, sizeof(a));
+  printf("Running ntt_plan_fwd (measure)\n");
+  if(SUCCESS !=
+     ntt_plan_init(&plan, t->m, t->q, t->w, NTT_PLAN_MEASURE, wisdom_path)) {
+    unlink(wisdom_path);
+    return ERROR;
+  }
+  const ntt_kernel_t tuned        = plan.kernel;
+  const uint64_t     tuned_base_n = plan.rec_base_n;
+  ntt_plan_fwd(&plan, a);
+  ntt_plan_destroy(&plan);
+
+  if(0 != memcmp(a_ntt, a, sizeof(a))) {
+    printf("Bad results after measured plan\n");
+    ret = ERROR;
+  }
+
+  // A new plan must be created from the wisdom file (without measuring).
+  if((SUCCESS == ret) &&
+     ((SUCCESS != ntt_plan_init(&plan, t->m, t->q, t->w, NTT_PLAN_ESTIMATE,
+                                wisdom_path)) ||
+      (plan.kernel != tuned) || (plan.rec_base_n != tuned_base_n))) {
+    printf("Bad kernel after loading the wisdom file\n");
+    ret = ERROR;
+  }
+  ntt_plan_destroy(&plan);
+
+  unlink(wisdom_path);
+  return ret;
+}
+
 int test_correctness(const test_case_t *t)
 {
   // Prepare input
@@ -271,14 +1606,46 @@ int test_correctness(const test_case_t *t)
   GUARD(test_radix2_scalar(t, a));
   GUARD(test_radix2_scalar_dbl(t, a, b, a_ntt));
   GUARD(test_radix2_scalar_seal(t, a, a_ntt))
-  GUARD(test_radix4_scalar(t, a, a_ntt))
-  GUARD(test_radix4x4_scalar(t, a, a_ntt))
+#ifdef AVX512_SUPPORT
+  if(!skip_tests(t, AVX512_MAX_MODULUS_MASK, "AVX512-F")) {
+    GUARD(test_radix4_avx512(t, a, a_ntt))
+  }
+#endif
+
+  // The Goldilocks, bigint and mixed-radix tests use their own moduli.
+  GUARD(test_goldilocks(t, a))
+  GUARD(test_goldilocks_coset(t, a))
+  GUARD(test_bigint(t, a))
+  GUARD(test_mixed_radix3(t, a))
+
+  if(!skip_tests(t, LAZY8_MAX_MODULUS_MASK, "scalar radix-4/8")) {
+    GUARD(test_radix4_scalar(t, a, a_ntt))
+    GUARD(test_radix4_trunc(t, a))
+    GUARD(test_radix4_partial(t, a, a_ntt))
+    GUARD(test_radix4_rec(t, a, a_ntt))
+    GUARD(test_radix4_gvec(t, a, a_ntt))
+    GUARD(test_radix4x4_scalar(t, a, a_ntt))
+    GUARD(test_radix8_scalar(t, a, a_ntt))
+    GUARD(test_radix4_natural(t, a, a_ntt))
+    GUARD(test_cyclic(t, a))
+    GUARD(test_final_reduce(t, a))
+    GUARD(test_nd(t, a))
+    GUARD(test_automorphism(t, a))
+    GUARD(test_autotune(t, a, a_ntt))
+  }
 #ifdef S390X
-  GUARD(test_radix4_intrinsic(t, a, a_ntt))
-  GUARD(test_radix4_intrinsic_dbl(t, a, b, a_ntt))
-#elif AVX512_IFMA_SUPPORT
-  GUARD(test_radix2_hexl(t, a, a_ntt))
-  GUARD(test_radix4_avx512_ifma(t, a, a_ntt))
+  // The VMSL kernels keep their [0, 8q) values in 56-bit words.
+  if(!skip_tests(t, ~((1UL << (VMSL_WORD_SIZE - 3)) - 1), "VMSL")) {
+    GUARD(test_radix4_intrinsic(t, a, a_ntt))
+    GUARD(test_radix4_intrinsic_dbl(t, a, b, a_ntt))
+  }
+#endif
+#ifdef AVX512_IFMA_SUPPORT
+  if(!skip_tests(t, AVX512_IFMA_MAX_MODULUS_MASK, "AVX512-IFMA")) {
+    GUARD(test_radix2_hexl(t, a, a_ntt))
+    GUARD(test_radix4_avx512_ifma(t, a, a_ntt))
+    GUARD(test_pointwise_avx512_ifma(t, a))
+  }
 #endif
 
   return SUCCESS;
@@ -20,20 +20,41 @@ typedef enum
   FWD_R4_AVX512_IFMA_UNORDERED,
   FWD_R4R2_AVX512_IFMA,
   FWD_R2_R16_AVX512_IFMA,
-  MAX_FWD = FWD_R2_R16_AVX512_IFMA
+  FWD_R8,
+  FWD_R8_AVX512_IFMA,
+  FWD_R4_AVX512_IFMA_LEAF,
+  FWD_R4_REC,
+  FWD_R4_AVX512_IFMA_REC,
+  FWD_R4_AVX512,
+  FWD_R4_GVEC,
+  MAX_FWD = FWD_R4_GVEC
 } func_num_t;
 
 #ifdef TEST_SPEED
 
 void report_test_fwd_perf_headers(void);
 void report_test_inv_perf_headers(void);
+void report_test_cyclic_perf_headers(void);
+void report_test_oop_perf_headers(void);
 
 void test_aligned_fwd_perf(const test_case_t *t);
 void test_unaligned_fwd_perf(const test_case_t *t);
 void test_inv_perf(const test_case_t *t);
+void test_cyclic_perf(const test_case_t *t);
+void test_oop_perf(const test_case_t *t);
 
 void test_fwd_single_case(const test_case_t *t, func_num_t func_num);
 
+#  ifndef INTEL_SDE
+void run_roofline_sweep(uint64_t q_bits);
+void run_autotune(const char *wisdom_path, uint64_t q_bits);
+void run_bigint_bench(void);
+void run_goldilocks_bench(void);
+void run_nd_bench(uint64_t q_bits);
+void run_trunc_bench(uint64_t q_bits);
+void run_galois_bench(uint64_t q_bits);
+#  endif
+
 #else
 
 int test_correctness(const test_case_t *t);
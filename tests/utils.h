@@ -12,7 +12,13 @@ EXTERNC_BEGIN
 static inline void random_buf(uint64_t *values, const size_t n, const uint64_t q)
 {
   for(size_t i = 0; i < n; i++) {
-    values[i] = rand() % q;
+    uint64_t r = (uint64_t)rand();
+
+    // A single rand() does not cover the moduli above RAND_MAX.
+    for(uint64_t range = RAND_MAX; range < q; range = (range << 16) | 0xffff) {
+      r = (r << 16) ^ (uint64_t)rand();
+    }
+    values[i] = r % q;
   }
 }
 
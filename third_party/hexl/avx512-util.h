@@ -162,3 +162,13 @@ static inline __m512i _mm512_hexl_mulhi_epi_52(__m512i x, __m512i y) {
   __m512i zero = _mm512_set1_epi64(0);
   return _mm512_madd52hi_epu64(zero, x, y);
 }
+
+// Returns (x + y) mod q; assumes 0 < x, y < q
+static inline __m512i _mm512_hexl_small_add_mod_epi64(__m512i x, __m512i y,
+                                                      __m512i q) {
+  HEXL_CHECK_BOUNDS(ExtractValues(x).data(), 8, ExtractValues(q)[0],
+                    "x exceeds bound " << ExtractValues(q)[0]);
+  HEXL_CHECK_BOUNDS(ExtractValues(y).data(), 8, ExtractValues(q)[0],
+                    "y exceeds bound " << ExtractValues(q)[0]);
+  return _mm512_hexl_small_mod_epu64(_mm512_add_epi64(x, y), q);
+}